@@ -0,0 +1,47 @@
+#pragma once
+
+#include "nfs/attr_cache.hpp"
+#include "rpc/rpc_pool.hpp"
+
+#include <chrono>
+
+// Connection options shared by NFSClient, Nfs4Client and Nfs41Client.
+struct ClientOptions {
+    // Number of TCP connections to the NFS server (Linux "nconnect=").
+    // Calls are spread across them according to `conn_policy`.
+    unsigned   nconnect    = 1;
+    ConnPolicy conn_policy = ConnPolicy::ROUND_ROBIN;
+
+    // NFSv4.1 only: fore-channel slots requested in CREATE_SESSION, i.e. how
+    // many COMPOUNDs may be outstanding at once.  The server may grant fewer.
+    uint32_t   session_slots = 64;
+
+    // NFSv4.1: READ/WRITE payload size to negotiate.  The fore channel is
+    // sized to carry this plus framing; larger transfers are split to fit what
+    // the server actually grants.  NFSv4.0: the READ/WRITE size of
+    // read_whole_file() / write_whole_file(), lowered to the server's
+    // maxread / maxwrite.
+    uint32_t   max_io_size   = 1u << 20;
+
+    // Port of the server's portmapper (RPCBIND), through which the NFS and
+    // MOUNT ports are resolved.  Only test servers listen elsewhere.
+    uint16_t   portmap_port  = 111;
+
+    // NFSv4: pause before sending an OPEN again that the server refused with
+    // NFS4ERR_GRACE while recovering from a restart (RFC 7530 §8.6).  This
+    // applies to open_read() / open_write() and to compound().
+    std::chrono::milliseconds grace_delay{5000};
+
+    // NFSv3 only: cache attributes from replies and answer GETATTR from the
+    // cache while they are fresh.  Off by default, so that every call still
+    // reaches the server ("noac"); true behaves like a Linux default mount.
+    bool                     attr_cache = false;
+    nfs3::AttrCacheTimeouts  attr_timeouts;
+
+    // NFSv3 and v4.0: cache LOOKUP results, names that do not exist included
+    // (Linux "lookupcache=all"; false is "lookupcache=none").  A directory's
+    // entries are trusted for attr_timeouts.acdirmin after its mtime / change
+    // attribute was last checked.  In NFSv3 this needs `attr_cache`.  Off
+    // by default.
+    bool                     lookup_cache = false;
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Directory-name lookup cache: (directory handle, name) -> handle, or "no such
+// name" for negative entries.  Shared by NFSClient (Fh = Fh3) and Nfs4Client
+// (Fh = Nfs4Fh); any handle type with a `data` byte vector will do.
+//
+// Entries are tied to a version of their directory — its mtime in NFSv3, its
+// change attribute in NFSv4 — which the client reports through observe_dir()
+// whenever it reads it from the server.  An entry answers only while the
+// directory still has the version it was recorded under, and only while that
+// version was confirmed within `dir_timeout`; past that, get() asks the
+// caller to REVALIDATE the directory first.  A directory whose version moved
+// on loses all its entries at once.
+//
+// Names the client creates or removes itself are put() or forget()ed directly,
+// so its own changes cost no extra round trip.  The cache holds at most
+// `max_entries` names and drops the least recently used.  Thread-safe.
+template <typename Fh>
+class DentryCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State {
+        MISS,         // nothing (valid) cached: ask the server
+        FOUND,        // `fh` is the answer
+        NOT_FOUND,    // negative entry: the name does not exist
+        REVALIDATE,   // cached, but the directory must be re-read first
+    };
+
+    struct Result {
+        State state = State::MISS;
+        Fh    fh{};
+    };
+
+    struct Stats {
+        uint64_t hits          = 0;
+        uint64_t negative_hits = 0;
+        uint64_t misses        = 0;
+        uint64_t invalidations = 0;   // directories found changed
+    };
+
+    explicit DentryCache(Clock::duration dir_timeout, size_t max_entries = 16384)
+        : dir_timeout_(dir_timeout), max_entries_(max_entries) {}
+
+    Result get(const Fh& dir, const std::string& name) {
+        const auto now = Clock::now();
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto it = entries_.find(key(dir, name));
+        const auto d  = dirs_.find(dir_key(dir));
+        if (it == entries_.end() || d == dirs_.end() ||
+            it->second.version != d->second.version) {
+            ++stats_.misses;
+            return {};
+        }
+        if (now - d->second.confirmed >= dir_timeout_) return {State::REVALIDATE, {}};
+
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        if (it->second.negative) {
+            ++stats_.negative_hits;
+            return {State::NOT_FOUND, {}};
+        }
+        ++stats_.hits;
+        return {State::FOUND, it->second.fh};
+    }
+
+    // `dir` was just seen on the server at `version`.
+    void observe_dir(const Fh& dir, uint64_t version) {
+        const auto now = Clock::now();
+        std::string dk = dir_key(dir);
+        std::lock_guard<std::mutex> lk(mu_);
+        if (dirs_.size() >= max_entries_ && dirs_.count(dk) == 0) prune_dirs();
+        auto [d, inserted] = dirs_.try_emplace(std::move(dk), Dir{version, now, 0});
+        if (!inserted && d->second.version != version) {
+            ++stats_.invalidations;    // stale entries go on their next get()
+            d->second.version = version;
+        }
+        d->second.confirmed = now;
+    }
+
+    // Record the outcome of a lookup (or of our own create / remove) under
+    // the directory's current version.  Ignored for an unobserved directory.
+    void put(const Fh& dir, const std::string& name, const Fh& fh) {
+        store(dir, name, false, fh);
+    }
+    void put_negative(const Fh& dir, const std::string& name) {
+        store(dir, name, true, Fh{});
+    }
+
+    void forget(const Fh& dir, const std::string& name) {
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto it = entries_.find(key(dir, name));
+        if (it != entries_.end()) erase(it);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lk(mu_);
+        entries_.clear();
+        lru_.clear();
+        dirs_.clear();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return stats_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return entries_.size();
+    }
+
+private:
+    struct Dir {
+        uint64_t          version;
+        Clock::time_point confirmed;
+        size_t            entries;     // names cached under this directory
+    };
+
+    struct Entry {
+        std::string                      dir;
+        bool                             negative;
+        Fh                               fh;
+        uint64_t                         version;
+        std::list<std::string>::iterator lru;
+    };
+
+    using EntryMap = std::unordered_map<std::string, Entry>;
+
+    static std::string dir_key(const Fh& dir) {
+        return std::string(dir.data.begin(), dir.data.end());
+    }
+
+    // Length-prefixed so that no handle/name pair can collide with another.
+    static std::string key(const Fh& dir, const std::string& name) {
+        std::string k(1, static_cast<char>(dir.data.size()));
+        k.append(dir.data.begin(), dir.data.end());
+        k += name;
+        return k;
+    }
+
+    void store(const Fh& dir, const std::string& name, bool negative, const Fh& fh) {
+        std::string dk = dir_key(dir);
+        std::string k  = key(dir, name);
+        std::lock_guard<std::mutex> lk(mu_);
+        const auto d = dirs_.find(dk);
+        if (d == dirs_.end()) return;
+
+        const auto it = entries_.find(k);
+        if (it != entries_.end()) {
+            it->second.negative = negative;
+            it->second.fh       = fh;
+            it->second.version  = d->second.version;
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return;
+        }
+        ++d->second.entries;
+        const uint64_t version = d->second.version;
+        lru_.push_front(k);
+        entries_.emplace(std::move(k), Entry{std::move(dk), negative, fh, version, lru_.begin()});
+        while (entries_.size() > max_entries_) erase(entries_.find(lru_.back()));
+    }
+
+    // Directories observed but holding no names (their lookups failed).
+    void prune_dirs() {
+        for (auto it = dirs_.begin(); it != dirs_.end();) {
+            if (it->second.entries == 0) it = dirs_.erase(it);
+            else                         ++it;
+        }
+    }
+
+    void erase(typename EntryMap::iterator it) {
+        const auto d = dirs_.find(it->second.dir);
+        if (d != dirs_.end() && --d->second.entries == 0) dirs_.erase(d);
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+    }
+
+    Clock::duration                      dir_timeout_;
+    size_t                               max_entries_;
+    mutable std::mutex                   mu_;
+    EntryMap                             entries_;
+    std::list<std::string>               lru_;      // most recently used first
+    std::unordered_map<std::string, Dir> dirs_;
+    Stats                                stats_;
+};
@@ -8,28 +8,34 @@ static constexpr uint32_t NFS_PROG       = 100003;
 static constexpr uint32_t NFS_VERS       = 3;
 static constexpr uint32_t NFSPROC3_ACCESS = 4;
 
-std::vector<uint8_t> encode_access_args(const Fh3& fh, uint32_t access_mask) {
-    XdrEncoder enc;
+void encode_access_args(XdrEncoder& enc, const Fh3& fh, uint32_t access_mask) {
     encode_fh3(enc, fh);
     enc.put_uint32(access_mask);
+}
+
+std::vector<uint8_t> encode_access_args(const Fh3& fh, uint32_t access_mask) {
+    XdrEncoder enc;
+    encode_access_args(enc, fh, access_mask);
     return enc.release();
 }
 
-uint32_t decode_access_reply(const std::vector<uint8_t>& data) {
+uint32_t decode_access_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // ACCESS3res always carries obj_attributes (post_op_attr) in both OK and fail.
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, fh);
     if (status != 0)
         throw NfsError(status, "ACCESS");
     // ACCESS3resok: access (uint32)
     return dec.get_uint32();
 }
 
-uint32_t access(TcpRpcClient& client, const Fh3& fh, uint32_t access_mask) {
-    const auto args  = encode_access_args(fh, access_mask);
+uint32_t access(TcpRpcClient& client, const Fh3& fh, uint32_t access_mask,
+                AttrCache* cache) {
+    XdrEncoder args;
+    encode_access_args(args, fh, access_mask);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_ACCESS, args);
-    return decode_access_reply(reply);
+    return decode_access_reply(reply, cache, fh);
 }
 
 }  // namespace nfs3
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -18,13 +19,16 @@ static constexpr uint32_t ACCESS3_DELETE  = 0x0010;
 static constexpr uint32_t ACCESS3_EXECUTE = 0x0020;
 
 // Encode/decode helpers (pure, no network)
+void                 encode_access_args(XdrEncoder& enc, const Fh3& fh, uint32_t access_mask);
 std::vector<uint8_t> encode_access_args(const Fh3& fh, uint32_t access_mask);
-uint32_t             decode_access_reply(const std::vector<uint8_t>& data);
+uint32_t             decode_access_reply(const std::vector<uint8_t>& data,
+                                         AttrCache* cache = nullptr, const Fh3& fh = {});
 
 // NFSPROC3_ACCESS (proc 4): check access permissions.
 // Returns the bitmask of permissions actually granted — which may be a subset
 // of access_mask (server can deny some bits), or even a superset (servers are
 // allowed to return extra bits).
-uint32_t access(TcpRpcClient& client, const Fh3& fh, uint32_t access_mask);
+uint32_t access(TcpRpcClient& client, const Fh3& fh, uint32_t access_mask,
+                AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -0,0 +1,138 @@
+#include "attr_cache.hpp"
+
+#include <algorithm>
+
+namespace nfs3 {
+
+static bool same_time(const Nfstime3& a, const Nfstime3& b) {
+    return a.seconds == b.seconds && a.nseconds == b.nseconds;
+}
+
+// Whether `a` still looks like `before`: what wcc_attr and the adaptive
+// timeout compare (size, mtime and ctime).
+static bool unchanged(const Fattr3& a, const WccAttr3& before) {
+    return a.size == before.size && same_time(a.mtime, before.mtime) &&
+           same_time(a.ctime, before.ctime);
+}
+
+// Whether `a` predates `cached`: its ctime is earlier, so it was sampled
+// before a change the cache has already seen.
+static bool older(const Fattr3& a, const Fattr3& cached) {
+    return a.ctime.seconds < cached.ctime.seconds ||
+           (a.ctime.seconds == cached.ctime.seconds && a.ctime.nseconds < cached.ctime.nseconds);
+}
+
+static WccAttr3 wcc_attr(const Fattr3& a) {
+    return WccAttr3{a.size, a.mtime, a.ctime};
+}
+
+std::optional<Fattr3> AttrCache::get(const Fh3& fh) {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lk(mu_);
+    const auto it = entries_.find(key(fh));
+    if (it == entries_.end() || now >= it->second.expires) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.attrs;
+}
+
+void AttrCache::update(const Fh3& fh, const Fattr3& attrs) {
+    const auto now = Clock::now();
+    std::string k = key(fh);
+    std::lock_guard<std::mutex> lk(mu_);
+    const auto it = entries_.find(k);
+    if (it != entries_.end() && older(attrs, it->second.attrs)) {
+        ++stats_.out_of_order;
+        return;
+    }
+    const Clock::duration timeout =
+        it != entries_.end() && unchanged(it->second.attrs, wcc_attr(attrs))
+            ? 2 * it->second.timeout
+            : min_timeout(attrs);
+    store(std::move(k), attrs, timeout, now);
+}
+
+bool AttrCache::update(const Fh3& fh, const WccData3& wcc) {
+    const auto now = Clock::now();
+    std::string k = key(fh);
+    std::lock_guard<std::mutex> lk(mu_);
+    const auto it = entries_.find(k);
+
+    // A reply overtaken by a later one tells nothing new.
+    if (it != entries_.end() && wcc.after.present && older(wcc.after.attrs, it->second.attrs)) {
+        ++stats_.out_of_order;
+        return true;
+    }
+
+    // Without pre-op attributes (or anything cached) the change cannot be
+    // told apart from someone else's; only a mismatch counts as foreign.
+    const bool known   = it != entries_.end() && wcc.before.present;
+    const bool foreign = known && !unchanged(it->second.attrs, wcc.before.attrs);
+    if (foreign) ++stats_.foreign_changes;
+
+    if (!wcc.after.present) {
+        if (it != entries_.end()) erase(it);
+        return !foreign;
+    }
+    const Clock::duration timeout =
+        known && !foreign ? it->second.timeout : min_timeout(wcc.after.attrs);
+    store(std::move(k), wcc.after.attrs, timeout, now);
+    return !foreign;
+}
+
+void AttrCache::invalidate(const Fh3& fh) {
+    std::lock_guard<std::mutex> lk(mu_);
+    const auto it = entries_.find(key(fh));
+    if (it != entries_.end()) erase(it);
+}
+
+void AttrCache::clear() {
+    std::lock_guard<std::mutex> lk(mu_);
+    entries_.clear();
+    lru_.clear();
+}
+
+AttrCache::Stats AttrCache::stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return stats_;
+}
+
+size_t AttrCache::size() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return entries_.size();
+}
+
+void AttrCache::store(std::string k, const Fattr3& attrs, Clock::duration timeout,
+                      Clock::time_point now) {
+    timeout = std::clamp(timeout, min_timeout(attrs), max_timeout(attrs));
+    const auto it = entries_.find(k);
+    if (it != entries_.end()) {
+        it->second.attrs   = attrs;
+        it->second.timeout = timeout;
+        it->second.expires = now + timeout;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return;
+    }
+    lru_.push_front(k);
+    entries_.emplace(std::move(k), Entry{attrs, timeout, now + timeout, lru_.begin()});
+    while (entries_.size() > max_entries_) erase(entries_.find(lru_.back()));
+}
+
+AttrCache::Clock::duration AttrCache::min_timeout(const Fattr3& a) const {
+    return a.type == Ftype3::NF3DIR ? timeouts_.acdirmin : timeouts_.acregmin;
+}
+
+AttrCache::Clock::duration AttrCache::max_timeout(const Fattr3& a) const {
+    return std::max(min_timeout(a), Clock::duration(
+        a.type == Ftype3::NF3DIR ? timeouts_.acdirmax : timeouts_.acregmax));
+}
+
+void AttrCache::erase(EntryMap::iterator it) {
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+}  // namespace nfs3
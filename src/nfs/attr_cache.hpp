@@ -0,0 +1,123 @@
+#pragma once
+
+#include "nfs3_types.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace nfs3 {
+
+// How long cached attributes stay valid (Linux "acregmin=" ... "acdirmax=").
+// An entry starts at the minimum; each time the server confirms it unchanged
+// the period doubles, up to the maximum, and any change drops it back.
+struct AttrCacheTimeouts {
+    std::chrono::milliseconds acregmin{3000};
+    std::chrono::milliseconds acregmax{60000};
+    std::chrono::milliseconds acdirmin{30000};
+    std::chrono::milliseconds acdirmax{60000};
+};
+
+// Client-side attribute cache keyed by file handle, fed with the fattr3,
+// post_op_attr and wcc_data that replies carry so that GETATTR need not ask
+// again.  Thread-safe.
+//
+// wcc_data is checked as RFC 1813 §2.6 intends: if the pre-operation
+// attributes equal the cached ones, nobody else touched the object between
+// our last look and our change, and the post-operation attributes are taken
+// as is.  Otherwise the object also changed behind our back; the new
+// attributes are still cached, but on the shortest timeout, and the change is
+// counted in stats().foreign_changes.
+//
+// Replies may be handled out of order (nconnect, pipelined calls), so
+// attributes whose ctime is older than the cached ones are ignored: ctime
+// moves forward with every change to the object.  These are counted in
+// stats().out_of_order.
+//
+// The cache holds at most `max_entries` handles and drops the least recently
+// used.
+class AttrCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t hits            = 0;
+        uint64_t misses          = 0;
+        uint64_t foreign_changes = 0;   // wcc pre-op attributes did not match
+        uint64_t out_of_order    = 0;   // older than the cached attributes
+    };
+
+    explicit AttrCache(const AttrCacheTimeouts& timeouts = {}, size_t max_entries = 65536)
+        : timeouts_(timeouts), max_entries_(max_entries) {}
+
+    // The cached attributes of `fh` if they have not expired.
+    std::optional<Fattr3> get(const Fh3& fh);
+
+    // Attributes the server just returned for `fh`, unless older than the
+    // cached ones.
+    void update(const Fh3& fh, const Fattr3& attrs);
+    void update(const Fh3& fh, const PostOpAttr3& attrs) {
+        if (attrs.present) update(fh, attrs.attrs);
+    }
+
+    // wcc_data of a call that modified `fh`.  Returns false if the pre-op
+    // attributes show a change by someone else.
+    bool update(const Fh3& fh, const WccData3& wcc);
+
+    void invalidate(const Fh3& fh);
+    void clear();
+
+    Stats  stats() const;
+    size_t size() const;
+
+private:
+    struct Entry {
+        Fattr3                           attrs;
+        Clock::duration                  timeout;
+        Clock::time_point                expires;
+        std::list<std::string>::iterator lru;
+    };
+
+    using EntryMap = std::unordered_map<std::string, Entry>;
+
+    static std::string key(const Fh3& fh) {
+        return std::string(fh.data.begin(), fh.data.end());
+    }
+
+    // Store `attrs` under `k` with `timeout`, clamped to the type's range.
+    void store(std::string k, const Fattr3& attrs, Clock::duration timeout, Clock::time_point now);
+    Clock::duration min_timeout(const Fattr3& a) const;
+    Clock::duration max_timeout(const Fattr3& a) const;
+    void erase(EntryMap::iterator it);
+
+    AttrCacheTimeouts                      timeouts_;
+    size_t                                 max_entries_;
+    mutable std::mutex                     mu_;
+    EntryMap                               entries_;
+    std::list<std::string>                 lru_;      // most recently used first
+    Stats                                  stats_;
+};
+
+// Reply decoding helpers: read a post_op_attr / wcc_data belonging to `fh`
+// and file it in `cache`, or just step over it if `cache` is null.
+inline void cache_post_op_attr(XdrDecoder& dec, AttrCache* cache, const Fh3& fh) {
+    if (!cache) {
+        skip_post_op_attr(dec);
+        return;
+    }
+    cache->update(fh, decode_post_op_attr(dec));
+}
+
+inline void cache_wcc_data(XdrDecoder& dec, AttrCache* cache, const Fh3& fh) {
+    if (!cache) {
+        skip_wcc_data(dec);
+        return;
+    }
+    cache->update(fh, decode_wcc_data(dec));
+}
+
+}  // namespace nfs3
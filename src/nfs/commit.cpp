@@ -9,35 +9,44 @@ static constexpr uint32_t NFS_VERS        = 3;
 static constexpr uint32_t NFSPROC3_COMMIT = 21;
 static constexpr size_t   VERF_SIZE       = 8;
 
+void encode_commit_args(XdrEncoder& enc,
+                        const Fh3& fh,
+                        uint64_t offset,
+                        uint32_t count) {
+    encode_fh3(enc, fh);
+    enc.put_uint64(offset);
+    enc.put_uint32(count);
+}
+
 std::vector<uint8_t> encode_commit_args(const Fh3& fh,
                                          uint64_t offset,
                                          uint32_t count) {
     XdrEncoder enc;
-    encode_fh3(enc, fh);
-    enc.put_uint64(offset);
-    enc.put_uint32(count);
+    encode_commit_args(enc, fh, offset, count);
     return enc.release();
 }
 
-CommitVerf3 decode_commit_reply(const std::vector<uint8_t>& data) {
+CommitVerf3 decode_commit_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                const Fh3& fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // COMMIT3res always carries file_wcc in both OK and fail.
-    skip_wcc_data(dec);
+    cache_wcc_data(dec, cache, fh);
     if (status != 0)
         throw NfsError(status, "COMMIT");
     // COMMIT3resok: writeverf3 (8-byte fixed opaque)
     CommitVerf3 verf{};
-    const auto v = dec.get_fixed_opaque(VERF_SIZE);
-    std::copy(v.begin(), v.end(), verf.begin());
+    const XdrSegment v = dec.get_fixed_opaque_view(VERF_SIZE);
+    std::copy(v.data, v.data + v.size, verf.begin());
     return verf;
 }
 
 CommitVerf3 commit(TcpRpcClient& client, const Fh3& fh,
-                   uint64_t offset, uint32_t count) {
-    const auto args  = encode_commit_args(fh, offset, count);
+                   uint64_t offset, uint32_t count, AttrCache* cache) {
+    XdrEncoder args;
+    encode_commit_args(args, fh, offset, count);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_COMMIT, args);
-    return decode_commit_reply(reply);
+    return decode_commit_reply(reply, cache, fh);
 }
 
 }  // namespace nfs3
@@ -11,31 +11,44 @@ static constexpr uint32_t NFS_VERS        = 3;
 static constexpr uint32_t NFSPROC3_CREATE = 8;
 static constexpr size_t   CREATE_VERF_SIZE = 8;
 
-std::vector<uint8_t> encode_create_args(const Fh3& dir, const std::string& name,
-                                         CreateMode3 mode, const Sattr3& attrs) {
-    XdrEncoder enc;
+void encode_create_args(XdrEncoder& enc,
+                        const Fh3& dir, const std::string& name,
+                        CreateMode3 mode, const Sattr3& attrs) {
     encode_fh3(enc, dir);
     enc.put_string(name);
     enc.put_uint32(static_cast<uint32_t>(mode));
     encode_sattr3(enc, attrs);
-    return enc.release();
 }
 
-std::vector<uint8_t> encode_create_args_exclusive(const Fh3& dir, const std::string& name,
-                                                    const CreateVerf3& verf) {
+std::vector<uint8_t> encode_create_args(const Fh3& dir, const std::string& name,
+                                         CreateMode3 mode, const Sattr3& attrs) {
     XdrEncoder enc;
+    encode_create_args(enc, dir, name, mode, attrs);
+    return enc.release();
+}
+
+void encode_create_args_exclusive(XdrEncoder& enc,
+                                  const Fh3& dir, const std::string& name,
+                                  const CreateVerf3& verf) {
     encode_fh3(enc, dir);
     enc.put_string(name);
     enc.put_uint32(static_cast<uint32_t>(CreateMode3::EXCLUSIVE));
     enc.put_fixed_opaque(verf.data.data(), CREATE_VERF_SIZE);
+}
+
+std::vector<uint8_t> encode_create_args_exclusive(const Fh3& dir, const std::string& name,
+                                                    const CreateVerf3& verf) {
+    XdrEncoder enc;
+    encode_create_args_exclusive(enc, dir, name, verf);
     return enc.release();
 }
 
-Fh3 decode_create_reply(const std::vector<uint8_t>& data) {
+Fh3 decode_create_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     if (status != 0) {
-        // CREATE3resfail: obj_wcc follows
+        // CREATE3resfail: dir_wcc
+        if (cache) cache_wcc_data(dec, cache, dir);
         throw NfsError(status, "CREATE");
     }
     // CREATE3resok: post_op_fh3, obj_attributes (post_op_attr), dir_wcc
@@ -44,23 +57,25 @@ Fh3 decode_create_reply(const std::vector<uint8_t>& data) {
     if (!fh_present)
         throw std::runtime_error("CREATE: server returned no file handle");
     Fh3 fh = decode_fh3(dec);
-    skip_post_op_attr(dec);  // obj_attributes
-    skip_wcc_data(dec);      // dir_wcc
+    cache_post_op_attr(dec, cache, fh);  // obj_attributes
+    cache_wcc_data(dec, cache, dir);     // dir_wcc
     return fh;
 }
 
 Fh3 create(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-            CreateMode3 mode, const Sattr3& attrs) {
-    const auto args  = encode_create_args(dir, name, mode, attrs);
+            CreateMode3 mode, const Sattr3& attrs, AttrCache* cache) {
+    XdrEncoder args;
+    encode_create_args(args, dir, name, mode, attrs);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_CREATE, args);
-    return decode_create_reply(reply);
+    return decode_create_reply(reply, cache, dir);
 }
 
 Fh3 create_exclusive(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-                     const CreateVerf3& verf) {
-    const auto args  = encode_create_args_exclusive(dir, name, verf);
+                     const CreateVerf3& verf, AttrCache* cache) {
+    XdrEncoder args;
+    encode_create_args_exclusive(args, dir, name, verf);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_CREATE, args);
-    return decode_create_reply(reply);
+    return decode_create_reply(reply, cache, dir);
 }
 
 }  // namespace nfs3
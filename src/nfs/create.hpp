@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -23,23 +24,29 @@ struct CreateVerf3 {
 
 // Encode/decode helpers (pure, no network)
 // UNCHECKED/GUARDED: send with sattr3
+void                 encode_create_args(XdrEncoder& enc, const Fh3& dir, const std::string& name,
+                                         CreateMode3 mode, const Sattr3& attrs);
 std::vector<uint8_t> encode_create_args(const Fh3& dir, const std::string& name,
                                          CreateMode3 mode, const Sattr3& attrs);
 // EXCLUSIVE: send with createverf3 instead of sattr3
+void                 encode_create_args_exclusive(XdrEncoder& enc, const Fh3& dir, const std::string& name,
+                                                    const CreateVerf3& verf);
 std::vector<uint8_t> encode_create_args_exclusive(const Fh3& dir, const std::string& name,
                                                     const CreateVerf3& verf);
 
 // Decode the CREATE reply; returns the new object's file handle.
 // Throws NfsError on failure. Throws std::runtime_error if the server does
 // not return a post-op file handle (server bug / very old server).
-Fh3 decode_create_reply(const std::vector<uint8_t>& data);
+Fh3 decode_create_reply(const std::vector<uint8_t>& data,
+                        AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_CREATE (proc 8) — UNCHECKED or GUARDED mode.
 Fh3 create(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-            CreateMode3 mode = CreateMode3::UNCHECKED, const Sattr3& attrs = {});
+            CreateMode3 mode = CreateMode3::UNCHECKED, const Sattr3& attrs = {},
+            AttrCache* cache = nullptr);
 
 // NFSPROC3_CREATE (proc 8) — EXCLUSIVE mode (idempotent with a verifier).
 Fh3 create_exclusive(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-                     const CreateVerf3& verf);
+                     const CreateVerf3& verf, AttrCache* cache = nullptr);
 
 }  // namespace nfs3
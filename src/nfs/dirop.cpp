@@ -12,83 +12,111 @@ static constexpr uint32_t NFSPROC3_RMDIR  = 13;
 
 // ── MKDIR ─────────────────────────────────────────────────────────────────────
 
-std::vector<uint8_t> encode_mkdir_args(const Fh3& dir, const std::string& name,
-                                        const Sattr3& attrs) {
-    XdrEncoder enc;
+void encode_mkdir_args(XdrEncoder& enc,
+                       const Fh3& dir, const std::string& name,
+                       const Sattr3& attrs) {
     encode_fh3(enc, dir);
     enc.put_string(name);
     encode_sattr3(enc, attrs);
+}
+
+std::vector<uint8_t> encode_mkdir_args(const Fh3& dir, const std::string& name,
+                                        const Sattr3& attrs) {
+    XdrEncoder enc;
+    encode_mkdir_args(enc, dir, name, attrs);
     return enc.release();
 }
 
-Fh3 decode_mkdir_reply(const std::vector<uint8_t>& data) {
+Fh3 decode_mkdir_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
-    if (status != 0)
+    if (status != 0) {
+        // MKDIR3resfail: dir_wcc
+        if (cache) cache_wcc_data(dec, cache, dir);
         throw NfsError(status, "MKDIR");
+    }
     // MKDIR3resok: obj (post_op_fh3), obj_attributes (post_op_attr), dir_wcc
     const uint32_t fh_present = dec.get_uint32();
     if (!fh_present)
         throw std::runtime_error("MKDIR: server returned no file handle");
     Fh3 fh = decode_fh3(dec);
-    skip_post_op_attr(dec);  // obj_attributes
-    skip_wcc_data(dec);      // dir_wcc
+    cache_post_op_attr(dec, cache, fh);  // obj_attributes
+    cache_wcc_data(dec, cache, dir);     // dir_wcc
     return fh;
 }
 
 Fh3 mkdir(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-           const Sattr3& attrs) {
-    const auto args  = encode_mkdir_args(dir, name, attrs);
+           const Sattr3& attrs, AttrCache* cache) {
+    XdrEncoder args;
+    encode_mkdir_args(args, dir, name, attrs);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_MKDIR, args);
-    return decode_mkdir_reply(reply);
+    return decode_mkdir_reply(reply, cache, dir);
 }
 
 // ── REMOVE ────────────────────────────────────────────────────────────────────
 
-std::vector<uint8_t> encode_remove_args(const Fh3& dir, const std::string& name) {
-    XdrEncoder enc;
+void encode_remove_args(XdrEncoder& enc, const Fh3& dir, const std::string& name) {
     encode_fh3(enc, dir);
     enc.put_string(name);
+}
+
+std::vector<uint8_t> encode_remove_args(const Fh3& dir, const std::string& name) {
+    XdrEncoder enc;
+    encode_remove_args(enc, dir, name);
     return enc.release();
 }
 
-void decode_remove_reply(const std::vector<uint8_t>& data) {
+void decode_remove_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
-    if (status != 0)
+    if (status != 0) {
+        // REMOVE3resfail: dir_wcc
+        if (cache) cache_wcc_data(dec, cache, dir);
         throw NfsError(status, "REMOVE");
+    }
     // REMOVE3resok: dir_wcc
-    skip_wcc_data(dec);
+    cache_wcc_data(dec, cache, dir);
 }
 
-void remove(TcpRpcClient& client, const Fh3& dir, const std::string& name) {
-    const auto args  = encode_remove_args(dir, name);
+void remove(TcpRpcClient& client, const Fh3& dir, const std::string& name,
+            AttrCache* cache) {
+    XdrEncoder args;
+    encode_remove_args(args, dir, name);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_REMOVE, args);
-    decode_remove_reply(reply);
+    decode_remove_reply(reply, cache, dir);
 }
 
 // ── RMDIR ─────────────────────────────────────────────────────────────────────
 
-std::vector<uint8_t> encode_rmdir_args(const Fh3& dir, const std::string& name) {
-    XdrEncoder enc;
+void encode_rmdir_args(XdrEncoder& enc, const Fh3& dir, const std::string& name) {
     encode_fh3(enc, dir);
     enc.put_string(name);
+}
+
+std::vector<uint8_t> encode_rmdir_args(const Fh3& dir, const std::string& name) {
+    XdrEncoder enc;
+    encode_rmdir_args(enc, dir, name);
     return enc.release();
 }
 
-void decode_rmdir_reply(const std::vector<uint8_t>& data) {
+void decode_rmdir_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
-    if (status != 0)
+    if (status != 0) {
+        // RMDIR3resfail: dir_wcc
+        if (cache) cache_wcc_data(dec, cache, dir);
         throw NfsError(status, "RMDIR");
+    }
     // RMDIR3resok: dir_wcc
-    skip_wcc_data(dec);
+    cache_wcc_data(dec, cache, dir);
 }
 
-void rmdir(TcpRpcClient& client, const Fh3& dir, const std::string& name) {
-    const auto args  = encode_rmdir_args(dir, name);
+void rmdir(TcpRpcClient& client, const Fh3& dir, const std::string& name,
+           AttrCache* cache) {
+    XdrEncoder args;
+    encode_rmdir_args(args, dir, name);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_RMDIR, args);
-    decode_rmdir_reply(reply);
+    decode_rmdir_reply(reply, cache, dir);
 }
 
 }  // namespace nfs3
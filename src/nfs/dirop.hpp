@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -13,29 +14,38 @@ namespace nfs3 {
 
 // ── MKDIR (proc 9) ───────────────────────────────────────────────────────────
 
+void                 encode_mkdir_args(XdrEncoder& enc, const Fh3& dir, const std::string& name,
+                                        const Sattr3& attrs);
 std::vector<uint8_t> encode_mkdir_args(const Fh3& dir, const std::string& name,
                                         const Sattr3& attrs);
-Fh3                  decode_mkdir_reply(const std::vector<uint8_t>& data);
+Fh3                  decode_mkdir_reply(const std::vector<uint8_t>& data,
+                                        AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_MKDIR: create a directory named `name` in `dir`.
 // Returns the new directory's file handle.
 Fh3 mkdir(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-           const Sattr3& attrs = {});
+           const Sattr3& attrs = {}, AttrCache* cache = nullptr);
 
 // ── REMOVE (proc 12) ─────────────────────────────────────────────────────────
 
+void                 encode_remove_args(XdrEncoder& enc, const Fh3& dir, const std::string& name);
 std::vector<uint8_t> encode_remove_args(const Fh3& dir, const std::string& name);
-void                 decode_remove_reply(const std::vector<uint8_t>& data);
+void                 decode_remove_reply(const std::vector<uint8_t>& data,
+                                         AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_REMOVE: delete the file named `name` from directory `dir`.
-void remove(TcpRpcClient& client, const Fh3& dir, const std::string& name);
+void remove(TcpRpcClient& client, const Fh3& dir, const std::string& name,
+            AttrCache* cache = nullptr);
 
 // ── RMDIR (proc 13) ──────────────────────────────────────────────────────────
 
+void                 encode_rmdir_args(XdrEncoder& enc, const Fh3& dir, const std::string& name);
 std::vector<uint8_t> encode_rmdir_args(const Fh3& dir, const std::string& name);
-void                 decode_rmdir_reply(const std::vector<uint8_t>& data);
+void                 decode_rmdir_reply(const std::vector<uint8_t>& data,
+                                        AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_RMDIR: remove the empty directory named `name` from directory `dir`.
-void rmdir(TcpRpcClient& client, const Fh3& dir, const std::string& name);
+void rmdir(TcpRpcClient& client, const Fh3& dir, const std::string& name,
+           AttrCache* cache = nullptr);
 
 }  // namespace nfs3
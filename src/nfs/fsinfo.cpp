@@ -12,17 +12,22 @@ static constexpr uint32_t NFSPROC3_PATHCONF = 20;
 
 // ── FSSTAT ────────────────────────────────────────────────────────────────────
 
+void encode_fsstat_args(XdrEncoder& enc, const Fh3& root) {
+    encode_fh3(enc, root);
+}
+
 std::vector<uint8_t> encode_fsstat_args(const Fh3& root) {
     XdrEncoder enc;
-    encode_fh3(enc, root);
+    encode_fsstat_args(enc, root);
     return enc.release();
 }
 
-FsstatResult decode_fsstat_reply(const std::vector<uint8_t>& data) {
+FsstatResult decode_fsstat_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                 const Fh3& root) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // FSSTAT3res always carries obj_attributes (post_op_attr).
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, root);
     if (status != 0)
         throw NfsError(status, "FSSTAT");
     FsstatResult r{};
@@ -36,25 +41,31 @@ FsstatResult decode_fsstat_reply(const std::vector<uint8_t>& data) {
     return r;
 }
 
-FsstatResult fsstat(TcpRpcClient& client, const Fh3& root) {
-    const auto args  = encode_fsstat_args(root);
+FsstatResult fsstat(TcpRpcClient& client, const Fh3& root, AttrCache* cache) {
+    XdrEncoder args;
+    encode_fsstat_args(args, root);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_FSSTAT, args);
-    return decode_fsstat_reply(reply);
+    return decode_fsstat_reply(reply, cache, root);
 }
 
 // ── FSINFO ────────────────────────────────────────────────────────────────────
 
+void encode_fsinfo_args(XdrEncoder& enc, const Fh3& root) {
+    encode_fh3(enc, root);
+}
+
 std::vector<uint8_t> encode_fsinfo_args(const Fh3& root) {
     XdrEncoder enc;
-    encode_fh3(enc, root);
+    encode_fsinfo_args(enc, root);
     return enc.release();
 }
 
-FsinfoResult decode_fsinfo_reply(const std::vector<uint8_t>& data) {
+FsinfoResult decode_fsinfo_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                 const Fh3& root) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // FSINFO3res always carries obj_attributes (post_op_attr).
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, root);
     if (status != 0)
         throw NfsError(status, "FSINFO");
     FsinfoResult r{};
@@ -72,25 +83,31 @@ FsinfoResult decode_fsinfo_reply(const std::vector<uint8_t>& data) {
     return r;
 }
 
-FsinfoResult fsinfo(TcpRpcClient& client, const Fh3& root) {
-    const auto args  = encode_fsinfo_args(root);
+FsinfoResult fsinfo(TcpRpcClient& client, const Fh3& root, AttrCache* cache) {
+    XdrEncoder args;
+    encode_fsinfo_args(args, root);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_FSINFO, args);
-    return decode_fsinfo_reply(reply);
+    return decode_fsinfo_reply(reply, cache, root);
 }
 
 // ── PATHCONF ──────────────────────────────────────────────────────────────────
 
+void encode_pathconf_args(XdrEncoder& enc, const Fh3& fh) {
+    encode_fh3(enc, fh);
+}
+
 std::vector<uint8_t> encode_pathconf_args(const Fh3& fh) {
     XdrEncoder enc;
-    encode_fh3(enc, fh);
+    encode_pathconf_args(enc, fh);
     return enc.release();
 }
 
-PathconfResult decode_pathconf_reply(const std::vector<uint8_t>& data) {
+PathconfResult decode_pathconf_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                     const Fh3& fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // PATHCONF3res always carries obj_attributes (post_op_attr).
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, fh);
     if (status != 0)
         throw NfsError(status, "PATHCONF");
     PathconfResult r{};
@@ -103,10 +120,11 @@ PathconfResult decode_pathconf_reply(const std::vector<uint8_t>& data) {
     return r;
 }
 
-PathconfResult pathconf(TcpRpcClient& client, const Fh3& fh) {
-    const auto args  = encode_pathconf_args(fh);
+PathconfResult pathconf(TcpRpcClient& client, const Fh3& fh, AttrCache* cache) {
+    XdrEncoder args;
+    encode_pathconf_args(args, fh);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_PATHCONF, args);
-    return decode_pathconf_reply(reply);
+    return decode_pathconf_reply(reply, cache, fh);
 }
 
 }  // namespace nfs3
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -21,9 +22,12 @@ struct FsstatResult {
     uint32_t invarsec;  // server-estimated consistency interval (seconds)
 };
 
+void                 encode_fsstat_args(XdrEncoder& enc, const Fh3& root);
 std::vector<uint8_t> encode_fsstat_args(const Fh3& root);
-FsstatResult         decode_fsstat_reply(const std::vector<uint8_t>& data);
-FsstatResult         fsstat(TcpRpcClient& client, const Fh3& root);
+FsstatResult         decode_fsstat_reply(const std::vector<uint8_t>& data,
+                                         AttrCache* cache = nullptr, const Fh3& root = {});
+FsstatResult         fsstat(TcpRpcClient& client, const Fh3& root,
+                            AttrCache* cache = nullptr);
 
 // ── FSINFO (proc 19) ─────────────────────────────────────────────────────────
 
@@ -47,9 +51,12 @@ struct FsinfoResult {
     uint32_t properties;   // FSF_* bitmask
 };
 
+void                 encode_fsinfo_args(XdrEncoder& enc, const Fh3& root);
 std::vector<uint8_t> encode_fsinfo_args(const Fh3& root);
-FsinfoResult         decode_fsinfo_reply(const std::vector<uint8_t>& data);
-FsinfoResult         fsinfo(TcpRpcClient& client, const Fh3& root);
+FsinfoResult         decode_fsinfo_reply(const std::vector<uint8_t>& data,
+                                         AttrCache* cache = nullptr, const Fh3& root = {});
+FsinfoResult         fsinfo(TcpRpcClient& client, const Fh3& root,
+                            AttrCache* cache = nullptr);
 
 // ── PATHCONF (proc 20) ───────────────────────────────────────────────────────
 
@@ -63,8 +70,11 @@ struct PathconfResult {
     bool     case_preserving;  // server preserves case when storing names
 };
 
+void                 encode_pathconf_args(XdrEncoder& enc, const Fh3& fh);
 std::vector<uint8_t> encode_pathconf_args(const Fh3& fh);
-PathconfResult       decode_pathconf_reply(const std::vector<uint8_t>& data);
-PathconfResult       pathconf(TcpRpcClient& client, const Fh3& fh);
+PathconfResult       decode_pathconf_reply(const std::vector<uint8_t>& data,
+                                           AttrCache* cache = nullptr, const Fh3& fh = {});
+PathconfResult       pathconf(TcpRpcClient& client, const Fh3& fh,
+                              AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -8,25 +8,32 @@ static constexpr uint32_t NFS_PROG        = 100003;
 static constexpr uint32_t NFS_VERS        = 3;
 static constexpr uint32_t NFSPROC3_GETATTR = 1;
 
+void encode_getattr_args(XdrEncoder& enc, const Fh3& fh) {
+    encode_fh3(enc, fh);
+}
+
 std::vector<uint8_t> encode_getattr_args(const Fh3& fh) {
     XdrEncoder enc;
-    encode_fh3(enc, fh);
+    encode_getattr_args(enc, fh);
     return enc.release();
 }
 
-Fattr3 decode_getattr_reply(const std::vector<uint8_t>& data) {
+Fattr3 decode_getattr_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     if (status != 0)
         throw NfsError(status, "GETATTR");
     // GETATTR3resok: obj_attributes (fattr3, always present)
-    return decode_fattr3(dec);
+    const Fattr3 attrs = decode_fattr3(dec);
+    if (cache) cache->update(fh, attrs);
+    return attrs;
 }
 
-Fattr3 getattr(TcpRpcClient& client, const Fh3& fh) {
-    const auto args  = encode_getattr_args(fh);
+Fattr3 getattr(TcpRpcClient& client, const Fh3& fh, AttrCache* cache) {
+    XdrEncoder args;
+    encode_getattr_args(args, fh);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_GETATTR, args);
-    return decode_getattr_reply(reply);
+    return decode_getattr_reply(reply, cache, fh);
 }
 
 }  // namespace nfs3
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -8,10 +9,12 @@
 namespace nfs3 {
 
 // Encode/decode helpers (pure, no network — callable from tests)
+void                 encode_getattr_args(XdrEncoder& enc, const Fh3& fh);
 std::vector<uint8_t> encode_getattr_args(const Fh3& fh);
-Fattr3               decode_getattr_reply(const std::vector<uint8_t>& data);
+Fattr3               decode_getattr_reply(const std::vector<uint8_t>& data,
+                                          AttrCache* cache = nullptr, const Fh3& fh = {});
 
 // NFSPROC3_GETATTR (proc 1): return file attributes for fh.
-Fattr3 getattr(TcpRpcClient& client, const Fh3& fh);
+Fattr3 getattr(TcpRpcClient& client, const Fh3& fh, AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -10,31 +10,38 @@ static constexpr uint32_t NFS_PROG        = 100003;
 static constexpr uint32_t NFS_VERS        = 3;
 static constexpr uint32_t NFSPROC3_LOOKUP = 3;
 
-std::vector<uint8_t> encode_lookup_args(const Fh3& dir, const std::string& name) {
-    XdrEncoder enc;
+void encode_lookup_args(XdrEncoder& enc, const Fh3& dir, const std::string& name) {
     encode_fh3(enc, dir);
     enc.put_string(name);
+}
+
+std::vector<uint8_t> encode_lookup_args(const Fh3& dir, const std::string& name) {
+    XdrEncoder enc;
+    encode_lookup_args(enc, dir, name);
     return enc.release();
 }
 
-Fh3 decode_lookup_reply(const std::vector<uint8_t>& data) {
+Fh3 decode_lookup_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     if (status != 0) {
-        // LOOKUP3resfail: dir_attributes (post_op_attr) follows, but we just throw.
+        // LOOKUP3resfail: dir_attributes (post_op_attr)
+        if (cache) cache_post_op_attr(dec, cache, dir);
         throw NfsError(status, "LOOKUP");
     }
     // LOOKUP3resok: object fh3, obj_attributes, dir_attributes
     Fh3 fh = decode_fh3(dec);
-    skip_post_op_attr(dec);  // obj_attributes
-    skip_post_op_attr(dec);  // dir_attributes
+    cache_post_op_attr(dec, cache, fh);    // obj_attributes
+    cache_post_op_attr(dec, cache, dir);   // dir_attributes
     return fh;
 }
 
-Fh3 lookup(TcpRpcClient& client, const Fh3& dir, const std::string& name) {
-    const auto args  = encode_lookup_args(dir, name);
+Fh3 lookup(TcpRpcClient& client, const Fh3& dir, const std::string& name,
+           AttrCache* cache) {
+    XdrEncoder args;
+    encode_lookup_args(args, dir, name);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_LOOKUP, args);
-    return decode_lookup_reply(reply);
+    return decode_lookup_reply(reply, cache, dir);
 }
 
 }  // namespace nfs3
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -9,10 +10,13 @@
 namespace nfs3 {
 
 // Encode / decode helpers (used directly by unit tests).
+void                 encode_lookup_args(XdrEncoder& enc, const Fh3& dir, const std::string& name);
 std::vector<uint8_t> encode_lookup_args(const Fh3& dir, const std::string& name);
-Fh3 decode_lookup_reply(const std::vector<uint8_t>& data);
+Fh3 decode_lookup_reply(const std::vector<uint8_t>& data,
+                        AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // Send NFSPROC3_LOOKUP and return the file handle of `name` inside `dir`.
-Fh3 lookup(TcpRpcClient& client, const Fh3& dir, const std::string& name);
+Fh3 lookup(TcpRpcClient& client, const Fh3& dir, const std::string& name,
+           AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -10,34 +10,48 @@ static constexpr uint32_t NFS_PROG       = 100003;
 static constexpr uint32_t NFS_VERS       = 3;
 static constexpr uint32_t NFSPROC3_MKNOD = 11;
 
-std::vector<uint8_t> encode_mknod_args(const Fh3& dir, const std::string& name,
-                                        Ftype3 type, const Sattr3& attrs) {
-    XdrEncoder enc;
+void encode_mknod_args(XdrEncoder& enc,
+                       const Fh3& dir, const std::string& name,
+                       Ftype3 type, const Sattr3& attrs) {
     encode_fh3(enc, dir);
     enc.put_string(name);
     enc.put_uint32(static_cast<uint32_t>(type));
     encode_sattr3(enc, attrs);
-    return enc.release();
 }
 
-std::vector<uint8_t> encode_mknod_device_args(const Fh3& dir, const std::string& name,
-                                               Ftype3 type, const Sattr3& attrs,
-                                               const DeviceSpec3& spec) {
+std::vector<uint8_t> encode_mknod_args(const Fh3& dir, const std::string& name,
+                                        Ftype3 type, const Sattr3& attrs) {
     XdrEncoder enc;
+    encode_mknod_args(enc, dir, name, type, attrs);
+    return enc.release();
+}
+
+void encode_mknod_device_args(XdrEncoder& enc,
+                              const Fh3& dir, const std::string& name,
+                              Ftype3 type, const Sattr3& attrs,
+                              const DeviceSpec3& spec) {
     encode_fh3(enc, dir);
     enc.put_string(name);
     enc.put_uint32(static_cast<uint32_t>(type));
     encode_sattr3(enc, attrs);
     enc.put_uint32(spec.major_num);
     enc.put_uint32(spec.minor_num);
+}
+
+std::vector<uint8_t> encode_mknod_device_args(const Fh3& dir, const std::string& name,
+                                               Ftype3 type, const Sattr3& attrs,
+                                               const DeviceSpec3& spec) {
+    XdrEncoder enc;
+    encode_mknod_device_args(enc, dir, name, type, attrs, spec);
     return enc.release();
 }
 
-Fh3 decode_mknod_reply(const std::vector<uint8_t>& data) {
+Fh3 decode_mknod_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     if (status != 0) {
-        // MKNOD3resfail: dir_wcc follows
+        // MKNOD3resfail: dir_wcc
+        if (cache) cache_wcc_data(dec, cache, dir);
         throw NfsError(status, "MKNOD");
     }
     // MKNOD3resok: obj (post_op_fh3), obj_attributes (post_op_attr), dir_wcc
@@ -45,44 +59,48 @@ Fh3 decode_mknod_reply(const std::vector<uint8_t>& data) {
     if (!fh_present)
         throw std::runtime_error("MKNOD: server returned no file handle");
     Fh3 fh = decode_fh3(dec);
-    skip_post_op_attr(dec);  // obj_attributes
-    skip_wcc_data(dec);      // dir_wcc
+    cache_post_op_attr(dec, cache, fh);  // obj_attributes
+    cache_wcc_data(dec, cache, dir);     // dir_wcc
     return fh;
 }
 
 static Fh3 mknod_simple(TcpRpcClient& client, const Fh3& dir,
-                          const std::string& name, Ftype3 type, const Sattr3& attrs) {
-    const auto args  = encode_mknod_args(dir, name, type, attrs);
+                          const std::string& name, Ftype3 type, const Sattr3& attrs,
+                          AttrCache* cache) {
+    XdrEncoder args;
+    encode_mknod_args(args, dir, name, type, attrs);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_MKNOD, args);
-    return decode_mknod_reply(reply);
+    return decode_mknod_reply(reply, cache, dir);
 }
 
 static Fh3 mknod_device(TcpRpcClient& client, const Fh3& dir,
                           const std::string& name, Ftype3 type,
-                          const Sattr3& attrs, const DeviceSpec3& spec) {
-    const auto args  = encode_mknod_device_args(dir, name, type, attrs, spec);
+                          const Sattr3& attrs, const DeviceSpec3& spec,
+                          AttrCache* cache) {
+    XdrEncoder args;
+    encode_mknod_device_args(args, dir, name, type, attrs, spec);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_MKNOD, args);
-    return decode_mknod_reply(reply);
+    return decode_mknod_reply(reply, cache, dir);
 }
 
 Fh3 mknod_fifo(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-                const Sattr3& attrs) {
-    return mknod_simple(client, dir, name, Ftype3::NF3FIFO, attrs);
+                const Sattr3& attrs, AttrCache* cache) {
+    return mknod_simple(client, dir, name, Ftype3::NF3FIFO, attrs, cache);
 }
 
 Fh3 mknod_socket(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-                  const Sattr3& attrs) {
-    return mknod_simple(client, dir, name, Ftype3::NF3SOCK, attrs);
+                  const Sattr3& attrs, AttrCache* cache) {
+    return mknod_simple(client, dir, name, Ftype3::NF3SOCK, attrs, cache);
 }
 
 Fh3 mknod_chr(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-               const Sattr3& attrs, const DeviceSpec3& spec) {
-    return mknod_device(client, dir, name, Ftype3::NF3CHR, attrs, spec);
+               const Sattr3& attrs, const DeviceSpec3& spec, AttrCache* cache) {
+    return mknod_device(client, dir, name, Ftype3::NF3CHR, attrs, spec, cache);
 }
 
 Fh3 mknod_blk(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-               const Sattr3& attrs, const DeviceSpec3& spec) {
-    return mknod_device(client, dir, name, Ftype3::NF3BLK, attrs, spec);
+               const Sattr3& attrs, const DeviceSpec3& spec, AttrCache* cache) {
+    return mknod_device(client, dir, name, Ftype3::NF3BLK, attrs, spec, cache);
 }
 
 }  // namespace nfs3
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -18,28 +19,36 @@ struct DeviceSpec3 {
 // Encode/decode helpers (pure, no network)
 
 // NF3FIFO or NF3SOCK: encode takes just the sattr3.
+void                 encode_mknod_args(XdrEncoder& enc, const Fh3& dir, const std::string& name,
+                                        Ftype3 type, const Sattr3& attrs = {});
 std::vector<uint8_t> encode_mknod_args(const Fh3& dir, const std::string& name,
                                         Ftype3 type, const Sattr3& attrs = {});
 
 // NF3CHR or NF3BLK: encode takes sattr3 + device specdata.
+void                 encode_mknod_device_args(XdrEncoder& enc, const Fh3& dir, const std::string& name,
+                                               Ftype3 type, const Sattr3& attrs,
+                                               const DeviceSpec3& spec);
 std::vector<uint8_t> encode_mknod_device_args(const Fh3& dir, const std::string& name,
                                                Ftype3 type, const Sattr3& attrs,
                                                const DeviceSpec3& spec);
 
-Fh3 decode_mknod_reply(const std::vector<uint8_t>& data);
+Fh3 decode_mknod_reply(const std::vector<uint8_t>& data,
+                       AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_MKNOD (proc 11) — create a special file.
 
 // Create a named pipe (NF3FIFO) or Unix socket (NF3SOCK).
 Fh3 mknod_fifo(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-                const Sattr3& attrs = {});
+                const Sattr3& attrs = {}, AttrCache* cache = nullptr);
 Fh3 mknod_socket(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-                  const Sattr3& attrs = {});
+                  const Sattr3& attrs = {}, AttrCache* cache = nullptr);
 
 // Create a character (NF3CHR) or block (NF3BLK) device file.
 Fh3 mknod_chr(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-               const Sattr3& attrs, const DeviceSpec3& spec);
+               const Sattr3& attrs, const DeviceSpec3& spec,
+               AttrCache* cache = nullptr);
 Fh3 mknod_blk(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-               const Sattr3& attrs, const DeviceSpec3& spec);
+               const Sattr3& attrs, const DeviceSpec3& spec,
+               AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -16,14 +16,14 @@ static constexpr uint32_t MOUNTPROC3_EXPORT = 5;
 
 // ── MNT ──────────────────────────────────────────────────────────────────────
 
-Fh3 mnt(const std::string& host, const std::string& export_path) {
-    const uint16_t port = getport(host, MOUNT_PROG, MOUNT_VERS);
+Fh3 mnt(const std::string& host, const std::string& export_path, uint16_t pmap_port) {
+    const uint16_t port = getport(host, MOUNT_PROG, MOUNT_VERS, pmap_port);
     TcpRpcClient client(host, port);
 
     XdrEncoder args;
     args.put_string(export_path);
 
-    const auto reply = client.call(MOUNT_PROG, MOUNT_VERS, MOUNTPROC3_MNT, args.bytes());
+    const auto reply = client.call(MOUNT_PROG, MOUNT_VERS, MOUNTPROC3_MNT, args);
 
     XdrDecoder dec(reply);
     const uint32_t status = dec.get_uint32();
@@ -37,25 +37,26 @@ Fh3 mnt(const std::string& host, const std::string& export_path) {
 
 // ── UMNT ─────────────────────────────────────────────────────────────────────
 
-void umnt(const std::string& host, const std::string& export_path) {
-    const uint16_t port = getport(host, MOUNT_PROG, MOUNT_VERS);
+void umnt(const std::string& host, const std::string& export_path, uint16_t pmap_port) {
+    const uint16_t port = getport(host, MOUNT_PROG, MOUNT_VERS, pmap_port);
     TcpRpcClient client(host, port);
 
     XdrEncoder args;
     args.put_string(export_path);
 
     // UMNT3 returns void — the reply body is empty.
-    client.call(MOUNT_PROG, MOUNT_VERS, MOUNTPROC3_UMNT, args.bytes());
+    client.call(MOUNT_PROG, MOUNT_VERS, MOUNTPROC3_UMNT, args);
 }
 
 // ── EXPORT ───────────────────────────────────────────────────────────────────
 
-std::vector<ExportEntry> export_list(const std::string& host) {
-    const uint16_t port = getport(host, MOUNT_PROG, MOUNT_VERS);
+std::vector<ExportEntry> export_list(const std::string& host, uint16_t pmap_port) {
+    const uint16_t port = getport(host, MOUNT_PROG, MOUNT_VERS, pmap_port);
     TcpRpcClient client(host, port);
 
     // EXPORT3 takes no arguments.
-    const auto reply = client.call(MOUNT_PROG, MOUNT_VERS, MOUNTPROC3_EXPORT, {});
+    const auto reply = client.call(MOUNT_PROG, MOUNT_VERS, MOUNTPROC3_EXPORT,
+                                   std::vector<uint8_t>{});
 
     // exports: XDR linked list of exportnode
     // exportnode: ex_dir (string) + ex_groups (XDR linked list of groupnode)
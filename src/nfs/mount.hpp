@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nfs3_types.hpp"
+#include "portmap.hpp"
 
 #include <string>
 #include <vector>
@@ -13,14 +14,19 @@ struct ExportEntry {
     std::vector<std::string> groups;  // allowed netgroups/hostnames; empty = world-accessible
 };
 
+// Each call resolves mountd through the portmapper at `pmap_port`.
+
 // MOUNTPROC3_MNT (proc 1): mount an export and return the root file handle.
-Fh3 mnt(const std::string& host, const std::string& export_path);
+Fh3 mnt(const std::string& host, const std::string& export_path,
+        uint16_t pmap_port = PMAP_PORT);
 
 // MOUNTPROC3_UMNT (proc 3): notify the server of an unmount.
 // This is advisory — the server may ignore it, but it is good practice.
-void umnt(const std::string& host, const std::string& export_path);
+void umnt(const std::string& host, const std::string& export_path,
+          uint16_t pmap_port = PMAP_PORT);
 
 // MOUNTPROC3_EXPORT (proc 5): retrieve the server's export list.
-std::vector<ExportEntry> export_list(const std::string& host);
+std::vector<ExportEntry> export_list(const std::string& host,
+                                     uint16_t pmap_port = PMAP_PORT);
 
 }  // namespace nfs3
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../xdr/xdr.hpp"
+#include "../xdr/xdr_struct.hpp"
 
 #include <array>
 #include <cstdint>
@@ -20,6 +21,13 @@ enum class Stable3 : uint32_t {
     FILE_SYNC = 2,
 };
 
+// Result returned by nfs3::read_into(): the bytes placed and whether the
+// READ reached the end of the file (a short READ need not)
+struct ReadResult {
+    uint32_t count;
+    bool     eof;
+};
+
 // Result returned by nfs3::write()
 struct WriteResult {
     uint32_t              count;
@@ -68,6 +76,57 @@ struct Fattr3 {
     Nfstime3  ctime;
 };
 
+// wcc_attr (RFC 1813 §2.6): the pre-operation subset carried in pre_op_attr.
+// XDR wire size: 6 uint32s = 24 bytes.
+struct WccAttr3 {
+    uint64_t size;
+    Nfstime3 mtime;
+    Nfstime3 ctime;
+};
+
+// post_op_attr (RFC 1813 §2.6): the object's attributes after the call, if
+// the server chose to send them.
+struct PostOpAttr3 {
+    bool   present = false;
+    Fattr3 attrs{};
+};
+
+// pre_op_attr (RFC 1813 §2.6): the object's wcc_attr before the call.
+struct PreOpAttr3 {
+    bool     present = false;
+    WccAttr3 attrs{};
+};
+
+// wcc_data (RFC 1813 §2.6): before and after attributes of a modified object.
+struct WccData3 {
+    PreOpAttr3  before;
+    PostOpAttr3 after;
+};
+
+// ── XDR schemas (fixed-size structures, see xdr_struct.hpp) ──────────────────
+
+template <> struct XdrSchema<Nfstime3> {
+    using fields = XdrFields<&Nfstime3::seconds, &Nfstime3::nseconds>;
+};
+
+template <> struct XdrSchema<Specdata3> {
+    using fields = XdrFields<&Specdata3::specdata1, &Specdata3::specdata2>;
+};
+
+template <> struct XdrSchema<Fattr3> {
+    using fields = XdrFields<&Fattr3::type, &Fattr3::mode, &Fattr3::nlink,
+                             &Fattr3::uid, &Fattr3::gid, &Fattr3::size,
+                             &Fattr3::used, &Fattr3::rdev, &Fattr3::fsid,
+                             &Fattr3::fileid, &Fattr3::atime, &Fattr3::mtime,
+                             &Fattr3::ctime>;
+};
+static_assert(xdr_wire_size<Fattr3> == 84, "fattr3 is 21 XDR words");
+
+template <> struct XdrSchema<WccAttr3> {
+    using fields = XdrFields<&WccAttr3::size, &WccAttr3::mtime, &WccAttr3::ctime>;
+};
+static_assert(xdr_wire_size<WccAttr3> == 24, "wcc_attr is 6 XDR words");
+
 // How to set a time field in sattr3 (RFC 1813 §2.6)
 enum class SetTimeHow : uint32_t {
     DONT_CHANGE       = 0,
@@ -98,26 +157,9 @@ inline Fh3 decode_fh3(XdrDecoder& dec) {
     return Fh3{dec.get_opaque()};
 }
 
+// One bounds check for all 84 bytes, then unrolled field loads.
 inline Fattr3 decode_fattr3(XdrDecoder& dec) {
-    Fattr3 a{};
-    a.type            = static_cast<Ftype3>(dec.get_uint32());
-    a.mode            = dec.get_uint32();
-    a.nlink           = dec.get_uint32();
-    a.uid             = dec.get_uint32();
-    a.gid             = dec.get_uint32();
-    a.size            = dec.get_uint64();
-    a.used            = dec.get_uint64();
-    a.rdev.specdata1  = dec.get_uint32();
-    a.rdev.specdata2  = dec.get_uint32();
-    a.fsid            = dec.get_uint64();
-    a.fileid          = dec.get_uint64();
-    a.atime.seconds   = dec.get_uint32();
-    a.atime.nseconds  = dec.get_uint32();
-    a.mtime.seconds   = dec.get_uint32();
-    a.mtime.nseconds  = dec.get_uint32();
-    a.ctime.seconds   = dec.get_uint32();
-    a.ctime.nseconds  = dec.get_uint32();
-    return a;
+    return xdr_decode<Fattr3>(dec);
 }
 
 inline void encode_sattr3(XdrEncoder& enc, const Sattr3& s) {
@@ -146,20 +188,37 @@ inline void encode_sattr3(XdrEncoder& enc, const Sattr3& s) {
     }
 }
 
+inline PostOpAttr3 decode_post_op_attr(XdrDecoder& dec) {
+    PostOpAttr3 a;
+    a.present = dec.get_uint32() != 0;
+    if (a.present) a.attrs = decode_fattr3(dec);
+    return a;
+}
+
+inline PreOpAttr3 decode_pre_op_attr(XdrDecoder& dec) {
+    PreOpAttr3 a;
+    a.present = dec.get_uint32() != 0;
+    if (a.present) a.attrs = xdr_decode<WccAttr3>(dec);
+    return a;
+}
+
+inline WccData3 decode_wcc_data(XdrDecoder& dec) {
+    WccData3 w;
+    w.before = decode_pre_op_attr(dec);
+    w.after  = decode_post_op_attr(dec);
+    return w;
+}
+
 // Skip a post_op_attr (RFC 1813 §2.6):
 //   bool(1) + optional fattr3(84 bytes = 21 uint32s)
 inline void skip_post_op_attr(XdrDecoder& dec) {
-    if (dec.get_uint32() != 0) {
-        decode_fattr3(dec);  // read and discard
-    }
+    if (dec.get_uint32() != 0) dec.skip(xdr_wire_size<Fattr3>);
 }
 
 // Skip a pre_op_attr (RFC 1813 §2.6):
 //   bool(1) + optional wcc_attr: size(uint64) + mtime(nfstime3) + ctime(nfstime3) = 6 uint32s
 inline void skip_pre_op_attr(XdrDecoder& dec) {
-    if (dec.get_uint32() != 0) {
-        for (int i = 0; i < 6; ++i) dec.get_uint32();
-    }
+    if (dec.get_uint32() != 0) dec.skip(xdr_wire_size<WccAttr3>);
 }
 
 // Skip wcc_data (pre_op_attr + post_op_attr)
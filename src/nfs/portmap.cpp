@@ -9,11 +9,11 @@ namespace nfs3 {
 static constexpr uint32_t PMAP_PROG        = 100000;
 static constexpr uint32_t PMAP_VERS        = 2;
 static constexpr uint32_t PMAPPROC_GETPORT = 3;
-static constexpr uint16_t PMAP_PORT        = 111;
 static constexpr uint32_t IPPROTO_TCP_XDR  = 6;
 
-uint16_t getport(const std::string& host, uint32_t prog, uint32_t vers) {
-    TcpRpcClient client(host, PMAP_PORT);
+uint16_t getport(const std::string& host, uint32_t prog, uint32_t vers,
+                 uint16_t pmap_port) {
+    TcpRpcClient client(host, pmap_port);
 
     XdrEncoder args;
     args.put_uint32(prog);
@@ -21,7 +21,7 @@ uint16_t getport(const std::string& host, uint32_t prog, uint32_t vers) {
     args.put_uint32(IPPROTO_TCP_XDR);
     args.put_uint32(0);  // port field is ignored in a GETPORT request
 
-    const auto reply = client.call(PMAP_PROG, PMAP_VERS, PMAPPROC_GETPORT, args.bytes());
+    const auto reply = client.call(PMAP_PROG, PMAP_VERS, PMAPPROC_GETPORT, args);
 
     XdrDecoder dec(reply);
     const uint32_t port = dec.get_uint32();
@@ -5,8 +5,12 @@
 
 namespace nfs3 {
 
-// Query the RPCBIND (portmap) daemon at port 111 for the TCP port of the
-// given (prog, vers) pair. Returns 0 if the program is not registered.
-uint16_t getport(const std::string& host, uint32_t prog, uint32_t vers);
+// Well-known RPCBIND (portmap) port.
+constexpr uint16_t PMAP_PORT = 111;
+
+// Query the RPCBIND (portmap) daemon at `pmap_port` for the TCP port of the
+// given (prog, vers) pair. Throws if the program is not registered.
+uint16_t getport(const std::string& host, uint32_t prog, uint32_t vers,
+                 uint16_t pmap_port = PMAP_PORT);
 
 }  // namespace nfs3
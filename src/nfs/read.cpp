@@ -10,19 +10,24 @@ static constexpr uint32_t NFS_PROG      = 100003;
 static constexpr uint32_t NFS_VERS      = 3;
 static constexpr uint32_t NFSPROC3_READ = 6;
 
-std::vector<uint8_t> encode_read_args(const Fh3& fh, uint64_t offset, uint32_t count) {
-    XdrEncoder enc;
+void encode_read_args(XdrEncoder& enc, const Fh3& fh, uint64_t offset, uint32_t count) {
     encode_fh3(enc, fh);
     enc.put_uint64(offset);
     enc.put_uint32(count);
+}
+
+std::vector<uint8_t> encode_read_args(const Fh3& fh, uint64_t offset, uint32_t count) {
+    XdrEncoder enc;
+    encode_read_args(enc, fh, offset, count);
     return enc.release();
 }
 
-std::vector<uint8_t> decode_read_reply(const std::vector<uint8_t>& data) {
+std::vector<uint8_t> decode_read_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                       const Fh3& fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // READ3res always carries file_attributes (post_op_attr) in both OK and fail.
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, fh);
     if (status != 0)
         throw NfsError(status, "READ");
     // READ3resok: count(uint32), eof(bool/uint32), data(opaque)
@@ -31,11 +36,57 @@ std::vector<uint8_t> decode_read_reply(const std::vector<uint8_t>& data) {
     return dec.get_opaque();
 }
 
+ReadResult decode_read_reply_into(RecordReader& rr, uint8_t* buf, uint32_t count,
+                                  AttrCache* cache, const Fh3& fh) {
+    const uint32_t status = rr.get_uint32();
+    // post_op_attr: attributes_follow, then a fixed-size fattr3.
+    if (rr.get_uint32()) {
+        if (cache) {
+            uint8_t raw[xdr_wire_size<Fattr3>];
+            rr.read(raw, sizeof(raw));
+            XdrDecoder dec(raw, sizeof(raw));
+            cache->update(fh, decode_fattr3(dec));
+        } else {
+            rr.skip(xdr_wire_size<Fattr3>);
+        }
+    }
+    if (status != 0)
+        throw NfsError(status, "READ");
+    /* count */ rr.get_uint32();
+    const bool eof = rr.get_uint32() != 0;
+    return ReadResult{static_cast<uint32_t>(rr.get_opaque_into(buf, count)), eof};
+}
+
 std::vector<uint8_t> read(TcpRpcClient& client, const Fh3& fh,
-                           uint64_t offset, uint32_t count) {
-    const auto args  = encode_read_args(fh, offset, count);
+                           uint64_t offset, uint32_t count, AttrCache* cache) {
+    XdrEncoder args;
+    encode_read_args(args, fh, offset, count);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_READ, args);
-    return decode_read_reply(reply);
+    return decode_read_reply(reply, cache, fh);
+}
+
+ReadResult read_into(TcpRpcClient& client, const Fh3& fh,
+                     uint64_t offset, uint8_t* buf, uint32_t count, AttrCache* cache) {
+    XdrEncoder args;
+    encode_read_args(args, fh, offset, count);
+
+    ReadResult got{};
+    client.call_into(NFS_PROG, NFS_VERS, NFSPROC3_READ, args, [&](RecordReader& rr) {
+        got = decode_read_reply_into(rr, buf, count, cache, fh);
+    });
+    return got;
+}
+
+std::future<std::vector<uint8_t>> read_async(TcpRpcClient& client, const Fh3& fh,
+                                             uint64_t offset, uint32_t count,
+                                             AttrCache* cache) {
+    XdrEncoder args;
+    encode_read_args(args, fh, offset, count);
+    auto reply = client.call_async(NFS_PROG, NFS_VERS, NFSPROC3_READ, args);
+    return std::async(std::launch::deferred,
+                      [reply = std::move(reply), cache, fh]() mutable {
+        return decode_read_reply(reply.get(), cache, fh);
+    });
 }
 
 }  // namespace nfs3
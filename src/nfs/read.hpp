@@ -1,18 +1,40 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
+#include <future>
 #include <vector>
 
 namespace nfs3 {
 
 // Encode / decode helpers (used directly by unit tests).
+void                 encode_read_args(XdrEncoder& enc, const Fh3& fh, uint64_t offset, uint32_t count);
 std::vector<uint8_t> encode_read_args(const Fh3& fh, uint64_t offset, uint32_t count);
-std::vector<uint8_t> decode_read_reply(const std::vector<uint8_t>& data);
+std::vector<uint8_t> decode_read_reply(const std::vector<uint8_t>& data,
+                                       AttrCache* cache = nullptr, const Fh3& fh = {});
+
+// Streaming decode of READ3res: the data lands directly in `buf`, which must
+// hold `count` bytes.  Returns the number of bytes placed and the eof flag.
+ReadResult decode_read_reply_into(RecordReader& rr, uint8_t* buf, uint32_t count,
+                                  AttrCache* cache = nullptr, const Fh3& fh = {});
 
 // Send NFSPROC3_READ and return the data bytes read.
 std::vector<uint8_t> read(TcpRpcClient& client, const Fh3& fh,
-                           uint64_t offset, uint32_t count);
+                           uint64_t offset, uint32_t count, AttrCache* cache = nullptr);
+
+// Send NFSPROC3_READ and receive the data straight from the socket into
+// `buf` (no intermediate record buffer).  Returns the number of bytes read
+// and the eof flag.
+ReadResult read_into(TcpRpcClient& client, const Fh3& fh,
+                     uint64_t offset, uint8_t* buf, uint32_t count,
+                     AttrCache* cache = nullptr);
+
+// Pipelined NFSPROC3_READ: returns once the CALL is sent; the reply is decoded
+// when the future is waited on.
+std::future<std::vector<uint8_t>> read_async(TcpRpcClient& client, const Fh3& fh,
+                                             uint64_t offset, uint32_t count,
+                                             AttrCache* cache = nullptr);
 
 }  // namespace nfs3
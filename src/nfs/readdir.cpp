@@ -9,32 +9,41 @@ static constexpr uint32_t NFS_VERS          = 3;
 static constexpr uint32_t NFSPROC3_READDIR  = 16;
 static constexpr size_t   COOKIEVERF_SIZE   = 8;
 
+void encode_readdir_args(XdrEncoder& enc,
+                         const Fh3& dir,
+                         uint64_t cookie,
+                         const std::array<uint8_t, 8>& cookieverf,
+                         uint32_t count) {
+    encode_fh3(enc, dir);
+    enc.put_uint64(cookie);
+    enc.put_fixed_opaque(cookieverf.data(), COOKIEVERF_SIZE);
+    enc.put_uint32(count);
+}
+
 std::vector<uint8_t> encode_readdir_args(const Fh3& dir,
                                           uint64_t cookie,
                                           const std::array<uint8_t, 8>& cookieverf,
                                           uint32_t count) {
     XdrEncoder enc;
-    encode_fh3(enc, dir);
-    enc.put_uint64(cookie);
-    enc.put_fixed_opaque(cookieverf.data(), COOKIEVERF_SIZE);
-    enc.put_uint32(count);
+    encode_readdir_args(enc, dir, cookie, cookieverf, count);
     return enc.release();
 }
 
-ReaddirPage decode_readdir_reply(const std::vector<uint8_t>& data) {
+ReaddirPage decode_readdir_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                 const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // READDIR3resfail: dir_attributes (post_op_attr)
     // READDIR3resok:   dir_attributes (post_op_attr), cookieverf, dirlist3
     // dir_attributes is present in both branches.
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, dir);
     if (status != 0)
         throw NfsError(status, "READDIR");
 
     // cookieverf3: fixed 8-byte opaque
     ReaddirPage page{};
-    const auto cv = dec.get_fixed_opaque(COOKIEVERF_SIZE);
-    std::copy(cv.begin(), cv.end(), page.cookieverf.begin());
+    const XdrSegment cv = dec.get_fixed_opaque_view(COOKIEVERF_SIZE);
+    std::copy(cv.data, cv.data + cv.size, page.cookieverf.begin());
 
     // dirlist3: XDR linked list of entry3
     // Each entry is preceded by a value_follows bool.
@@ -54,19 +63,21 @@ ReaddirPage decode_readdir_reply(const std::vector<uint8_t>& data) {
 ReaddirPage readdir_page(TcpRpcClient& client, const Fh3& dir,
                           uint64_t cookie,
                           const std::array<uint8_t, 8>& cookieverf,
-                          uint32_t count) {
-    const auto args  = encode_readdir_args(dir, cookie, cookieverf, count);
+                          uint32_t count, AttrCache* cache) {
+    XdrEncoder args;
+    encode_readdir_args(args, dir, cookie, cookieverf, count);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_READDIR, args);
-    return decode_readdir_reply(reply);
+    return decode_readdir_reply(reply, cache, dir);
 }
 
-std::vector<DirEntry3> readdir(TcpRpcClient& client, const Fh3& dir, uint32_t count) {
+std::vector<DirEntry3> readdir(TcpRpcClient& client, const Fh3& dir, uint32_t count,
+                               AttrCache* cache) {
     std::vector<DirEntry3> all;
     uint64_t cookie = 0;
     std::array<uint8_t, 8> cookieverf{};
 
     for (;;) {
-        auto page = readdir_page(client, dir, cookie, cookieverf, count);
+        auto page = readdir_page(client, dir, cookie, cookieverf, count, cache);
         for (auto& e : page.entries) {
             cookie = e.cookie;
             all.push_back(std::move(e));
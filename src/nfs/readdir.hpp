@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -25,11 +26,16 @@ struct ReaddirPage {
 };
 
 // Encode/decode helpers (pure, no network)
+void                 encode_readdir_args(XdrEncoder& enc, const Fh3& dir,
+                                          uint64_t cookie,
+                                          const std::array<uint8_t, 8>& cookieverf,
+                                          uint32_t count);
 std::vector<uint8_t> encode_readdir_args(const Fh3& dir,
                                           uint64_t cookie,
                                           const std::array<uint8_t, 8>& cookieverf,
                                           uint32_t count);
-ReaddirPage decode_readdir_reply(const std::vector<uint8_t>& data);
+ReaddirPage decode_readdir_reply(const std::vector<uint8_t>& data,
+                                 AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_READDIR (proc 16) — single RPC, returns one page of entries.
 // Pass cookie=0 and cookieverf={} for the first call; subsequent calls use
@@ -37,10 +43,12 @@ ReaddirPage decode_readdir_reply(const std::vector<uint8_t>& data);
 ReaddirPage readdir_page(TcpRpcClient& client, const Fh3& dir,
                           uint64_t cookie = 0,
                           const std::array<uint8_t, 8>& cookieverf = {},
-                          uint32_t count = 4096);
+                          uint32_t count = 4096,
+                          AttrCache* cache = nullptr);
 
 // Convenience: auto-paginate until eof and return all entries.
 std::vector<DirEntry3> readdir(TcpRpcClient& client, const Fh3& dir,
-                                uint32_t count = 4096);
+                                uint32_t count = 4096,
+                                AttrCache* cache = nullptr);
 
 }  // namespace nfs3
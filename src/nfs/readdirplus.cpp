@@ -9,32 +9,42 @@ static constexpr uint32_t NFS_VERS             = 3;
 static constexpr uint32_t NFSPROC3_READDIRPLUS = 17;
 static constexpr size_t   COOKIEVERF_SIZE      = 8;
 
+void encode_readdirplus_args(XdrEncoder& enc,
+                             const Fh3& dir,
+                             uint64_t cookie,
+                             const std::array<uint8_t, 8>& cookieverf,
+                             uint32_t dircount,
+                             uint32_t maxcount) {
+    encode_fh3(enc, dir);
+    enc.put_uint64(cookie);
+    enc.put_fixed_opaque(cookieverf.data(), COOKIEVERF_SIZE);
+    enc.put_uint32(dircount);
+    enc.put_uint32(maxcount);
+}
+
 std::vector<uint8_t> encode_readdirplus_args(const Fh3& dir,
                                               uint64_t cookie,
                                               const std::array<uint8_t, 8>& cookieverf,
                                               uint32_t dircount,
                                               uint32_t maxcount) {
     XdrEncoder enc;
-    encode_fh3(enc, dir);
-    enc.put_uint64(cookie);
-    enc.put_fixed_opaque(cookieverf.data(), COOKIEVERF_SIZE);
-    enc.put_uint32(dircount);
-    enc.put_uint32(maxcount);
+    encode_readdirplus_args(enc, dir, cookie, cookieverf, dircount, maxcount);
     return enc.release();
 }
 
-ReaddirplusPage decode_readdirplus_reply(const std::vector<uint8_t>& data) {
+ReaddirplusPage decode_readdirplus_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                         const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // dir_attributes present in both OK and fail.
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, dir);
     if (status != 0)
         throw NfsError(status, "READDIRPLUS");
 
     // cookieverf3: fixed 8-byte opaque
     ReaddirplusPage page{};
-    const auto cv = dec.get_fixed_opaque(COOKIEVERF_SIZE);
-    std::copy(cv.begin(), cv.end(), page.cookieverf.begin());
+    const XdrSegment cv = dec.get_fixed_opaque_view(COOKIEVERF_SIZE);
+    std::copy(cv.data, cv.data + cv.size, page.cookieverf.begin());
 
     // dirlistplus3: XDR linked list of entryplus3
     while (dec.get_uint32() != 0) {
@@ -52,6 +62,8 @@ ReaddirplusPage decode_readdirplus_reply(const std::vector<uint8_t>& data) {
         entry.has_fh = (dec.get_uint32() != 0);
         if (entry.has_fh)
             entry.fh = decode_fh3(dec);
+        if (cache && entry.has_attrs && entry.has_fh)
+            cache->update(entry.fh, entry.attrs);
 
         page.entries.push_back(std::move(entry));
     }
@@ -63,22 +75,24 @@ ReaddirplusPage decode_readdirplus_reply(const std::vector<uint8_t>& data) {
 ReaddirplusPage readdirplus_page(TcpRpcClient& client, const Fh3& dir,
                                   uint64_t cookie,
                                   const std::array<uint8_t, 8>& cookieverf,
-                                  uint32_t dircount, uint32_t maxcount) {
-    const auto args  = encode_readdirplus_args(dir, cookie, cookieverf,
-                                               dircount, maxcount);
+                                  uint32_t dircount, uint32_t maxcount,
+                                  AttrCache* cache) {
+    XdrEncoder args;
+    encode_readdirplus_args(args, dir, cookie, cookieverf, dircount, maxcount);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_READDIRPLUS, args);
-    return decode_readdirplus_reply(reply);
+    return decode_readdirplus_reply(reply, cache, dir);
 }
 
 std::vector<DirEntryPlus3> readdirplus(TcpRpcClient& client, const Fh3& dir,
-                                        uint32_t dircount, uint32_t maxcount) {
+                                        uint32_t dircount, uint32_t maxcount,
+                                        AttrCache* cache) {
     std::vector<DirEntryPlus3> all;
     uint64_t cookie = 0;
     std::array<uint8_t, 8> cookieverf{};
 
     for (;;) {
         auto page = readdirplus_page(client, dir, cookie, cookieverf,
-                                     dircount, maxcount);
+                                     dircount, maxcount, cache);
         for (auto& e : page.entries) {
             cookie = e.cookie;
             all.push_back(std::move(e));
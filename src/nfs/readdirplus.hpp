@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -33,23 +34,31 @@ struct ReaddirplusPage {
 // Encode/decode helpers (pure, no network)
 // dircount: max bytes of entry names + cookies in the reply.
 // maxcount: max total reply bytes (including attributes and file handles).
+void                 encode_readdirplus_args(XdrEncoder& enc, const Fh3& dir,
+                                              uint64_t cookie,
+                                              const std::array<uint8_t, 8>& cookieverf,
+                                              uint32_t dircount,
+                                              uint32_t maxcount);
 std::vector<uint8_t> encode_readdirplus_args(const Fh3& dir,
                                               uint64_t cookie,
                                               const std::array<uint8_t, 8>& cookieverf,
                                               uint32_t dircount,
                                               uint32_t maxcount);
-ReaddirplusPage decode_readdirplus_reply(const std::vector<uint8_t>& data);
+ReaddirplusPage decode_readdirplus_reply(const std::vector<uint8_t>& data,
+                                         AttrCache* cache = nullptr, const Fh3& dir = {});
 
 // NFSPROC3_READDIRPLUS (proc 17) — single page.
 ReaddirplusPage readdirplus_page(TcpRpcClient& client, const Fh3& dir,
                                   uint64_t cookie = 0,
                                   const std::array<uint8_t, 8>& cookieverf = {},
                                   uint32_t dircount = 4096,
-                                  uint32_t maxcount = 32768);
+                                  uint32_t maxcount = 32768,
+                                  AttrCache* cache = nullptr);
 
 // Convenience: auto-paginate until eof and return all entries.
 std::vector<DirEntryPlus3> readdirplus(TcpRpcClient& client, const Fh3& dir,
                                         uint32_t dircount = 4096,
-                                        uint32_t maxcount = 32768);
+                                        uint32_t maxcount = 32768,
+                                        AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -8,32 +8,41 @@ static constexpr uint32_t NFS_PROG        = 100003;
 static constexpr uint32_t NFS_VERS        = 3;
 static constexpr uint32_t NFSPROC3_RENAME = 14;
 
-std::vector<uint8_t> encode_rename_args(const Fh3& from_dir, const std::string& from_name,
-                                         const Fh3& to_dir,   const std::string& to_name) {
-    XdrEncoder enc;
+void encode_rename_args(XdrEncoder& enc,
+                        const Fh3& from_dir, const std::string& from_name,
+                        const Fh3& to_dir,   const std::string& to_name) {
     encode_fh3(enc, from_dir);
     enc.put_string(from_name);
     encode_fh3(enc, to_dir);
     enc.put_string(to_name);
+}
+
+std::vector<uint8_t> encode_rename_args(const Fh3& from_dir, const std::string& from_name,
+                                         const Fh3& to_dir,   const std::string& to_name) {
+    XdrEncoder enc;
+    encode_rename_args(enc, from_dir, from_name, to_dir, to_name);
     return enc.release();
 }
 
-void decode_rename_reply(const std::vector<uint8_t>& data) {
+void decode_rename_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                         const Fh3& from_dir, const Fh3& to_dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // RENAME3res always carries fromdir_wcc and todir_wcc in both OK and fail.
-    skip_wcc_data(dec);  // fromdir_wcc
-    skip_wcc_data(dec);  // todir_wcc
+    cache_wcc_data(dec, cache, from_dir);  // fromdir_wcc
+    cache_wcc_data(dec, cache, to_dir);    // todir_wcc
     if (status != 0)
         throw NfsError(status, "RENAME");
 }
 
 void rename(TcpRpcClient& client,
             const Fh3& from_dir, const std::string& from_name,
-            const Fh3& to_dir,   const std::string& to_name) {
-    const auto args  = encode_rename_args(from_dir, from_name, to_dir, to_name);
+            const Fh3& to_dir,   const std::string& to_name,
+            AttrCache* cache) {
+    XdrEncoder args;
+    encode_rename_args(args, from_dir, from_name, to_dir, to_name);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_RENAME, args);
-    decode_rename_reply(reply);
+    decode_rename_reply(reply, cache, from_dir, to_dir);
 }
 
 }  // namespace nfs3
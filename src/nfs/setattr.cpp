@@ -8,9 +8,9 @@ static constexpr uint32_t NFS_PROG         = 100003;
 static constexpr uint32_t NFS_VERS         = 3;
 static constexpr uint32_t NFSPROC3_SETATTR = 2;
 
-std::vector<uint8_t> encode_setattr_args(const Fh3& fh, const Sattr3& attrs,
-                                          const SattrGuard3& guard) {
-    XdrEncoder enc;
+void encode_setattr_args(XdrEncoder& enc,
+                         const Fh3& fh, const Sattr3& attrs,
+                         const SattrGuard3& guard) {
     encode_fh3(enc, fh);
     encode_sattr3(enc, attrs);
     // sattrguard3: bool + optional nfstime3
@@ -19,23 +19,30 @@ std::vector<uint8_t> encode_setattr_args(const Fh3& fh, const Sattr3& attrs,
         enc.put_uint32(guard.ctime_sec);
         enc.put_uint32(guard.ctime_nsec);
     }
+}
+
+std::vector<uint8_t> encode_setattr_args(const Fh3& fh, const Sattr3& attrs,
+                                          const SattrGuard3& guard) {
+    XdrEncoder enc;
+    encode_setattr_args(enc, fh, attrs, guard);
     return enc.release();
 }
 
-void decode_setattr_reply(const std::vector<uint8_t>& data) {
+void decode_setattr_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // SETATTR3res always carries obj_wcc (wcc_data) in both OK and fail.
-    skip_wcc_data(dec);
+    cache_wcc_data(dec, cache, fh);
     if (status != 0)
         throw NfsError(status, "SETATTR");
 }
 
 void setattr(TcpRpcClient& client, const Fh3& fh, const Sattr3& attrs,
-             const SattrGuard3& guard) {
-    const auto args  = encode_setattr_args(fh, attrs, guard);
+             const SattrGuard3& guard, AttrCache* cache) {
+    XdrEncoder args;
+    encode_setattr_args(args, fh, attrs, guard);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_SETATTR, args);
-    decode_setattr_reply(reply);
+    decode_setattr_reply(reply, cache, fh);
 }
 
 }  // namespace nfs3
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
@@ -17,13 +18,16 @@ struct SattrGuard3 {
 };
 
 // Encode/decode helpers (pure, no network)
+void                 encode_setattr_args(XdrEncoder& enc, const Fh3& fh, const Sattr3& attrs,
+                                          const SattrGuard3& guard = {});
 std::vector<uint8_t> encode_setattr_args(const Fh3& fh, const Sattr3& attrs,
                                           const SattrGuard3& guard = {});
-void decode_setattr_reply(const std::vector<uint8_t>& data);
+void decode_setattr_reply(const std::vector<uint8_t>& data,
+                          AttrCache* cache = nullptr, const Fh3& fh = {});
 
 // NFSPROC3_SETATTR (proc 2): set attributes on fh.
 // Throws NfsError on failure (including NFS3ERR_NOT_SYNC if the guard fails).
 void setattr(TcpRpcClient& client, const Fh3& fh, const Sattr3& attrs,
-             const SattrGuard3& guard = {});
+             const SattrGuard3& guard = {}, AttrCache* cache = nullptr);
 
 }  // namespace nfs3
@@ -14,48 +14,62 @@ static constexpr uint32_t NFSPROC3_LINK     = 15;
 
 // ── READLINK ─────────────────────────────────────────────────────────────────
 
+void encode_readlink_args(XdrEncoder& enc, const Fh3& symlink_fh) {
+    encode_fh3(enc, symlink_fh);
+}
+
 std::vector<uint8_t> encode_readlink_args(const Fh3& symlink_fh) {
     XdrEncoder enc;
-    encode_fh3(enc, symlink_fh);
+    encode_readlink_args(enc, symlink_fh);
     return enc.release();
 }
 
-std::string decode_readlink_reply(const std::vector<uint8_t>& data) {
+std::string decode_readlink_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                                  const Fh3& symlink_fh) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // READLINK3res always carries symlink_attributes (post_op_attr).
-    skip_post_op_attr(dec);
+    cache_post_op_attr(dec, cache, symlink_fh);
     if (status != 0)
         throw NfsError(status, "READLINK");
     // READLINK3resok: data (nfspath3 = string)
     return dec.get_string();
 }
 
-std::string readlink(TcpRpcClient& client, const Fh3& symlink_fh) {
-    const auto args  = encode_readlink_args(symlink_fh);
+std::string readlink(TcpRpcClient& client, const Fh3& symlink_fh, AttrCache* cache) {
+    XdrEncoder args;
+    encode_readlink_args(args, symlink_fh);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_READLINK, args);
-    return decode_readlink_reply(reply);
+    return decode_readlink_reply(reply, cache, symlink_fh);
 }
 
 // ── SYMLINK ──────────────────────────────────────────────────────────────────
 
-std::vector<uint8_t> encode_symlink_args(const Fh3& dir, const std::string& name,
-                                          const std::string& target,
-                                          const Sattr3& attrs) {
-    XdrEncoder enc;
+void encode_symlink_args(XdrEncoder& enc,
+                         const Fh3& dir, const std::string& name,
+                         const std::string& target,
+                         const Sattr3& attrs) {
     encode_fh3(enc, dir);
     enc.put_string(name);
     // symlinkdata3: sattr3 + nfspath3
     encode_sattr3(enc, attrs);
     enc.put_string(target);
+}
+
+std::vector<uint8_t> encode_symlink_args(const Fh3& dir, const std::string& name,
+                                          const std::string& target,
+                                          const Sattr3& attrs) {
+    XdrEncoder enc;
+    encode_symlink_args(enc, dir, name, target, attrs);
     return enc.release();
 }
 
-Fh3 decode_symlink_reply(const std::vector<uint8_t>& data) {
+Fh3 decode_symlink_reply(const std::vector<uint8_t>& data, AttrCache* cache, const Fh3& dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     if (status != 0) {
-        // SYMLINK3resfail: dir_wcc follows
+        // SYMLINK3resfail: dir_wcc
+        if (cache) cache_wcc_data(dec, cache, dir);
         throw NfsError(status, "SYMLINK");
     }
     // SYMLINK3resok: obj (post_op_fh3), obj_attributes (post_op_attr), dir_wcc
@@ -63,45 +77,55 @@ Fh3 decode_symlink_reply(const std::vector<uint8_t>& data) {
     if (!fh_present)
         throw std::runtime_error("SYMLINK: server returned no file handle");
     Fh3 fh = decode_fh3(dec);
-    skip_post_op_attr(dec);  // obj_attributes
-    skip_wcc_data(dec);      // dir_wcc
+    cache_post_op_attr(dec, cache, fh);  // obj_attributes
+    cache_wcc_data(dec, cache, dir);     // dir_wcc
     return fh;
 }
 
 Fh3 symlink(TcpRpcClient& client, const Fh3& dir, const std::string& name,
-             const std::string& target, const Sattr3& attrs) {
-    const auto args  = encode_symlink_args(dir, name, target, attrs);
+             const std::string& target, const Sattr3& attrs, AttrCache* cache) {
+    XdrEncoder args;
+    encode_symlink_args(args, dir, name, target, attrs);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_SYMLINK, args);
-    return decode_symlink_reply(reply);
+    return decode_symlink_reply(reply, cache, dir);
 }
 
 // ── LINK ─────────────────────────────────────────────────────────────────────
 
+void encode_link_args(XdrEncoder& enc,
+                      const Fh3& file,
+                      const Fh3& link_dir,
+                      const std::string& link_name) {
+    encode_fh3(enc, file);
+    encode_fh3(enc, link_dir);
+    enc.put_string(link_name);
+}
+
 std::vector<uint8_t> encode_link_args(const Fh3& file,
                                        const Fh3& link_dir,
                                        const std::string& link_name) {
     XdrEncoder enc;
-    encode_fh3(enc, file);
-    encode_fh3(enc, link_dir);
-    enc.put_string(link_name);
+    encode_link_args(enc, file, link_dir, link_name);
     return enc.release();
 }
 
-void decode_link_reply(const std::vector<uint8_t>& data) {
+void decode_link_reply(const std::vector<uint8_t>& data, AttrCache* cache,
+                       const Fh3& file, const Fh3& link_dir) {
     XdrDecoder dec(data);
     const uint32_t status = dec.get_uint32();
     // LINK3res always carries file_attributes (post_op_attr) and linkdir_wcc.
-    skip_post_op_attr(dec);  // file_attributes
-    skip_wcc_data(dec);      // linkdir_wcc
+    cache_post_op_attr(dec, cache, file);   // file_attributes
+    cache_wcc_data(dec, cache, link_dir);   // linkdir_wcc
     if (status != 0)
         throw NfsError(status, "LINK");
 }
 
 void link(TcpRpcClient& client, const Fh3& file,
-           const Fh3& link_dir, const std::string& link_name) {
-    const auto args  = encode_link_args(file, link_dir, link_name);
+           const Fh3& link_dir, const std::string& link_name, AttrCache* cache) {
+    XdrEncoder args;
+    encode_link_args(args, file, link_dir, link_name);
     const auto reply = client.call(NFS_PROG, NFS_VERS, NFSPROC3_LINK, args);
-    decode_link_reply(reply);
+    decode_link_reply(reply, cache, file, link_dir);
 }
 
 }  // namespace nfs3
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "attr_cache.hpp"
 #include "nfs3_types.hpp"
 #include "../rpc/rpc_client.hpp"
 
+#include <future>
 #include <vector>
 
 namespace nfs3 {
@@ -11,10 +13,19 @@ namespace nfs3 {
 std::vector<uint8_t> encode_write_args(const Fh3& fh, uint64_t offset,
                                         Stable3 stable,
                                         const uint8_t* data, size_t data_size);
-WriteResult decode_write_reply(const std::vector<uint8_t>& data);
+WriteResult decode_write_reply(const std::vector<uint8_t>& data,
+                               AttrCache* cache = nullptr, const Fh3& fh = {});
 
 // Send NFSPROC3_WRITE and return the result.
 WriteResult write(TcpRpcClient& client, const Fh3& fh, uint64_t offset,
-                  Stable3 stable, const uint8_t* data, size_t data_size);
+                  Stable3 stable, const uint8_t* data, size_t data_size,
+                  AttrCache* cache = nullptr);
+
+// Pipelined NFSPROC3_WRITE: `data` has been sent when this returns, so the
+// caller may reuse its buffer immediately.
+std::future<WriteResult> write_async(TcpRpcClient& client, const Fh3& fh,
+                                     uint64_t offset, Stable3 stable,
+                                     const uint8_t* data, size_t data_size,
+                                     AttrCache* cache = nullptr);
 
 }  // namespace nfs3
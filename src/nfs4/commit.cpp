@@ -16,8 +16,8 @@ std::array<uint8_t, 8> decode_commit_result(XdrDecoder& dec) {
     if (status != 0) throw Nfs4Error(status, "COMMIT");
 
     std::array<uint8_t, 8> verf{};
-    auto v = dec.get_fixed_opaque(8);
-    std::copy(v.begin(), v.end(), verf.begin());
+    const XdrSegment v = dec.get_fixed_opaque_view(8);
+    std::copy(v.data, v.data + v.size, verf.begin());
     return verf;
 }
 
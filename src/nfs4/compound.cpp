@@ -9,30 +9,73 @@ static constexpr uint32_t NFS4_PROC_COMPOUND = 1;
 
 std::vector<uint8_t> call_compound(TcpRpcClient& rpc,
                                     const std::string& tag,
-                                    const std::vector<uint8_t>& ops_bytes,
+                                    const XdrEncoder& ops,
                                     uint32_t num_ops,
                                     uint32_t minorversion) {
-    // Encode COMPOUND4args header: tag, minorversion, numops
-    XdrEncoder hdr;
-    hdr.put_string(tag);
-    hdr.put_uint32(minorversion);
-    hdr.put_uint32(num_ops);
-    auto hdr_bytes = hdr.release();
-
-    // Concatenate header + ops
-    std::vector<uint8_t> args;
-    args.reserve(hdr_bytes.size() + ops_bytes.size());
-    args.insert(args.end(), hdr_bytes.begin(), hdr_bytes.end());
-    args.insert(args.end(), ops_bytes.begin(), ops_bytes.end());
+    // Encode COMPOUND4args header: tag, minorversion, numops.  The ops are
+    // referenced behind it, so they reach the socket without another copy.
+    XdrEncoder args;
+    args.put_string(tag);
+    args.put_uint32(minorversion);
+    args.put_uint32(num_ops);
+    args.append_ref(ops);
 
     return rpc.call(NFS4_PROG, NFS4_VERS, NFS4_PROC_COMPOUND, args);
 }
 
+void call_compound_into(TcpRpcClient& rpc,
+                        const std::string& tag,
+                        const XdrEncoder& ops,
+                        uint32_t num_ops,
+                        uint32_t minorversion,
+                        const TcpRpcClient::ReplySink& sink) {
+    XdrEncoder args;
+    args.put_string(tag);
+    args.put_uint32(minorversion);
+    args.put_uint32(num_ops);
+    args.append_ref(ops);
+
+    rpc.call_into(NFS4_PROG, NFS4_VERS, NFS4_PROC_COMPOUND, args, sink);
+}
+
+std::future<void> call_compound_async_into(TcpRpcClient& rpc,
+                                           const std::string& tag,
+                                           const XdrEncoder& ops,
+                                           uint32_t num_ops,
+                                           uint32_t minorversion,
+                                           TcpRpcClient::ReplySink sink) {
+    XdrEncoder args;
+    args.put_string(tag);
+    args.put_uint32(minorversion);
+    args.put_uint32(num_ops);
+    args.append_ref(ops);
+
+    return rpc.call_async_into(NFS4_PROG, NFS4_VERS, NFS4_PROC_COMPOUND, args,
+                               std::move(sink));
+}
+
+std::vector<uint8_t> call_compound(TcpRpcClient& rpc,
+                                    const std::string& tag,
+                                    const std::vector<uint8_t>& ops_bytes,
+                                    uint32_t num_ops,
+                                    uint32_t minorversion) {
+    XdrEncoder ops;
+    ops.put_bytes_ref(ops_bytes.data(), ops_bytes.size());
+    return call_compound(rpc, tag, ops, num_ops, minorversion);
+}
+
 void check_compound_status(XdrDecoder& dec) {
     uint32_t status = dec.get_uint32();
     if (status != 0) throw Nfs4Error(status, "COMPOUND");
-    dec.get_string();    // echoed tag
+    dec.skip_opaque();   // echoed tag
     dec.get_uint32();    // numops in reply
 }
 
+void check_compound_status(RecordReader& rr) {
+    uint32_t status = rr.get_uint32();
+    if (status != 0) throw Nfs4Error(status, "COMPOUND");
+    rr.skip_opaque();    // echoed tag
+    rr.get_uint32();     // numops in reply
+}
+
 }  // namespace nfs4
@@ -5,6 +5,7 @@
 #include "nfs4_error.hpp"
 
 #include <cstdint>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -63,6 +64,33 @@ std::vector<uint8_t> call_compound(TcpRpcClient& rpc,
                                     uint32_t num_ops,
                                     uint32_t minorversion = 0);
 
+// Same, sending the ops straight out of `ops` (including any payloads it
+// references) as a gather list instead of concatenating them first.
+std::vector<uint8_t> call_compound(TcpRpcClient& rpc,
+                                    const std::string& tag,
+                                    const XdrEncoder& ops,
+                                    uint32_t num_ops,
+                                    uint32_t minorversion = 0);
+
+// Same, but the reply is streamed: `sink` receives a RecordReader positioned at
+// COMPOUND4res.status (see TcpRpcClient::call_into).
+void call_compound_into(TcpRpcClient& rpc,
+                        const std::string& tag,
+                        const XdrEncoder& ops,
+                        uint32_t num_ops,
+                        uint32_t minorversion,
+                        const TcpRpcClient::ReplySink& sink);
+
+// Pipelined form of call_compound_into (see TcpRpcClient::call_async_into):
+// returns once the request is sent; `sink` runs on the connection's reader
+// thread when the reply arrives.
+std::future<void> call_compound_async_into(TcpRpcClient& rpc,
+                                           const std::string& tag,
+                                           const XdrEncoder& ops,
+                                           uint32_t num_ops,
+                                           uint32_t minorversion,
+                                           TcpRpcClient::ReplySink sink);
+
 // Helper: parse the COMPOUND4res header from `reply` and return an XdrDecoder
 // positioned at the start of the resarray.  Throws Nfs4Error on outer failure.
 //
@@ -73,5 +101,6 @@ std::vector<uint8_t> call_compound(TcpRpcClient& rpc,
 //   decode_putfh_result(dec);
 //   auto fh = decode_getfh_result(dec);
 void check_compound_status(XdrDecoder& dec);
+void check_compound_status(RecordReader& rr);
 
 }  // namespace nfs4
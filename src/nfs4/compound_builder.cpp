@@ -0,0 +1,195 @@
+#include "compound_builder.hpp"
+#include "compound.hpp"
+#include "commit.hpp"
+#include "create.hpp"
+#include "dirop.hpp"
+#include "fh_ops.hpp"
+#include "getattr.hpp"
+#include "lookup.hpp"
+#include "read.hpp"
+#include "readlink.hpp"
+#include "setattr.hpp"
+#include "write.hpp"
+
+#include <algorithm>
+
+namespace nfs4 {
+
+CompoundBuilder& CompoundBuilder::putfh(const Nfs4Fh& fh) {
+    if (fh.data.empty()) return putrootfh();
+    encode_putfh(ops_, fh);
+    return add(OP_PUTFH);
+}
+
+CompoundBuilder& CompoundBuilder::putrootfh() {
+    encode_putrootfh(ops_);
+    return add(OP_PUTROOTFH);
+}
+
+CompoundBuilder& CompoundBuilder::lookup(const std::string& name) {
+    encode_lookup(ops_, name);
+    return add(OP_LOOKUP);
+}
+
+CompoundBuilder& CompoundBuilder::lookupp() {
+    encode_lookupp(ops_);
+    return add(OP_LOOKUPP);
+}
+
+CompoundBuilder& CompoundBuilder::getfh() {
+    encode_getfh(ops_);
+    return add(OP_GETFH);
+}
+
+CompoundBuilder& CompoundBuilder::savefh() {
+    encode_savefh(ops_);
+    return add(OP_SAVEFH);
+}
+
+CompoundBuilder& CompoundBuilder::restorefh() {
+    encode_restorefh(ops_);
+    return add(OP_RESTOREFH);
+}
+
+CompoundBuilder& CompoundBuilder::getattr(std::initializer_list<uint32_t> attr_ids) {
+    encode_getattr(ops_, attr_ids);
+    return add(OP_GETATTR);
+}
+
+CompoundBuilder& CompoundBuilder::access(uint32_t mask) {
+    encode_access(ops_, mask);
+    return add(OP_ACCESS);
+}
+
+// The seqid is the first argument of OPEN and CLOSE, and follows the stateid
+// in OPEN_CONFIRM.
+
+CompoundBuilder& CompoundBuilder::open(const std::string& name, uint32_t share_access,
+                                       bool create, const Sattr4& attrs) {
+    seqid_at_.push_back(ops_.mark() + 4);
+    if (create)
+        encode_open_create(ops_, 0, share_access, owner_.clientid, owner_.owner, name, attrs);
+    else
+        encode_open_nocreate(ops_, 0, share_access, owner_.clientid, owner_.owner, name);
+    return add(OP_OPEN);
+}
+
+CompoundBuilder& CompoundBuilder::open_confirm(const Stateid4& stateid) {
+    seqid_at_.push_back(ops_.mark() + 4 + xdr_wire_size<Stateid4>);
+    encode_open_confirm(ops_, stateid, 0);
+    return add(OP_OPEN_CONFIRM);
+}
+
+CompoundBuilder& CompoundBuilder::close(const Stateid4& stateid) {
+    seqid_at_.push_back(ops_.mark() + 4);
+    encode_close(ops_, 0, stateid);
+    return add(OP_CLOSE);
+}
+
+CompoundBuilder& CompoundBuilder::read(const Stateid4& stateid, uint64_t offset,
+                                       uint32_t count) {
+    encode_read(ops_, stateid, offset, count);
+    return add(OP_READ);
+}
+
+CompoundBuilder& CompoundBuilder::write(const Stateid4& stateid, uint64_t offset,
+                                        Stable4 stable, const uint8_t* data, uint32_t len) {
+    encode_write(ops_, stateid, offset, stable, data, len);
+    return add(OP_WRITE);
+}
+
+CompoundBuilder& CompoundBuilder::commit(uint64_t offset, uint32_t count) {
+    encode_commit(ops_, offset, count);
+    return add(OP_COMMIT);
+}
+
+CompoundBuilder& CompoundBuilder::setattr(const Stateid4& stateid, const Sattr4& attrs) {
+    encode_setattr(ops_, stateid, attrs);
+    return add(OP_SETATTR);
+}
+
+CompoundBuilder& CompoundBuilder::mkdir(const std::string& name, const Sattr4& attrs) {
+    encode_create_dir(ops_, name, attrs);
+    return add(OP_CREATE);
+}
+
+CompoundBuilder& CompoundBuilder::symlink(const std::string& name, const std::string& target,
+                                          const Sattr4& attrs) {
+    encode_create_symlink(ops_, name, target, attrs);
+    return add(OP_CREATE);
+}
+
+CompoundBuilder& CompoundBuilder::readlink() {
+    encode_readlink(ops_);
+    return add(OP_READLINK);
+}
+
+CompoundBuilder& CompoundBuilder::remove(const std::string& name) {
+    encode_remove(ops_, name);
+    return add(OP_REMOVE);
+}
+
+CompoundBuilder& CompoundBuilder::rename(const std::string& oldname, const std::string& newname) {
+    encode_rename(ops_, oldname, newname);
+    return add(OP_RENAME);
+}
+
+// ── Decode ────────────────────────────────────────────────────────────────────
+
+// One result; the per-op decoders throw Nfs4Error on a non-zero status.
+static void decode_op(XdrDecoder& dec, OpResult4& r) {
+    switch (r.op) {
+    case OP_PUTFH:
+    case OP_PUTROOTFH:      decode_putfh_result(dec);                     break;
+    case OP_LOOKUP:         decode_lookup_result(dec);                    break;
+    case OP_LOOKUPP:        decode_lookupp_result(dec);                   break;
+    case OP_GETFH:          r.value = decode_getfh_result(dec);           break;
+    case OP_SAVEFH:         decode_savefh_result(dec);                    break;
+    case OP_RESTOREFH:      decode_restorefh_result(dec);                 break;
+    case OP_GETATTR:        r.value = decode_getattr_result(dec);         break;
+    case OP_ACCESS:         r.value = decode_access_result(dec);          break;
+    case OP_OPEN:           r.value = decode_open_result(dec);            break;
+    case OP_OPEN_CONFIRM:   r.value = decode_open_confirm_result(dec);    break;
+    case OP_CLOSE:          decode_close_result(dec);                     break;
+    case OP_READ: {
+        Nfs4ReadResult rd;
+        rd.data = decode_read_result(dec, &rd.eof);
+        r.value = std::move(rd);
+        break;
+    }
+    case OP_WRITE:          r.value = decode_write_result(dec);           break;
+    case OP_COMMIT:         r.value = decode_commit_result(dec);          break;
+    case OP_SETATTR:        decode_setattr_result(dec);                   break;
+    case OP_CREATE:         decode_create_result(dec);                    break;
+    case OP_READLINK:       r.value = decode_readlink_result(dec);        break;
+    case OP_REMOVE:         decode_remove_result(dec);                    break;
+    case OP_RENAME:         decode_rename_result(dec);                    break;
+    }
+}
+
+CompoundResult CompoundBuilder::decode(XdrDecoder& dec) const {
+    const uint32_t status = dec.get_uint32();
+    dec.skip_opaque();                                    // tag
+    const uint32_t count = dec.get_uint32();
+    return decode_results(dec, status, count);
+}
+
+CompoundResult CompoundBuilder::decode_results(XdrDecoder& dec, uint32_t status,
+                                               uint32_t count) const {
+    CompoundResult res;
+    res.status = status;
+    const size_t n = std::min<size_t>(count, opcodes_.size());
+    for (size_t i = 0; i < n; ++i) {
+        OpResult4& r = res.ops.emplace_back();
+        r.op = opcodes_[i];
+        try {
+            decode_op(dec, r);
+        } catch (const Nfs4Error& e) {
+            r.status = e.status;                          // processing stopped here
+            break;
+        }
+    }
+    return res;
+}
+
+}  // namespace nfs4
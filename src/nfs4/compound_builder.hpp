@@ -0,0 +1,144 @@
+#pragma once
+
+#include "nfs4_types.hpp"
+#include "nfs4_error.hpp"
+#include "nfs4_attr.hpp"
+#include "access.hpp"
+#include "open.hpp"
+#include "../xdr/xdr.hpp"
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace nfs4 {
+
+// Special stateids (RFC 8881 §8.2.3).  The anonymous stateid reads, writes
+// or sets attributes without open state.  The current stateid (NFSv4.1 only)
+// stands for the one the last op of the same COMPOUND produced, e.g. READ or
+// CLOSE after OPEN.
+constexpr Stateid4 ANONYMOUS_STATEID{};
+constexpr Stateid4 CURRENT_STATEID{1, {}};
+
+// The open-owner the OPENs of a COMPOUND are made for (RFC 7530 §3.3.6).
+struct OpenOwner4 {
+    uint64_t    clientid{};
+    std::string owner;
+};
+
+// Result of one op of a CompoundBuilder.  `value` holds what the op returns,
+// if anything: GETFH Nfs4Fh, GETATTR Fattr4, ACCESS Access4Result, OPEN
+// Open4Result, OPEN_CONFIRM Stateid4, READ Nfs4ReadResult, WRITE Nfs4WriteResult,
+// COMMIT the write verifier, READLINK the target.
+struct OpResult4 {
+    uint32_t op{};
+    uint32_t status{};
+    std::variant<std::monostate, Nfs4Fh, Fattr4, Access4Result, Open4Result, Stateid4,
+                 Nfs4ReadResult, Nfs4WriteResult, std::array<uint8_t, 8>,
+                 std::string> value;
+};
+
+// The results of a COMPOUND: one per op up to and including the first that
+// failed, which also gives the COMPOUND its status.  Ops are numbered from 0
+// in the order they were added; an NFSv4.1 SEQUENCE is not among them.
+struct CompoundResult {
+    uint32_t               status{};
+    std::vector<OpResult4> ops;
+
+    bool ok() const { return status == 0; }
+
+    // Throws Nfs4Error unless every op succeeded.
+    void check() const {
+        if (status != 0) throw Nfs4Error(status, "COMPOUND");
+    }
+
+    // The value of op `i`.  Throws Nfs4Error if that op failed or never ran,
+    // std::bad_variant_access if it does not return a T.
+    template <typename T>
+    const T& get(size_t i) const {
+        if (i >= ops.size() || ops[i].status != 0)
+            throw Nfs4Error(i < ops.size() ? ops[i].status : status, "COMPOUND");
+        return std::get<T>(ops[i].value);
+    }
+};
+
+// Assembles a COMPOUND from typed ops and decodes its reply into a
+// CompoundResult, so that unrelated work can share one round trip:
+//
+//   auto b = client.compound_builder();
+//   b.putfh(dir).open("f", OPEN4_SHARE_ACCESS_READ, false).getfh()
+//    .read(CURRENT_STATEID, 0, 4096).close(CURRENT_STATEID);
+//   auto r = client.compound(b);
+//   auto data = r.get<Nfs4ReadResult>(3).data;
+//
+// The op number to pass to get() is num_ops() before the op was added.
+// Nfs4Client::compound() and Nfs41Client::compound() send it; the latter
+// puts SEQUENCE in front.  OPEN, OPEN_CONFIRM and CLOSE carry an open-owner
+// seqid, which the client fills in when sending (set_seqid()); OPEN needs the
+// client's open-owner too, so start from the client's compound_builder() for
+// those.  WRITE data is referenced, not copied, until the COMPOUND is sent.
+class CompoundBuilder {
+public:
+    explicit CompoundBuilder(OpenOwner4 owner = {}) : owner_(std::move(owner)) {}
+
+    // An empty handle is the root sentinel and becomes PUTROOTFH.
+    CompoundBuilder& putfh(const Nfs4Fh& fh);
+    CompoundBuilder& putrootfh();
+    CompoundBuilder& lookup(const std::string& name);
+    CompoundBuilder& lookupp();
+    CompoundBuilder& getfh();
+    CompoundBuilder& savefh();
+    CompoundBuilder& restorefh();
+    CompoundBuilder& getattr(std::initializer_list<uint32_t> attr_ids);
+    CompoundBuilder& access(uint32_t mask);
+
+    // OPEN by name in the current directory; leaves the file current.
+    CompoundBuilder& open(const std::string& name, uint32_t share_access, bool create,
+                          const Sattr4& attrs = {});
+    CompoundBuilder& open_confirm(const Stateid4& stateid);
+    CompoundBuilder& close(const Stateid4& stateid);
+
+    CompoundBuilder& read(const Stateid4& stateid, uint64_t offset, uint32_t count);
+    CompoundBuilder& write(const Stateid4& stateid, uint64_t offset, Stable4 stable,
+                           const uint8_t* data, uint32_t len);
+    CompoundBuilder& commit(uint64_t offset = 0, uint32_t count = 0);
+    CompoundBuilder& setattr(const Stateid4& stateid, const Sattr4& attrs);
+
+    CompoundBuilder& mkdir(const std::string& name, const Sattr4& attrs = {});
+    CompoundBuilder& symlink(const std::string& name, const std::string& target,
+                             const Sattr4& attrs = {});
+    CompoundBuilder& readlink();
+    CompoundBuilder& remove(const std::string& name);
+    // Renames in the saved directory to the current one (SAVEFH first).
+    CompoundBuilder& rename(const std::string& oldname, const std::string& newname);
+
+    uint32_t          num_ops() const { return static_cast<uint32_t>(opcodes_.size()); }
+    const XdrEncoder& ops() const { return ops_; }
+
+    // Open-owner seqids, one per OPEN / OPEN_CONFIRM / CLOSE in op order.
+    size_t num_seqids() const { return seqid_at_.size(); }
+    void   set_seqid(size_t i, uint32_t seqid) { ops_.patch_uint32(seqid_at_.at(i), seqid); }
+
+    // Decode a reply from COMPOUND4res.status on.
+    CompoundResult decode(XdrDecoder& dec) const;
+
+    // Decode `count` results of these ops, the COMPOUND having `status`.
+    CompoundResult decode_results(XdrDecoder& dec, uint32_t status, uint32_t count) const;
+
+private:
+    CompoundBuilder& add(uint32_t op) {
+        opcodes_.push_back(op);
+        return *this;
+    }
+
+    OpenOwner4            owner_;
+    XdrEncoder            ops_;
+    std::vector<uint32_t> opcodes_;
+    std::vector<size_t>   seqid_at_;
+};
+
+}  // namespace nfs4
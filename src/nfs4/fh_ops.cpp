@@ -48,6 +48,13 @@ void decode_putfh_result(XdrDecoder& dec) {
     check_op_status(dec, OP_PUTFH, "PUTFH");
 }
 
+void decode_putfh_result(RecordReader& rr) {
+    uint32_t resop  = rr.get_uint32();
+    uint32_t status = rr.get_uint32();
+    (void)resop;
+    if (status != 0) throw Nfs4Error(status, "PUTFH");
+}
+
 Nfs4Fh decode_getfh_result(XdrDecoder& dec) {
     check_op_status(dec, OP_GETFH, "GETFH");
     return decode_nfs4fh(dec);
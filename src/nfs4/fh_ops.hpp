@@ -2,6 +2,7 @@
 
 #include "nfs4_types.hpp"
 #include "nfs4_error.hpp"
+#include "../rpc/record_reader.hpp"
 #include "../xdr/xdr.hpp"
 
 namespace nfs4 {
@@ -21,6 +22,7 @@ void encode_lookupp(XdrEncoder& enc);
 
 void   decode_putrootfh_result(XdrDecoder& dec);
 void   decode_putfh_result(XdrDecoder& dec);
+void   decode_putfh_result(RecordReader& rr);  // also accepts a PUTROOTFH result
 Nfs4Fh decode_getfh_result(XdrDecoder& dec);
 void   decode_savefh_result(XdrDecoder& dec);
 void   decode_restorefh_result(XdrDecoder& dec);
@@ -15,4 +15,19 @@ void decode_lookup_result(XdrDecoder& dec) {
     if (status != 0) throw Nfs4Error(status, "LOOKUP");
 }
 
+void encode_lookup_path(XdrEncoder& enc, const std::vector<std::string>& names,
+                        size_t first, size_t count) {
+    for (size_t i = first; i < first + count; ++i) {
+        if (names[i] == "..")
+            enc.put_uint32(OP_LOOKUPP);
+        else
+            encode_lookup(enc, names[i]);
+    }
+}
+
+// LOOKUP and LOOKUPP results look the same: resop, status, nothing else.
+void decode_lookup_path_result(XdrDecoder& dec, size_t count) {
+    for (size_t i = 0; i < count; ++i) decode_lookup_result(dec);
+}
+
 }  // namespace nfs4
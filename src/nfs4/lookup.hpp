@@ -4,11 +4,19 @@
 #include "nfs4_error.hpp"
 #include "../xdr/xdr.hpp"
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace nfs4 {
 
 void encode_lookup(XdrEncoder& enc, const std::string& name);
 void decode_lookup_result(XdrDecoder& dec);
 
+// `count` names of `names` starting at `first`, one LOOKUP each from the
+// current filehandle; ".." is sent as LOOKUPP.
+void encode_lookup_path(XdrEncoder& enc, const std::vector<std::string>& names,
+                        size_t first, size_t count);
+void decode_lookup_path_result(XdrDecoder& dec, size_t count);
+
 }  // namespace nfs4
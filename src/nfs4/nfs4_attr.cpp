@@ -2,6 +2,8 @@
 #include "nfs4_types.hpp"
 #include "../xdr/xdr.hpp"
 
+#include <algorithm>
+
 namespace nfs4 {
 
 void bitmap4_set(std::vector<uint32_t>& bm, uint32_t id) {
@@ -19,15 +21,27 @@ bool bitmap4_test(const std::vector<uint32_t>& bm, uint32_t id) {
 }
 
 void encode_bitmap4(XdrEncoder& enc, const std::vector<uint32_t>& bm) {
-    enc.put_uint32(static_cast<uint32_t>(bm.size()));
-    for (uint32_t w : bm) enc.put_uint32(w);
+    encode_bitmap4(enc, bm.data(), bm.size());
+}
+
+void encode_bitmap4(XdrEncoder& enc, const uint32_t* words, size_t nwords) {
+    enc.put_uint32_array(words, nwords);
+}
+
+// Words of a bitmap built on the stack; covers every attribute this client
+// requests or sets.
+static constexpr size_t STACK_BITMAP_WORDS = 4;
+
+// Set `id` in a fixed-size bitmap, tracking the number of words in use.
+static void stack_bitmap_set(uint32_t (&bm)[STACK_BITMAP_WORDS], size_t& nwords,
+                             uint32_t id) {
+    const size_t word = id / 32;
+    bm[word] |= 1u << (id % 32);
+    nwords = std::max(nwords, word + 1);
 }
 
 std::vector<uint32_t> decode_bitmap4(XdrDecoder& dec) {
-    uint32_t count = dec.get_uint32();
-    std::vector<uint32_t> bm(count);
-    for (uint32_t& w : bm) w = dec.get_uint32();
-    return bm;
+    return dec.get_uint32_array();
 }
 
 std::vector<uint32_t> make_bitmap4(std::initializer_list<uint32_t> ids) {
@@ -37,13 +51,22 @@ std::vector<uint32_t> make_bitmap4(std::initializer_list<uint32_t> ids) {
 }
 
 void encode_attr_request(XdrEncoder& enc, std::initializer_list<uint32_t> ids) {
-    encode_bitmap4(enc, make_bitmap4(ids));
+    uint32_t bm[STACK_BITMAP_WORDS] = {};
+    size_t   nwords = 0;
+    for (uint32_t id : ids) {
+        if (id >= 32 * STACK_BITMAP_WORDS) {
+            encode_bitmap4(enc, make_bitmap4(ids));
+            return;
+        }
+        stack_bitmap_set(bm, nwords, id);
+    }
+    encode_bitmap4(enc, bm, nwords);
 }
 
 Fattr4 decode_fattr4(XdrDecoder& dec) {
     auto bm       = decode_bitmap4(dec);
-    auto attrlist = dec.get_opaque();
-    XdrDecoder ad(attrlist);
+    const XdrSegment attrlist = dec.get_opaque_view();
+    XdrDecoder ad(attrlist.data, attrlist.size);
 
     Fattr4 a;
 
@@ -65,6 +88,12 @@ Fattr4 decode_fattr4(XdrDecoder& dec) {
     if (bitmap4_test(bm, attr::FILEID)) {
         a.fileid = ad.get_uint64();
     }
+    if (bitmap4_test(bm, attr::MAXREAD)) {
+        a.maxread = ad.get_uint64();
+    }
+    if (bitmap4_test(bm, attr::MAXWRITE)) {
+        a.maxwrite = ad.get_uint64();
+    }
     if (bitmap4_test(bm, attr::MODE)) {
         a.mode = ad.get_uint32();
     }
@@ -98,34 +127,36 @@ Fattr4 decode_fattr4(XdrDecoder& dec) {
 
 void encode_fattr4(XdrEncoder& enc, const Sattr4& attrs) {
     // Build bitmap — attributes encoded in ascending ID order.
-    std::vector<uint32_t> bm;
-    if (attrs.size)         bitmap4_set(bm, attr::SIZE);
-    if (attrs.mode)         bitmap4_set(bm, attr::MODE);
-    if (attrs.owner)        bitmap4_set(bm, attr::OWNER);
-    if (attrs.owner_group)  bitmap4_set(bm, attr::OWNER_GROUP);
-    if (attrs.time_access)  bitmap4_set(bm, attr::TIME_ACCESS_SET);
-    if (attrs.time_modify)  bitmap4_set(bm, attr::TIME_MODIFY_SET);
-
-    // Encode attrlist into a temporary buffer (ascending ID order).
-    XdrEncoder ae;
-    if (attrs.size)  ae.put_uint64(*attrs.size);
-    if (attrs.mode)  ae.put_uint32(*attrs.mode);
-    if (attrs.owner) ae.put_string(*attrs.owner);
-    if (attrs.owner_group) ae.put_string(*attrs.owner_group);
+    uint32_t bm[STACK_BITMAP_WORDS] = {};
+    size_t   nwords = 0;
+    if (attrs.size)         stack_bitmap_set(bm, nwords, attr::SIZE);
+    if (attrs.mode)         stack_bitmap_set(bm, nwords, attr::MODE);
+    if (attrs.owner)        stack_bitmap_set(bm, nwords, attr::OWNER);
+    if (attrs.owner_group)  stack_bitmap_set(bm, nwords, attr::OWNER_GROUP);
+    if (attrs.time_access)  stack_bitmap_set(bm, nwords, attr::TIME_ACCESS_SET);
+    if (attrs.time_modify)  stack_bitmap_set(bm, nwords, attr::TIME_MODIFY_SET);
+    encode_bitmap4(enc, bm, nwords);
+
+    // attrlist4 is encoded in place (ascending ID order) behind a length
+    // placeholder that is patched once its size is known.
+    const size_t len_at = enc.mark();
+    enc.put_uint32(0);
+    if (attrs.size)  enc.put_uint64(*attrs.size);
+    if (attrs.mode)  enc.put_uint32(*attrs.mode);
+    if (attrs.owner) enc.put_string(*attrs.owner);
+    if (attrs.owner_group) enc.put_string(*attrs.owner_group);
     if (attrs.time_access) {
         // settime4: time_how4=SET_TO_CLIENT_TIME(1) + nfstime4
-        ae.put_uint32(1);
-        ae.put_uint64(static_cast<uint64_t>(attrs.time_access->seconds));
-        ae.put_uint32(attrs.time_access->nseconds);
+        enc.put_uint32(1);
+        enc.put_uint64(static_cast<uint64_t>(attrs.time_access->seconds));
+        enc.put_uint32(attrs.time_access->nseconds);
     }
     if (attrs.time_modify) {
-        ae.put_uint32(1);
-        ae.put_uint64(static_cast<uint64_t>(attrs.time_modify->seconds));
-        ae.put_uint32(attrs.time_modify->nseconds);
+        enc.put_uint32(1);
+        enc.put_uint64(static_cast<uint64_t>(attrs.time_modify->seconds));
+        enc.put_uint32(attrs.time_modify->nseconds);
     }
-
-    encode_bitmap4(enc, bm);
-    enc.put_opaque(ae.bytes());
+    enc.patch_uint32(len_at, static_cast<uint32_t>(enc.mark() - len_at - 4));
 }
 
 }  // namespace nfs4
@@ -18,6 +18,8 @@ namespace attr {
     constexpr uint32_t SIZE              = 4;
     constexpr uint32_t FSID              = 8;
     constexpr uint32_t FILEID            = 20;
+    constexpr uint32_t MAXREAD           = 30;
+    constexpr uint32_t MAXWRITE          = 31;
     constexpr uint32_t MODE              = 33;
     constexpr uint32_t NUMLINKS          = 35;
     constexpr uint32_t OWNER             = 36;
@@ -38,6 +40,7 @@ void bitmap4_set(std::vector<uint32_t>& bm, uint32_t id);
 bool bitmap4_test(const std::vector<uint32_t>& bm, uint32_t id);
 
 void                  encode_bitmap4(XdrEncoder& enc, const std::vector<uint32_t>& bm);
+void                  encode_bitmap4(XdrEncoder& enc, const uint32_t* words, size_t nwords);
 std::vector<uint32_t> decode_bitmap4(XdrDecoder& dec);
 
 std::vector<uint32_t> make_bitmap4(std::initializer_list<uint32_t> ids);
@@ -80,6 +80,8 @@ enum class Nfsstat4 : uint32_t {
     NFS4ERR_DEADSESSION         = 10056,
     NFS4ERR_SEQ_FALSE_RETRY     = 10060,
     NFS4ERR_SEQ_MISORDERED      = 10063,
+    NFS4ERR_RETRY_UNCACHED_REP  = 10068,
+    NFS4ERR_TOO_MANY_OPS        = 10070,
 };
 
 // Exception thrown when an NFS4 operation returns a non-zero nfsstat4.
@@ -94,3 +96,22 @@ struct Nfs4Error : std::runtime_error {
 
     bool is(Nfsstat4 code) const { return status == static_cast<uint32_t>(code); }
 };
+
+// Whether an OPEN, OPEN_CONFIRM or CLOSE that got `status` used up its
+// open-owner seqid: success and every error do, but for those that say
+// the request was never applied (RFC 7530 §9.1.7).
+inline bool nfs4_seqid_advances(uint32_t status) {
+    switch (static_cast<Nfsstat4>(status)) {
+    case Nfsstat4::NFS4ERR_STALE_CLIENTID:
+    case Nfsstat4::NFS4ERR_STALE_STATEID:
+    case Nfsstat4::NFS4ERR_BAD_STATEID:
+    case Nfsstat4::NFS4ERR_BAD_SEQID:
+    case Nfsstat4::NFS4ERR_BADXDR:
+    case Nfsstat4::NFS4ERR_RESOURCE:
+    case Nfsstat4::NFS4ERR_NOFILEHANDLE:
+    case Nfsstat4::NFS4ERR_MOVED:
+        return false;
+    default:
+        return true;
+    }
+}
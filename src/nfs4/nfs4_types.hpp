@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../xdr/xdr.hpp"
+#include "../xdr/xdr_struct.hpp"
 
 #include <array>
 #include <cstdint>
@@ -56,6 +57,8 @@ struct Fattr4 {
     std::optional<uint64_t>    change;
     std::optional<uint64_t>    size;
     std::optional<uint64_t>    fileid;
+    std::optional<uint64_t>    maxread;
+    std::optional<uint64_t>    maxwrite;
     std::optional<uint32_t>    mode;
     std::optional<uint32_t>    numlinks;
     std::optional<std::string> owner;
@@ -71,7 +74,13 @@ struct Fattr4 {
 struct Nfs4File {
     Nfs4Fh   fh;
     Stateid4 stateid;
-    uint32_t seqid{};  // tracks the open seqid (needed for CLOSE)
+    uint32_t seqid{};  // v4.1 OPEN seqid; v4.0 CLOSE takes the owner's next one
+};
+
+// One READ's data, and whether it reached the end of the file
+struct Nfs4ReadResult {
+    std::vector<uint8_t> data;
+    bool                 eof{};
 };
 
 // Result returned by nfs4::write()
@@ -88,6 +97,22 @@ struct Nfs4DirEntry {
     Fattr4      attrs;
 };
 
+// What resolve_path() found at the end of a path
+struct Nfs4PathInfo {
+    Nfs4Fh fh;
+    Fattr4 attrs;
+};
+
+// ── XDR schemas (fixed-size structures, see xdr_struct.hpp) ──────────────────
+
+template <> struct XdrSchema<Stateid4> {
+    using fields = XdrFields<&Stateid4::seqid, &Stateid4::other>;
+};
+
+template <> struct XdrSchema<Nfstime4> {
+    using fields = XdrFields<&Nfstime4::seconds, &Nfstime4::nseconds>;
+};
+
 // ── XDR helpers for NFSv4 structures ─────────────────────────────────────────
 
 inline void encode_nfs4fh(XdrEncoder& enc, const Nfs4Fh& fh) {
@@ -99,28 +124,18 @@ inline Nfs4Fh decode_nfs4fh(XdrDecoder& dec) {
 }
 
 inline void encode_stateid4(XdrEncoder& enc, const Stateid4& sid) {
-    enc.put_uint32(sid.seqid);
-    enc.put_fixed_opaque(sid.other.data(), 12);
+    xdr_encode(enc, sid);
 }
 
 inline Stateid4 decode_stateid4(XdrDecoder& dec) {
-    Stateid4 sid;
-    sid.seqid    = dec.get_uint32();
-    auto raw     = dec.get_fixed_opaque(12);
-    std::copy(raw.begin(), raw.end(), sid.other.begin());
-    return sid;
+    return xdr_decode<Stateid4>(dec);
 }
 
 inline Nfstime4 decode_nfstime4(XdrDecoder& dec) {
-    Nfstime4 t;
-    t.seconds  = static_cast<int64_t>(dec.get_uint64());
-    t.nseconds = dec.get_uint32();
-    return t;
+    return xdr_decode<Nfstime4>(dec);
 }
 
 // change_info4: atomic(bool) + before(uint64) + after(uint64) — skip it
 inline void skip_change_info4(XdrDecoder& dec) {
-    dec.get_uint32();  // atomic
-    dec.get_uint64();  // before
-    dec.get_uint64();  // after
+    dec.skip(4 + 8 + 8);  // atomic, before, after
 }
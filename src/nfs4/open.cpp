@@ -73,7 +73,7 @@ Open4Result decode_open_result(XdrDecoder& dec) {
         dec.get_uint32();  // recall bool
         // nfsace4: type(u32) + flag(u32) + access_mask(u32) + who(string)
         dec.get_uint32(); dec.get_uint32(); dec.get_uint32();
-        dec.get_string();
+        dec.skip_opaque();
     } else if (deleg_type == 2) {
         // OPEN_DELEGATE_WRITE: stateid4 + recall(bool) + space_limit + nfsace4
         decode_stateid4(dec);
@@ -83,7 +83,7 @@ Open4Result decode_open_result(XdrDecoder& dec) {
         dec.get_uint32();   // bytes_per_block or padding (u32)
         // nfsace4
         dec.get_uint32(); dec.get_uint32(); dec.get_uint32();
-        dec.get_string();
+        dec.skip_opaque();
     }
     // OPEN_DELEGATE_NONE (0): nothing to read
 
@@ -11,14 +11,27 @@ void encode_read(XdrEncoder& enc, const Stateid4& stateid,
     enc.put_uint32(count);
 }
 
-std::vector<uint8_t> decode_read_result(XdrDecoder& dec) {
+std::vector<uint8_t> decode_read_result(XdrDecoder& dec, bool* eof) {
     uint32_t resop  = dec.get_uint32();
     uint32_t status = dec.get_uint32();
     (void)resop;
     if (status != 0) throw Nfs4Error(status, "READ");
 
-    /* eof */ dec.get_uint32();
+    const bool at_eof = dec.get_uint32() != 0;
+    if (eof) *eof = at_eof;
     return dec.get_opaque();
 }
 
+uint32_t decode_read_result_into(RecordReader& rr, uint8_t* buf, uint32_t count,
+                                 bool* eof) {
+    uint32_t resop  = rr.get_uint32();
+    uint32_t status = rr.get_uint32();
+    (void)resop;
+    if (status != 0) throw Nfs4Error(status, "READ");
+
+    const bool at_eof = rr.get_uint32() != 0;
+    if (eof) *eof = at_eof;
+    return static_cast<uint32_t>(rr.get_opaque_into(buf, count));
+}
+
 }  // namespace nfs4
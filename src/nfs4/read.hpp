@@ -2,6 +2,7 @@
 
 #include "nfs4_types.hpp"
 #include "nfs4_error.hpp"
+#include "../rpc/record_reader.hpp"
 #include "../xdr/xdr.hpp"
 
 #include <cstdint>
@@ -12,7 +13,13 @@ namespace nfs4 {
 void encode_read(XdrEncoder& enc, const Stateid4& stateid,
                  uint64_t offset, uint32_t count);
 
-// Returns the data bytes; eof is discarded (callers check data.size() < count).
-std::vector<uint8_t> decode_read_result(XdrDecoder& dec);
+// Returns the data bytes and stores the eof flag in `*eof` if given.  A READ
+// may come back short without being at EOF; only the flag says the file ended.
+std::vector<uint8_t> decode_read_result(XdrDecoder& dec, bool* eof = nullptr);
+
+// Streaming form: the data is received directly into `buf` (capacity `count`).
+// Returns the number of bytes placed.
+uint32_t decode_read_result_into(RecordReader& rr, uint8_t* buf, uint32_t count,
+                                 bool* eof = nullptr);
 
 }  // namespace nfs4
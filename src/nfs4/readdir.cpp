@@ -26,8 +26,8 @@ ReaddirPage4 decode_readdir_result(XdrDecoder& dec) {
 
     ReaddirPage4 page;
 
-    auto cv = dec.get_fixed_opaque(8);
-    std::copy(cv.begin(), cv.end(), page.cookieverf.begin());
+    const XdrSegment cv = dec.get_fixed_opaque_view(8);
+    std::copy(cv.data, cv.data + cv.size, page.cookieverf.begin());
 
     // dirlist4: value_follows + entries + eof
     while (dec.get_uint32() != 0) {  // value_follows
@@ -43,16 +43,16 @@ ExchangeIdResult decode_exchange_id_result(XdrDecoder& dec) {
 
     // eir_server_owner: so_minor_id(u64) + so_major_id(opaque<>)
     dec.get_uint64();
-    dec.get_opaque();
+    dec.skip_opaque();
 
     // eir_server_scope: opaque<>
-    dec.get_opaque();
+    dec.skip_opaque();
 
     // eir_server_impl_id: array<nfs_impl_id4> — skip count then each element
     uint32_t impl_count = dec.get_uint32();
     for (uint32_t i = 0; i < impl_count; ++i) {
-        dec.get_opaque();  // nii_domain
-        dec.get_opaque();  // nii_name
+        dec.skip_opaque();  // nii_domain
+        dec.skip_opaque();  // nii_name
         dec.get_uint64();  // nii_date.seconds
         dec.get_uint32();  // nii_date.nseconds
     }
@@ -62,22 +62,41 @@ ExchangeIdResult decode_exchange_id_result(XdrDecoder& dec) {
 
 // ── CREATE_SESSION ────────────────────────────────────────────────────────────
 
-static void encode_channel_attrs(XdrEncoder& enc,
-                                  uint32_t maxrqst,
-                                  uint32_t maxresp,
-                                  uint32_t maxresp_cached) {
-    enc.put_uint32(0);             // ca_headerpadsize
-    enc.put_uint32(maxrqst);       // ca_maxrequestsize
-    enc.put_uint32(maxresp);       // ca_maxresponsesize
-    enc.put_uint32(maxresp_cached);// ca_maxresponsesize_cached
-    enc.put_uint32(16);            // ca_maxoperations
-    enc.put_uint32(1);             // ca_maxrequests
-    enc.put_uint32(0);             // ca_rdma_ird: empty array (count=0)
+static void encode_channel_attrs(XdrEncoder& enc, const ChannelAttrs41& ca) {
+    enc.put_uint32(ca.headerpadsize);          // ca_headerpadsize
+    enc.put_uint32(ca.maxrequestsize);         // ca_maxrequestsize
+    enc.put_uint32(ca.maxresponsesize);        // ca_maxresponsesize
+    enc.put_uint32(ca.maxresponsesize_cached); // ca_maxresponsesize_cached
+    enc.put_uint32(ca.maxoperations);          // ca_maxoperations
+    enc.put_uint32(ca.maxrequests);            // ca_maxrequests
+    enc.put_uint32(0);                         // ca_rdma_ird: empty array (count=0)
+}
+
+static ChannelAttrs41 decode_channel_attrs(XdrDecoder& dec) {
+    // Six fixed words plus the ca_rdma_ird<1> count, swapped in one go.
+    uint32_t w[7];
+    dec.get_uint32_words(w, 7);
+    ChannelAttrs41 ca;
+    ca.headerpadsize          = w[0];
+    ca.maxrequestsize         = w[1];
+    ca.maxresponsesize        = w[2];
+    ca.maxresponsesize_cached = w[3];
+    ca.maxoperations          = w[4];
+    ca.maxrequests            = w[5];
+    dec.skip(4 * static_cast<size_t>(w[6]));   // ca_rdma_ird entries
+    return ca;
+}
+
+uint32_t max_io_payload(uint32_t channel_size) {
+    if (channel_size <= CHANNEL_IO_HEADROOM) return 1;
+    const uint32_t room = channel_size - CHANNEL_IO_HEADROOM;
+    return room >= 4096 ? room & ~4095u : room;
 }
 
 void encode_create_session(XdrEncoder& enc,
                            uint64_t clientid,
-                           uint32_t sequenceid) {
+                           uint32_t sequenceid,
+                           const ChannelAttrs41& fore) {
     enc.put_uint32(OP_CREATE_SESSION);
 
     enc.put_uint64(clientid);
@@ -85,9 +104,13 @@ void encode_create_session(XdrEncoder& enc,
     enc.put_uint32(0);  // csa_flags
 
     // csa_fore_chan_attrs
-    encode_channel_attrs(enc, 65536, 65536, 1024);
+    encode_channel_attrs(enc, fore);
     // csa_back_chan_attrs (minimal)
-    encode_channel_attrs(enc, 4096, 4096, 256);
+    ChannelAttrs41 back;
+    back.maxrequestsize         = 4096;
+    back.maxresponsesize        = 4096;
+    back.maxresponsesize_cached = 256;
+    encode_channel_attrs(enc, back);
 
     enc.put_uint32(0);  // csa_cb_program
 
@@ -96,26 +119,21 @@ void encode_create_session(XdrEncoder& enc,
     enc.put_uint32(0);  // AUTH_NONE
 }
 
-SessionId41 decode_create_session_result(XdrDecoder& dec) {
+CreateSessionResult decode_create_session_result(XdrDecoder& dec) {
     uint32_t resop  = dec.get_uint32();
     uint32_t status = dec.get_uint32();
     (void)resop;
     if (status != 0) throw Nfs4Error(status, "CREATE_SESSION");
 
-    SessionId41 sid{};
-    auto raw = dec.get_fixed_opaque(16);
-    std::copy(raw.begin(), raw.end(), sid.begin());
-
-    // csr_sequence, csr_flags — skip
-    dec.get_uint32();
-    dec.get_uint32();
-
-    // csr_fore_chan_attrs: 7 uint32s
-    for (int i = 0; i < 7; ++i) dec.get_uint32();
-    // csr_back_chan_attrs: 7 uint32s
-    for (int i = 0; i < 7; ++i) dec.get_uint32();
+    CreateSessionResult r;
+    const XdrSegment raw = dec.get_fixed_opaque_view(16);
+    std::copy(raw.data, raw.data + raw.size, r.sessionid.begin());
 
-    return sid;
+    r.sequence = dec.get_uint32();
+    r.flags    = dec.get_uint32();
+    r.fore     = decode_channel_attrs(dec);
+    r.back     = decode_channel_attrs(dec);
+    return r;
 }
 
 // ── SEQUENCE ──────────────────────────────────────────────────────────────────
@@ -134,20 +152,27 @@ void encode_sequence41(XdrEncoder& enc,
     enc.put_uint32(cachethis ? 1 : 0);
 }
 
-void decode_sequence41_result(XdrDecoder& dec) {
+SequenceResult41 decode_sequence41_result(XdrDecoder& dec) {
     uint32_t resop  = dec.get_uint32();
     uint32_t status = dec.get_uint32();
     (void)resop;
     if (status != 0) throw Nfs4Error(status, "SEQUENCE");
 
-    // sr_sessionid(16) + sr_sequenceid(u32) + sr_slotid(u32) +
-    // sr_highest_slotid(u32) + sr_target_highest_slotid(u32) + sr_status_flags(u32)
-    dec.get_fixed_opaque(16);
-    dec.get_uint32();
-    dec.get_uint32();
-    dec.get_uint32();
-    dec.get_uint32();
-    dec.get_uint32();
+    return xdr_decode<SequenceResult41>(dec);
+}
+
+SequenceResult41 decode_sequence41_result(RecordReader& rr) {
+    uint32_t resop  = rr.get_uint32();
+    uint32_t status = rr.get_uint32();
+    (void)resop;
+    if (status != 0) throw Nfs4Error(status, "SEQUENCE");
+
+    // The whole fixed-size result in one read, then decoded in place.
+    uint8_t raw[xdr_wire_size<SequenceResult41>];
+    rr.read(raw, sizeof(raw));
+    SequenceResult41 r;
+    xdr_load(raw, r);
+    return r;
 }
 
 // ── RECLAIM_COMPLETE ──────────────────────────────────────────────────────────
@@ -178,4 +203,26 @@ void decode_destroy_session_result(XdrDecoder& dec) {
     if (status != 0) throw Nfs4Error(status, "DESTROY_SESSION");
 }
 
+// ── BIND_CONN_TO_SESSION ──────────────────────────────────────────────────────
+
+void encode_bind_conn_to_session(XdrEncoder& enc, const SessionId41& sessionid) {
+    enc.put_uint32(OP_BIND_CONN_TO_SESSION);
+    enc.put_fixed_opaque(sessionid.data(), 16);
+    enc.put_uint32(CDFC4_FORE);
+    enc.put_uint32(0);  // bctsa_use_conn_in_rdma_mode = false
+}
+
+void decode_bind_conn_to_session_result(XdrDecoder& dec) {
+    uint32_t resop  = dec.get_uint32();
+    uint32_t status = dec.get_uint32();
+    (void)resop;
+    if (status != 0) throw Nfs4Error(status, "BIND_CONN_TO_SESSION");
+
+    // bctsr_sessid(16) + bctsr_dir(u32) + bctsr_use_conn_in_rdma_mode(bool)
+    dec.skip(16);
+    if (dec.get_uint32() != CDFS4_FORE)
+        throw std::runtime_error("BIND_CONN_TO_SESSION: not bound to the fore channel");
+    dec.get_uint32();
+}
+
 }  // namespace nfs4
@@ -2,6 +2,7 @@
 
 #include "nfs4_error.hpp"
 #include "nfs4_types.hpp"
+#include "../rpc/record_reader.hpp"
 #include "../xdr/xdr.hpp"
 
 #include <array>
@@ -26,22 +27,53 @@ void encode_exchange_id(XdrEncoder& enc,
 // Decode EXCHANGE_ID per-op result.
 ExchangeIdResult decode_exchange_id_result(XdrDecoder& dec);
 
+// channel_attrs4 (RFC 8881 §18.36).  ca_rdma_ird is always sent empty.
+struct ChannelAttrs41 {
+    uint32_t headerpadsize{0};
+    uint32_t maxrequestsize{65536};
+    uint32_t maxresponsesize{65536};
+    uint32_t maxresponsesize_cached{1024};
+    uint32_t maxoperations{16};
+    uint32_t maxrequests{1};            // number of slots
+};
+
+// Bytes reserved in a channel's max request/response size for everything
+// around a READ/WRITE payload (RPC header and credentials, COMPOUND header,
+// SEQUENCE, PUTFH and the READ/WRITE op itself).
+constexpr uint32_t CHANNEL_IO_HEADROOM = 1024;
+
+// Largest READ/WRITE payload that fits a channel size (ca_maxresponsesize
+// for READ, ca_maxrequestsize for WRITE), rounded down to a 4 KiB multiple
+// when at least 4 KiB fits.  Never less than 1.
+uint32_t max_io_payload(uint32_t channel_size);
+
+// Result of CREATE_SESSION: the session ID and what the server granted.
+struct CreateSessionResult {
+    SessionId41    sessionid{};
+    uint32_t       sequence{};
+    uint32_t       flags{};
+    ChannelAttrs41 fore;
+    ChannelAttrs41 back;
+};
+
 // Encode CREATE_SESSION op into `enc` (RFC 8881 §18.36).
 //   clientid   — from EXCHANGE_ID response
 //   sequenceid — eir_sequenceid from EXCHANGE_ID response
+//   fore       — requested fore channel limits (maxrequests = slots wanted)
 void encode_create_session(XdrEncoder& enc,
                            uint64_t clientid,
-                           uint32_t sequenceid);
+                           uint32_t sequenceid,
+                           const ChannelAttrs41& fore = {});
 
-// Decode CREATE_SESSION per-op result; returns the 16-byte session ID.
-SessionId41 decode_create_session_result(XdrDecoder& dec);
+// Decode CREATE_SESSION per-op result.
+CreateSessionResult decode_create_session_result(XdrDecoder& dec);
 
 // Encode SEQUENCE op into `enc` (RFC 8881 §18.46).
 // Must be the first op in every NFSv4.1 COMPOUND after session setup.
 //   sessionid     — from CREATE_SESSION
 //   sequenceid    — monotonically increasing per-slot counter (starts at 1)
-//   slotid        — always 0 for single-slot sessions
-//   highest_slotid— always 0 for single-slot sessions
+//   slotid        — slot this request occupies (see SlotTable41)
+//   highest_slotid— highest slot ID the client has a request outstanding on
 //   cachethis     — false (no reply caching)
 void encode_sequence41(XdrEncoder& enc,
                        const SessionId41& sessionid,
@@ -50,8 +82,30 @@ void encode_sequence41(XdrEncoder& enc,
                        uint32_t highest_slotid = 0,
                        bool cachethis = false);
 
-// Decode SEQUENCE per-op result (skips all fields for single-slot use).
-void decode_sequence41_result(XdrDecoder& dec);
+// SEQUENCE4resok.  The slot fields drive SlotTable41 resizing.
+struct SequenceResult41 {
+    SessionId41 sessionid{};
+    uint32_t    sequenceid{};
+    uint32_t    slotid{};
+    uint32_t    highest_slotid{};          // highest slot the server will accept now
+    uint32_t    target_highest_slotid{};   // where the server wants the client to be
+    uint32_t    status_flags{};
+};
+
+}  // namespace nfs4
+
+template <> struct XdrSchema<nfs4::SequenceResult41> {
+    using S = nfs4::SequenceResult41;
+    using fields = XdrFields<&S::sessionid, &S::sequenceid, &S::slotid,
+                             &S::highest_slotid, &S::target_highest_slotid,
+                             &S::status_flags>;
+};
+
+namespace nfs4 {
+
+// Decode SEQUENCE per-op result.
+SequenceResult41 decode_sequence41_result(XdrDecoder& dec);
+SequenceResult41 decode_sequence41_result(RecordReader& rr);
 
 // Encode RECLAIM_COMPLETE op into `enc` (RFC 8881 §18.51).
 //   one_fs — false = global reclaim complete (use after session establishment)
@@ -66,4 +120,23 @@ void encode_destroy_session(XdrEncoder& enc, const SessionId41& sessionid);
 // Decode DESTROY_SESSION per-op result (just checks status).
 void decode_destroy_session_result(XdrDecoder& dec);
 
+// channel_dir_from_client4 (RFC 8881 §18.34)
+constexpr uint32_t CDFC4_FORE         = 0x1;
+constexpr uint32_t CDFC4_BACK         = 0x2;
+constexpr uint32_t CDFC4_FORE_OR_BOTH = 0x3;
+
+// channel_dir_from_server4 (RFC 8881 §18.34)
+constexpr uint32_t CDFS4_FORE         = 0x1;
+constexpr uint32_t CDFS4_BACK         = 0x2;
+constexpr uint32_t CDFS4_BOTH         = 0x3;
+
+// Encode BIND_CONN_TO_SESSION op into `enc` (RFC 8881 §18.34).  Must be the
+// only op in its COMPOUND; associates the sending connection with the fore
+// channel of `sessionid` only, as the client runs no callback service.
+void encode_bind_conn_to_session(XdrEncoder& enc, const SessionId41& sessionid);
+
+// Decode BIND_CONN_TO_SESSION per-op result: checks status, and throws if the
+// server bound the connection to anything but the fore channel.
+void decode_bind_conn_to_session_result(XdrDecoder& dec);
+
 }  // namespace nfs4
@@ -30,8 +30,8 @@ SetclientidResult decode_setclientid_result(XdrDecoder& dec) {
 
     SetclientidResult r;
     r.clientid = dec.get_uint64();
-    auto cv    = dec.get_fixed_opaque(8);
-    std::copy(cv.begin(), cv.end(), r.confirm_verifier.begin());
+    const XdrSegment cv = dec.get_fixed_opaque_view(8);
+    std::copy(cv.data, cv.data + cv.size, r.confirm_verifier.begin());
     return r;
 }
 
@@ -0,0 +1,127 @@
+#include "slot_table41.hpp"
+
+#include <algorithm>
+
+namespace nfs4 {
+
+SlotTable41::SlotTable41(uint32_t nslots) {
+    nslots  = std::min(std::max<uint32_t>(nslots, 1), MAX_SLOTS);
+    seqids_.assign(nslots, 1);
+    busy_.assign(nslots, false);
+    unknown_.assign(nslots, false);
+    limit_  = nslots;
+    kept_   = nslots;
+}
+
+SlotTable41::Slot SlotTable41::acquire() {
+    std::future<uint32_t> handoff;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        uint32_t slotid = 0;
+        if (waiters_.empty() && take_locked(slotid))
+            return make_slot_locked(slotid);
+        waiters_.emplace_back();
+        handoff = waiters_.back().get_future();
+    }
+    // A releasing thread marks the slot busy on our behalf before handing it over.
+    const uint32_t slotid = handoff.get();
+    std::lock_guard<std::mutex> lk(mutex_);
+    return make_slot_locked(slotid);
+}
+
+void SlotTable41::complete(const Slot& slot, const SequenceResult41& res) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    ++seqids_[slot.slotid];
+
+    // Use no more slots than the server's target; it keeps the state of
+    // those up to sr_highest_slotid, and only slots above that are dropped
+    // and start over at sequence ID 1 when reused (RFC 8881 §2.10.6.1).
+    const uint32_t kept   = std::min(res.highest_slotid, MAX_SLOTS - 1) + 1;
+    const uint32_t wanted = std::min(res.target_highest_slotid, kept - 1) + 1;
+    if (wanted > seqids_.size()) {
+        seqids_.resize(wanted, 1);
+        busy_.resize(wanted, false);
+        unknown_.resize(wanted, false);
+    }
+    for (uint32_t i = kept; i < kept_ && i < seqids_.size(); ++i) {
+        seqids_[i]  = 1;
+        unknown_[i] = false;
+    }
+    kept_ = kept;
+    const uint32_t old_limit = limit_;
+    limit_ = std::max<uint32_t>(wanted, 1);
+
+    free_locked(slot.slotid);
+
+    // Newly usable slots can satisfy waiters right away.
+    for (uint32_t i = old_limit; i < limit_ && !waiters_.empty(); ++i)
+        if (!busy_[i]) {
+            busy_[i] = true;
+            free_locked(i);
+        }
+}
+
+void SlotTable41::release(const Slot& slot) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    free_locked(slot.slotid);
+}
+
+void SlotTable41::lost(const Slot& slot) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    unknown_[slot.slotid] = true;
+    free_locked(slot.slotid);
+}
+
+SlotTable41::Slot SlotTable41::resync(const Slot& slot, uint32_t next_seqid) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    seqids_[slot.slotid]  = next_seqid;
+    unknown_[slot.slotid] = false;
+    return make_slot_locked(slot.slotid);
+}
+
+uint32_t SlotTable41::capacity() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return static_cast<uint32_t>(seqids_.size());
+}
+
+uint32_t SlotTable41::usable() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return limit_;
+}
+
+void SlotTable41::free_locked(uint32_t slotid) {
+    if (slotid < limit_ && !waiters_.empty()) {
+        // Hand over directly: the slot stays busy, now owned by the waiter.
+        waiters_.front().set_value(slotid);
+        waiters_.pop_front();
+        return;
+    }
+    busy_[slotid] = false;
+    // A slot beyond the limit is parked.  It keeps its sequence ID while
+    // the server keeps its state; above sr_highest_slotid the server has
+    // dropped it, and this slot was still busy when the others were reset.
+    if (slotid >= kept_) {
+        seqids_[slotid]  = 1;
+        unknown_[slotid] = false;
+    }
+}
+
+bool SlotTable41::take_locked(uint32_t& slotid) {
+    for (uint32_t i = 0; i < limit_; ++i) {
+        if (!busy_[i]) {
+            busy_[i] = true;
+            slotid   = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+SlotTable41::Slot SlotTable41::make_slot_locked(uint32_t slotid) const {
+    uint32_t highest = slotid;
+    for (uint32_t i = static_cast<uint32_t>(busy_.size()); i-- > slotid + 1;)
+        if (busy_[i]) { highest = i; break; }
+    return Slot{slotid, seqids_[slotid], highest, unknown_[slotid]};
+}
+
+}  // namespace nfs4
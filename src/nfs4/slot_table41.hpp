@@ -0,0 +1,85 @@
+#pragma once
+
+#include "session41.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace nfs4 {
+
+// NFSv4.1 fore-channel slot table (RFC 8881 §2.10.6).
+//
+// Each COMPOUND occupies one slot from acquire() until its SEQUENCE result
+// arrives; each slot carries its own sequence ID.  The number of usable slots
+// follows the server's sr_target_highest_slotid from every SEQUENCE reply, up
+// to MAX_SLOTS.  Sequence IDs are kept up to sr_highest_slotid, the slots the
+// server still holds state for, so that a target raised again reuses them.
+//
+// A COMPOUND that got no reply may or may not have run on the server, so its
+// slot's sequence ID is unknown: lost() parks it until a bare SEQUENCE finds
+// out which (resync()), rather than risk a false retry on its next use.
+//
+// Thread-safe.  When every usable slot is busy, acquire() blocks; released
+// slots are handed to waiters in FIFO order.
+class SlotTable41 {
+public:
+    // A slot lent out for one COMPOUND.
+    struct Slot {
+        uint32_t slotid;
+        uint32_t seqid;            // sa_sequenceid to send
+        uint32_t highest_slotid;   // sa_highest_slotid to send
+        bool     resync;           // seqid unknown: call resync() before use
+    };
+
+    static constexpr uint32_t MAX_SLOTS = 1024;
+
+    // `nslots` = ca_maxrequests granted by CREATE_SESSION (at least 1).
+    explicit SlotTable41(uint32_t nslots);
+
+    SlotTable41(const SlotTable41&) = delete;
+    SlotTable41& operator=(const SlotTable41&) = delete;
+
+    Slot acquire();
+
+    // The SEQUENCE on `slot` succeeded: advance its sequence ID, adopt the
+    // server's slot limits, and free the slot.
+    void complete(const Slot& slot, const SequenceResult41& res);
+
+    // The server answered without running SEQUENCE on `slot`, or SEQUENCE
+    // failed: free it without advancing its sequence ID.
+    void release(const Slot& slot);
+
+    // No reply for `slot`: the server may or may not have run the COMPOUND.
+    // Free it; whoever takes it next gets Slot::resync set.
+    void lost(const Slot& slot);
+
+    // The server's sequence ID for `slot` (still held) is now known: the
+    // next one to send is `next_seqid`.  Returns the slot to use.
+    Slot resync(const Slot& slot, uint32_t next_seqid);
+
+    // Slots currently usable (highest usable slot ID + 1).
+    uint32_t usable() const;
+
+    // Slots the table currently holds state for (>= usable()).
+    uint32_t capacity() const;
+
+private:
+    // Give `slotid` to the oldest waiter or mark it free.  Caller holds mutex_.
+    void free_locked(uint32_t slotid);
+    // Take the lowest free usable slot, or return false.  Caller holds mutex_.
+    bool take_locked(uint32_t& slotid);
+    Slot make_slot_locked(uint32_t slotid) const;
+
+    mutable std::mutex                    mutex_;
+    std::vector<uint32_t>                 seqids_;   // next sequence ID per slot
+    std::vector<bool>                     busy_;
+    std::vector<bool>                     unknown_;  // lost(), not yet resync()ed
+    uint32_t                              limit_;    // usable slots
+    uint32_t                              kept_;     // slots the server keeps state for
+    std::deque<std::promise<uint32_t>>    waiters_;
+};
+
+}  // namespace nfs4
@@ -10,7 +10,7 @@ void encode_write(XdrEncoder& enc, const Stateid4& stateid,
     encode_stateid4(enc, stateid);
     enc.put_uint64(offset);
     enc.put_uint32(static_cast<uint32_t>(stable));
-    enc.put_opaque(data, len);
+    enc.put_opaque_ref(data, len);  // sent from the caller's buffer, not copied
 }
 
 Nfs4WriteResult decode_write_result(XdrDecoder& dec) {
@@ -22,8 +22,21 @@ Nfs4WriteResult decode_write_result(XdrDecoder& dec) {
     Nfs4WriteResult r;
     r.count     = dec.get_uint32();
     r.committed = static_cast<Stable4>(dec.get_uint32());
-    auto v      = dec.get_fixed_opaque(8);
-    std::copy(v.begin(), v.end(), r.verf.begin());
+    const XdrSegment v = dec.get_fixed_opaque_view(8);
+    std::copy(v.data, v.data + v.size, r.verf.begin());
+    return r;
+}
+
+Nfs4WriteResult decode_write_result(RecordReader& rr) {
+    uint32_t resop  = rr.get_uint32();
+    uint32_t status = rr.get_uint32();
+    (void)resop;
+    if (status != 0) throw Nfs4Error(status, "WRITE");
+
+    Nfs4WriteResult r;
+    r.count     = rr.get_uint32();
+    r.committed = static_cast<Stable4>(rr.get_uint32());
+    rr.read(r.verf.data(), r.verf.size());
     return r;
 }
 
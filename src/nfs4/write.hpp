@@ -2,16 +2,20 @@
 
 #include "nfs4_types.hpp"
 #include "nfs4_error.hpp"
+#include "../rpc/record_reader.hpp"
 #include "../xdr/xdr.hpp"
 
 #include <cstdint>
 
 namespace nfs4 {
 
+// The data is referenced by `enc`, not copied: it must stay valid until the
+// COMPOUND has been sent.
 void encode_write(XdrEncoder& enc, const Stateid4& stateid,
                   uint64_t offset, Stable4 stable,
                   const uint8_t* data, uint32_t len);
 
 Nfs4WriteResult decode_write_result(XdrDecoder& dec);
+Nfs4WriteResult decode_write_result(RecordReader& rr);
 
 }  // namespace nfs4
@@ -15,13 +15,17 @@
 #include "nfs4/readdir.hpp"
 #include "nfs4/readlink.hpp"
 #include "nfs/portmap.hpp"
+#include "path.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
-#include <unistd.h>
+#include <stdexcept>
+#include <thread>
 
 static constexpr uint32_t NFS4_PROG = 100003;
 static constexpr uint32_t NFS4_VERS = 4;
+static const char* const OPEN_OWNER = "nfsclient-v41";
 
 // ── encode_fh helper (same logic as v4.0) ────────────────────────────────────
 
@@ -32,28 +36,197 @@ static void encode_fh(XdrEncoder& ops, const Nfs4Fh& fh) {
         nfs4::encode_putfh(ops, fh);
 }
 
+// The attributes getattr() and resolve_path() ask for.
+static void encode_getattr_all(XdrEncoder& ops) {
+    nfs4::encode_getattr(ops, {
+        nfs4::attr::TYPE, nfs4::attr::CHANGE, nfs4::attr::SIZE,
+        nfs4::attr::FILEID, nfs4::attr::MODE, nfs4::attr::NUMLINKS,
+        nfs4::attr::OWNER, nfs4::attr::OWNER_GROUP,
+        nfs4::attr::TIME_ACCESS, nfs4::attr::TIME_METADATA, nfs4::attr::TIME_MODIFY
+    });
+}
+
 // ── Nfs41Client::compound41 ───────────────────────────────────────────────────
 
+nfs4::SlotTable41::Slot Nfs41Client::acquire_slot(TcpRpcClient& conn) {
+    const auto slot = slots_->acquire();
+    if (!slot.resync) return slot;
+
+    // Whether the server ran the COMPOUND that got no reply is unknown.  A
+    // bare SEQUENCE one past its seqid tells: accepted if it did, misordered
+    // if it did not (RFC 8881 §2.10.6.1).  Sent on the connection the slot
+    // is about to be used on, so one dead connection cannot starve it.
+    const uint32_t probe = slot.seqid + 1;
+    XdrEncoder ops;
+    nfs4::encode_sequence41(ops, sessionid_, probe, slot.slotid, slot.highest_slotid);
+    try {
+        auto reply = nfs4::call_compound(conn, "resync", ops, 1, /*minorversion=*/1);
+        XdrDecoder dec(reply);
+        const uint32_t status = dec.get_uint32();
+        dec.skip_opaque();                 // tag
+        if (dec.get_uint32() == 0) throw Nfs4Error(status, "SEQUENCE");
+        try {
+            nfs4::decode_sequence41_result(dec);
+            return slots_->resync(slot, probe + 1);
+        } catch (const Nfs4Error& e) {
+            if (e.status == static_cast<uint32_t>(Nfsstat4::NFS4ERR_SEQ_MISORDERED))
+                return slots_->resync(slot, slot.seqid);
+            // An earlier probe ran but its reply was lost as well.
+            if (e.status == static_cast<uint32_t>(Nfsstat4::NFS4ERR_RETRY_UNCACHED_REP))
+                return slots_->resync(slot, probe + 1);
+            throw;
+        }
+    } catch (...) {
+        slots_->lost(slot);
+        throw;
+    }
+}
+
 std::vector<uint8_t> Nfs41Client::compound41(const std::string& tag,
-                                               const std::vector<uint8_t>& ops_bytes,
+                                               const XdrEncoder& ops,
                                                uint32_t num_ops) {
-    XdrEncoder seq;
-    nfs4::encode_sequence41(seq, sessionid_, slot_seqid_++);
-    auto seq_bytes = seq.release();
+    TcpRpcClient& conn = rpc();
+    const auto slot = acquire_slot(conn);
+    XdrEncoder all_ops;
+    nfs4::encode_sequence41(all_ops, sessionid_, slot.seqid, slot.slotid,
+                            slot.highest_slotid);
+    all_ops.append_ref(ops);
+
+    std::vector<uint8_t> reply;
+    try {
+        reply = nfs4::call_compound(conn, tag, all_ops, num_ops + 1, /*minorversion=*/1);
+    } catch (...) {
+        slots_->lost(slot);
+        throw;
+    }
+
+    // Settle the slot from the SEQUENCE result; callers decode the reply
+    // again from the top and see any error themselves.
+    try {
+        XdrDecoder dec(reply);
+        dec.get_uint32();                  // status
+        dec.skip_opaque();                 // tag
+        if (dec.get_uint32() == 0) {       // no results: SEQUENCE never ran
+            slots_->release(slot);
+        } else {
+            slots_->complete(slot, nfs4::decode_sequence41_result(dec));
+        }
+    } catch (const Nfs4Error&) {
+        slots_->release(slot);             // SEQUENCE failed: the slot did not move
+    } catch (const std::exception&) {
+        slots_->lost(slot);
+    }
+    return reply;
+}
 
-    std::vector<uint8_t> all_ops;
-    all_ops.reserve(seq_bytes.size() + ops_bytes.size());
-    all_ops.insert(all_ops.end(), seq_bytes.begin(), seq_bytes.end());
-    all_ops.insert(all_ops.end(), ops_bytes.begin(), ops_bytes.end());
+void Nfs41Client::compound41_into(const std::string& tag,
+                                  const XdrEncoder& ops,
+                                  uint32_t num_ops,
+                                  const TcpRpcClient::ReplySink& sink) {
+    TcpRpcClient& conn = rpc();
+    const auto slot = acquire_slot(conn);
+    XdrEncoder all_ops;
+    nfs4::encode_sequence41(all_ops, sessionid_, slot.seqid, slot.slotid,
+                            slot.highest_slotid);
+    all_ops.append_ref(ops);
+
+    bool settled = false;
+    try {
+        nfs4::call_compound_into(conn, tag, all_ops, num_ops + 1, /*minorversion=*/1,
+                                 [&](RecordReader& rr) {
+            const uint32_t status = rr.get_uint32();
+            rr.skip_opaque();                       // echoed tag
+            if (rr.get_uint32() > 0) {              // numres
+                nfs4::SequenceResult41 seq;
+                try {
+                    seq = nfs4::decode_sequence41_result(rr);
+                } catch (const Nfs4Error&) {
+                    slots_->release(slot);
+                    settled = true;
+                    throw;
+                }
+                slots_->complete(slot, seq);
+            } else {
+                slots_->release(slot);
+            }
+            settled = true;
+            if (status != 0) throw Nfs4Error(status, "COMPOUND");
+            sink(rr);
+        });
+    } catch (...) {
+        // No SEQUENCE result: the server may still have run the COMPOUND.
+        if (!settled) slots_->lost(slot);
+        throw;
+    }
+}
 
-    return nfs4::call_compound(*rpc_, tag, all_ops, num_ops + 1, /*minorversion=*/1);
+std::future<void> Nfs41Client::compound41_async_into(const std::string& tag,
+                                                    const XdrEncoder& ops,
+                                                    uint32_t num_ops,
+                                                    TcpRpcClient::ReplySink sink) {
+    TcpRpcClient& conn = rpc();
+    const auto slot = acquire_slot(conn);
+    XdrEncoder all_ops;
+    nfs4::encode_sequence41(all_ops, sessionid_, slot.seqid, slot.slotid,
+                            slot.highest_slotid);
+    all_ops.append_ref(ops);
+
+    // Whoever gets here first settles the slot: normally the sink, as soon as
+    // the SEQUENCE result is in; the collecting caller only if no SEQUENCE
+    // result came, in which case the server may still have run the COMPOUND.
+    nfs4::SlotTable41* slots = slots_.get();
+    auto settled = std::make_shared<std::atomic<bool>>(false);
+    auto release = [slots, slot, settled] {
+        if (!settled->exchange(true)) slots->release(slot);
+    };
+    auto lost = [slots, slot, settled] {
+        if (!settled->exchange(true)) slots->lost(slot);
+    };
+
+    std::future<void> sent;
+    try {
+        sent = nfs4::call_compound_async_into(conn, tag, all_ops, num_ops + 1,
+                                              /*minorversion=*/1,
+                                              [slots, slot, settled, release,
+                                               sink = std::move(sink)](RecordReader& rr) {
+            const uint32_t status = rr.get_uint32();
+            rr.skip_opaque();                       // echoed tag
+            if (rr.get_uint32() > 0) {              // numres
+                nfs4::SequenceResult41 seq;
+                try {
+                    seq = nfs4::decode_sequence41_result(rr);
+                } catch (const Nfs4Error&) {
+                    release();
+                    throw;
+                }
+                if (!settled->exchange(true)) slots->complete(slot, seq);
+            } else {
+                release();
+            }
+            if (status != 0) throw Nfs4Error(status, "COMPOUND");
+            sink(rr);
+        });
+    } catch (...) {
+        lost();
+        throw;
+    }
+    return std::async(std::launch::deferred,
+                      [sent = std::move(sent), lost]() mutable {
+        try {
+            sent.get();
+        } catch (...) {
+            lost();
+            throw;
+        }
+    });
 }
 
 // ── Constructors ──────────────────────────────────────────────────────────────
 
-static void do_bootstrap(TcpRpcClient& rpc,
-                          uint64_t& clientid_out,
-                          SessionId41& sessionid_out) {
+static nfs4::CreateSessionResult do_bootstrap(TcpRpcClient& rpc,
+                                               uint32_t session_slots,
+                                               uint32_t max_io_size,
+                                               uint64_t& clientid_out) {
     auto now = std::chrono::steady_clock::now().time_since_epoch().count();
     std::array<uint8_t, 8> verifier{};
     for (int i = 7; i >= 0; --i) {
@@ -64,33 +237,40 @@ static void do_bootstrap(TcpRpcClient& rpc,
     // EXCHANGE_ID — no SEQUENCE prefix, outside any session
     XdrEncoder ops1;
     nfs4::encode_exchange_id(ops1, verifier, "nfsclient-v41");
-    auto reply1 = nfs4::call_compound(rpc, "init", ops1.release(), 1, /*minorversion=*/1);
+    auto reply1 = nfs4::call_compound(rpc, "init", ops1, 1, /*minorversion=*/1);
     XdrDecoder dec1(reply1);
     nfs4::check_compound_status(dec1);
     auto exid = nfs4::decode_exchange_id_result(dec1);
 
     // CREATE_SESSION — no SEQUENCE prefix, outside any session
     XdrEncoder ops2;
-    nfs4::encode_create_session(ops2, exid.clientid, exid.sequenceid);
-    auto reply2 = nfs4::call_compound(rpc, "init", ops2.release(), 1, /*minorversion=*/1);
+    nfs4::ChannelAttrs41 fore;
+    fore.maxrequests     = session_slots;
+    fore.maxrequestsize  = max_io_size + nfs4::CHANNEL_IO_HEADROOM;
+    fore.maxresponsesize = max_io_size + nfs4::CHANNEL_IO_HEADROOM;
+    fore.maxoperations   = 64;   // room for deep paths in one resolve_path() COMPOUND
+    nfs4::encode_create_session(ops2, exid.clientid, exid.sequenceid, fore);
+    auto reply2 = nfs4::call_compound(rpc, "init", ops2, 1, /*minorversion=*/1);
     XdrDecoder dec2(reply2);
     nfs4::check_compound_status(dec2);
-    auto sid = nfs4::decode_create_session_result(dec2);
+    auto cs = nfs4::decode_create_session_result(dec2);
 
-    clientid_out  = exid.clientid;
-    sessionid_out = sid;
+    clientid_out = exid.clientid;
+    return cs;
 }
 
-Nfs41Client::Nfs41Client(const std::string& host) : host_(host) {
-    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS);
-    rpc_ = std::make_unique<TcpRpcClient>(host_, port);
-    do_bootstrap(*rpc_, clientid_, sessionid_);
-    slot_seqid_ = 1;
+Nfs41Client::Nfs41Client(const std::string& host, const ClientOptions& opts)
+    : host_(host) {
+    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS,
+                                                opts.portmap_port);
+    pool_ = std::make_unique<RpcConnectionPool>(host_, port, opts.nconnect,
+                                                opts.conn_policy);
+    start_session(opts);
 
     // RECLAIM_COMPLETE — first COMPOUND inside the session (with SEQUENCE)
     XdrEncoder ops_rc;
     nfs4::encode_reclaim_complete(ops_rc);
-    auto reply_rc = compound41("init", ops_rc.release(), 1);
+    auto reply_rc = compound41("init", ops_rc, 1);
     XdrDecoder dec_rc(reply_rc);
     nfs4::check_compound_status(dec_rc);
     nfs4::decode_sequence41_result(dec_rc);
@@ -100,7 +280,7 @@ Nfs41Client::Nfs41Client(const std::string& host) : host_(host) {
     XdrEncoder ops_root;
     nfs4::encode_putrootfh(ops_root);
     nfs4::encode_getfh(ops_root);
-    auto reply_root = compound41("", ops_root.release(), 2);
+    auto reply_root = compound41("", ops_root, 2);
     XdrDecoder dec_root(reply_root);
     nfs4::check_compound_status(dec_root);
     nfs4::decode_sequence41_result(dec_root);
@@ -109,16 +289,19 @@ Nfs41Client::Nfs41Client(const std::string& host) : host_(host) {
     root_fh_ = Nfs4Fh{};
 }
 
-Nfs41Client::Nfs41Client(const std::string& host, const AuthSys& auth) : host_(host) {
-    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS);
-    rpc_ = std::make_unique<TcpRpcClient>(host_, port);
-    rpc_->set_auth_sys(auth);
-    do_bootstrap(*rpc_, clientid_, sessionid_);
-    slot_seqid_ = 1;
+Nfs41Client::Nfs41Client(const std::string& host, const AuthSys& auth,
+                         const ClientOptions& opts)
+    : host_(host) {
+    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS,
+                                                opts.portmap_port);
+    pool_ = std::make_unique<RpcConnectionPool>(host_, port, opts.nconnect,
+                                                opts.conn_policy);
+    pool_->set_auth_sys(auth);
+    start_session(opts);
 
     XdrEncoder ops_rc;
     nfs4::encode_reclaim_complete(ops_rc);
-    auto reply_rc = compound41("init", ops_rc.release(), 1);
+    auto reply_rc = compound41("init", ops_rc, 1);
     XdrDecoder dec_rc(reply_rc);
     nfs4::check_compound_status(dec_rc);
     nfs4::decode_sequence41_result(dec_rc);
@@ -127,7 +310,7 @@ Nfs41Client::Nfs41Client(const std::string& host, const AuthSys& auth) : host_(h
     XdrEncoder ops_root;
     nfs4::encode_putrootfh(ops_root);
     nfs4::encode_getfh(ops_root);
-    auto reply_root = compound41("", ops_root.release(), 2);
+    auto reply_root = compound41("", ops_root, 2);
     XdrDecoder dec_root(reply_root);
     nfs4::check_compound_status(dec_root);
     nfs4::decode_sequence41_result(dec_root);
@@ -136,17 +319,47 @@ Nfs41Client::Nfs41Client(const std::string& host, const AuthSys& auth) : host_(h
     root_fh_ = Nfs4Fh{};
 }
 
+void Nfs41Client::start_session(const ClientOptions& opts) {
+    auto cs    = do_bootstrap(pool_->primary(), opts.session_slots, opts.max_io_size,
+                              clientid_);
+    sessionid_ = cs.sessionid;
+    fore_      = cs.fore;
+    slots_     = std::make_unique<nfs4::SlotTable41>(cs.fore.maxrequests);
+
+    // Transfers are capped by both the caller's wish and the server's grant.
+    grace_delay_ = opts.grace_delay;
+    max_read_  = std::min(opts.max_io_size, nfs4::max_io_payload(fore_.maxresponsesize));
+    max_write_ = std::min(opts.max_io_size, nfs4::max_io_payload(fore_.maxrequestsize));
+
+    // resolve_path() spends SEQUENCE, PUTFH, GETFH and GETATTR besides its LOOKUPs.
+    max_path_lookups_ = fore_.maxoperations > 4 ? fore_.maxoperations - 4 : 1;
+    bind_extra_connections();
+}
+
+void Nfs41Client::bind_extra_connections() {
+    // The session was created over the primary connection; every other
+    // connection must be associated with it before it can carry SEQUENCE.
+    for (size_t i = 1; i < pool_->size(); ++i) {
+        XdrEncoder ops;
+        nfs4::encode_bind_conn_to_session(ops, sessionid_);
+        auto reply = nfs4::call_compound(pool_->at(i), "init", ops, 1, /*minorversion=*/1);
+        XdrDecoder dec(reply);
+        nfs4::check_compound_status(dec);
+        nfs4::decode_bind_conn_to_session_result(dec);
+    }
+}
+
 Nfs41Client::~Nfs41Client() {
     // Best-effort DESTROY_SESSION on shutdown
     try {
         XdrEncoder ops;
         nfs4::encode_destroy_session(ops, sessionid_);
-        nfs4::call_compound(*rpc_, "destroy", ops.release(), 1, /*minorversion=*/1);
+        nfs4::call_compound(pool_->primary(), "destroy", ops, 1, /*minorversion=*/1);
     } catch (...) {}
 }
 
-void Nfs41Client::set_auth_sys(const AuthSys& auth) { rpc_->set_auth_sys(auth); }
-void Nfs41Client::clear_auth()                       { rpc_->clear_auth(); }
+void Nfs41Client::set_auth_sys(const AuthSys& auth) { pool_->set_auth_sys(auth); }
+void Nfs41Client::clear_auth()                       { pool_->clear_auth(); }
 
 // ── File handle operations ────────────────────────────────────────────────────
 
@@ -155,7 +368,7 @@ Nfs4Fh Nfs41Client::lookup(const Nfs4Fh& dir, const std::string& name) {
     encode_fh(ops, dir);
     nfs4::encode_lookup(ops, name);
     nfs4::encode_getfh(ops);
-    auto reply = compound41("", ops.release(), 3);
+    auto reply = compound41("", ops, 3);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -164,16 +377,51 @@ Nfs4Fh Nfs41Client::lookup(const Nfs4Fh& dir, const std::string& name) {
     return nfs4::decode_getfh_result(dec);
 }
 
+Nfs4PathInfo Nfs41Client::resolve_path(const Nfs4Fh& dir, const std::string& path) {
+    const std::vector<std::string> names = split_path(path);
+    Nfs4PathInfo at{dir, {}};
+    size_t next = 0;
+    for (;;) {
+        const size_t count = std::min<size_t>(names.size() - next, max_path_lookups_);
+        const bool   last  = next + count == names.size();
+        try {
+            resolve_step(at, names, next, count, last);
+        } catch (const Nfs4Error& e) {
+            // The grant should have prevented this, but a server may count
+            // differently: retry with half as many lookups.
+            if (count < 2 || !(e.is(Nfsstat4::NFS4ERR_TOO_MANY_OPS) ||
+                               e.is(Nfsstat4::NFS4ERR_RESOURCE)))
+                throw;
+            max_path_lookups_ = static_cast<uint32_t>(count / 2);
+            continue;
+        }
+        if (last) return at;
+        next += count;
+    }
+}
+
+void Nfs41Client::resolve_step(Nfs4PathInfo& at, const std::vector<std::string>& names,
+                               size_t first, size_t count, bool last) {
+    XdrEncoder ops;
+    encode_fh(ops, at.fh);
+    nfs4::encode_lookup_path(ops, names, first, count);
+    if (count > 0) nfs4::encode_getfh(ops);
+    if (last)      encode_getattr_all(ops);
+    auto reply = compound41("", ops, static_cast<uint32_t>(1 + count + (count > 0) + last));
+    XdrDecoder dec(reply);
+    nfs4::check_compound_status(dec);
+    nfs4::decode_sequence41_result(dec);
+    nfs4::decode_putfh_result(dec);
+    nfs4::decode_lookup_path_result(dec, count);
+    if (count > 0) at.fh    = nfs4::decode_getfh_result(dec);
+    if (last)      at.attrs = nfs4::decode_getattr_result(dec);
+}
+
 Fattr4 Nfs41Client::getattr(const Nfs4Fh& fh) {
     XdrEncoder ops;
     encode_fh(ops, fh);
-    nfs4::encode_getattr(ops, {
-        nfs4::attr::TYPE, nfs4::attr::CHANGE, nfs4::attr::SIZE,
-        nfs4::attr::FILEID, nfs4::attr::MODE, nfs4::attr::NUMLINKS,
-        nfs4::attr::OWNER, nfs4::attr::OWNER_GROUP,
-        nfs4::attr::TIME_ACCESS, nfs4::attr::TIME_METADATA, nfs4::attr::TIME_MODIFY
-    });
-    auto reply = compound41("", ops.release(), 2);
+    encode_getattr_all(ops);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -185,7 +433,7 @@ uint32_t Nfs41Client::access(const Nfs4Fh& fh, uint32_t mask) {
     XdrEncoder ops;
     encode_fh(ops, fh);
     nfs4::encode_access(ops, mask);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -207,19 +455,19 @@ Nfs4File Nfs41Client::do_open(const Nfs4Fh& dir, const std::string& name,
         encode_fh(ops, dir);
         if (create) {
             nfs4::encode_open_create(ops, seqid, share_access,
-                                     clientid_, "nfsclient-v41", name);
+                                     clientid_, OPEN_OWNER, name);
         } else {
             nfs4::encode_open_nocreate(ops, seqid, share_access,
-                                       clientid_, "nfsclient-v41", name);
+                                       clientid_, OPEN_OWNER, name);
         }
         nfs4::encode_getfh(ops);
-        reply = compound41("", ops.release(), 3);
+        reply = compound41("", ops, 3);
         XdrDecoder dec(reply);
         try {
             nfs4::check_compound_status(dec);
         } catch (const Nfs4Error& e) {
             if (e.status == NFS4ERR_GRACE) {
-                ::sleep(5);
+                std::this_thread::sleep_for(grace_delay_);
                 continue;
             }
             throw;
@@ -257,7 +505,7 @@ void Nfs41Client::close(const Nfs4File& f) {
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_close(ops, f.seqid, f.stateid);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -269,28 +517,193 @@ void Nfs41Client::close(const Nfs4File& f) {
 
 std::vector<uint8_t> Nfs41Client::read(const Nfs4File& f,
                                         uint64_t offset, uint32_t count) {
+    // Split to the negotiated size.  A chunk may come back short before EOF;
+    // only the eof flag ends the read early.
+    std::vector<uint8_t> out;
+    while (out.size() < count) {
+        const uint32_t want = std::min(max_read_, count - static_cast<uint32_t>(out.size()));
+        Nfs4ReadResult chunk = read_once(f, offset + out.size(), want);
+        if (out.empty() && (chunk.eof || chunk.data.size() == count)) return std::move(chunk.data);
+        out.insert(out.end(), chunk.data.begin(), chunk.data.end());
+        if (chunk.eof || chunk.data.empty()) break;
+    }
+    return out;
+}
+
+Nfs4ReadResult Nfs41Client::read_once(const Nfs4File& f,
+                                       uint64_t offset, uint32_t count) {
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_read(ops, f.stateid, offset, count);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
     nfs4::decode_putfh_result(dec);
-    return nfs4::decode_read_result(dec);
+    Nfs4ReadResult r;
+    r.data = nfs4::decode_read_result(dec, &r.eof);
+    return r;
+}
+
+uint32_t Nfs41Client::read_into(const Nfs4File& f, uint64_t offset,
+                                uint8_t* buf, uint32_t count) {
+    uint32_t done = 0;
+    while (done < count) {
+        const uint32_t want = std::min(max_read_, count - done);
+        XdrEncoder ops;
+        encode_fh(ops, f.fh);
+        nfs4::encode_read(ops, f.stateid, offset + done, want);
+        uint32_t got = 0;
+        bool     eof = false;
+        compound41_into("", ops, 2, [&](RecordReader& rr) {
+            nfs4::decode_putfh_result(rr);
+            got = nfs4::decode_read_result_into(rr, buf + done, want, &eof);
+        });
+        done += got;
+        if (eof || got == 0) break;
+    }
+    return done;
 }
 
 uint32_t Nfs41Client::write(const Nfs4File& f, uint64_t offset, Stable4 stable,
                              const uint8_t* data, uint32_t len) {
+    uint32_t done = 0;
+    do {
+        const uint32_t want = std::min(max_write_, len - done);
+        XdrEncoder ops;
+        encode_fh(ops, f.fh);
+        nfs4::encode_write(ops, f.stateid, offset + done, stable, data + done, want);
+        auto reply = compound41("", ops, 2);
+        XdrDecoder dec(reply);
+        nfs4::check_compound_status(dec);
+        nfs4::decode_sequence41_result(dec);
+        nfs4::decode_putfh_result(dec);
+        const uint32_t wrote = nfs4::decode_write_result(dec).count;
+        done += wrote;
+        if (wrote < want) break;   // short write: report what the server took
+    } while (done < len);
+    return done;
+}
+
+std::future<std::vector<uint8_t>> Nfs41Client::read_async(const Nfs4File& f,
+                                                          uint64_t offset, uint32_t count) {
+    if (count > max_read_)
+        throw std::invalid_argument("read_async: count exceeds max_read_size()");
+    XdrEncoder ops;
+    encode_fh(ops, f.fh);
+    nfs4::encode_read(ops, f.stateid, offset, count);
+    auto data = std::make_shared<std::vector<uint8_t>>(count);
+    auto sent = compound41_async_into("", ops, 2, [data, count](RecordReader& rr) {
+        nfs4::decode_putfh_result(rr);
+        data->resize(nfs4::decode_read_result_into(rr, data->data(), count));
+    });
+    return std::async(std::launch::deferred, [sent = std::move(sent), data]() mutable {
+        sent.get();
+        return std::move(*data);
+    });
+}
+
+std::future<uint32_t> Nfs41Client::write_async(const Nfs4File& f, uint64_t offset,
+                                               Stable4 stable, const uint8_t* data,
+                                               uint32_t len) {
+    if (len > max_write_)
+        throw std::invalid_argument("write_async: len exceeds max_write_size()");
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_write(ops, f.stateid, offset, stable, data, len);
-    auto reply = compound41("", ops.release(), 2);
-    XdrDecoder dec(reply);
-    nfs4::check_compound_status(dec);
-    nfs4::decode_sequence41_result(dec);
-    nfs4::decode_putfh_result(dec);
-    return nfs4::decode_write_result(dec).count;
+    auto wrote = std::make_shared<uint32_t>(0);
+    auto sent = compound41_async_into("", ops, 2, [wrote](RecordReader& rr) {
+        nfs4::decode_putfh_result(rr);
+        *wrote = nfs4::decode_write_result(rr).count;
+    });
+    return std::async(std::launch::deferred, [sent = std::move(sent), wrote]() mutable {
+        sent.get();
+        return *wrote;
+    });
+}
+
+std::vector<uint8_t> Nfs41Client::read_whole_file(const Nfs4Fh& dir,
+                                                  const std::string& name) {
+    auto b = compound_builder();
+    b.putfh(dir).open(name, nfs4::OPEN4_SHARE_ACCESS_READ, false).getfh()
+     .read(nfs4::CURRENT_STATEID, 0, max_read_).close(nfs4::CURRENT_STATEID);
+    const nfs4::CompoundResult r = compound(b);
+    close_left_open(r, dir, name);
+    r.check();
+
+    std::vector<uint8_t> data = r.get<Nfs4ReadResult>(3).data;
+    if (r.get<Nfs4ReadResult>(3).eof) return data;
+
+    // Longer than one READ, which the size of a file about to be opened
+    // cannot tell in advance: that COMPOUND has closed it already, so the
+    // rest is read under an OPEN of its own.
+    const Nfs4File f = open_read(dir, name);
+    try {
+        for (bool eof = false; !eof;) {
+            Nfs4ReadResult more = read_once(f, data.size(), max_read_);
+            if (more.data.empty() && !more.eof) throw std::runtime_error("READ made no progress");
+            eof = more.eof;
+            data.insert(data.end(), more.data.begin(), more.data.end());
+        }
+    } catch (const std::exception&) {
+        try {
+            close(f);   // best effort: the error above is what gets reported
+        } catch (const std::exception&) {}
+        throw;
+    }
+    close(f);
+    return data;
+}
+
+void Nfs41Client::write_whole_file(const Nfs4Fh& dir, const std::string& name,
+                                   const uint8_t* data, size_t len) {
+    nfs4::Sattr4 truncate;
+    truncate.size = 0;
+    const bool     fits  = len <= max_write_;
+    const uint32_t first = static_cast<uint32_t>(std::min<size_t>(len, max_write_));
+    auto b = compound_builder();
+    b.putfh(dir).open(name, nfs4::OPEN4_SHARE_ACCESS_WRITE, true, truncate).getfh()
+     .write(nfs4::CURRENT_STATEID, 0, Stable4::FILE_SYNC, data, first);
+    // More than one WRITE: the rest goes out under the open stateid, and
+    // CLOSE after it.
+    if (fits) b.close(nfs4::CURRENT_STATEID);
+    const nfs4::CompoundResult r = compound(b);
+    close_left_open(r, dir, name);
+    r.check();
+
+    size_t   done = r.get<Nfs4WriteResult>(3).count;
+    Nfs4File f{r.get<Nfs4Fh>(2), r.get<nfs4::Open4Result>(1).stateid, 0};
+    if (fits) {
+        if (done == len) return;
+        f = open_write(dir, name, false);   // a short WRITE, then closed
+    }
+    try {
+        while (done < len) {
+            const uint32_t want  = static_cast<uint32_t>(std::min<size_t>(len - done, max_write_));
+            const uint32_t wrote = write(f, done, Stable4::FILE_SYNC, data + done, want);
+            if (wrote == 0) throw std::runtime_error("WRITE made no progress");
+            done += wrote;
+        }
+    } catch (const std::exception&) {
+        try {
+            close(f);   // best effort: the error above is what gets reported
+        } catch (const std::exception&) {}
+        throw;
+    }
+    close(f);
+}
+
+void Nfs41Client::close_left_open(const nfs4::CompoundResult& r, const Nfs4Fh& dir,
+                                  const std::string& name) {
+    // OPEN (op 1) went through, CLOSE was never reached.  If GETFH (op 2)
+    // failed too, the file is found by name.
+    if (r.ok() || r.ops.size() < 3 || r.ops[1].status != 0 ||
+        r.ops.back().op == nfs4::OP_CLOSE)
+        return;
+    try {
+        const Nfs4Fh fh = r.ops[2].status == 0 ? r.get<Nfs4Fh>(2) : lookup(dir, name);
+        close(Nfs4File{fh, r.get<nfs4::Open4Result>(1).stateid, 0});
+    } catch (const std::exception&) {}
 }
 
 std::array<uint8_t, 8> Nfs41Client::commit(const Nfs4File& f,
@@ -298,7 +711,7 @@ std::array<uint8_t, 8> Nfs41Client::commit(const Nfs4File& f,
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_commit(ops, offset, count);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -314,7 +727,7 @@ Nfs4Fh Nfs41Client::mkdir(const Nfs4Fh& dir, const std::string& name,
     encode_fh(ops, dir);
     nfs4::encode_create_dir(ops, name, attrs);
     nfs4::encode_getfh(ops);
-    auto reply = compound41("", ops.release(), 3);
+    auto reply = compound41("", ops, 3);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -327,7 +740,7 @@ void Nfs41Client::remove(const Nfs4Fh& dir, const std::string& name) {
     XdrEncoder ops;
     encode_fh(ops, dir);
     nfs4::encode_remove(ops, name);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -342,7 +755,7 @@ void Nfs41Client::rename(const Nfs4Fh& src_dir, const std::string& src_name,
     nfs4::encode_savefh(ops);
     encode_fh(ops, dst_dir);
     nfs4::encode_rename(ops, src_name, dst_name);
-    auto reply = compound41("", ops.release(), 4);
+    auto reply = compound41("", ops, 4);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -358,7 +771,7 @@ Nfs4Fh Nfs41Client::symlink(const Nfs4Fh& dir, const std::string& name,
     encode_fh(ops, dir);
     nfs4::encode_create_symlink(ops, name, target, attrs);
     nfs4::encode_getfh(ops);
-    auto reply = compound41("", ops.release(), 3);
+    auto reply = compound41("", ops, 3);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -371,7 +784,7 @@ std::string Nfs41Client::readlink(const Nfs4Fh& fh) {
     XdrEncoder ops;
     encode_fh(ops, fh);
     nfs4::encode_readlink(ops);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -384,7 +797,7 @@ void Nfs41Client::setattr(const Nfs4Fh& fh, const nfs4::Sattr4& attrs) {
     XdrEncoder ops;
     encode_fh(ops, fh);
     nfs4::encode_setattr(ops, anon, attrs);
-    auto reply = compound41("", ops.release(), 2);
+    auto reply = compound41("", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_sequence41_result(dec);
@@ -406,7 +819,7 @@ std::vector<Nfs4DirEntry> Nfs41Client::readdir(const Nfs4Fh& dir) {
                              4096, 32768,
                              {nfs4::attr::TYPE, nfs4::attr::SIZE, nfs4::attr::FILEID,
                               nfs4::attr::MODE, nfs4::attr::TIME_MODIFY});
-        auto reply = compound41("", ops.release(), 2);
+        auto reply = compound41("", ops, 2);
         XdrDecoder dec(reply);
         nfs4::check_compound_status(dec);
         nfs4::decode_sequence41_result(dec);
@@ -423,3 +836,26 @@ std::vector<Nfs4DirEntry> Nfs41Client::readdir(const Nfs4Fh& dir) {
     }
     return all;
 }
+
+// ── Batched COMPOUNDs ─────────────────────────────────────────────────────────
+
+nfs4::CompoundBuilder Nfs41Client::compound_builder() const {
+    return nfs4::CompoundBuilder({clientid_, OPEN_OWNER});
+}
+
+nfs4::CompoundResult Nfs41Client::compound(nfs4::CompoundBuilder& b) {
+    for (size_t i = 0; i < b.num_seqids(); ++i) b.set_seqid(i, ++open_seqid_);
+    while (true) {
+        auto reply = compound41("", b.ops(), b.num_ops());
+        XdrDecoder dec(reply);
+        const uint32_t status = dec.get_uint32();
+        dec.skip_opaque();                                // tag
+        const uint32_t numres = dec.get_uint32();
+        if (numres == 0) throw Nfs4Error(status, "COMPOUND");
+        nfs4::decode_sequence41_result(dec);
+        nfs4::CompoundResult r = b.decode_results(dec, status, numres - 1);
+        // As in do_open(), sent again while the server is in its grace period.
+        if (r.status != static_cast<uint32_t>(Nfsstat4::NFS4ERR_GRACE)) return r;
+        std::this_thread::sleep_for(grace_delay_);
+    }
+}
@@ -1,36 +1,50 @@
 #pragma once
 
+#include "client_options.hpp"
 #include "nfs4/nfs4_types.hpp"
+#include "nfs4/compound_builder.hpp"
 #include "nfs4/nfs4_error.hpp"
 #include "nfs4/nfs4_attr.hpp"
 #include "nfs4/readdir.hpp"
+#include "nfs4/slot_table41.hpp"
 #include "rpc/rpc_client.hpp"
+#include "rpc/rpc_pool.hpp"
 #include "rpc/rpc_types.hpp"
 
 #include <array>
 #include <cstdint>
+#include <atomic>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
 // High-level NFSv4.1 client.
 //
-// On construction, resolves the NFS port via portmap, establishes a persistent
-// TCP connection, and performs the EXCHANGE_ID / CREATE_SESSION / RECLAIM_COMPLETE
-// handshake to set up an NFSv4.1 session.
+// On construction, resolves the NFS port via portmap, establishes persistent
+// TCP connection(s), and performs the EXCHANGE_ID / CREATE_SESSION / RECLAIM_COMPLETE
+// handshake to set up an NFSv4.1 session.  With `opts.nconnect` > 1 the extra
+// connections are attached to the same session via BIND_CONN_TO_SESSION.
 //
 // Public API is identical to Nfs4Client.  All COMPOUNDs after session setup
-// automatically prepend a SEQUENCE op (single-slot, slotid=0).
+// automatically prepend a SEQUENCE op on a slot taken from the session's slot
+// table (`opts.session_slots` requested; resized by the server's SEQUENCE
+// replies).
 //
 // In NFSv4.1 there is no OPEN_CONFIRM; RENEW is replaced by implicit lease
 // renewal via SEQUENCE on any COMPOUND.
+//
+// Thread safety: all operations may be called concurrently on one instance.
+// Each COMPOUND holds one slot; when all slots are busy, callers wait for one.
+// set_auth_sys()/clear_auth() affect calls issued after they return.
 class Nfs41Client {
 public:
     // Connect to `host` with AUTH_NONE and establish an NFSv4.1 session.
-    explicit Nfs41Client(const std::string& host);
+    explicit Nfs41Client(const std::string& host, const ClientOptions& opts = {});
 
     // Same as above but switches to AUTH_SYS before session setup.
-    Nfs41Client(const std::string& host, const AuthSys& auth);
+    Nfs41Client(const std::string& host, const AuthSys& auth,
+                const ClientOptions& opts = {});
 
     ~Nfs41Client();
 
@@ -42,6 +56,12 @@ public:
     Nfs4Fh root_fh() const { return root_fh_; }
 
     Nfs4Fh lookup(const Nfs4Fh& dir, const std::string& name);
+
+    // As in Nfs4Client, but a path too long for the session's ca_maxoperations
+    // is split up front rather than after the server refuses it.
+    Nfs4PathInfo resolve_path(const std::string& path) { return resolve_path(root_fh_, path); }
+    Nfs4PathInfo resolve_path(const Nfs4Fh& dir, const std::string& path);
+
     Fattr4 getattr(const Nfs4Fh& fh);
     uint32_t access(const Nfs4Fh& fh, uint32_t mask);
 
@@ -53,12 +73,39 @@ public:
 
     // ── Data operations ───────────────────────────────────────────────────────
 
+    // READ/WRITE larger than the negotiated limits (max_read_size() /
+    // max_write_size()) are split into several COMPOUNDs.  Reads go on past
+    // short chunks and stop at EOF; writes stop at the first short write.
     std::vector<uint8_t> read(const Nfs4File& f, uint64_t offset, uint32_t count);
+    uint32_t read_into(const Nfs4File& f, uint64_t offset, uint8_t* buf, uint32_t count);
     uint32_t write(const Nfs4File& f, uint64_t offset, Stable4 stable,
                    const uint8_t* data, uint32_t len);
     std::array<uint8_t, 8> commit(const Nfs4File& f,
                                    uint64_t offset = 0, uint32_t count = 0);
 
+    // Whole-file read / create-or-truncate-and-write (FILE_SYNC) in one
+    // COMPOUND: PUTFH + OPEN + GETFH + READ/WRITE + CLOSE, the last two on
+    // the current stateid.  What does not fit in max_read_size() /
+    // max_write_size() follows in further COMPOUNDs, after the CLOSE, under
+    // the anonymous stateid.
+    std::vector<uint8_t> read_whole_file(const Nfs4Fh& dir, const std::string& name);
+    void write_whole_file(const Nfs4Fh& dir, const std::string& name,
+                          const uint8_t* data, size_t len);
+    void write_whole_file(const Nfs4Fh& dir, const std::string& name,
+                          const std::vector<uint8_t>& data) {
+        write_whole_file(dir, name, data.data(), data.size());
+    }
+
+    // Pipelined READ / WRITE of at most max_read_size() / max_write_size()
+    // bytes (std::invalid_argument otherwise), as in Nfs4Client.  A call may
+    // wait for a free session slot; the slot is given back when the reply
+    // arrives, not when the future is collected.  Collect every future before
+    // destroying the client.
+    std::future<std::vector<uint8_t>> read_async(const Nfs4File& f, uint64_t offset,
+                                                 uint32_t count);
+    std::future<uint32_t> write_async(const Nfs4File& f, uint64_t offset, Stable4 stable,
+                                      const uint8_t* data, uint32_t len);
+
     // ── Namespace operations ──────────────────────────────────────────────────
 
     Nfs4Fh mkdir(const Nfs4Fh& dir, const std::string& name,
@@ -75,26 +122,84 @@ public:
 
     std::vector<Nfs4DirEntry> readdir(const Nfs4Fh& dir);
 
+    // ── Batched COMPOUNDs ─────────────────────────────────────────────────────
+
+    // As in Nfs4Client; compound() puts SEQUENCE in front, and throws
+    // Nfs4Error if SEQUENCE itself fails.  Ops after an OPEN may use
+    // nfs4::CURRENT_STATEID.
+    nfs4::CompoundBuilder compound_builder() const;
+    nfs4::CompoundResult  compound(nfs4::CompoundBuilder& b);
+
     // ── Session ID (for test introspection) ───────────────────────────────────
 
     const SessionId41& session_id() const { return sessionid_; }
+
+    // Fore-channel limits granted by CREATE_SESSION and the per-COMPOUND
+    // READ/WRITE payload sizes derived from them.
+    const nfs4::ChannelAttrs41& fore_channel() const { return fore_; }
+    uint32_t max_read_size() const  { return max_read_; }
+    uint32_t max_write_size() const { return max_write_; }
     uint64_t client_id() const { return clientid_; }
 
 private:
     // Send a COMPOUND with SEQUENCE prepended (minorversion=1).
     std::vector<uint8_t> compound41(const std::string& tag,
-                                     const std::vector<uint8_t>& ops_bytes,
+                                     const XdrEncoder& ops,
                                      uint32_t num_ops);
 
+    // Streaming variant.  The COMPOUND header and SEQUENCE result are consumed
+    // here (throwing on failure); `sink` starts at the first result of `ops`.
+    void compound41_into(const std::string& tag,
+                         const XdrEncoder& ops,
+                         uint32_t num_ops,
+                         const TcpRpcClient::ReplySink& sink);
+
+    // Pipelined compound41_into: returns once sent.  The slot is settled and
+    // `sink` run on the connection's reader thread when the reply arrives.
+    std::future<void> compound41_async_into(const std::string& tag,
+                                            const XdrEncoder& ops,
+                                            uint32_t num_ops,
+                                            TcpRpcClient::ReplySink sink);
+
+    // A slot for the next COMPOUND on `conn`, resynchronised first if the
+    // last COMPOUND on it got no reply.
+    nfs4::SlotTable41::Slot acquire_slot(TcpRpcClient& conn);
+
+    // One READ COMPOUND of at most max_read_ bytes, with its eof flag.
+    Nfs4ReadResult read_once(const Nfs4File& f, uint64_t offset, uint32_t count);
+
+    // One COMPOUND of resolve_path(), as in Nfs4Client.
+    void resolve_step(Nfs4PathInfo& at, const std::vector<std::string>& names,
+                      size_t first, size_t count, bool last);
+
+    // CLOSE the file a whole-file COMPOUND opened if it failed before its
+    // CLOSE; best effort, as the COMPOUND's own error is what gets reported.
+    void close_left_open(const nfs4::CompoundResult& r, const Nfs4Fh& dir,
+                         const std::string& name);
+
     // Perform OPEN (with NFS4ERR_GRACE retry loop); no OPEN_CONFIRM in v4.1.
     Nfs4File do_open(const Nfs4Fh& dir, const std::string& name,
                      uint32_t share_access, bool create);
 
-    std::string                   host_;
-    std::unique_ptr<TcpRpcClient> rpc_;
-    Nfs4Fh                        root_fh_;
-    uint64_t                      clientid_{};
-    SessionId41                   sessionid_{};
-    uint32_t                      slot_seqid_{1};  // increments each COMPOUND
-    uint32_t                      open_seqid_{0};  // OPEN seqid (ignored by server in v4.1)
+    // EXCHANGE_ID + CREATE_SESSION on the primary connection, then set up the
+    // slot table and bind the other connections.
+    void start_session(const ClientOptions& opts);
+
+    // BIND_CONN_TO_SESSION on every connection but the primary.
+    void bind_extra_connections();
+
+    TcpRpcClient& rpc() { return pool_->pick(); }
+
+    std::string                        host_;
+    std::unique_ptr<RpcConnectionPool> pool_;
+    Nfs4Fh                             root_fh_;
+    uint64_t                           clientid_{};
+    SessionId41                        sessionid_{};
+    std::unique_ptr<nfs4::SlotTable41> slots_;
+    nfs4::ChannelAttrs41               fore_;
+    uint32_t                           max_read_{65536};
+    uint32_t                           max_write_{65536};
+    std::chrono::milliseconds          grace_delay_{5000};  // before an NFS4ERR_GRACE retry
+    std::atomic<uint32_t>              max_path_lookups_{1};  // per resolve_path() COMPOUND
+    std::atomic<uint32_t>              open_seqid_{0};  // OPEN seqid (ignored by server in v4.1)
 };
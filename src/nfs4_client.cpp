@@ -15,13 +15,17 @@
 #include "nfs4/readdir.hpp"
 #include "nfs4/readlink.hpp"
 #include "nfs/portmap.hpp"
+#include "path.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
-#include <unistd.h>
+#include <stdexcept>
+#include <thread>
 
 static constexpr uint32_t NFS4_PROG = 100003;
 static constexpr uint32_t NFS4_VERS = 4;
+static const char* const OPEN_OWNER = "nfsclient-v4";
 
 // ── Constructor helpers (file-local) ──────────────────────────────────────────
 
@@ -35,14 +39,14 @@ static uint64_t do_setclientid_confirm(TcpRpcClient& rpc) {
 
     XdrEncoder ops;
     nfs4::encode_setclientid(ops, verifier, "nfsclient-v4");
-    auto reply = nfs4::call_compound(rpc, "init", ops.release(), 1);
+    auto reply = nfs4::call_compound(rpc, "init", ops, 1);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     auto r = nfs4::decode_setclientid_result(dec);
 
     XdrEncoder ops2;
     nfs4::encode_setclientid_confirm(ops2, r.clientid, r.confirm_verifier);
-    auto reply2 = nfs4::call_compound(rpc, "init", ops2.release(), 1);
+    auto reply2 = nfs4::call_compound(rpc, "init", ops2, 1);
     XdrDecoder dec2(reply2);
     nfs4::check_compound_status(dec2);
     nfs4::decode_setclientid_confirm_result(dec2);
@@ -54,15 +58,20 @@ static uint64_t do_setclientid_confirm(TcpRpcClient& rpc) {
 // All Nfs4Client methods treat an empty Nfs4Fh as "use PUTROOTFH" to
 // avoid PUTFH on the root FH, which Linux nfsd rejects with NFS4ERR_PERM
 // via fh_verify() while PUTROOTFH (exp_pseudoroot) bypasses that check.
-static Nfs4Fh do_get_root_fh(TcpRpcClient& rpc) {
+// `max_io` is lowered to the server's maxread / maxwrite where it gives them.
+static Nfs4Fh do_get_root_fh(TcpRpcClient& rpc, uint32_t& max_io) {
     XdrEncoder ops;
     nfs4::encode_putrootfh(ops);
     nfs4::encode_getfh(ops);
-    auto reply = nfs4::call_compound(rpc, "", ops.release(), 2);
+    nfs4::encode_getattr(ops, {nfs4::attr::MAXREAD, nfs4::attr::MAXWRITE});
+    auto reply = nfs4::call_compound(rpc, "", ops, 3);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putrootfh_result(dec);
     nfs4::decode_getfh_result(dec);   // discard FH; we use PUTROOTFH for root ops
+    const Fattr4 fs = nfs4::decode_getattr_result(dec);
+    for (const auto& limit : {fs.maxread, fs.maxwrite})
+        if (limit && *limit > 0 && *limit < max_io) max_io = static_cast<uint32_t>(*limit);
     return Nfs4Fh{};                  // empty = root sentinel
 }
 
@@ -75,51 +84,169 @@ static void encode_fh(XdrEncoder& ops, const Nfs4Fh& fh) {
         nfs4::encode_putfh(ops, fh);
 }
 
+// The attributes getattr() and resolve_path() ask for.
+static void encode_getattr_all(XdrEncoder& ops) {
+    nfs4::encode_getattr(ops, {
+        nfs4::attr::TYPE, nfs4::attr::CHANGE, nfs4::attr::SIZE,
+        nfs4::attr::FILEID, nfs4::attr::MODE, nfs4::attr::NUMLINKS,
+        nfs4::attr::OWNER, nfs4::attr::OWNER_GROUP,
+        nfs4::attr::TIME_ACCESS, nfs4::attr::TIME_METADATA, nfs4::attr::TIME_MODIFY
+    });
+}
+
 // ── Constructors ──────────────────────────────────────────────────────────────
 
-Nfs4Client::Nfs4Client(const std::string& host) : host_(host) {
-    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS);
-    rpc_      = std::make_unique<TcpRpcClient>(host_, port);
-    clientid_ = do_setclientid_confirm(*rpc_);
-    root_fh_  = do_get_root_fh(*rpc_);
+Nfs4Client::Nfs4Client(const std::string& host, const ClientOptions& opts)
+    : host_(host) {
+    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS,
+                                                opts.portmap_port);
+    pool_     = std::make_unique<RpcConnectionPool>(host_, port, opts.nconnect,
+                                                    opts.conn_policy);
+    clientid_ = do_setclientid_confirm(pool_->primary());
+    max_io_   = opts.max_io_size;
+    grace_delay_ = opts.grace_delay;
+    root_fh_  = do_get_root_fh(pool_->primary(), max_io_);
+    if (opts.lookup_cache)
+        dentry_cache_ = std::make_unique<DentryCache<Nfs4Fh>>(opts.attr_timeouts.acdirmin);
 }
 
-Nfs4Client::Nfs4Client(const std::string& host, const AuthSys& auth) : host_(host) {
-    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS);
-    rpc_      = std::make_unique<TcpRpcClient>(host_, port);
-    rpc_->set_auth_sys(auth);    // switch to AUTH_SYS before SETCLIENTID and PUTROOTFH
-    clientid_ = do_setclientid_confirm(*rpc_);
-    root_fh_  = do_get_root_fh(*rpc_);
+Nfs4Client::Nfs4Client(const std::string& host, const AuthSys& auth,
+                       const ClientOptions& opts)
+    : host_(host) {
+    const uint16_t port = nfs3::getport(host_, NFS4_PROG, NFS4_VERS,
+                                                opts.portmap_port);
+    pool_     = std::make_unique<RpcConnectionPool>(host_, port, opts.nconnect,
+                                                    opts.conn_policy);
+    pool_->set_auth_sys(auth);   // switch to AUTH_SYS before SETCLIENTID and PUTROOTFH
+    clientid_ = do_setclientid_confirm(pool_->primary());
+    max_io_   = opts.max_io_size;
+    grace_delay_ = opts.grace_delay;
+    root_fh_  = do_get_root_fh(pool_->primary(), max_io_);
+    if (opts.lookup_cache)
+        dentry_cache_ = std::make_unique<DentryCache<Nfs4Fh>>(opts.attr_timeouts.acdirmin);
 }
 
-void Nfs4Client::set_auth_sys(const AuthSys& auth) { rpc_->set_auth_sys(auth); }
-void Nfs4Client::clear_auth()                       { rpc_->clear_auth(); }
+void Nfs4Client::set_auth_sys(const AuthSys& auth) { pool_->set_auth_sys(auth); }
+void Nfs4Client::clear_auth()                       { pool_->clear_auth(); }
 
 // ── File handle operations ────────────────────────────────────────────────────
 
 Nfs4Fh Nfs4Client::lookup(const Nfs4Fh& dir, const std::string& name) {
+    if (!dentry_cache_) {
+        XdrEncoder ops;
+        encode_fh(ops, dir);
+        nfs4::encode_lookup(ops, name);
+        nfs4::encode_getfh(ops);
+        auto reply = nfs4::call_compound(rpc(), "", ops, 3);
+        XdrDecoder dec(reply);
+        nfs4::check_compound_status(dec);
+        nfs4::decode_putfh_result(dec);
+        nfs4::decode_lookup_result(dec);
+        return nfs4::decode_getfh_result(dec);
+    }
+
+    using State = DentryCache<Nfs4Fh>::State;
+    auto hit = dentry_cache_->get(dir, name);
+    if (hit.state == State::REVALIDATE) {
+        revalidate_dir(dir);
+        hit = dentry_cache_->get(dir, name);
+    }
+    if (hit.state == State::FOUND) return hit.fh;
+    if (hit.state == State::NOT_FOUND)
+        throw Nfs4Error(static_cast<uint32_t>(Nfsstat4::NFS4ERR_NOENT), "LOOKUP");
+
     XdrEncoder ops;
     encode_fh(ops, dir);
+    nfs4::encode_getattr(ops, {nfs4::attr::CHANGE});
     nfs4::encode_lookup(ops, name);
     nfs4::encode_getfh(ops);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 3);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 4);
+    XdrDecoder dec(reply);
+
+    // The directory's change attribute is wanted even when LOOKUP fails, so
+    // the results are read up to the failing op instead of stopping at the
+    // COMPOUND status.
+    const uint32_t status = dec.get_uint32();
+    dec.skip_opaque();                                    // tag
+    if (dec.get_uint32() == 0) throw Nfs4Error(status, "COMPOUND");
+    nfs4::decode_putfh_result(dec);
+    const Fattr4 dir_attrs = nfs4::decode_getattr_result(dec);
+    if (dir_attrs.change) dentry_cache_->observe_dir(dir, *dir_attrs.change);
+    try {
+        nfs4::decode_lookup_result(dec);
+    } catch (const Nfs4Error& e) {
+        if (e.is(Nfsstat4::NFS4ERR_NOENT)) dentry_cache_->put_negative(dir, name);
+        throw;
+    }
+    Nfs4Fh fh = nfs4::decode_getfh_result(dec);
+    dentry_cache_->put(dir, name, fh);
+    return fh;
+}
+
+void Nfs4Client::revalidate_dir(const Nfs4Fh& dir) {
+    XdrEncoder ops;
+    encode_fh(ops, dir);
+    nfs4::encode_getattr(ops, {nfs4::attr::CHANGE});
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
+    XdrDecoder dec(reply);
+    nfs4::check_compound_status(dec);
+    nfs4::decode_putfh_result(dec);
+    const Fattr4 attrs = nfs4::decode_getattr_result(dec);
+    if (attrs.change) dentry_cache_->observe_dir(dir, *attrs.change);
+}
+
+void Nfs4Client::name_added(const Nfs4Fh& dir, const std::string& name, const Nfs4Fh& fh) {
+    if (dentry_cache_) dentry_cache_->put(dir, name, fh);
+}
+
+void Nfs4Client::name_removed(const Nfs4Fh& dir, const std::string& name) {
+    if (dentry_cache_) dentry_cache_->put_negative(dir, name);
+}
+
+Nfs4PathInfo Nfs4Client::resolve_path(const Nfs4Fh& dir, const std::string& path) {
+    const std::vector<std::string> names = split_path(path);
+    Nfs4PathInfo at{dir, {}};
+    size_t next = 0;
+    for (;;) {
+        const size_t count = std::min<size_t>(names.size() - next, max_path_lookups_);
+        const bool   last  = next + count == names.size();
+        try {
+            resolve_step(at, names, next, count, last);
+        } catch (const Nfs4Error& e) {
+            // Too many ops for the server: retry with half as many lookups.
+            if (count < 2 || !e.is(Nfsstat4::NFS4ERR_RESOURCE)) throw;
+            max_path_lookups_ = static_cast<uint32_t>(count / 2);
+            continue;
+        }
+        if (last) return at;
+        next += count;
+    }
+}
+
+void Nfs4Client::resolve_step(Nfs4PathInfo& at, const std::vector<std::string>& names,
+                              size_t first, size_t count, bool last) {
+    // With no names left the handle is already known: skip GETFH, which
+    // would also replace the root sentinel with the real root handle.
+    XdrEncoder ops;
+    encode_fh(ops, at.fh);
+    nfs4::encode_lookup_path(ops, names, first, count);
+    if (count > 0) nfs4::encode_getfh(ops);
+    if (last)      encode_getattr_all(ops);
+    auto reply = nfs4::call_compound(rpc(), "", ops,
+                                     static_cast<uint32_t>(1 + count + (count > 0) + last));
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
-    nfs4::decode_lookup_result(dec);
-    return nfs4::decode_getfh_result(dec);
+    nfs4::decode_lookup_path_result(dec, count);
+    if (count > 0) at.fh    = nfs4::decode_getfh_result(dec);
+    if (last)      at.attrs = nfs4::decode_getattr_result(dec);
 }
 
 Fattr4 Nfs4Client::getattr(const Nfs4Fh& fh) {
     XdrEncoder ops;
     encode_fh(ops, fh);
-    nfs4::encode_getattr(ops, {
-        nfs4::attr::TYPE, nfs4::attr::CHANGE, nfs4::attr::SIZE,
-        nfs4::attr::FILEID, nfs4::attr::MODE, nfs4::attr::NUMLINKS,
-        nfs4::attr::OWNER, nfs4::attr::OWNER_GROUP,
-        nfs4::attr::TIME_ACCESS, nfs4::attr::TIME_METADATA, nfs4::attr::TIME_MODIFY
-    });
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    encode_getattr_all(ops);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
@@ -130,7 +257,7 @@ uint32_t Nfs4Client::access(const Nfs4Fh& fh, uint32_t mask) {
     XdrEncoder ops;
     encode_fh(ops, fh);
     nfs4::encode_access(ops, mask);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
@@ -141,63 +268,10 @@ uint32_t Nfs4Client::access(const Nfs4Fh& fh, uint32_t mask) {
 
 Nfs4File Nfs4Client::do_open(const Nfs4Fh& dir, const std::string& name,
                               uint32_t share_access, bool create) {
-    static constexpr uint32_t NFS4ERR_GRACE = 10013;
-
-    uint32_t seqid = ++open_seqid_;
-
-    // Retry loop: RFC 7530 §8.6 requires clients to retry on NFS4ERR_GRACE
-    // (server in grace period after restart) using the same seqid.
-    std::vector<uint8_t> reply;
-    while (true) {
-        XdrEncoder ops;
-        encode_fh(ops, dir);
-        if (create) {
-            nfs4::encode_open_create(ops, seqid, share_access,
-                                     clientid_, "nfsclient-v4", name);
-        } else {
-            nfs4::encode_open_nocreate(ops, seqid, share_access,
-                                       clientid_, "nfsclient-v4", name);
-        }
-        nfs4::encode_getfh(ops);
-        reply = nfs4::call_compound(*rpc_, "", ops.release(), 3);
-        XdrDecoder dec(reply);
-        try {
-            nfs4::check_compound_status(dec);
-        } catch (const Nfs4Error& e) {
-            if (e.status == NFS4ERR_GRACE) {
-                ::sleep(5);
-                continue;  // retry with same seqid
-            }
-            throw;
-        }
-        // Success — re-create decoder at the start of the reply for decoding below
-        break;
-    }
-    XdrDecoder dec(reply);
-    nfs4::check_compound_status(dec);
-    nfs4::decode_putfh_result(dec);
-    auto open_res = nfs4::decode_open_result(dec);
-    Nfs4Fh fh = nfs4::decode_getfh_result(dec);
-
+    auto b = compound_builder();
+    b.putfh(dir).open(name, share_access, create).getfh();
     Nfs4File f;
-    f.fh      = fh;
-    f.stateid = open_res.stateid;
-    f.seqid   = seqid;
-
-    // OPEN_CONFIRM required when rflags & OPEN4_RESULT_CONFIRM
-    if (open_res.rflags & nfs4::OPEN4_RESULT_CONFIRM) {
-        uint32_t confirm_seqid = ++open_seqid_;
-        XdrEncoder ops2;
-        encode_fh(ops2, fh);
-        nfs4::encode_open_confirm(ops2, f.stateid, confirm_seqid);
-        auto reply2 = nfs4::call_compound(*rpc_, "", ops2.release(), 2);
-        XdrDecoder dec2(reply2);
-        nfs4::check_compound_status(dec2);
-        nfs4::decode_putfh_result(dec2);
-        f.stateid = nfs4::decode_open_confirm_result(dec2);
-        f.seqid   = confirm_seqid;
-    }
-
+    open_compound(b, dir, name, f).check();
     return f;
 }
 
@@ -210,28 +284,43 @@ Nfs4File Nfs4Client::open_write(const Nfs4Fh& dir, const std::string& name, bool
 }
 
 void Nfs4Client::close(const Nfs4File& f) {
-    XdrEncoder ops;
-    encode_fh(ops, f.fh);
-    nfs4::encode_close(ops, f.seqid, f.stateid);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
-    XdrDecoder dec(reply);
-    nfs4::check_compound_status(dec);
-    nfs4::decode_putfh_result(dec);
-    nfs4::decode_close_result(dec);
+    auto b = compound_builder();
+    b.putfh(f.fh).close(f.stateid);
+    compound(b).check();
 }
 
 // ── Data operations ───────────────────────────────────────────────────────────
 
 std::vector<uint8_t> Nfs4Client::read(const Nfs4File& f,
                                        uint64_t offset, uint32_t count) {
+    return read_once(f, offset, count).data;
+}
+
+Nfs4ReadResult Nfs4Client::read_once(const Nfs4File& f, uint64_t offset, uint32_t count) {
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_read(ops, f.stateid, offset, count);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
-    return nfs4::decode_read_result(dec);
+    Nfs4ReadResult r;
+    r.data = nfs4::decode_read_result(dec, &r.eof);
+    return r;
+}
+
+uint32_t Nfs4Client::read_into(const Nfs4File& f, uint64_t offset,
+                               uint8_t* buf, uint32_t count) {
+    XdrEncoder ops;
+    encode_fh(ops, f.fh);
+    nfs4::encode_read(ops, f.stateid, offset, count);
+    uint32_t got = 0;
+    nfs4::call_compound_into(rpc(), "", ops, 2, /*minorversion=*/0, [&](RecordReader& rr) {
+        nfs4::check_compound_status(rr);
+        nfs4::decode_putfh_result(rr);
+        got = nfs4::decode_read_result_into(rr, buf, count);
+    });
+    return got;
 }
 
 uint32_t Nfs4Client::write(const Nfs4File& f, uint64_t offset, Stable4 stable,
@@ -239,19 +328,111 @@ uint32_t Nfs4Client::write(const Nfs4File& f, uint64_t offset, Stable4 stable,
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_write(ops, f.stateid, offset, stable, data, len);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
     return nfs4::decode_write_result(dec).count;
 }
 
+std::future<std::vector<uint8_t>> Nfs4Client::read_async(const Nfs4File& f,
+                                                         uint64_t offset, uint32_t count) {
+    XdrEncoder ops;
+    encode_fh(ops, f.fh);
+    nfs4::encode_read(ops, f.stateid, offset, count);
+    auto data = std::make_shared<std::vector<uint8_t>>(count);
+    auto sent = nfs4::call_compound_async_into(rpc(), "", ops, 2, /*minorversion=*/0,
+                                               [data, count](RecordReader& rr) {
+        nfs4::check_compound_status(rr);
+        nfs4::decode_putfh_result(rr);
+        data->resize(nfs4::decode_read_result_into(rr, data->data(), count));
+    });
+    return std::async(std::launch::deferred, [sent = std::move(sent), data]() mutable {
+        sent.get();
+        return std::move(*data);
+    });
+}
+
+std::future<uint32_t> Nfs4Client::write_async(const Nfs4File& f, uint64_t offset,
+                                              Stable4 stable, const uint8_t* data,
+                                              uint32_t len) {
+    XdrEncoder ops;
+    encode_fh(ops, f.fh);
+    nfs4::encode_write(ops, f.stateid, offset, stable, data, len);
+    auto wrote = std::make_shared<uint32_t>(0);
+    auto sent = nfs4::call_compound_async_into(rpc(), "", ops, 2, /*minorversion=*/0,
+                                               [wrote](RecordReader& rr) {
+        nfs4::check_compound_status(rr);
+        nfs4::decode_putfh_result(rr);
+        *wrote = nfs4::decode_write_result(rr).count;
+    });
+    return std::async(std::launch::deferred, [sent = std::move(sent), wrote]() mutable {
+        sent.get();
+        return *wrote;
+    });
+}
+
+std::vector<uint8_t> Nfs4Client::read_whole_file(const Nfs4Fh& dir, const std::string& name) {
+    auto b = compound_builder();
+    b.putfh(dir).open(name, nfs4::OPEN4_SHARE_ACCESS_READ, false).getfh()
+     .read(nfs4::ANONYMOUS_STATEID, 0, max_io_);
+    Nfs4File f;
+    const nfs4::CompoundResult r = open_compound(b, dir, name, f);
+
+    std::vector<uint8_t> data;
+    try {
+        r.check();
+        data = r.get<Nfs4ReadResult>(3).data;
+        for (bool eof = r.get<Nfs4ReadResult>(3).eof; !eof;) {
+            Nfs4ReadResult more = read_once(f, data.size(), max_io_);
+            if (more.data.empty() && !more.eof) throw std::runtime_error("READ made no progress");
+            eof = more.eof;
+            data.insert(data.end(), more.data.begin(), more.data.end());
+        }
+    } catch (const std::exception&) {
+        try {
+            close(f);   // best effort: the error above is what gets reported
+        } catch (const std::exception&) {}
+        throw;
+    }
+    close(f);
+    return data;
+}
+
+void Nfs4Client::write_whole_file(const Nfs4Fh& dir, const std::string& name,
+                                  const uint8_t* data, size_t len) {
+    nfs4::Sattr4 truncate;
+    truncate.size = 0;
+    const uint32_t first = static_cast<uint32_t>(std::min<size_t>(len, max_io_));
+    auto b = compound_builder();
+    b.putfh(dir).open(name, nfs4::OPEN4_SHARE_ACCESS_WRITE, true, truncate).getfh()
+     .write(nfs4::ANONYMOUS_STATEID, 0, Stable4::FILE_SYNC, data, first);
+    Nfs4File f;
+    const nfs4::CompoundResult r = open_compound(b, dir, name, f);
+
+    try {
+        r.check();
+        for (size_t done = r.get<Nfs4WriteResult>(3).count; done < len;) {
+            const uint32_t want  = static_cast<uint32_t>(std::min<size_t>(len - done, max_io_));
+            const uint32_t wrote = write(f, done, Stable4::FILE_SYNC, data + done, want);
+            if (wrote == 0) throw std::runtime_error("WRITE made no progress");
+            done += wrote;
+        }
+    } catch (const std::exception&) {
+        try {
+            close(f);   // best effort: the error above is what gets reported
+        } catch (const std::exception&) {}
+        throw;
+    }
+    close(f);
+}
+
 std::array<uint8_t, 8> Nfs4Client::commit(const Nfs4File& f,
                                             uint64_t offset, uint32_t count) {
     XdrEncoder ops;
     encode_fh(ops, f.fh);
     nfs4::encode_commit(ops, offset, count);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
@@ -266,23 +447,26 @@ Nfs4Fh Nfs4Client::mkdir(const Nfs4Fh& dir, const std::string& name,
     encode_fh(ops, dir);
     nfs4::encode_create_dir(ops, name, attrs);
     nfs4::encode_getfh(ops);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 3);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 3);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
     nfs4::decode_create_result(dec);
-    return nfs4::decode_getfh_result(dec);
+    Nfs4Fh fh = nfs4::decode_getfh_result(dec);
+    name_added(dir, name, fh);
+    return fh;
 }
 
 void Nfs4Client::remove(const Nfs4Fh& dir, const std::string& name) {
     XdrEncoder ops;
     encode_fh(ops, dir);
     nfs4::encode_remove(ops, name);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
     nfs4::decode_remove_result(dec);
+    name_removed(dir, name);
 }
 
 void Nfs4Client::rename(const Nfs4Fh& src_dir, const std::string& src_name,
@@ -293,13 +477,15 @@ void Nfs4Client::rename(const Nfs4Fh& src_dir, const std::string& src_name,
     nfs4::encode_savefh(ops);
     encode_fh(ops, dst_dir);
     nfs4::encode_rename(ops, src_name, dst_name);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 4);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 4);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
     nfs4::decode_savefh_result(dec);
     nfs4::decode_putfh_result(dec);
     nfs4::decode_rename_result(dec);
+    name_removed(src_dir, src_name);
+    if (dentry_cache_) dentry_cache_->forget(dst_dir, dst_name);
 }
 
 Nfs4Fh Nfs4Client::symlink(const Nfs4Fh& dir, const std::string& name,
@@ -308,19 +494,21 @@ Nfs4Fh Nfs4Client::symlink(const Nfs4Fh& dir, const std::string& name,
     encode_fh(ops, dir);
     nfs4::encode_create_symlink(ops, name, target, attrs);
     nfs4::encode_getfh(ops);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 3);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 3);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
     nfs4::decode_create_result(dec);
-    return nfs4::decode_getfh_result(dec);
+    Nfs4Fh fh = nfs4::decode_getfh_result(dec);
+    name_added(dir, name, fh);
+    return fh;
 }
 
 std::string Nfs4Client::readlink(const Nfs4Fh& fh) {
     XdrEncoder ops;
     encode_fh(ops, fh);
     nfs4::encode_readlink(ops);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
@@ -333,7 +521,7 @@ void Nfs4Client::setattr(const Nfs4Fh& fh, const nfs4::Sattr4& attrs) {
     XdrEncoder ops;
     encode_fh(ops, fh);
     nfs4::encode_setattr(ops, anon, attrs);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 2);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_putfh_result(dec);
@@ -354,7 +542,7 @@ std::vector<Nfs4DirEntry> Nfs4Client::readdir(const Nfs4Fh& dir) {
                              4096, 32768,
                              {nfs4::attr::TYPE, nfs4::attr::SIZE, nfs4::attr::FILEID,
                               nfs4::attr::MODE, nfs4::attr::TIME_MODIFY});
-        auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 2);
+        auto reply = nfs4::call_compound(rpc(), "", ops, 2);
         XdrDecoder dec(reply);
         nfs4::check_compound_status(dec);
         nfs4::decode_putfh_result(dec);
@@ -376,8 +564,81 @@ std::vector<Nfs4DirEntry> Nfs4Client::readdir(const Nfs4Fh& dir) {
 void Nfs4Client::renew() {
     XdrEncoder ops;
     nfs4::encode_renew(ops, clientid_);
-    auto reply = nfs4::call_compound(*rpc_, "", ops.release(), 1);
+    auto reply = nfs4::call_compound(rpc(), "", ops, 1);
     XdrDecoder dec(reply);
     nfs4::check_compound_status(dec);
     nfs4::decode_renew_result(dec);
 }
+
+// ── Batched COMPOUNDs ─────────────────────────────────────────────────────────
+
+nfs4::CompoundResult Nfs4Client::open_compound(nfs4::CompoundBuilder& b,
+                                               const Nfs4Fh& dir, const std::string& name,
+                                               Nfs4File& f) {
+    // OPEN and its OPEN_CONFIRM go out back to back: no other seqid of
+    // this open-owner may come between them.
+    std::lock_guard<std::mutex> owner(owner_mutex_);
+    nfs4::CompoundResult r = send_compound(b);
+    if (r.ops.size() < 2 || r.ops[1].status != 0) r.check();   // not opened
+    const nfs4::Open4Result& open = r.get<nfs4::Open4Result>(1);
+    f.stateid = open.stateid;
+    try {
+        f.fh = r.get<Nfs4Fh>(2);
+    } catch (const std::exception&) {
+        // GETFH failed after OPEN: find the file by name to close it, best
+        // effort, as the COMPOUND's own error is what gets reported.
+        try {
+            f.fh = lookup(dir, name);
+            confirm_locked(f, open);
+            auto c = compound_builder();
+            c.putfh(f.fh).close(f.stateid);
+            send_compound(c).check();
+        } catch (const std::exception&) {}
+        throw;
+    }
+    name_added(dir, name, f.fh);
+    confirm_locked(f, open);
+    return r;
+}
+
+void Nfs4Client::confirm_locked(Nfs4File& f, const nfs4::Open4Result& open) {
+    if (!(open.rflags & nfs4::OPEN4_RESULT_CONFIRM)) return;
+    auto b = compound_builder();
+    b.putfh(f.fh).open_confirm(f.stateid);
+    f.stateid = send_compound(b).get<Stateid4>(1);
+}
+
+nfs4::CompoundBuilder Nfs4Client::compound_builder() const {
+    return nfs4::CompoundBuilder({clientid_, OPEN_OWNER});
+}
+
+nfs4::CompoundResult Nfs4Client::compound(nfs4::CompoundBuilder& b) {
+    std::unique_lock<std::mutex> owner(owner_mutex_, std::defer_lock);
+    if (b.num_seqids() > 0) owner.lock();
+    return send_compound(b);
+}
+
+nfs4::CompoundResult Nfs4Client::send_compound(nfs4::CompoundBuilder& b) {
+    // RFC 7530 §8.6: during the server's grace period, the same ops again.
+    while (true) {
+        const uint32_t base = open_seqid_;
+        for (size_t i = 0; i < b.num_seqids(); ++i)
+            b.set_seqid(i, base + 1 + static_cast<uint32_t>(i));
+        open_seqid_ = base + static_cast<uint32_t>(b.num_seqids());   // if no reply
+        auto reply = nfs4::call_compound(rpc(), "", b.ops(), b.num_ops());
+        XdrDecoder dec(reply);
+        nfs4::CompoundResult r = b.decode(dec);
+
+        // Only the seqids of ops the server got to are used up, and not
+        // even those if it refused them as never applied (RFC 7530 §9.1.7).
+        uint32_t used = 0;
+        for (const auto& op : r.ops)
+            if ((op.op == nfs4::OP_OPEN || op.op == nfs4::OP_OPEN_CONFIRM ||
+                 op.op == nfs4::OP_CLOSE) && nfs4_seqid_advances(op.status))
+                ++used;
+        open_seqid_ = base + used;
+
+        if (r.status != static_cast<uint32_t>(Nfsstat4::NFS4ERR_GRACE)) return r;
+        std::this_thread::sleep_for(grace_delay_);
+    }
+}
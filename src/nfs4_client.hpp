@@ -1,35 +1,51 @@
 #pragma once
 
+#include "client_options.hpp"
+#include "dentry_cache.hpp"
 #include "nfs4/nfs4_types.hpp"
+#include "nfs4/compound_builder.hpp"
 #include "nfs4/nfs4_error.hpp"
 #include "nfs4/nfs4_attr.hpp"
 #include "nfs4/readdir.hpp"
 #include "rpc/rpc_client.hpp"
+#include "rpc/rpc_pool.hpp"
 #include "rpc/rpc_types.hpp"
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 // High-level NFSv4.0 client.
 //
-// On construction, resolves the NFS port via portmap, establishes a persistent
-// TCP connection, and performs the SETCLIENTID / SETCLIENTID_CONFIRM handshake
+// On construction, resolves the NFS port via portmap, establishes persistent
+// TCP connection(s) (`opts.nconnect`, default 1), and performs the SETCLIENTID / SETCLIENTID_CONFIRM handshake
 // to obtain a clientid4 from the server.
 //
 // All data operations (read, write) require an Nfs4File obtained via open_read()
 // or open_write() and must be paired with close().
+//
+// lookup() results, NFS4ERR_NOENT included, are cached per directory and
+// trusted while the directory's change attribute stays the same (see
+// DentryCache; off with `opts.lookup_cache = false`).
+//
+// Thread safety: all operations may be called concurrently on one instance.
+// OPEN, OPEN_CONFIRM and CLOSE are serialised because they share the
+// open-owner seqid; everything else runs in parallel on the connection(s).
 class Nfs4Client {
 public:
     // Connect to `host`, resolve its NFSv4 port, and register this client.
     // PUTROOTFH is sent with AUTH_NONE (works on servers that allow it).
-    explicit Nfs4Client(const std::string& host);
+    explicit Nfs4Client(const std::string& host, const ClientOptions& opts = {});
 
     // Same as above, but switches to AUTH_SYS credentials before PUTROOTFH+GETFH.
     // Use this when the server requires AUTH_SYS for filesystem access (e.g. Linux nfsd).
-    Nfs4Client(const std::string& host, const AuthSys& auth);
+    Nfs4Client(const std::string& host, const AuthSys& auth,
+               const ClientOptions& opts = {});
 
     // Switch to AUTH_SYS credentials for all subsequent calls.
     void set_auth_sys(const AuthSys& auth);
@@ -40,9 +56,18 @@ public:
     // Returns the root file handle (established in constructor via PUTROOTFH+GETFH).
     Nfs4Fh root_fh() const { return root_fh_; }
 
-    // Resolve a name inside a directory (COMPOUND: PUTFH + LOOKUP + GETFH).
+    // Resolve a name inside a directory (COMPOUND: PUTFH + LOOKUP + GETFH, with
+    // GETATTR(change) of the directory ahead of LOOKUP when caching).
     Nfs4Fh lookup(const Nfs4Fh& dir, const std::string& name);
 
+    // Resolve a slash-separated path from the root, or from `dir`, in one
+    // COMPOUND: PUTROOTFH/PUTFH + LOOKUP per name + GETFH + GETATTR.  ".."
+    // becomes LOOKUPP.  If the server answers NFS4ERR_RESOURCE, the path is
+    // walked in smaller pieces, and the smaller size is kept for later calls.
+    // Bypasses the lookup cache.
+    Nfs4PathInfo resolve_path(const std::string& path) { return resolve_path(root_fh_, path); }
+    Nfs4PathInfo resolve_path(const Nfs4Fh& dir, const std::string& path);
+
     // Get file attributes (COMPOUND: PUTFH + GETATTR).
     Fattr4 getattr(const Nfs4Fh& fh);
 
@@ -65,10 +90,38 @@ public:
     // Read up to `count` bytes from `f` at `offset`.
     std::vector<uint8_t> read(const Nfs4File& f, uint64_t offset, uint32_t count);
 
+    // Same, but the data is received directly into `buf` (at least `count`
+    // bytes).  Returns the number of bytes read.
+    uint32_t read_into(const Nfs4File& f, uint64_t offset, uint8_t* buf, uint32_t count);
+
     // Write `len` bytes to `f` at `offset`. Returns number of bytes written.
     uint32_t write(const Nfs4File& f, uint64_t offset, Stable4 stable,
                    const uint8_t* data, uint32_t len);
 
+    // Pipelined READ / WRITE: the COMPOUND is sent before these return (so
+    // `data` may be released at once); collect the result from the future.
+    // Many may be in flight on one connection.
+    std::future<std::vector<uint8_t>> read_async(const Nfs4File& f, uint64_t offset,
+                                                 uint32_t count);
+    std::future<uint32_t> write_async(const Nfs4File& f, uint64_t offset, Stable4 stable,
+                                      const uint8_t* data, uint32_t len);
+
+    // Read all of `name` in `dir` (COMPOUND: PUTFH + OPEN + GETFH + READ with
+    // the anonymous stateid, then PUTFH + CLOSE).  v4.0 has no current
+    // stateid, so CLOSE, which needs the one OPEN returned, takes a second
+    // round trip, and a third once per open-owner for OPEN_CONFIRM.  Reading
+    // goes on, a READ at a time, until the server reports EOF.
+    std::vector<uint8_t> read_whole_file(const Nfs4Fh& dir, const std::string& name);
+
+    // Create or truncate `name` and write `data` to it with FILE_SYNC, in
+    // the same COMPOUNDs as read_whole_file() with OPEN(CREATE) and WRITE.
+    void write_whole_file(const Nfs4Fh& dir, const std::string& name,
+                          const uint8_t* data, size_t len);
+    void write_whole_file(const Nfs4Fh& dir, const std::string& name,
+                          const std::vector<uint8_t>& data) {
+        write_whole_file(dir, name, data.data(), data.size());
+    }
+
     // Flush unstable writes to stable storage (COMPOUND: PUTFH + COMMIT).
     std::array<uint8_t, 8> commit(const Nfs4File& f,
                                    uint64_t offset = 0, uint32_t count = 0);
@@ -105,14 +158,69 @@ public:
 
     void renew();
 
+    // ── Batched COMPOUNDs ─────────────────────────────────────────────────────
+
+    // A CompoundBuilder whose OPENs are made for this client's open-owner.
+    nfs4::CompoundBuilder compound_builder() const;
+
+    // Send `b` as one COMPOUND, filling in its open-owner seqids first, and
+    // decode whatever results came back; only transport failures throw.
+    // A COMPOUND refused with NFS4ERR_GRACE is sent again after
+    // `opts.grace_delay`, as open_read() does.  Only the seqids of ops the
+    // server got to count as used, by the rules of RFC 7530 §9.1.7.
+    // NFSv4.0 has no current stateid: chain READ / WRITE / CLOSE to an OPEN
+    // in the same COMPOUND with the anonymous stateid and a later CLOSE.
+    nfs4::CompoundResult compound(nfs4::CompoundBuilder& b);
+
+    // The lookup cache, or null if disabled by ClientOptions.
+    DentryCache<Nfs4Fh>* lookup_cache() { return dentry_cache_.get(); }
+
 private:
     // Perform OPEN and optional OPEN_CONFIRM; return the opened Nfs4File.
     Nfs4File do_open(const Nfs4Fh& dir, const std::string& name,
                      uint32_t share_access, bool create);
 
-    std::string                    host_;
-    std::unique_ptr<TcpRpcClient>  rpc_;
-    Nfs4Fh                         root_fh_;
-    uint64_t                       clientid_{};
-    uint32_t                       open_seqid_{0};
+    // One READ COMPOUND, with its eof flag.
+    Nfs4ReadResult read_once(const Nfs4File& f, uint64_t offset, uint32_t count);
+
+    // compound() for a caller already holding owner_mutex_ if `b` carries
+    // seqids.
+    nfs4::CompoundResult send_compound(nfs4::CompoundBuilder& b);
+
+    // Send `b`, which starts PUTFH, OPEN, GETFH, and set `f` to the file it
+    // opened, confirmed before the open-owner is let go (RFC 7530 §16.18.5).
+    // Throws, leaving nothing open, if the OPEN or GETFH failed; otherwise
+    // the caller checks the rest of the result and closes `f`.
+    nfs4::CompoundResult open_compound(nfs4::CompoundBuilder& b, const Nfs4Fh& dir,
+                                       const std::string& name, Nfs4File& f);
+
+    // OPEN_CONFIRM `f` if `open` asks for it.  Caller holds owner_mutex_.
+    void confirm_locked(Nfs4File& f, const nfs4::Open4Result& open);
+
+    // Connection for the next COMPOUND.  The clientid is per client, not per
+    // connection, so any connection will do in v4.0.
+    TcpRpcClient& rpc() { return pool_->pick(); }
+
+    // One COMPOUND of resolve_path(): look up `count` names from `at.fh`,
+    // and fetch the attributes as well if these are the last ones.
+    void resolve_step(Nfs4PathInfo& at, const std::vector<std::string>& names,
+                      size_t first, size_t count, bool last);
+
+    // Re-read the change attribute of `dir` for the lookup cache.
+    void revalidate_dir(const Nfs4Fh& dir);
+
+    // Our own namespace changes, recorded in the lookup cache.
+    void name_added(const Nfs4Fh& dir, const std::string& name, const Nfs4Fh& fh);
+    void name_removed(const Nfs4Fh& dir, const std::string& name);
+
+    std::string                        host_;
+    std::unique_ptr<RpcConnectionPool> pool_;
+    Nfs4Fh                             root_fh_;
+    uint64_t                           clientid_{};
+    std::mutex                         owner_mutex_;    // guards open_seqid_ round trips
+    uint32_t                           open_seqid_{0};
+    std::unique_ptr<DentryCache<Nfs4Fh>> dentry_cache_;
+    uint32_t                           max_io_{1u << 20};  // read/write_whole_file() chunk
+    std::chrono::milliseconds          grace_delay_{5000};  // before an NFS4ERR_GRACE retry
+    std::atomic<uint32_t>              max_path_lookups_{UINT32_MAX};  // per resolve_path() COMPOUND
 };
@@ -16,158 +16,248 @@
 #include "nfs/readdirplus.hpp"
 #include "nfs/symlink.hpp"
 #include "nfs/mknod.hpp"
+#include "path.hpp"
 
 static constexpr uint32_t NFS_PROG = 100003;
 static constexpr uint32_t NFS_VERS = 3;
 
-NFSClient::NFSClient(const std::string& host) : host_(host) {
-    const uint16_t port = nfs3::getport(host_, NFS_PROG, NFS_VERS);
-    nfs_conn_ = std::make_unique<TcpRpcClient>(host_, port);
+// What the lookup cache tracks of a directory: its mtime.
+static uint64_t dir_version(const Fattr3& a) {
+    return uint64_t(a.mtime.seconds) << 32 | a.mtime.nseconds;
+}
+
+NFSClient::NFSClient(const std::string& host, const ClientOptions& opts)
+    : host_(host), pmap_port_(opts.portmap_port) {
+    const uint16_t port = nfs3::getport(host_, NFS_PROG, NFS_VERS, pmap_port_);
+    pool_ = std::make_unique<RpcConnectionPool>(host_, port, opts.nconnect,
+                                                opts.conn_policy);
+    if (opts.attr_cache)
+        attr_cache_ = std::make_unique<nfs3::AttrCache>(opts.attr_timeouts);
+    if (opts.attr_cache && opts.lookup_cache)
+        dentry_cache_ = std::make_unique<DentryCache<Fh3>>(opts.attr_timeouts.acdirmin);
 }
 
 void NFSClient::set_auth_sys(const AuthSys& auth) {
-    nfs_conn_->set_auth_sys(auth);
+    pool_->set_auth_sys(auth);
 }
 
 void NFSClient::clear_auth() {
-    nfs_conn_->clear_auth();
+    pool_->clear_auth();
 }
 
 Fh3 NFSClient::mount(const std::string& export_path) {
-    return nfs3::mnt(host_, export_path);
+    return nfs3::mnt(host_, export_path, pmap_port_);
 }
 
 Fattr3 NFSClient::getattr(const Fh3& fh) {
-    return nfs3::getattr(*nfs_conn_, fh);
+    if (attr_cache_) {
+        if (auto cached = attr_cache_->get(fh)) return *cached;
+    }
+    return nfs3::getattr(conn(), fh, attr_cache_.get());
 }
 
 Fh3 NFSClient::lookup(const Fh3& dir, const std::string& name) {
-    return nfs3::lookup(*nfs_conn_, dir, name);
+    if (!dentry_cache_) return nfs3::lookup(conn(), dir, name, attr_cache_.get());
+
+    using State = DentryCache<Fh3>::State;
+    auto hit = dentry_cache_->get(dir, name);
+    if (hit.state == State::REVALIDATE) {
+        // One GETATTR re-confirms every name cached under `dir`.
+        nfs3::getattr(conn(), dir, attr_cache_.get());
+        observe_dir(dir);
+        hit = dentry_cache_->get(dir, name);
+    }
+    if (hit.state == State::FOUND) return hit.fh;
+    if (hit.state == State::NOT_FOUND)
+        throw NfsError(static_cast<uint32_t>(Nfsstat3::NFS3ERR_NOENT), "LOOKUP");
+
+    try {
+        const Fh3 fh = nfs3::lookup(conn(), dir, name, attr_cache_.get());
+        observe_dir(dir);
+        dentry_cache_->put(dir, name, fh);
+        return fh;
+    } catch (const NfsError& e) {
+        if (e.is(Nfsstat3::NFS3ERR_NOENT)) {
+            observe_dir(dir);
+            dentry_cache_->put_negative(dir, name);
+        }
+        throw;
+    }
+}
+
+Fh3 NFSClient::resolve_path(const Fh3& dir, const std::string& path) {
+    Fh3 fh = dir;
+    for (const std::string& name : split_path(path)) {
+        // A directory's ".." changes when it is moved, which its mtime does
+        // not show, so it is not cached.
+        fh = name == ".." ? nfs3::lookup(conn(), fh, name, attr_cache_.get())
+                          : lookup(fh, name);
+    }
+    return fh;
+}
+
+void NFSClient::observe_dir(const Fh3& dir) {
+    if (auto attrs = attr_cache_->get(dir)) dentry_cache_->observe_dir(dir, dir_version(*attrs));
+}
+
+Fh3 NFSClient::name_added(const Fh3& dir, const std::string& name, const Fh3& fh) {
+    if (dentry_cache_) dentry_cache_->put(dir, name, fh);
+    return fh;
+}
+
+void NFSClient::name_removed(const Fh3& dir, const std::string& name) {
+    if (dentry_cache_) dentry_cache_->put_negative(dir, name);
 }
 
 std::vector<uint8_t> NFSClient::read(const Fh3& fh, uint64_t offset, uint32_t count) {
-    return nfs3::read(*nfs_conn_, fh, offset, count);
+    return nfs3::read(conn(), fh, offset, count, attr_cache_.get());
+}
+
+ReadResult NFSClient::read_into(const Fh3& fh, uint64_t offset, uint8_t* buf,
+                                uint32_t count) {
+    return nfs3::read_into(conn(), fh, offset, buf, count, attr_cache_.get());
 }
 
 WriteResult NFSClient::write(const Fh3& fh, uint64_t offset, Stable3 stable,
                               const uint8_t* data, size_t data_size) {
-    return nfs3::write(*nfs_conn_, fh, offset, stable, data, data_size);
+    return nfs3::write(conn(), fh, offset, stable, data, data_size, attr_cache_.get());
+}
+
+std::future<std::vector<uint8_t>> NFSClient::read_async(const Fh3& fh, uint64_t offset,
+                                                       uint32_t count) {
+    return nfs3::read_async(conn(), fh, offset, count, attr_cache_.get());
+}
+
+std::future<WriteResult> NFSClient::write_async(const Fh3& fh, uint64_t offset,
+                                                Stable3 stable,
+                                                const uint8_t* data, size_t data_size) {
+    return nfs3::write_async(conn(), fh, offset, stable, data, data_size, attr_cache_.get());
 }
 
 Fh3 NFSClient::create(const Fh3& dir, const std::string& name,
                        nfs3::CreateMode3 mode, const Sattr3& attrs) {
-    return nfs3::create(*nfs_conn_, dir, name, mode, attrs);
+    return name_added(dir, name,
+                      nfs3::create(conn(), dir, name, mode, attrs, attr_cache_.get()));
 }
 
 Fh3 NFSClient::create_exclusive(const Fh3& dir, const std::string& name,
                                  const nfs3::CreateVerf3& verf) {
-    return nfs3::create_exclusive(*nfs_conn_, dir, name, verf);
+    return name_added(dir, name,
+                      nfs3::create_exclusive(conn(), dir, name, verf, attr_cache_.get()));
 }
 
 Fh3 NFSClient::mkdir(const Fh3& dir, const std::string& name, const Sattr3& attrs) {
-    return nfs3::mkdir(*nfs_conn_, dir, name, attrs);
+    return name_added(dir, name, nfs3::mkdir(conn(), dir, name, attrs, attr_cache_.get()));
 }
 
 void NFSClient::remove(const Fh3& dir, const std::string& name) {
-    return nfs3::remove(*nfs_conn_, dir, name);
+    nfs3::remove(conn(), dir, name, attr_cache_.get());
+    name_removed(dir, name);
 }
 
 void NFSClient::rmdir(const Fh3& dir, const std::string& name) {
-    return nfs3::rmdir(*nfs_conn_, dir, name);
+    nfs3::rmdir(conn(), dir, name, attr_cache_.get());
+    name_removed(dir, name);
 }
 
 void NFSClient::setattr(const Fh3& fh, const Sattr3& attrs,
                          const nfs3::SattrGuard3& guard) {
-    nfs3::setattr(*nfs_conn_, fh, attrs, guard);
+    nfs3::setattr(conn(), fh, attrs, guard, attr_cache_.get());
 }
 
 nfs3::ReaddirPage NFSClient::readdir_page(const Fh3& dir,
                                             uint64_t cookie,
                                             const std::array<uint8_t, 8>& cookieverf,
                                             uint32_t count) {
-    return nfs3::readdir_page(*nfs_conn_, dir, cookie, cookieverf, count);
+    return nfs3::readdir_page(conn(), dir, cookie, cookieverf, count, attr_cache_.get());
 }
 
 std::vector<nfs3::DirEntry3> NFSClient::readdir(const Fh3& dir, uint32_t count) {
-    return nfs3::readdir(*nfs_conn_, dir, count);
+    return nfs3::readdir(conn(), dir, count, attr_cache_.get());
 }
 
 void NFSClient::rename(const Fh3& from_dir, const std::string& from_name,
                         const Fh3& to_dir,   const std::string& to_name) {
-    nfs3::rename(*nfs_conn_, from_dir, from_name, to_dir, to_name);
+    nfs3::rename(conn(), from_dir, from_name, to_dir, to_name, attr_cache_.get());
+    name_removed(from_dir, from_name);
+    if (dentry_cache_) dentry_cache_->forget(to_dir, to_name);
 }
 
 nfs3::CommitVerf3 NFSClient::commit(const Fh3& fh, uint64_t offset, uint32_t count) {
-    return nfs3::commit(*nfs_conn_, fh, offset, count);
+    return nfs3::commit(conn(), fh, offset, count, attr_cache_.get());
 }
 
 uint32_t NFSClient::access(const Fh3& fh, uint32_t access_mask) {
-    return nfs3::access(*nfs_conn_, fh, access_mask);
+    return nfs3::access(conn(), fh, access_mask, attr_cache_.get());
 }
 
 nfs3::FsstatResult NFSClient::fsstat(const Fh3& root) {
-    return nfs3::fsstat(*nfs_conn_, root);
+    return nfs3::fsstat(conn(), root, attr_cache_.get());
 }
 
 nfs3::FsinfoResult NFSClient::fsinfo(const Fh3& root) {
-    return nfs3::fsinfo(*nfs_conn_, root);
+    return nfs3::fsinfo(conn(), root, attr_cache_.get());
 }
 
 nfs3::PathconfResult NFSClient::pathconf(const Fh3& fh) {
-    return nfs3::pathconf(*nfs_conn_, fh);
+    return nfs3::pathconf(conn(), fh, attr_cache_.get());
 }
 
 std::string NFSClient::readlink(const Fh3& symlink_fh) {
-    return nfs3::readlink(*nfs_conn_, symlink_fh);
+    return nfs3::readlink(conn(), symlink_fh, attr_cache_.get());
 }
 
 Fh3 NFSClient::symlink(const Fh3& dir, const std::string& name,
                         const std::string& target, const Sattr3& attrs) {
-    return nfs3::symlink(*nfs_conn_, dir, name, target, attrs);
+    return name_added(dir, name,
+                      nfs3::symlink(conn(), dir, name, target, attrs, attr_cache_.get()));
 }
 
 void NFSClient::link(const Fh3& file, const Fh3& link_dir,
                      const std::string& link_name) {
-    nfs3::link(*nfs_conn_, file, link_dir, link_name);
+    nfs3::link(conn(), file, link_dir, link_name, attr_cache_.get());
+    name_added(link_dir, link_name, file);
 }
 
 Fh3 NFSClient::mknod_fifo(const Fh3& dir, const std::string& name,
                             const Sattr3& attrs) {
-    return nfs3::mknod_fifo(*nfs_conn_, dir, name, attrs);
+    return name_added(dir, name, nfs3::mknod_fifo(conn(), dir, name, attrs, attr_cache_.get()));
 }
 
 Fh3 NFSClient::mknod_socket(const Fh3& dir, const std::string& name,
                               const Sattr3& attrs) {
-    return nfs3::mknod_socket(*nfs_conn_, dir, name, attrs);
+    return name_added(dir, name, nfs3::mknod_socket(conn(), dir, name, attrs, attr_cache_.get()));
 }
 
 Fh3 NFSClient::mknod_chr(const Fh3& dir, const std::string& name,
                            const Sattr3& attrs, const nfs3::DeviceSpec3& spec) {
-    return nfs3::mknod_chr(*nfs_conn_, dir, name, attrs, spec);
+    return name_added(dir, name,
+                      nfs3::mknod_chr(conn(), dir, name, attrs, spec, attr_cache_.get()));
 }
 
 Fh3 NFSClient::mknod_blk(const Fh3& dir, const std::string& name,
                            const Sattr3& attrs, const nfs3::DeviceSpec3& spec) {
-    return nfs3::mknod_blk(*nfs_conn_, dir, name, attrs, spec);
+    return name_added(dir, name,
+                      nfs3::mknod_blk(conn(), dir, name, attrs, spec, attr_cache_.get()));
 }
 
 nfs3::ReaddirplusPage NFSClient::readdirplus_page(
         const Fh3& dir, uint64_t cookie,
         const std::array<uint8_t, 8>& cookieverf,
         uint32_t dircount, uint32_t maxcount) {
-    return nfs3::readdirplus_page(*nfs_conn_, dir, cookie, cookieverf,
-                                   dircount, maxcount);
+    return nfs3::readdirplus_page(conn(), dir, cookie, cookieverf,
+                                   dircount, maxcount, attr_cache_.get());
 }
 
 std::vector<nfs3::DirEntryPlus3> NFSClient::readdirplus(
         const Fh3& dir, uint32_t dircount, uint32_t maxcount) {
-    return nfs3::readdirplus(*nfs_conn_, dir, dircount, maxcount);
+    return nfs3::readdirplus(conn(), dir, dircount, maxcount, attr_cache_.get());
 }
 
 void NFSClient::umnt(const std::string& export_path) {
-    nfs3::umnt(host_, export_path);
+    nfs3::umnt(host_, export_path, pmap_port_);
 }
 
 std::vector<nfs3::ExportEntry> NFSClient::export_list() {
-    return nfs3::export_list(host_);
+    return nfs3::export_list(host_, pmap_port_);
 }
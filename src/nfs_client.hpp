@@ -1,8 +1,11 @@
 #pragma once
 
+#include "client_options.hpp"
+#include "dentry_cache.hpp"
 #include "nfs/nfs3_types.hpp"
 #include "nfs/nfs_error.hpp"
 #include "nfs/access.hpp"
+#include "nfs/attr_cache.hpp"
 #include "nfs/commit.hpp"
 #include "nfs/create.hpp"
 #include "nfs/fsinfo.hpp"
@@ -14,23 +17,36 @@
 #include "nfs/setattr.hpp"
 #include "nfs/symlink.hpp"
 #include "rpc/rpc_client.hpp"
+#include "rpc/rpc_pool.hpp"
 #include "rpc/rpc_types.hpp"
 
 #include <array>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
 // High-level NFSv3 client.
 //
-// On construction, resolves the NFS port via portmap and establishes a
-// persistent TCP connection to the NFS daemon.
+// On construction, resolves the NFS port via portmap and establishes
+// persistent TCP connection(s) to the NFS daemon — one by default, or
+// `opts.nconnect` with each call routed by `opts.conn_policy`.
 //
 // mount() opens a separate short-lived connection to mountd each call.
+//
+// Attributes returned by any call are kept in an attribute cache (unless
+// `opts.attr_cache` is off), and getattr() is answered from it while the
+// entry is fresh; see nfs3::AttrCache for the timeouts and wcc checks.
+// lookup() results, failures with NFS3ERR_NOENT included, are likewise kept
+// in a DentryCache checked against the directory's mtime.
+//
+// Thread safety: NFSv3 is stateless, so every operation may be called
+// concurrently on one instance; concurrent calls are pipelined on the
+// connection(s).
 class NFSClient {
 public:
-    explicit NFSClient(const std::string& host);
+    explicit NFSClient(const std::string& host, const ClientOptions& opts = {});
 
     // Switch to AUTH_SYS credentials for all subsequent NFS calls.
     void set_auth_sys(const AuthSys& auth);
@@ -45,15 +61,29 @@ public:
 
     // ── File operations ──────────────────────────────────────────────────────
 
-    // NFSPROC3_GETATTR (proc 1): return file attributes.
+    // NFSPROC3_GETATTR (proc 1): return file attributes, from the attribute
+    // cache if they are still fresh there.
     Fattr3 getattr(const Fh3& fh);
 
-    // NFSPROC3_LOOKUP (proc 3): resolve a name inside a directory.
+    // NFSPROC3_LOOKUP (proc 3): resolve a name inside a directory, from the
+    // lookup cache while the directory is unchanged.
     Fh3 lookup(const Fh3& dir, const std::string& name);
 
+    // Resolve a slash-separated path from `dir` (e.g. the handle mount()
+    // returned), one lookup() per name.  NFSv3 has no way to chain them in
+    // one call, so each name the lookup cache cannot answer costs a round
+    // trip; repeated paths are served from the cache.  ".." is always asked
+    // of the server.
+    Fh3 resolve_path(const Fh3& dir, const std::string& path);
+
     // NFSPROC3_READ (proc 6): read up to `count` bytes from `fh` at `offset`.
     std::vector<uint8_t> read(const Fh3& fh, uint64_t offset, uint32_t count);
 
+    // Same, but the data is received directly into `buf` (at least `count`
+    // bytes).  One READ: it may return fewer than `count` bytes before EOF,
+    // which only `eof` in the result reports.
+    ReadResult read_into(const Fh3& fh, uint64_t offset, uint8_t* buf, uint32_t count);
+
     // NFSPROC3_WRITE (proc 7): write `data_size` bytes to `fh` at `offset`.
     WriteResult write(const Fh3& fh, uint64_t offset, Stable3 stable,
                       const uint8_t* data, size_t data_size);
@@ -63,6 +93,13 @@ public:
         return write(fh, offset, stable, data.data(), data.size());
     }
 
+    // Pipelined READ / WRITE: send now, collect the result from the future.
+    // Many may be outstanding at once on the same connection.
+    std::future<std::vector<uint8_t>> read_async(const Fh3& fh, uint64_t offset,
+                                                 uint32_t count);
+    std::future<WriteResult> write_async(const Fh3& fh, uint64_t offset, Stable3 stable,
+                                         const uint8_t* data, size_t data_size);
+
     // NFSPROC3_CREATE (proc 8): create a file. Returns the new file's handle.
     Fh3 create(const Fh3& dir, const std::string& name,
                 nfs3::CreateMode3 mode = nfs3::CreateMode3::UNCHECKED,
@@ -160,7 +197,26 @@ public:
     // MOUNTPROC3_EXPORT (proc 5): retrieve the server's export list.
     std::vector<nfs3::ExportEntry> export_list();
 
+    // The attribute cache, or null if disabled by ClientOptions.
+    nfs3::AttrCache* attr_cache() { return attr_cache_.get(); }
+
+    // The lookup cache, or null if disabled by ClientOptions.
+    DentryCache<Fh3>* lookup_cache() { return dentry_cache_.get(); }
+
 private:
-    std::string                  host_;
-    std::unique_ptr<TcpRpcClient> nfs_conn_;
+    // Connection for the next NFS call.
+    TcpRpcClient& conn() { return pool_->pick(); }
+
+    // Our own namespace changes, recorded in the lookup cache.
+    Fh3  name_added(const Fh3& dir, const std::string& name, const Fh3& fh);
+    void name_removed(const Fh3& dir, const std::string& name);
+
+    // Pass the attribute cache's mtime of `dir` on to the lookup cache.
+    void observe_dir(const Fh3& dir);
+
+    std::string                        host_;
+    uint16_t                           pmap_port_;
+    std::unique_ptr<RpcConnectionPool> pool_;
+    std::unique_ptr<nfs3::AttrCache>   attr_cache_;
+    std::unique_ptr<DentryCache<Fh3>>  dentry_cache_;
 };
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Split a slash-separated path into the names to look up one after another.
+// Empty components (leading, trailing or doubled slashes) and "." are
+// dropped; ".." is kept for the caller to resolve against the server.
+inline std::vector<std::string> split_path(const std::string& path) {
+    std::vector<std::string> names;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (end > start) {
+            std::string name = path.substr(start, end - start);
+            if (name != ".") names.push_back(std::move(name));
+        }
+        start = end + 1;
+    }
+    return names;
+}
@@ -0,0 +1,188 @@
+#include "record_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+
+// ── Socket helpers ───────────────────────────────────────────────────────────
+
+size_t RecordReader::recv_some(uint8_t* dst, size_t n) {
+    const ssize_t got = recv(sock_, dst, n, 0);
+    if (got <= 0) {
+        failed_ = true;
+        throw std::runtime_error("recv() record data failed");
+    }
+    return static_cast<size_t>(got);
+}
+
+void RecordReader::recv_exact(uint8_t* dst, size_t n) {
+    size_t received = 0;
+    while (received < n) received += recv_some(dst + received, n - received);
+}
+
+bool RecordReader::next_fragment() {
+    // Zero-length fragments are legal, hence the loop.
+    while (frag_left_ == 0) {
+        if (started_ && last_) return false;
+
+        uint8_t mark_buf[4];
+        size_t received = 0;
+        while (received < 4) {
+            const ssize_t n = recv(sock_, mark_buf + received, 4 - received, 0);
+            if (n <= 0) {
+                failed_ = true;
+                throw std::runtime_error("recv() record mark failed");
+            }
+            received += static_cast<size_t>(n);
+        }
+
+        const uint32_t mark =
+            (static_cast<uint32_t>(mark_buf[0]) << 24) |
+            (static_cast<uint32_t>(mark_buf[1]) << 16) |
+            (static_cast<uint32_t>(mark_buf[2]) <<  8) |
+             static_cast<uint32_t>(mark_buf[3]);
+
+        started_   = true;
+        last_      = (mark & 0x80000000u) != 0;
+        frag_left_ = mark & 0x7FFFFFFFu;
+    }
+    return true;
+}
+
+void RecordReader::stage(size_t n) {
+    if (stage_len_ - stage_pos_ >= n) return;
+
+    // Slide the unread tail to the front, then top up from the socket.  A
+    // single recv() may bring in more than asked for (up to the end of the
+    // fragment), which saves syscalls on header-heavy replies.
+    const size_t have = stage_len_ - stage_pos_;
+    std::memmove(stage_, stage_ + stage_pos_, have);
+    stage_pos_ = 0;
+    stage_len_ = have;
+
+    while (stage_len_ < n) {
+        if (!next_fragment())
+            throw std::runtime_error("RPC: record truncated");
+        const size_t want = std::min(sizeof(stage_) - stage_len_,
+                                     static_cast<size_t>(frag_left_));
+        const size_t got = recv_some(stage_ + stage_len_, want);
+        stage_len_ += got;
+        frag_left_ -= static_cast<uint32_t>(got);
+    }
+}
+
+void RecordReader::check_length(size_t n) const {
+    if (started_ && last_ && n > stage_len_ - stage_pos_ + frag_left_)
+        throw std::runtime_error("XDR: length " + std::to_string(n) +
+                                 " runs past the end of the record");
+}
+
+// ── XDR items ────────────────────────────────────────────────────────────────
+
+// Alignment padding after `len` bytes of opaque data.  size_t, so that a
+// length near 2^32 cannot wrap.
+static size_t xdr_pad(size_t len) { return (4 - len % 4) % 4; }
+
+uint32_t RecordReader::get_uint32() {
+    stage(4);
+    const uint8_t* p = stage_ + stage_pos_;
+    stage_pos_ += 4;
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) <<  8) |
+            static_cast<uint32_t>(p[3]);
+}
+
+uint64_t RecordReader::get_uint64() {
+    const uint64_t hi = get_uint32();
+    const uint64_t lo = get_uint32();
+    return (hi << 32) | lo;
+}
+
+std::string RecordReader::get_string() {
+    const size_t len = get_uint32();
+    check_length(len + xdr_pad(len));
+    // Grow with the bytes that actually arrive: in a record whose last
+    // fragment is still to come, a bogus length cannot be caught up front.
+    std::string s;
+    while (s.size() < len) {
+        const size_t at = s.size();
+        s.resize(at + std::min<size_t>(len - at, 64 * 1024));
+        read(reinterpret_cast<uint8_t*>(&s[at]), s.size() - at);
+    }
+    skip(xdr_pad(len));
+    return s;
+}
+
+size_t RecordReader::get_opaque_into(uint8_t* dst, size_t max) {
+    const size_t len = get_uint32();
+    if (len > max)
+        throw std::runtime_error("XDR: opaque length " + std::to_string(len) +
+                                 " exceeds buffer of " + std::to_string(max));
+    check_length(len + xdr_pad(len));
+    read(dst, len);
+    skip(xdr_pad(len));
+    return len;
+}
+
+void RecordReader::skip_opaque() {
+    const size_t len = get_uint32();
+    check_length(len + xdr_pad(len));
+    skip(len + xdr_pad(len));
+}
+
+// ── Bulk bytes ───────────────────────────────────────────────────────────────
+
+void RecordReader::read(uint8_t* dst, size_t n) {
+    // Whatever is already staged first, then straight from the socket.
+    const size_t staged = std::min(n, stage_len_ - stage_pos_);
+    std::memcpy(dst, stage_ + stage_pos_, staged);
+    stage_pos_ += staged;
+    dst += staged;
+    n   -= staged;
+
+    while (n > 0) {
+        if (!next_fragment())
+            throw std::runtime_error("RPC: record truncated");
+        const size_t chunk = std::min(n, static_cast<size_t>(frag_left_));
+        recv_exact(dst, chunk);
+        frag_left_ -= static_cast<uint32_t>(chunk);
+        dst += chunk;
+        n   -= chunk;
+    }
+}
+
+void RecordReader::skip(size_t n) {
+    const size_t staged = std::min(n, stage_len_ - stage_pos_);
+    stage_pos_ += staged;
+    n -= staged;
+
+    // The stage is empty now; reuse it as a scratch buffer.
+    while (n > 0) {
+        if (!next_fragment())
+            throw std::runtime_error("RPC: record truncated");
+        const size_t chunk = std::min({n, sizeof(stage_),
+                                       static_cast<size_t>(frag_left_)});
+        const size_t got = recv_some(stage_, chunk);
+        frag_left_ -= static_cast<uint32_t>(got);
+        n -= got;
+    }
+}
+
+void RecordReader::read_rest(std::vector<uint8_t>& out) {
+    out.insert(out.end(), stage_ + stage_pos_, stage_ + stage_len_);
+    stage_pos_ = stage_len_ = 0;
+
+    while (next_fragment()) {
+        const size_t offset = out.size();
+        out.resize(offset + frag_left_);
+        recv_exact(out.data() + offset, frag_left_);
+        frag_left_ = 0;
+    }
+}
+
+void RecordReader::drain() {
+    stage_pos_ = stage_len_ = 0;
+    while (next_fragment()) skip(frag_left_);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Streaming reader for one RFC 5531 record arriving on a TCP socket.
+//
+// Small XDR items (status words, attributes, the opaque length prefix) are
+// decoded out of a little staging buffer; bulk bytes requested with read() /
+// get_opaque_into() are recv()d straight into the caller's memory.  The reader
+// never pulls bytes past the end of its record off the socket, so the stream
+// stays aligned on the next record mark once drain() has run.
+//
+// Fragment boundaries are handled transparently.
+class RecordReader {
+public:
+    explicit RecordReader(int sock) : sock_(sock) {}
+
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    uint32_t get_uint32();
+    uint64_t get_uint64();
+
+    // String: 4-byte length, bytes, alignment padding.  Like the opaque
+    // readers below, throws if the length runs past the end of the record.
+    std::string get_string();
+
+    // Variable-length opaque read directly into `dst`; returns its length.
+    // Throws if the encoded length exceeds `max`.
+    size_t get_opaque_into(uint8_t* dst, size_t max);
+
+    // Step over a variable-length opaque / string.
+    void skip_opaque();
+
+    // Exactly `n` raw bytes (no padding handling).
+    void read(uint8_t* dst, size_t n);
+    void skip(size_t n);
+
+    // Append everything left in the record to `out`.
+    void read_rest(std::vector<uint8_t>& out);
+
+    // Discard everything left in the record.
+    void drain();
+
+    // True once a recv() has failed: the connection is no longer usable and
+    // the stream position is unknown.
+    bool failed() const { return failed_; }
+
+private:
+    // Ensure at least one unread byte of the record lies in the current
+    // fragment (reading fragment marks as needed).  False at end of record.
+    bool next_fragment();
+
+    // Make at least `n` (<= sizeof(stage_)) bytes available in the stage.
+    void stage(size_t n);
+
+    // Throw unless `n` more bytes may still be in the record.  The rest of
+    // the record is known once its last fragment has begun.
+    void check_length(size_t n) const;
+
+    void recv_exact(uint8_t* dst, size_t n);
+    size_t recv_some(uint8_t* dst, size_t n);
+
+    int      sock_;
+    uint32_t frag_left_ = 0;      // bytes of the current fragment still on the socket
+    bool     started_   = false;  // first fragment mark has been read
+    bool     last_      = false;  // current fragment is the last one
+    bool     failed_    = false;
+
+    uint8_t  stage_[256];
+    size_t   stage_pos_ = 0;
+    size_t   stage_len_ = 0;
+};
@@ -2,10 +2,14 @@
 #include "rpc_types.hpp"
 #include "../xdr/xdr.hpp"
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <climits>
+#include <cstring>
 #include <netdb.h>
 #include <stdexcept>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 // ── Construction / Destruction ───────────────────────────────────────────────
@@ -36,28 +40,29 @@ TcpRpcClient::TcpRpcClient(const std::string& host, uint16_t port)
 }
 
 TcpRpcClient::~TcpRpcClient() {
+    if (reader_.joinable()) {
+        // Wake the reader out of recv(); it fails any calls still pending.
+        shutdown(sock_, SHUT_RDWR);
+        reader_.join();
+    }
     if (sock_ >= 0) close(sock_);
 }
 
 // ── Auth management ──────────────────────────────────────────────────────────
 
 void TcpRpcClient::set_auth_sys(const AuthSys& auth) {
-    auth_sys_ = std::make_unique<AuthSys>(auth);
+    std::atomic_store(&auth_sys_, std::shared_ptr<const AuthSys>(std::make_shared<AuthSys>(auth)));
 }
 
 void TcpRpcClient::clear_auth() {
-    auth_sys_.reset();
+    std::atomic_store(&auth_sys_, std::shared_ptr<const AuthSys>());
 }
 
 // ── Pure helpers (also used by unit tests) ───────────────────────────────────
 
-std::vector<uint8_t> TcpRpcClient::buildCallMessage(uint32_t xid,
-                                                      uint32_t prog,
-                                                      uint32_t vers,
-                                                      uint32_t proc,
-                                                      const std::vector<uint8_t>& args,
-                                                      const AuthSys* auth) {
-    XdrEncoder enc;
+void TcpRpcClient::encodeCallHeader(XdrEncoder& enc, uint32_t xid,
+                                    uint32_t prog, uint32_t vers, uint32_t proc,
+                                    const AuthSys* auth) {
     enc.put_uint32(xid);
     enc.put_uint32(static_cast<uint32_t>(MsgType::CALL));
     enc.put_uint32(RPC_VERSION);
@@ -66,17 +71,17 @@ std::vector<uint8_t> TcpRpcClient::buildCallMessage(uint32_t xid,
     enc.put_uint32(proc);
 
     if (auth) {
-        // AUTH_SYS credential body (RFC 5531 §8.1)
-        XdrEncoder cred_body;
-        cred_body.put_uint32(auth->stamp);
-        cred_body.put_string(auth->machinename);
-        cred_body.put_uint32(auth->uid);
-        cred_body.put_uint32(auth->gid);
-        cred_body.put_uint32(static_cast<uint32_t>(auth->gids.size()));
-        for (uint32_t g : auth->gids) cred_body.put_uint32(g);
-
+        // AUTH_SYS credential body (RFC 5531 §8.1), encoded in place behind
+        // its length word.
         enc.put_uint32(AUTH_SYS_FLAV);
-        enc.put_opaque(cred_body.release());
+        const size_t len_at = enc.mark();
+        enc.put_uint32(0);
+        enc.put_uint32(auth->stamp);
+        enc.put_string(auth->machinename);
+        enc.put_uint32(auth->uid);
+        enc.put_uint32(auth->gid);
+        enc.put_uint32_array(auth->gids.data(), auth->gids.size());
+        enc.patch_uint32(len_at, static_cast<uint32_t>(enc.mark() - len_at - 4));
     } else {
         // AUTH_NONE credential: flavor=0, body_len=0
         enc.put_uint32(AUTH_NONE);
@@ -86,7 +91,16 @@ std::vector<uint8_t> TcpRpcClient::buildCallMessage(uint32_t xid,
     // Verifier is always AUTH_NONE
     enc.put_uint32(AUTH_NONE);
     enc.put_uint32(0);
+}
 
+std::vector<uint8_t> TcpRpcClient::buildCallMessage(uint32_t xid,
+                                                      uint32_t prog,
+                                                      uint32_t vers,
+                                                      uint32_t proc,
+                                                      const std::vector<uint8_t>& args,
+                                                      const AuthSys* auth) {
+    XdrEncoder enc;
+    encodeCallHeader(enc, xid, prog, vers, proc, auth);
     auto buf = enc.release();
     buf.insert(buf.end(), args.begin(), args.end());
     return buf;
@@ -106,7 +120,7 @@ std::vector<uint8_t> TcpRpcClient::addRecordMark(const std::vector<uint8_t>& pay
     return result;
 }
 
-std::vector<uint8_t> TcpRpcClient::parseReply(const std::vector<uint8_t>& record) {
+size_t TcpRpcClient::parseReply(const std::vector<uint8_t>& record) {
     XdrDecoder dec(record);
     /* xid        */ dec.get_uint32();
 
@@ -121,81 +135,343 @@ std::vector<uint8_t> TcpRpcClient::parseReply(const std::vector<uint8_t>& record
 
     // verifier: auth_flavor + variable-length body
     /* verf_flavor */ dec.get_uint32();
-    /* verf_body   */ dec.get_opaque();
+    /* verf_body   */ dec.skip_opaque();
 
     const auto accept_stat = dec.get_uint32();
     if (accept_stat != static_cast<uint32_t>(AcceptStat::SUCCESS))
         throw std::runtime_error("RPC: not accepted (accept_stat=" +
                                  std::to_string(accept_stat) + ")");
 
-    return dec.get_remaining();
+    return dec.offset();
 }
 
 // ── Network I/O ──────────────────────────────────────────────────────────────
 
-void TcpRpcClient::sendAll(const std::vector<uint8_t>& data) {
-    size_t total = 0;
-    while (total < data.size()) {
-        const ssize_t n = send(sock_, data.data() + total, data.size() - total, 0);
-        if (n <= 0)
-            throw std::runtime_error("send() failed");
-        total += static_cast<size_t>(n);
+std::shared_ptr<const TcpRpcClient::CallHeader>
+TcpRpcClient::callHeader(uint32_t prog, uint32_t vers) {
+    const auto cred = auth();
+    std::lock_guard<std::mutex> lk(header_mutex_);
+    for (auto& h : headers_) {
+        if (h->prog != prog || h->vers != vers) continue;
+        if (h->cred == cred) return h;
+        // Credentials changed since this template was built: re-encode below.
+        h = makeCallHeader(prog, vers, cred);
+        return h;
     }
+    headers_.push_back(makeCallHeader(prog, vers, cred));
+    return headers_.back();
+}
+
+std::shared_ptr<const TcpRpcClient::CallHeader>
+TcpRpcClient::makeCallHeader(uint32_t prog, uint32_t vers,
+                             std::shared_ptr<const AuthSys> cred) {
+    XdrEncoder enc;
+    encodeCallHeader(enc, /*xid=*/0, prog, vers, /*proc=*/0, cred.get());
+    auto h   = std::make_shared<CallHeader>();
+    h->prog  = prog;
+    h->vers  = vers;
+    h->cred  = std::move(cred);
+    h->bytes = enc.release();
+    return h;
 }
 
-std::vector<uint8_t> TcpRpcClient::recvRecord() {
-    // RFC 5531 §11: a record may be split across multiple fragments.
-    // Each fragment is prefixed by a 4-byte mark: bit 31 = last-fragment,
-    // bits 30-0 = fragment length.  Reassemble until last-fragment is set.
-    std::vector<uint8_t> record;
-
-    for (;;) {
-        // Read the 4-byte record mark.
-        uint8_t mark_buf[4] = {};
-        size_t received = 0;
-        while (received < 4) {
-            const ssize_t n = recv(sock_, mark_buf + received, 4 - received, 0);
-            if (n <= 0)
-                throw std::runtime_error("recv() record mark failed");
-            received += static_cast<size_t>(n);
+static void put_be32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >>  8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+void TcpRpcClient::sendCall(uint32_t xid, uint32_t prog, uint32_t vers, uint32_t proc,
+                            const XdrEncoder& args) {
+    // Record mark + CALL header are copied from the cached template into one
+    // stack buffer with the XID and procedure patched in; the argument
+    // segments follow in place, never copied into a contiguous frame.
+    const auto hdr = callHeader(prog, vers);
+    const size_t hdr_len = hdr->bytes.size();
+
+    uint8_t stack_head[4 + 512];
+    std::vector<uint8_t> heap_head;  // only for oversized AUTH_SYS credentials
+    uint8_t* head = stack_head;
+    if (4 + hdr_len > sizeof(stack_head)) {
+        heap_head.resize(4 + hdr_len);
+        head = heap_head.data();
+    }
+    put_be32(head, (1u << 31) | static_cast<uint32_t>(hdr_len + args.size()));
+    std::memcpy(head + 4, hdr->bytes.data(), hdr_len);
+    put_be32(head + 4 + CallHeader::XID_OFFSET,  xid);
+    put_be32(head + 4 + CallHeader::PROC_OFFSET, proc);
+
+    static constexpr size_t MAX_SEGMENTS = 32;
+    XdrSegment segs[MAX_SEGMENTS + 1];
+    segs[0] = {head, 4 + hdr_len};
+    size_t nsegs = args.segments(segs + 1, MAX_SEGMENTS);
+    if (nsegs > MAX_SEGMENTS) {
+        // Pathologically fragmented arguments: fall back to one flat copy.
+        const auto& flat = args.bytes();
+        segs[1] = {flat.data(), flat.size()};
+        nsegs = 1;
+    }
+    submitFrame(segs, nsegs + 1);
+}
+
+void TcpRpcClient::submitFrame(const XdrSegment* segs, size_t count) {
+    SendJob job{segs, count, {}};
+    auto written = job.written.get_future();
+
+    std::unique_lock<std::mutex> lk(submit_mutex_);
+    submit_queue_.push_back(&job);
+    if (!sending_) {
+        // Become the combiner: write batches until the queue stays empty.
+        // Frames queued by other threads meanwhile ride along in one sendmsg().
+        sending_ = true;
+        while (!submit_queue_.empty()) {
+            std::vector<SendJob*> batch;
+            batch.swap(submit_queue_);
+            lk.unlock();
+
+            std::exception_ptr error;
+            try {
+                std::vector<iovec> iov;
+                for (const SendJob* j : batch)
+                    for (size_t i = 0; i < j->count; ++i)
+                        iov.push_back({const_cast<uint8_t*>(j->segs[i].data), j->segs[i].size});
+                sendIov(iov.data(), iov.size());
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lk.lock();
+            for (SendJob* j : batch) {
+                if (error) j->written.set_exception(error);
+                else       j->written.set_value();
+            }
         }
+        sending_ = false;
+    }
+    lk.unlock();
+
+    // Someone (possibly us) has written the frame, or failed to.
+    written.get();
+}
 
-        const uint32_t mark =
-            (static_cast<uint32_t>(mark_buf[0]) << 24) |
-            (static_cast<uint32_t>(mark_buf[1]) << 16) |
-            (static_cast<uint32_t>(mark_buf[2]) <<  8) |
-             static_cast<uint32_t>(mark_buf[3]);
-
-        const bool     last_fragment = (mark & 0x80000000u) != 0;
-        const uint32_t frag_len      = mark & 0x7FFFFFFFu;
-
-        // Append this fragment's data to the reassembly buffer.
-        const size_t offset = record.size();
-        record.resize(offset + frag_len);
-        received = 0;
-        while (received < frag_len) {
-            const ssize_t n = recv(sock_, record.data() + offset + received,
-                                   frag_len - received, 0);
-            if (n <= 0)
-                throw std::runtime_error("recv() record data failed");
-            received += static_cast<size_t>(n);
+void TcpRpcClient::sendIov(iovec* iov, size_t count) {
+    size_t first = 0;
+    while (first < count) {
+        msghdr mh{};
+        mh.msg_iov    = iov + first;
+        mh.msg_iovlen = std::min<size_t>(count - first, IOV_MAX);
+        ssize_t n = sendmsg(sock_, &mh, MSG_NOSIGNAL);
+        if (n <= 0)
+            throw std::runtime_error("send() failed");
+        // Advance past fully-sent segments; trim a partially-sent one.
+        while (n > 0 && first < count) {
+            const size_t len = iov[first].iov_len;
+            if (static_cast<size_t>(n) >= len) {
+                n -= static_cast<ssize_t>(len);
+                ++first;
+            } else {
+                iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + n;
+                iov[first].iov_len  = len - static_cast<size_t>(n);
+                n = 0;
+            }
         }
+    }
+}
+
+std::vector<uint8_t> TcpRpcClient::recvBody(RecordReader& rr) {
+    // The reply header is checked off the stream, so the only copy made is
+    // the result body itself.
+    std::vector<uint8_t> body;
+    consumeReply(rr, [&](RecordReader& r) { r.read_rest(body); });
+    return body;
+}
+
+void TcpRpcClient::consumeReply(RecordReader& rr, const ReplySink& sink) {
+    try {
+        // Same checks as parseReply(), minus the XID the caller already read.
+        const auto msg_type = rr.get_uint32();
+        if (msg_type != static_cast<uint32_t>(MsgType::REPLY))
+            throw std::runtime_error("RPC: expected REPLY message type");
+
+        const auto reply_stat = rr.get_uint32();
+        if (reply_stat != static_cast<uint32_t>(ReplyStat::MSG_ACCEPTED))
+            throw std::runtime_error("RPC: message denied (reply_stat=" +
+                                     std::to_string(reply_stat) + ")");
+
+        /* verf_flavor */ rr.get_uint32();
+        rr.skip_opaque();                               // verf body
+
+        const auto accept_stat = rr.get_uint32();
+        if (accept_stat != static_cast<uint32_t>(AcceptStat::SUCCESS))
+            throw std::runtime_error("RPC: not accepted (accept_stat=" +
+                                     std::to_string(accept_stat) + ")");
+
+        sink(rr);
+    } catch (...) {
+        // Keep the stream aligned on the next record for the next caller.
+        if (!rr.failed()) rr.drain();
+        throw;
+    }
+    rr.drain();
+}
+
+// ── Pipelined reply demultiplexer ────────────────────────────────────────────
+
+void TcpRpcClient::start_reader() {
+    if (pipelined_.load(std::memory_order_acquire)) return;
+    // Taking io_mutex_ waits out any direct call that is mid-recv, so the
+    // reader never races a synchronous caller for the same reply.
+    std::lock_guard<std::mutex> lk(io_mutex_);
+    if (pipelined_.load(std::memory_order_relaxed)) return;
+    reader_ = std::thread(&TcpRpcClient::reader_loop, this);
+    pipelined_.store(true, std::memory_order_release);
+}
 
-        if (last_fragment) break;
+void TcpRpcClient::reader_loop() {
+    try {
+        for (;;) {
+            RecordReader rr(sock_);
+            const uint32_t xid = rr.get_uint32();
+
+            Pending waiter;
+            {
+                std::lock_guard<std::mutex> lk(pending_mutex_);
+                auto it = pending_.find(xid);
+                if (it == pending_.end()) {  // stale or unknown XID: drop
+                    rr.drain();
+                    continue;
+                }
+                waiter = std::move(it->second);
+                pending_.erase(it);
+            }
+
+            try {
+                if (waiter.sink) {
+                    consumeReply(rr, waiter.sink);
+                    waiter.done.set_value({});
+                } else {
+                    waiter.done.set_value(recvBody(rr));
+                }
+            } catch (...) {
+                waiter.done.set_exception(std::current_exception());
+                if (rr.failed()) throw;
+            }
+        }
+    } catch (...) {
+        // Connection is unusable: fail everything in flight and refuse new calls.
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        broken_ = std::current_exception();
+        for (auto& kv : pending_) kv.second.done.set_exception(broken_);
+        pending_.clear();
     }
+}
 
-    return record;
+size_t TcpRpcClient::outstanding() const {
+    std::lock_guard<std::mutex> lk(pending_mutex_);
+    return pending_.size() + direct_inflight_.load(std::memory_order_relaxed);
 }
 
 // ── Public call ──────────────────────────────────────────────────────────────
 
+namespace {
+// Counts a synchronous caller in outstanding() for the duration of its call.
+struct DirectCall {
+    explicit DirectCall(std::atomic<size_t>& n) : n_(n) { n_.fetch_add(1, std::memory_order_relaxed); }
+    ~DirectCall() { n_.fetch_sub(1, std::memory_order_relaxed); }
+    std::atomic<size_t>& n_;
+};
+}  // namespace
+
 std::vector<uint8_t> TcpRpcClient::call(uint32_t prog, uint32_t vers, uint32_t proc,
                                          const std::vector<uint8_t>& args) {
-    const uint32_t my_xid = xid_++;
-    const auto msg    = buildCallMessage(my_xid, prog, vers, proc, args,
-                                         auth_sys_.get());
-    const auto framed = addRecordMark(msg);
-    sendAll(framed);
-    const auto record = recvRecord();
-    return parseReply(record);
+    XdrEncoder enc;
+    enc.put_bytes_ref(args.data(), args.size());
+    return call(prog, vers, proc, enc);
+}
+
+std::vector<uint8_t> TcpRpcClient::call(uint32_t prog, uint32_t vers, uint32_t proc,
+                                         const XdrEncoder& args) {
+    if (!pipelined_.load(std::memory_order_acquire)) {
+        // Uncontended: one round trip on the calling thread.  If another
+        // caller is already mid-call, switch the connection to pipelined
+        // mode instead of queueing behind it.
+        DirectCall counted(direct_inflight_);
+        std::unique_lock<std::mutex> lk(io_mutex_, std::try_to_lock);
+        if (lk.owns_lock() && !pipelined_.load(std::memory_order_relaxed)) {
+            sendCall(xid_.fetch_add(1, std::memory_order_relaxed), prog, vers, proc, args);
+            RecordReader rr(sock_);
+            /* xid */ rr.get_uint32();
+            return recvBody(rr);
+        }
+    }
+    return call_async(prog, vers, proc, args).get();
+}
+
+std::future<std::vector<uint8_t>> TcpRpcClient::call_async(uint32_t prog, uint32_t vers,
+                                                           uint32_t proc,
+                                                           const std::vector<uint8_t>& args) {
+    XdrEncoder enc;
+    enc.put_bytes_ref(args.data(), args.size());
+    return call_async(prog, vers, proc, enc);
+}
+
+std::future<std::vector<uint8_t>> TcpRpcClient::call_async(uint32_t prog, uint32_t vers,
+                                                           uint32_t proc,
+                                                           const XdrEncoder& args) {
+    return submit(prog, vers, proc, args, nullptr);
+}
+
+void TcpRpcClient::call_into(uint32_t prog, uint32_t vers, uint32_t proc,
+                             const XdrEncoder& args, const ReplySink& sink) {
+    if (!pipelined_.load(std::memory_order_acquire)) {
+        DirectCall counted(direct_inflight_);
+        std::unique_lock<std::mutex> lk(io_mutex_, std::try_to_lock);
+        if (lk.owns_lock() && !pipelined_.load(std::memory_order_relaxed)) {
+            sendCall(xid_.fetch_add(1, std::memory_order_relaxed), prog, vers, proc, args);
+            RecordReader rr(sock_);
+            /* xid */ rr.get_uint32();
+            consumeReply(rr, sink);
+            return;
+        }
+    }
+    // The sink runs on the reader thread; it only touches memory owned by
+    // this (blocked) caller, so waiting here keeps it alive.
+    submit(prog, vers, proc, args, sink).get();
+}
+
+std::future<void> TcpRpcClient::call_async_into(uint32_t prog, uint32_t vers,
+                                                uint32_t proc, const XdrEncoder& args,
+                                                ReplySink sink) {
+    auto body = submit(prog, vers, proc, args, std::move(sink));
+    return std::async(std::launch::deferred, [body = std::move(body)]() mutable {
+        body.get();                               // empty: the sink consumed it
+    });
+}
+
+std::future<std::vector<uint8_t>> TcpRpcClient::submit(uint32_t prog, uint32_t vers,
+                                                       uint32_t proc,
+                                                       const XdrEncoder& args,
+                                                       ReplySink sink) {
+    start_reader();
+
+    // Register before sending: the reply may beat send() back to us.
+    const uint32_t my_xid = xid_.fetch_add(1, std::memory_order_relaxed);
+    std::future<std::vector<uint8_t>> result;
+    {
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        if (broken_) std::rethrow_exception(broken_);
+        auto& entry = pending_[my_xid];
+        entry.sink = std::move(sink);
+        result = entry.done.get_future();
+    }
+
+    try {
+        sendCall(my_xid, prog, vers, proc, args);
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(pending_mutex_);
+        pending_.erase(my_xid);
+        throw;
+    }
+    return result;
 }
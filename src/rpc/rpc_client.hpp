@@ -1,17 +1,46 @@
 #pragma once
 
 #include "rpc_types.hpp"
+#include "record_reader.hpp"
+#include "../xdr/xdr.hpp"
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+struct iovec;
+
 // Sends ONC RPC CALL messages over a TCP connection using RFC 5531 record marking.
 // Each call() encodes a complete CALL frame, sends it, reads the REPLY, and
 // returns the raw XDR bytes of the procedure result body.
+//
+// call_async() pipelines: many CALLs with distinct XIDs may be in flight on the
+// one socket, and a background reader thread matches each REPLY to its caller
+// by XID (replies may arrive in any order).  The first call_async() starts the
+// reader; from then on call() is routed through the same path, so synchronous
+// and asynchronous calls may be mixed freely.  Two threads calling call() at
+// once also switch the connection to pipelined mode, so concurrent
+// synchronous callers share the socket instead of taking turns.
+//
+// Thread safety: every public member may be called concurrently from any
+// number of threads.  XIDs come from an atomic counter.  Outgoing frames go
+// through a combining submission queue: whichever caller finds the socket
+// idle sends its own frame plus every frame queued behind it in one
+// sendmsg(), while the others wait for their frame to be written.
+// Credentials are swapped atomically; a call uses whatever was set when its
+// frame was encoded.
 class TcpRpcClient {
 public:
+    // Consumes a procedure result body straight off the socket (see call_into).
+    using ReplySink = std::function<void(RecordReader&)>;
+
     TcpRpcClient(const std::string& host, uint16_t port);
     ~TcpRpcClient();
 
@@ -21,6 +50,42 @@ public:
     std::vector<uint8_t> call(uint32_t prog, uint32_t vers, uint32_t proc,
                               const std::vector<uint8_t>& args);
 
+    // Gather form: the record mark, CALL header and each segment of `args`
+    // go out in one sendmsg() without being copied into a contiguous frame.
+    std::vector<uint8_t> call(uint32_t prog, uint32_t vers, uint32_t proc,
+                              const XdrEncoder& args);
+
+    // Send a CALL without waiting for its REPLY.  The future yields the result
+    // body (as call() would return it) or rethrows the RPC/transport error.
+    // The CALL has been fully sent when this returns, so `args` (and anything
+    // it references) may be released immediately.
+    std::future<std::vector<uint8_t>> call_async(uint32_t prog, uint32_t vers,
+                                                 uint32_t proc,
+                                                 const std::vector<uint8_t>& args);
+    std::future<std::vector<uint8_t>> call_async(uint32_t prog, uint32_t vers,
+                                                 uint32_t proc,
+                                                 const XdrEncoder& args);
+
+    // Streaming form: once the RPC reply header has been checked, `sink` is
+    // handed a RecordReader positioned at the result body and may pull bulk
+    // data directly into its own buffers.  Whatever the sink leaves unread is
+    // drained afterwards.  Exceptions thrown by the sink propagate to the
+    // caller.  In pipelined mode the sink runs on the reader thread while this
+    // call blocks.
+    void call_into(uint32_t prog, uint32_t vers, uint32_t proc,
+                   const XdrEncoder& args, const ReplySink& sink);
+
+    // Pipelined call_into(): returns once the CALL is sent.  `sink` runs on
+    // the reader thread when the reply arrives, so everything it touches must
+    // outlive the call.  The future is ready after the sink has run and
+    // rethrows whatever it or the transport threw.
+    std::future<void> call_async_into(uint32_t prog, uint32_t vers, uint32_t proc,
+                                      const XdrEncoder& args, ReplySink sink);
+
+    // Number of calls issued on this connection whose replies have not been
+    // consumed yet: pipelined calls in flight plus a direct call in progress.
+    size_t outstanding() const;
+
     // Switch to AUTH_SYS credentials for all subsequent calls.
     void set_auth_sys(const AuthSys& auth);
 
@@ -35,13 +100,87 @@ public:
                                                   const std::vector<uint8_t>& args,
                                                   const AuthSys* auth = nullptr);
     static std::vector<uint8_t> addRecordMark(const std::vector<uint8_t>& payload);
-    static std::vector<uint8_t> parseReply(const std::vector<uint8_t>& record);
+    // Checks an accepted REPLY record and returns the offset of its result
+    // body within `record`.
+    static size_t parseReply(const std::vector<uint8_t>& record);
 
 private:
-    void sendAll(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> recvRecord();
+    static void encodeCallHeader(XdrEncoder& enc, uint32_t xid,
+                                 uint32_t prog, uint32_t vers, uint32_t proc,
+                                 const AuthSys* auth);
+
+    // Pre-encoded CALL header for one (prog, vers, credential).  Only the XID
+    // and procedure words differ between calls; they are patched into a copy.
+    struct CallHeader {
+        static constexpr size_t XID_OFFSET  = 0;
+        static constexpr size_t PROC_OFFSET = 20;  // xid, mtype, rpcvers, prog, vers
+        uint32_t                       prog;
+        uint32_t                       vers;
+        std::shared_ptr<const AuthSys> cred;       // identity it was built for
+        std::vector<uint8_t>           bytes;
+    };
+
+    // Cached template for (prog, vers) under the current credentials; rebuilt
+    // after set_auth_sys()/clear_auth().
+    std::shared_ptr<const CallHeader> callHeader(uint32_t prog, uint32_t vers);
+    static std::shared_ptr<const CallHeader> makeCallHeader(
+        uint32_t prog, uint32_t vers, std::shared_ptr<const AuthSys> cred);
+
+    // Frame and send one CALL as a gather list (sendmsg).
+    void sendCall(uint32_t xid, uint32_t prog, uint32_t vers, uint32_t proc,
+                  const XdrEncoder& args);
+
+    // Combining submission queue: blocks until `segs` has been written.
+    void submitFrame(const XdrSegment* segs, size_t count);
+    void sendIov(iovec* iov, size_t count);
+    // Read the rest of a reply (XID already consumed) and return its result body.
+    static std::vector<uint8_t> recvBody(RecordReader& rr);
+
+    // Check the accepted-reply header, run `sink`, then drain the record —
+    // also when the header or sink throws, unless the socket itself failed.
+    static void consumeReply(RecordReader& rr, const ReplySink& sink);
+
+    // Register a pipelined call (with an optional streaming sink) and send it.
+    std::future<std::vector<uint8_t>> submit(uint32_t prog, uint32_t vers, uint32_t proc,
+                                             const XdrEncoder& args, ReplySink sink);
+
+    // Start the reply demultiplexer (idempotent).
+    void start_reader();
+    void reader_loop();
+
+    // Current credentials; read and replaced with std::atomic_load/store.
+    std::shared_ptr<const AuthSys> auth() const { return std::atomic_load(&auth_sys_); }
+
+    int                             sock_;
+    std::atomic<uint32_t>           xid_;
+    std::shared_ptr<const AuthSys>  auth_sys_;  // null = AUTH_NONE
+
+    // One template per (prog, vers) in use — a handful at most.
+    std::mutex                                     header_mutex_;
+    std::vector<std::shared_ptr<const CallHeader>> headers_;
+
+    // One frame waiting in (or being written from) the submission queue.
+    struct SendJob {
+        const XdrSegment*  segs;
+        size_t             count;
+        std::promise<void> written;  // fulfilled by whichever thread sent it
+    };
+    std::mutex                submit_mutex_;
+    std::vector<SendJob*>     submit_queue_;
+    bool                      sending_ = false;  // a combiner is writing
 
-    int                       sock_;
-    uint32_t                  xid_;
-    std::unique_ptr<AuthSys>  auth_sys_;  // null = AUTH_NONE
+    // Pipelined mode state.  io_mutex_ serialises direct (non-pipelined)
+    // calls and the switch into pipelined mode; pending_mutex_ guards the
+    // XID table.
+    std::mutex                io_mutex_;
+    mutable std::mutex        pending_mutex_;
+    struct Pending {
+        std::promise<std::vector<uint8_t>> done;
+        ReplySink                          sink;  // empty = buffer the whole body
+    };
+    std::unordered_map<uint32_t, Pending> pending_;
+    std::exception_ptr        broken_;    // set once the reader hits a fatal error
+    std::atomic<bool>         pipelined_{false};
+    std::atomic<size_t>       direct_inflight_{0};
+    std::thread               reader_;
 };
@@ -0,0 +1,42 @@
+#include "rpc_pool.hpp"
+
+#include <stdexcept>
+
+RpcConnectionPool::RpcConnectionPool(const std::string& host, uint16_t port,
+                                     unsigned nconnect, ConnPolicy policy)
+    : policy_(policy) {
+    if (nconnect == 0)
+        throw std::invalid_argument("nconnect must be at least 1");
+    conns_.reserve(nconnect);
+    for (unsigned i = 0; i < nconnect; ++i)
+        conns_.push_back(std::make_unique<TcpRpcClient>(host, port));
+}
+
+TcpRpcClient& RpcConnectionPool::pick() {
+    if (conns_.size() == 1) return *conns_.front();
+
+    const size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    if (policy_ == ConnPolicy::ROUND_ROBIN)
+        return *conns_[start % conns_.size()];
+
+    // LEAST_OUTSTANDING: scan from a rotating start so ties spread evenly.
+    size_t best      = start % conns_.size();
+    size_t best_load = conns_[best]->outstanding();
+    for (size_t i = 1; i < conns_.size() && best_load > 0; ++i) {
+        const size_t idx  = (start + i) % conns_.size();
+        const size_t load = conns_[idx]->outstanding();
+        if (load < best_load) {
+            best      = idx;
+            best_load = load;
+        }
+    }
+    return *conns_[best];
+}
+
+void RpcConnectionPool::set_auth_sys(const AuthSys& auth) {
+    for (auto& c : conns_) c->set_auth_sys(auth);
+}
+
+void RpcConnectionPool::clear_auth() {
+    for (auto& c : conns_) c->clear_auth();
+}
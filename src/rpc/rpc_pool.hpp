@@ -0,0 +1,49 @@
+#pragma once
+
+#include "rpc_client.hpp"
+#include "rpc_types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// How RpcConnectionPool::pick() chooses a connection.
+enum class ConnPolicy {
+    ROUND_ROBIN,        // rotate through the connections
+    LEAST_OUTSTANDING,  // the connection with the fewest calls in flight
+};
+
+// nconnect-style set of TCP connections to one server endpoint.
+//
+// Spreading calls over several connections lets one client object use more
+// than a single TCP flow's worth of bandwidth (server and switch hashing pins
+// each flow to one queue/CPU).  Every connection carries the same credentials.
+// pick() is thread-safe; each TcpRpcClient serialises its own I/O.
+class RpcConnectionPool {
+public:
+    RpcConnectionPool(const std::string& host, uint16_t port,
+                      unsigned nconnect, ConnPolicy policy = ConnPolicy::ROUND_ROBIN);
+
+    RpcConnectionPool(const RpcConnectionPool&) = delete;
+    RpcConnectionPool& operator=(const RpcConnectionPool&) = delete;
+
+    // Connection to use for the next call.
+    TcpRpcClient& pick();
+
+    // The first connection (used for session/clientid setup and teardown).
+    TcpRpcClient& primary() { return *conns_.front(); }
+
+    size_t size() const { return conns_.size(); }
+    TcpRpcClient& at(size_t i) { return *conns_.at(i); }
+
+    // Apply to every connection.
+    void set_auth_sys(const AuthSys& auth);
+    void clear_auth();
+
+private:
+    std::vector<std::unique_ptr<TcpRpcClient>> conns_;
+    ConnPolicy                                 policy_;
+    std::atomic<size_t>                        next_{0};
+};
@@ -1,32 +1,144 @@
 #include "xdr.hpp"
+#include "xdr_bswap.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 // ── XdrEncoder ──────────────────────────────────────────────────────────────
 
-void XdrEncoder::put_uint32(uint32_t v) {
-    buf_.push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
-    buf_.push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
-    buf_.push_back(static_cast<uint8_t>((v >>  8) & 0xFF));
-    buf_.push_back(static_cast<uint8_t>( v        & 0xFF));
+XdrEncoder::XdrEncoder(const XdrEncoder& other)
+    : base_(inline_), cur_(inline_), end_(inline_ + INLINE_CAPACITY) {
+    *this = other;
 }
 
-void XdrEncoder::put_uint64(uint64_t v) {
-    put_uint32(static_cast<uint32_t>(v >> 32));
-    put_uint32(static_cast<uint32_t>(v & 0xFFFFFFFFu));
+XdrEncoder& XdrEncoder::operator=(const XdrEncoder& other) {
+    if (this == &other) return *this;
+    cur_ = base_;
+    const size_t used = other.mark();
+    if (used > 0) std::memcpy(claim(used), other.base_, used);
+    nrefs_ = 0;
+    more_refs_.clear();
+    for (size_t i = 0; i < other.nrefs_; ++i) add_ref(other.ref(i));
+    return *this;
+}
+
+void XdrEncoder::grow(size_t n) {
+    const size_t used = mark();
+    const size_t cap  = std::max(used + n, 2 * static_cast<size_t>(end_ - base_));
+    std::unique_ptr<uint8_t[]> block(new uint8_t[cap]);
+    if (used > 0) std::memcpy(block.get(), base_, used);
+    heap_ = std::move(block);
+    base_ = heap_.get();
+    cur_  = base_ + used;
+    end_  = base_ + cap;
+}
+
+void XdrEncoder::put_uint32_words(const uint32_t* v, size_t n) {
+    xdr_store_be32_array(claim(4 * n), v, n);
+}
+
+void XdrEncoder::put_uint64_words(const uint64_t* v, size_t n) {
+    xdr_store_be64_array(claim(8 * n), v, n);
 }
 
 void XdrEncoder::put_opaque(const uint8_t* data, size_t size) {
-    put_uint32(static_cast<uint32_t>(size));
-    buf_.insert(buf_.end(), data, data + size);
-    size_t pad = (4 - (size % 4)) % 4;
-    for (size_t i = 0; i < pad; ++i) buf_.push_back(0);
+    uint8_t* p = claim(xdr_opaque_size(size));
+    xdr_store_be32(p, static_cast<uint32_t>(size));
+    if (size > 0) std::memcpy(p + 4, data, size);
+    std::memset(p + 4 + size, 0, xdr_pad(size));
 }
 
 void XdrEncoder::put_fixed_opaque(const uint8_t* data, size_t size) {
-    buf_.insert(buf_.end(), data, data + size);
-    size_t pad = (4 - (size % 4)) % 4;
-    for (size_t i = 0; i < pad; ++i) buf_.push_back(0);
+    const size_t pad = xdr_pad(size);
+    uint8_t* p = claim(size + pad);
+    if (size > 0) std::memcpy(p, data, size);
+    std::memset(p + size, 0, pad);
+}
+
+void XdrEncoder::put_opaque_ref(const uint8_t* data, size_t size) {
+    put_uint32(static_cast<uint32_t>(size));
+    put_bytes_ref(data, size);
+    const size_t pad = xdr_pad(size);
+    std::memset(claim(pad), 0, pad);
+}
+
+void XdrEncoder::put_bytes_ref(const uint8_t* data, size_t size) {
+    if (size > 0) add_ref({mark(), data, size});
+}
+
+void XdrEncoder::append_ref(const XdrEncoder& other) {
+    size_t pos = 0;
+    for (size_t i = 0; i < other.nrefs_; ++i) {
+        const Ref& r = other.ref(i);
+        put_bytes_ref(other.base_ + pos, r.at - pos);
+        put_bytes_ref(r.data, r.size);
+        pos = r.at;
+    }
+    put_bytes_ref(other.base_ + pos, other.mark() - pos);
+}
+
+void XdrEncoder::patch_uint32(size_t at, uint32_t v) {
+    if (at + 4 > mark())
+        throw std::out_of_range("XdrEncoder: patch beyond encoded data");
+    xdr_store_be32(base_ + at, v);
+}
+
+void XdrEncoder::add_ref(const Ref& r) {
+    if (nrefs_ < INLINE_REFS) refs_[nrefs_] = r;
+    else                      more_refs_.push_back(r);
+    ++nrefs_;
+}
+
+size_t XdrEncoder::size() const {
+    size_t n = mark();
+    for (size_t i = 0; i < nrefs_; ++i) n += ref(i).size;
+    return n;
+}
+
+size_t XdrEncoder::segments(XdrSegment* out, size_t max) const {
+    size_t count = 0;
+    auto emit = [&](const uint8_t* p, size_t n) {
+        if (n == 0) return;
+        if (count < max) out[count] = {p, n};
+        ++count;
+    };
+    size_t pos = 0;
+    for (size_t i = 0; i < nrefs_; ++i) {
+        const Ref& r = ref(i);
+        emit(base_ + pos, r.at - pos);
+        emit(r.data, r.size);
+        pos = r.at;
+    }
+    emit(base_ + pos, mark() - pos);
+    return count;
+}
+
+void XdrEncoder::copy_to(uint8_t* dst) const {
+    size_t pos = 0;
+    for (size_t i = 0; i < nrefs_; ++i) {
+        const Ref& r = ref(i);
+        std::memcpy(dst, base_ + pos, r.at - pos);
+        dst += r.at - pos;
+        std::memcpy(dst, r.data, r.size);
+        dst += r.size;
+        pos = r.at;
+    }
+    std::memcpy(dst, base_ + pos, mark() - pos);
+}
+
+const std::vector<uint8_t>& XdrEncoder::bytes() const {
+    flat_.resize(size());
+    if (!flat_.empty()) copy_to(flat_.data());
+    return flat_;
+}
+
+std::vector<uint8_t> XdrEncoder::release() {
+    std::vector<uint8_t> out(size());
+    if (!out.empty()) copy_to(out.data());
+    cur_   = base_;
+    nrefs_ = 0;
+    more_refs_.clear();
+    return out;
 }
 
 // ── XdrDecoder ──────────────────────────────────────────────────────────────
@@ -38,10 +150,7 @@ void XdrDecoder::require(size_t n) const {
 
 uint32_t XdrDecoder::get_uint32() {
     require(4);
-    uint32_t v = (static_cast<uint32_t>(data_[offset_    ]) << 24) |
-                 (static_cast<uint32_t>(data_[offset_ + 1]) << 16) |
-                 (static_cast<uint32_t>(data_[offset_ + 2]) <<  8) |
-                  static_cast<uint32_t>(data_[offset_ + 3]);
+    const uint32_t v = xdr_load_be32(data_ + offset_);
     offset_ += 4;
     return v;
 }
@@ -52,34 +161,70 @@ uint64_t XdrDecoder::get_uint64() {
     return (hi << 32) | lo;
 }
 
+void XdrDecoder::get_uint32_words(uint32_t* out, size_t n) {
+    require(4 * n);
+    xdr_load_be32_array(out, data_ + offset_, n);
+    offset_ += 4 * n;
+}
+
+void XdrDecoder::get_uint64_words(uint64_t* out, size_t n) {
+    require(8 * n);
+    xdr_load_be64_array(out, data_ + offset_, n);
+    offset_ += 8 * n;
+}
+
+std::vector<uint32_t> XdrDecoder::get_uint32_array() {
+    const uint32_t n = get_uint32();
+    require(4 * static_cast<size_t>(n));  // before sizing the vector
+    std::vector<uint32_t> v(n);
+    get_uint32_words(v.data(), n);
+    return v;
+}
+
 std::vector<uint8_t> XdrDecoder::get_opaque() {
-    uint32_t len = get_uint32();
-    require(len);
-    std::vector<uint8_t> result(data_ + offset_, data_ + offset_ + len);
-    offset_ += len;
-    size_t pad = (4 - (len % 4)) % 4;
-    require(pad);
-    offset_ += pad;
-    return result;
+    const XdrSegment v = get_opaque_view();
+    return std::vector<uint8_t>(v.data, v.data + v.size);
 }
 
 std::string XdrDecoder::get_string() {
-    auto bytes = get_opaque();
-    return std::string(bytes.begin(), bytes.end());
+    return std::string(get_string_view());
 }
 
 std::vector<uint8_t> XdrDecoder::get_fixed_opaque(size_t n) {
-    require(n);
-    std::vector<uint8_t> result(data_ + offset_, data_ + offset_ + n);
-    offset_ += n;
-    size_t pad = (4 - (n % 4)) % 4;
-    require(pad);
-    offset_ += pad;
-    return result;
+    const XdrSegment v = get_fixed_opaque_view(n);
+    return std::vector<uint8_t>(v.data, v.data + v.size);
 }
 
 std::vector<uint8_t> XdrDecoder::get_remaining() {
-    std::vector<uint8_t> result(data_ + offset_, data_ + size_);
+    const XdrSegment v = get_remaining_view();
+    return std::vector<uint8_t>(v.data, v.data + v.size);
+}
+
+XdrSegment XdrDecoder::get_opaque_view() {
+    const uint32_t len = get_uint32();
+    return get_fixed_opaque_view(len);
+}
+
+std::string_view XdrDecoder::get_string_view() {
+    const XdrSegment v = get_opaque_view();
+    return std::string_view(reinterpret_cast<const char*>(v.data), v.size);
+}
+
+XdrSegment XdrDecoder::get_fixed_opaque_view(size_t n) {
+    const size_t pad = xdr_pad(n);
+    require(n + pad);
+    const XdrSegment v{data_ + offset_, n};
+    offset_ += n + pad;
+    return v;
+}
+
+XdrSegment XdrDecoder::get_remaining_view() {
+    const XdrSegment v{data_ + offset_, size_ - offset_};
     offset_ = size_;
-    return result;
+    return v;
+}
+
+void XdrDecoder::skip(size_t n) {
+    require(n);
+    offset_ += n;
 }
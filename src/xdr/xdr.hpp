@@ -1,15 +1,104 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// A contiguous byte range of an encoded message (see XdrEncoder::segments()).
+struct XdrSegment {
+    const uint8_t* data;
+    size_t         size;
+};
+
+// Wire size helpers, for reserving exactly what a message needs.
+inline size_t xdr_pad(size_t n)         { return (4 - (n % 4)) % 4; }
+inline size_t xdr_opaque_size(size_t n) { return 4 + n + xdr_pad(n); }
+
+inline void xdr_store_be32(uint8_t* p, uint32_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    std::memcpy(p, &v, 4);
+}
+
+inline void xdr_store_be64(uint8_t* p, uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    std::memcpy(p, &v, 8);
+}
+
+inline uint32_t xdr_load_be32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+inline uint64_t xdr_load_be64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
 // XDR encoder: serializes values into a big-endian byte buffer.
+//
+// Values are stored through a raw cursor.  The buffer starts out as either
+// INLINE_CAPACITY bytes inside the encoder itself or storage supplied by the
+// caller, so handles, names and attributes of a metadata op are encoded
+// without touching the heap; only a message that outgrows its buffer moves
+// to a heap block (once, if the size was reserve()d up front).
+//
+// Large payloads can be referenced instead of copied (put_opaque_ref /
+// put_bytes_ref / append_ref).  The encoded message is then a gather list of
+// inline bytes interleaved with the referenced ranges, which the RPC layer
+// hands to sendmsg() as-is.  Referenced memory must outlive the send.
 class XdrEncoder {
 public:
-    void put_uint32(uint32_t v);
-    void put_uint64(uint64_t v);
+    static constexpr size_t INLINE_CAPACITY = 512;
+
+    XdrEncoder() : base_(inline_), cur_(inline_), end_(inline_ + INLINE_CAPACITY) {}
+
+    // Encode into `buf` (e.g. a stack array sized for the message).  `buf`
+    // must outlive the encoder; if the message outgrows it, the bytes move
+    // to the heap and `buf` is no longer written.
+    XdrEncoder(uint8_t* buf, size_t capacity)
+        : base_(buf), cur_(buf), end_(buf + capacity) {}
+
+    XdrEncoder(const XdrEncoder& other);
+    XdrEncoder& operator=(const XdrEncoder& other);
+
+    // Make room for `n` more inline bytes, so a message of known size costs
+    // at most one allocation instead of repeated growth.
+    void reserve(size_t n) {
+        if (static_cast<size_t>(end_ - cur_) < n) grow(n);
+    }
+
+    void put_uint32(uint32_t v) { xdr_store_be32(claim(4), v); }
+    void put_uint64(uint64_t v) { xdr_store_be64(claim(8), v); }
+
+    // `n` words back to back, byte-swapped in bulk (see xdr_bswap.hpp).
+    void put_uint32_words(const uint32_t* v, size_t n);
+    void put_uint64_words(const uint64_t* v, size_t n);
+
+    // Counted array (XDR `unsigned int<>`): element count, then the words.
+    void put_uint32_array(const uint32_t* v, size_t n) {
+        put_uint32(static_cast<uint32_t>(n));
+        put_uint32_words(v, n);
+    }
+
+    // Claim `n` raw bytes for the caller to fill in (fixed-size struct
+    // codecs, see xdr_struct.hpp).  The pointer is valid until the next put.
+    uint8_t* put_raw(size_t n) { return claim(n); }
 
     // Variable-length opaque: 4-byte length prefix + data + 4-byte alignment padding.
     void put_opaque(const uint8_t* data, size_t size);
@@ -25,11 +114,75 @@ public:
     // Fixed-length opaque: data + 4-byte alignment padding, no length prefix.
     void put_fixed_opaque(const uint8_t* data, size_t size);
 
-    const std::vector<uint8_t>& bytes() const { return buf_; }
-    std::vector<uint8_t> release() { return std::move(buf_); }
+    // Variable-length opaque whose payload is referenced, not copied: only the
+    // length prefix and padding are written into the encoder.
+    void put_opaque_ref(const uint8_t* data, size_t size);
+
+    // Raw bytes (already XDR-encoded, 4-byte aligned) referenced, not copied.
+    void put_bytes_ref(const uint8_t* data, size_t size);
+
+    // Reference the whole encoded content of `other` (which must not change
+    // or be destroyed until this encoder has been sent).
+    void append_ref(const XdrEncoder& other);
+
+    // Position of the next inline byte.  Together with patch_uint32() this
+    // lets a length word be written before the item it measures is encoded:
+    // take mark(), put a placeholder, encode, then patch in the difference.
+    // Referenced ranges are not counted.
+    size_t mark() const { return static_cast<size_t>(cur_ - base_); }
+    void   patch_uint32(size_t at, uint32_t v);
+
+    // Total encoded size, including referenced ranges.
+    size_t size() const;
+
+    // Write up to `max` segments of the gather list into `out`, in wire order.
+    // Returns the total number of segments (which may exceed `max`).
+    size_t segments(XdrSegment* out, size_t max) const;
+
+    // Flat copy of the encoded message, rebuilt on every call.  Meant for
+    // tests and cold paths; prefer segments() on the send path.
+    const std::vector<uint8_t>& bytes() const;
+
+    // Flat copy of the encoded message; the encoder is left empty.
+    std::vector<uint8_t> release();
 
 private:
-    std::vector<uint8_t> buf_;
+    // A referenced range spliced in before inline offset `at`.
+    struct Ref {
+        size_t         at;
+        const uint8_t* data;
+        size_t         size;
+    };
+    static constexpr size_t INLINE_REFS = 4;
+
+    // Advance the cursor by `n` bytes and return where they start.
+    uint8_t* claim(size_t n) {
+        if (static_cast<size_t>(end_ - cur_) < n) grow(n);
+        uint8_t* p = cur_;
+        cur_ += n;
+        return p;
+    }
+    void grow(size_t n);
+
+    void add_ref(const Ref& r);
+    const Ref& ref(size_t i) const {
+        return i < INLINE_REFS ? refs_[i] : more_refs_[i - INLINE_REFS];
+    }
+
+    // Copy the flattened message to `dst` (size() bytes).
+    void copy_to(uint8_t* dst) const;
+
+    uint8_t*                   base_;
+    uint8_t*                   cur_;
+    uint8_t*                   end_;
+    std::unique_ptr<uint8_t[]> heap_;   // owns base_ once the message has grown
+    uint8_t                    inline_[INLINE_CAPACITY];
+
+    size_t                     nrefs_ = 0;
+    Ref                        refs_[INLINE_REFS];
+    std::vector<Ref>           more_refs_;
+
+    mutable std::vector<uint8_t> flat_;  // backing store for bytes()
 };
 
 // XDR decoder: deserializes values from a big-endian byte buffer.
@@ -43,6 +196,13 @@ public:
     uint32_t get_uint32();
     uint64_t get_uint64();
 
+    // `n` words back to back into `out`, byte-swapped in bulk.
+    void get_uint32_words(uint32_t* out, size_t n);
+    void get_uint64_words(uint64_t* out, size_t n);
+
+    // Counted array (XDR `unsigned int<>`).
+    std::vector<uint32_t> get_uint32_array();
+
     // Variable-length opaque: reads 4-byte length, data, and alignment padding.
     std::vector<uint8_t> get_opaque();
 
@@ -55,6 +215,18 @@ public:
     // Returns remaining bytes and advances the cursor to end.
     std::vector<uint8_t> get_remaining();
 
+    // Non-owning forms of the above: they point into the decoded buffer and
+    // stay valid only as long as it does.
+    XdrSegment       get_opaque_view();
+    std::string_view get_string_view();
+    XdrSegment       get_fixed_opaque_view(size_t n);
+    XdrSegment       get_remaining_view();
+
+    // Step over a variable-length opaque / string, or `n` raw bytes.
+    void skip_opaque() { get_opaque_view(); }
+    void skip(size_t n);
+
+    size_t offset()    const { return offset_; }
     size_t remaining() const { return size_ - offset_; }
 
 private:
@@ -0,0 +1,108 @@
+#include "xdr_bswap.hpp"
+#include "xdr.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define XDR_BSWAP_X86 1
+#endif
+
+// Loading and storing are the same byte shuffle, so each kernel is written
+// once over raw bytes: reverse every `W`-byte group of `n` words.
+
+namespace {
+
+template <size_t W>
+void swap_scalar(uint8_t* dst, const uint8_t* src, size_t n) {
+    // On a big-endian host both directions are a plain copy, which is what
+    // xdr_load_be*() followed by a host-order memcpy amounts to.
+    for (size_t i = 0; i < n; ++i, dst += W, src += W) {
+        if constexpr (W == 4) {
+            const uint32_t v = xdr_load_be32(src);
+            std::memcpy(dst, &v, 4);
+        } else {
+            const uint64_t v = xdr_load_be64(src);
+            std::memcpy(dst, &v, 8);
+        }
+    }
+}
+
+#ifdef XDR_BSWAP_X86
+
+template <size_t W>
+__m128i shuffle_mask_128() {
+    return W == 4 ? _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+                  : _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+}
+
+template <size_t W>
+__attribute__((target("ssse3")))
+void swap_ssse3(uint8_t* dst, const uint8_t* src, size_t n) {
+    const __m128i mask = shuffle_mask_128<W>();
+    constexpr size_t per = 16 / W;
+    size_t i = 0;
+    for (; i + per <= n; i += per, dst += 16, src += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(v, mask));
+    }
+    swap_scalar<W>(dst, src, n - i);
+}
+
+template <size_t W>
+__attribute__((target("avx2")))
+void swap_avx2(uint8_t* dst, const uint8_t* src, size_t n) {
+    const __m128i lane = shuffle_mask_128<W>();
+    const __m256i mask = _mm256_broadcastsi128_si256(lane);
+    constexpr size_t per = 32 / W;
+    size_t i = 0;
+    for (; i + per <= n; i += per, dst += 32, src += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(v, mask));
+    }
+    swap_scalar<W>(dst, src, n - i);
+}
+
+#endif  // XDR_BSWAP_X86
+
+struct Kernel {
+    void (*swap32)(uint8_t*, const uint8_t*, size_t);
+    void (*swap64)(uint8_t*, const uint8_t*, size_t);
+    const char* name;
+};
+
+Kernel pick_kernel() {
+#ifdef XDR_BSWAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))  return {swap_avx2<4>,  swap_avx2<8>,  "avx2"};
+    if (__builtin_cpu_supports("ssse3")) return {swap_ssse3<4>, swap_ssse3<8>, "ssse3"};
+#endif
+    return {swap_scalar<4>, swap_scalar<8>, "scalar"};
+}
+
+const Kernel& kernel() {
+    static const Kernel k = pick_kernel();
+    return k;
+}
+
+}  // namespace
+
+void xdr_load_be32_array(uint32_t* dst, const uint8_t* src, size_t n) {
+    kernel().swap32(reinterpret_cast<uint8_t*>(dst), src, n);
+}
+
+void xdr_load_be64_array(uint64_t* dst, const uint8_t* src, size_t n) {
+    kernel().swap64(reinterpret_cast<uint8_t*>(dst), src, n);
+}
+
+void xdr_store_be32_array(uint8_t* dst, const uint32_t* src, size_t n) {
+    kernel().swap32(dst, reinterpret_cast<const uint8_t*>(src), n);
+}
+
+void xdr_store_be64_array(uint8_t* dst, const uint64_t* src, size_t n) {
+    kernel().swap64(dst, reinterpret_cast<const uint8_t*>(src), n);
+}
+
+const char* xdr_bswap_kernel() {
+    return kernel().name;
+}
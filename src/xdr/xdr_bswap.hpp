@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Bulk conversion between big-endian XDR words and host integers.
+//
+// The kernel is picked once, at first use, from what the CPU supports:
+// AVX2 (8 words per shuffle), SSSE3 (4 words), or a scalar loop.  Tails and
+// short arrays go through the scalar path, so any `n` is fine.  Source and
+// destination must not overlap.
+
+// `n` big-endian words at `src` → host-order `dst`.
+void xdr_load_be32_array(uint32_t* dst, const uint8_t* src, size_t n);
+void xdr_load_be64_array(uint64_t* dst, const uint8_t* src, size_t n);
+
+// `n` host-order words at `src` → big-endian bytes at `dst`.
+void xdr_store_be32_array(uint8_t* dst, const uint32_t* src, size_t n);
+void xdr_store_be64_array(uint8_t* dst, const uint64_t* src, size_t n);
+
+// Name of the kernel in use ("avx2", "ssse3" or "scalar"), for diagnostics.
+const char* xdr_bswap_kernel();
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "xdr.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Compile-time codecs for fixed-layout XDR structures.
+//
+// A structure opts in by specialising XdrSchema with its members in wire
+// order:
+//
+//     template <> struct XdrSchema<Nfstime3> {
+//         using fields = XdrFields<&Nfstime3::seconds, &Nfstime3::nseconds>;
+//     };
+//
+// Supported member types are uint32_t, uint64_t, int64_t, bool, 32-bit enums,
+// std::array<uint8_t, N> (fixed opaque, padded) and other structures with a
+// schema.  Every one of them has a fixed wire size, so xdr_wire_size<T> is a
+// constant and xdr_decode() does a single bounds check for the whole struct,
+// then byte-swaps each field in an unrolled sequence.
+
+template <auto... Members> struct XdrFields {};
+
+template <typename T> struct XdrSchema;
+
+namespace xdr_detail {
+
+template <typename M> struct MemberOf;
+template <typename C, typename M> struct MemberOf<M C::*> { using type = M; };
+template <auto M> using member_t = typename MemberOf<decltype(M)>::type;
+
+template <typename F, typename = void> struct FieldCodec;
+
+template <typename T, typename Fields = typename XdrSchema<T>::fields>
+struct StructCodec;
+
+template <> struct FieldCodec<uint32_t> {
+    static constexpr size_t size = 4;
+    static void load(const uint8_t* p, uint32_t& v) { v = xdr_load_be32(p); }
+    static void store(uint8_t* p, uint32_t v)       { xdr_store_be32(p, v); }
+};
+
+template <> struct FieldCodec<uint64_t> {
+    static constexpr size_t size = 8;
+    static void load(const uint8_t* p, uint64_t& v) { v = xdr_load_be64(p); }
+    static void store(uint8_t* p, uint64_t v)       { xdr_store_be64(p, v); }
+};
+
+template <> struct FieldCodec<int64_t> {
+    static constexpr size_t size = 8;
+    static void load(const uint8_t* p, int64_t& v) {
+        v = static_cast<int64_t>(xdr_load_be64(p));
+    }
+    static void store(uint8_t* p, int64_t v) { xdr_store_be64(p, static_cast<uint64_t>(v)); }
+};
+
+template <> struct FieldCodec<bool> {
+    static constexpr size_t size = 4;
+    static void load(const uint8_t* p, bool& v) { v = xdr_load_be32(p) != 0; }
+    static void store(uint8_t* p, bool v)       { xdr_store_be32(p, v ? 1u : 0u); }
+};
+
+template <typename E>
+struct FieldCodec<E, std::enable_if_t<std::is_enum_v<E>>> {
+    static_assert(sizeof(E) == 4, "XDR enums are 32 bits on the wire");
+    static constexpr size_t size = 4;
+    static void load(const uint8_t* p, E& v) { v = static_cast<E>(xdr_load_be32(p)); }
+    static void store(uint8_t* p, E v) {
+        xdr_store_be32(p, static_cast<uint32_t>(v));
+    }
+};
+
+template <size_t N> struct FieldCodec<std::array<uint8_t, N>> {
+    static constexpr size_t size = N + (4 - N % 4) % 4;
+    static void load(const uint8_t* p, std::array<uint8_t, N>& v) {
+        std::memcpy(v.data(), p, N);
+    }
+    static void store(uint8_t* p, const std::array<uint8_t, N>& v) {
+        std::memcpy(p, v.data(), N);
+        std::memset(p + N, 0, size - N);
+    }
+};
+
+template <typename T>
+struct FieldCodec<T, std::void_t<typename XdrSchema<T>::fields>> : StructCodec<T> {};
+
+template <typename T, auto... Ms>
+struct StructCodec<T, XdrFields<Ms...>> {
+    static constexpr size_t size = (size_t{0} + ... + FieldCodec<member_t<Ms>>::size);
+
+    static void load(const uint8_t* p, T& v) { (load_field<Ms>(p, v), ...); }
+    static void store(uint8_t* p, const T& v) { (store_field<Ms>(p, v), ...); }
+
+private:
+    template <auto M>
+    static void load_field(const uint8_t*& p, T& v) {
+        using C = FieldCodec<member_t<M>>;
+        C::load(p, v.*M);
+        p += C::size;
+    }
+    template <auto M>
+    static void store_field(uint8_t*& p, const T& v) {
+        using C = FieldCodec<member_t<M>>;
+        C::store(p, v.*M);
+        p += C::size;
+    }
+};
+
+}  // namespace xdr_detail
+
+// Encoded size of T in bytes (always a multiple of 4).
+template <typename T>
+constexpr size_t xdr_wire_size = xdr_detail::StructCodec<T>::size;
+
+// Raw forms over xdr_wire_size<T> bytes the caller has already bounds-checked.
+template <typename T>
+void xdr_load(const uint8_t* p, T& v) { xdr_detail::StructCodec<T>::load(p, v); }
+
+template <typename T>
+void xdr_store(uint8_t* p, const T& v) { xdr_detail::StructCodec<T>::store(p, v); }
+
+template <typename T>
+T xdr_decode(XdrDecoder& dec) {
+    T v{};
+    xdr_load(dec.get_fixed_opaque_view(xdr_wire_size<T>).data, v);
+    return v;
+}
+
+template <typename T>
+void xdr_encode(XdrEncoder& enc, const T& v) {
+    xdr_store(enc.put_raw(xdr_wire_size<T>), v);
+}
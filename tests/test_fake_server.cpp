@@ -0,0 +1,684 @@
+#include "fake_server.hpp"
+
+#include "nfs_client.hpp"
+#include "nfs4_client.hpp"
+#include "nfs41_client.hpp"
+#include "nfs4/compound.hpp"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using fake::FakeServer;
+using fake::FakeServerOptions;
+
+static std::vector<uint8_t> pattern(size_t n) {
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = static_cast<uint8_t>(i * 7 + 3);
+    return v;
+}
+
+// Directories d0/d1/... `depth` deep with a file "f" at the bottom; returns
+// the path of the file.
+static std::string make_deep_path(fake::FakeFs& fs, int depth) {
+    fake::NewNode dir_node;
+    dir_node.type = Ftype3::NF3DIR;
+    uint64_t    dir  = fake::FakeFs::ROOT;
+    std::string path;
+    for (int i = 0; i < depth; ++i) {
+        const std::string name = "d" + std::to_string(i);
+        dir  = fs.create(dir, name, dir_node);
+        path += "/" + name;
+    }
+    fs.create(dir, "f", {});
+    return path + "/f";
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+// ── FakeFs ───────────────────────────────────────────────────────────────────
+
+TEST(FakeFs, SizeOnlyModeReadsZeros) {
+    fake::FakeFs fs(/*store_data=*/false);
+    fake::NewNode node;
+    const uint64_t id = fs.create(fake::FakeFs::ROOT, "big", node);
+    const auto data = pattern(4096);
+    fs.write(id, 1u << 30, data.data(), 4096);
+    EXPECT_EQ(fs.stat(id).attr.size, (1u << 30) + 4096u);
+
+    std::vector<uint8_t> out;
+    bool eof = false;
+    EXPECT_EQ(fs.read(id, 1u << 30, 8192, out, eof), 4096u);
+    EXPECT_TRUE(eof);
+    EXPECT_TRUE(std::all_of(out.begin(), out.end(), [](uint8_t b) { return b == 0; }));
+}
+
+TEST(FakeFs, ReaddirCookiesSurviveRemoval) {
+    fake::FakeFs fs;
+    for (const char* n : {"a", "b", "c"}) fs.create(fake::FakeFs::ROOT, n, {});
+    bool eof = false;
+    auto first = fs.readdir(fake::FakeFs::ROOT, 0, 1, eof);
+    ASSERT_EQ(first.size(), 1u);
+    EXPECT_FALSE(eof);
+    fs.remove(fake::FakeFs::ROOT, first[0].name, fake::RemoveKind::FILE);
+    auto rest = fs.readdir(fake::FakeFs::ROOT, first[0].cookie, 10, eof);
+    EXPECT_EQ(rest.size(), 2u);
+    EXPECT_TRUE(eof);
+}
+
+// ── NFSv3 ────────────────────────────────────────────────────────────────────
+
+TEST(FakeServer, Nfs3RoundTrip) {
+    FakeServer srv;
+    NFSClient client(srv.host(), srv.client_options());
+    const Fh3 root = client.mount(srv.export_path());
+
+    const Fh3 dir  = client.mkdir(root, "d");
+    const Fh3 file = client.create(dir, "f");
+    const auto data = pattern(100000);
+    const WriteResult w = client.write(file, 0, Stable3::FILE_SYNC, data);
+    EXPECT_EQ(w.count, data.size());
+    EXPECT_EQ(client.read(file, 0, 200000), data);
+    EXPECT_EQ(client.getattr(file).size, data.size());
+
+    client.rename(dir, "f", root, "g");
+    const auto names = client.readdir(root);
+    std::vector<std::string> seen;
+    for (const auto& e : names) seen.push_back(e.name);
+    std::sort(seen.begin(), seen.end());
+    EXPECT_EQ(seen, (std::vector<std::string>{".", "..", "d", "g"}));
+
+    client.remove(root, "g");
+    client.rmdir(root, "d");
+    EXPECT_THROW(client.lookup(root, "d"), NfsError);
+
+    EXPECT_EQ(client.fsinfo(root).rtmax, FakeServerOptions{}.max_io_size);
+    EXPECT_EQ(srv.nfs3_calls(7), 1u);                // WRITE
+    EXPECT_GT(srv.rpc_calls(), srv.nfs3_calls(7));
+}
+
+TEST(FakeServer, Nfs3UnknownExportIsRefused) {
+    FakeServer srv;
+    NFSClient client(srv.host(), srv.client_options());
+    EXPECT_THROW(client.mount("/nope"), std::runtime_error);
+}
+
+TEST(FakeServer, Nfs3ReaddirPaginates) {
+    FakeServer srv;
+    for (int i = 0; i < 300; ++i)
+        srv.fs().create(fake::FakeFs::ROOT, "entry-" + std::to_string(i), {});
+    NFSClient client(srv.host(), srv.client_options());
+    const Fh3 root = client.mount(srv.export_path());
+    EXPECT_EQ(client.readdir(root, 1024).size(), 302u);
+    EXPECT_GT(srv.nfs3_calls(16), 1u);               // READDIR
+}
+
+TEST(FakeServer, Nfs3GetattrServedFromAttrCache) {
+    FakeServer srv;
+    const uint64_t id = srv.fs().create(fake::FakeFs::ROOT, "f", {});
+    ClientOptions co = srv.client_options();
+    co.attr_cache    = true;
+    NFSClient client(srv.host(), co);
+    const Fh3 root = client.mount(srv.export_path());
+    const Fh3 file = client.lookup(root, "f");       // caches the attributes
+
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(client.getattr(file).size, 0u);
+    EXPECT_EQ(srv.nfs3_calls(1), 0u);                // GETATTR
+
+    // A change behind the client's back shows up in the next WRITE's wcc_data.
+    const auto data = pattern(10);
+    srv.fs().write(id, 0, data.data(), 10);
+    client.write(file, 100, Stable3::FILE_SYNC, data);
+    EXPECT_EQ(client.attr_cache()->stats().foreign_changes, 1u);
+    EXPECT_EQ(client.getattr(file).size, 110u);
+    EXPECT_EQ(srv.nfs3_calls(1), 0u);
+
+    NFSClient uncached(srv.host(), srv.client_options());   // "noac" by default
+    EXPECT_EQ(uncached.attr_cache(), nullptr);
+    EXPECT_EQ(uncached.getattr(file).size, 110u);
+    EXPECT_EQ(srv.nfs3_calls(1), 1u);
+}
+
+TEST(FakeServer, Nfs3ReadIntoReportsEof) {
+    FakeServerOptions o;
+    o.short_read = 1000;
+    FakeServer srv(o);
+    const auto data = pattern(1500);
+    srv.fs().write(srv.fs().create(fake::FakeFs::ROOT, "f", {}), 0, data.data(), 1500);
+    NFSClient client(srv.host(), srv.client_options());
+    const Fh3 file = client.lookup(client.mount(srv.export_path()), "f");
+
+    std::vector<uint8_t> buf(4096);
+    ReadResult r = client.read_into(file, 0, buf.data(), 4096);
+    EXPECT_EQ(r.count, 1000u);                       // short, but not the end
+    EXPECT_FALSE(r.eof);
+    r = client.read_into(file, 1000, buf.data(), 4096);
+    EXPECT_EQ(r.count, 500u);
+    EXPECT_TRUE(r.eof);
+}
+
+TEST(FakeServer, Nfs3LookupCache) {
+    FakeServer srv;
+    srv.fs().create(fake::FakeFs::ROOT, "f", {});
+    ClientOptions co = srv.client_options();
+    co.attr_cache   = true;
+    co.lookup_cache = true;
+    co.attr_timeouts.acdirmin = std::chrono::milliseconds(100);
+    NFSClient client(srv.host(), co);
+    const Fh3 root = client.mount(srv.export_path());
+
+    const Fh3 f = client.lookup(root, "f");
+    EXPECT_EQ(client.lookup(root, "f"), f);
+    EXPECT_THROW(client.lookup(root, "g"), NfsError);
+    EXPECT_THROW(client.lookup(root, "g"), NfsError);
+    EXPECT_EQ(srv.nfs3_calls(3), 2u);                // LOOKUP
+
+    // Our own CREATE replaces the negative entry.
+    const Fh3 g = client.create(root, "g");
+    EXPECT_EQ(client.lookup(root, "g"), g);
+    EXPECT_EQ(srv.nfs3_calls(3), 2u);
+
+    // Someone else's change is seen once the directory is revalidated.
+    srv.fs().remove(fake::FakeFs::ROOT, "f", fake::RemoveKind::FILE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_THROW(client.lookup(root, "f"), NfsError);
+    EXPECT_EQ(srv.nfs3_calls(3), 3u);
+    EXPECT_GE(client.lookup_cache()->stats().invalidations, 1u);
+}
+
+TEST(FakeServer, Nfs3ResolvePath) {
+    FakeServer srv;
+    const std::string path = make_deep_path(srv.fs(), 12);
+    ClientOptions co = srv.client_options();
+    co.attr_cache   = true;
+    co.lookup_cache = true;
+    NFSClient client(srv.host(), co);
+    const Fh3 root = client.mount(srv.export_path());
+
+    const Fh3 f = client.resolve_path(root, path);
+    EXPECT_EQ(client.getattr(f).type, Ftype3::NF3REG);
+    EXPECT_EQ(srv.nfs3_calls(3), 13u);               // LOOKUP
+
+    // Every component is cached now; ".." still goes to the server.
+    EXPECT_EQ(client.resolve_path(root, path), f);
+    EXPECT_EQ(client.resolve_path(root, "d0/./d1/../d1//"),
+              client.resolve_path(root, "/d0/d1"));
+    EXPECT_EQ(srv.nfs3_calls(3), 14u);
+    EXPECT_EQ(client.resolve_path(root, ""), root);
+    EXPECT_THROW(client.resolve_path(root, "d0/nope/f"), NfsError);
+}
+
+// ── NFSv4.0 / 4.1 ────────────────────────────────────────────────────────────
+
+TEST(FakeServer, Nfs4RoundTrip) {
+    FakeServer srv;
+    Nfs4Client client(srv.host(), srv.client_options());
+    const Nfs4Fh root = client.root_fh();
+
+    const auto data = pattern(70000);
+    Nfs4File f = client.open_write(root, "f");
+    EXPECT_EQ(client.write(f, 0, Stable4::FILE_SYNC, data.data(),
+                           static_cast<uint32_t>(data.size())), data.size());
+    client.close(f);
+    f = client.open_read(root, "f");
+    EXPECT_EQ(client.read(f, 0, 100000), data);
+    client.close(f);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN_CONFIRM), 1u);   // once per open-owner
+
+    const Nfs4Fh dir = client.mkdir(root, "d");
+    client.symlink(dir, "l", "../f");
+    EXPECT_EQ(client.readlink(client.lookup(dir, "l")), "../f");
+    client.rename(root, "f", dir, "g");
+    EXPECT_EQ(*client.getattr(client.lookup(dir, "g")).size, data.size());
+    EXPECT_EQ(client.readdir(dir).size(), 2u);
+    EXPECT_THROW(client.lookup(root, "f"), Nfs4Error);
+}
+
+TEST(FakeServer, Nfs4LookupCache) {
+    FakeServer srv;
+    srv.fs().create(fake::FakeFs::ROOT, "f", {});
+    ClientOptions co = srv.client_options();
+    co.lookup_cache  = true;
+    Nfs4Client client(srv.host(), co);
+    const Nfs4Fh root = client.root_fh();
+
+    const Nfs4Fh f = client.lookup(root, "f");
+    EXPECT_EQ(client.lookup(root, "f").data, f.data);
+    EXPECT_THROW(client.lookup(root, "g"), Nfs4Error);
+    EXPECT_THROW(client.lookup(root, "g"), Nfs4Error);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_LOOKUP), 2u);
+
+    client.remove(root, "f");
+    EXPECT_THROW(client.lookup(root, "f"), Nfs4Error);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_LOOKUP), 2u);
+    EXPECT_EQ(client.lookup_cache()->stats().negative_hits, 2u);
+}
+
+TEST(FakeServer, Nfs4ResolvePathInOneCompound) {
+    FakeServer srv;
+    const std::string path = make_deep_path(srv.fs(), 12);
+    Nfs4Client client(srv.host(), srv.client_options());
+
+    srv.reset_counters();
+    const Nfs4PathInfo f = client.resolve_path(path);
+    EXPECT_EQ(srv.rpc_calls(), 1u);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_LOOKUP), 13u);
+    EXPECT_EQ(*f.attrs.type, Ftype4::NF4REG);
+    EXPECT_EQ(client.resolve_path("d0/d1/../d1/d2").fh.data,
+              client.resolve_path("./d0/d1/d2").fh.data);
+
+    const Nfs4Fh d10 = client.resolve_path(path.substr(0, path.size() - 2) + "/..").fh;
+    EXPECT_EQ(client.resolve_path(d10, "d11/f").fh.data, f.fh.data);
+    EXPECT_EQ(*client.resolve_path("/").attrs.type, Ftype4::NF4DIR);
+    EXPECT_TRUE(client.resolve_path("").fh.data.empty());  // the root sentinel
+    try {
+        client.resolve_path("d0/nope/f");
+        FAIL() << "resolved a missing path";
+    } catch (const Nfs4Error& e) {
+        EXPECT_TRUE(e.is(Nfsstat4::NFS4ERR_NOENT));
+    }
+}
+
+TEST(FakeServer, Nfs4ResolvePathSplitsLongCompounds) {
+    FakeServerOptions o;
+    o.max_compound_ops = 6;
+    FakeServer srv(o);
+    const std::string path = make_deep_path(srv.fs(), 12);
+
+    // v4.0 learns the limit from NFS4ERR_RESOURCE ...
+    Nfs4Client v40(srv.host(), srv.client_options());
+    const Nfs4PathInfo a = v40.resolve_path(path);
+    EXPECT_EQ(*a.attrs.type, Ftype4::NF4REG);
+    srv.reset_counters();
+    EXPECT_EQ(v40.resolve_path(path).fh.data, a.fh.data);
+    EXPECT_EQ(srv.rpc_calls(), 5u);                  // 13 names, 3 per COMPOUND
+
+    // ... v4.1 from the session's ca_maxoperations.
+    Nfs41Client v41(srv.host(), srv.client_options());
+    EXPECT_EQ(v41.fore_channel().maxoperations, 6u);
+    srv.reset_counters();
+    EXPECT_EQ(v41.resolve_path(path).fh.data, a.fh.data);
+    EXPECT_EQ(srv.rpc_calls(), 7u);                  // 2 lookups each
+}
+
+TEST(FakeServer, Nfs4CompoundBuilderBatchesUnrelatedOps) {
+    FakeServer srv;
+    srv.fs().create(fake::FakeFs::ROOT, "f", {});
+    Nfs4Client client(srv.host(), srv.client_options());
+    const std::vector<uint8_t> data = pattern(100);
+
+    // Create and fill "g", look at "f" and fail on "nope", all in one go.
+    auto b = client.compound_builder();
+    b.putfh(client.root_fh()).open("g", nfs4::OPEN4_SHARE_ACCESS_WRITE, true)
+     .write(nfs4::ANONYMOUS_STATEID, 0, Stable4::FILE_SYNC, data.data(), 100)
+     .putfh(client.root_fh()).lookup("f").getattr({nfs4::attr::TYPE})
+     .putfh(client.root_fh()).lookup("nope").getfh();
+    srv.reset_counters();
+    const nfs4::CompoundResult r = client.compound(b);
+    EXPECT_EQ(srv.rpc_calls(), 1u);
+
+    EXPECT_EQ(r.ops.size(), 8u);
+    EXPECT_EQ(r.status, static_cast<uint32_t>(Nfsstat4::NFS4ERR_NOENT));
+    EXPECT_EQ(r.get<Nfs4WriteResult>(2).count, 100u);
+    EXPECT_EQ(*r.get<Fattr4>(5).type, Ftype4::NF4REG);
+
+    EXPECT_NO_THROW(r.get<nfs4::Open4Result>(1));
+    const Nfs4File g{client.lookup(client.root_fh(), "g"), nfs4::ANONYMOUS_STATEID, 0};
+    EXPECT_EQ(client.read(g, 0, 200), data);
+}
+
+TEST(FakeServer, Nfs41CompoundBuilderOpenReadClose) {
+    FakeServer srv;
+    const std::vector<uint8_t> data = pattern(5000);
+    const uint64_t id = srv.fs().create(fake::FakeFs::ROOT, "f", {});
+    srv.fs().write(id, 0, data.data(), 5000);
+    Nfs41Client client(srv.host(), srv.client_options());
+
+    auto b = client.compound_builder();
+    b.putfh(client.root_fh()).open("f", nfs4::OPEN4_SHARE_ACCESS_READ, false)
+     .read(nfs4::CURRENT_STATEID, 0, 8192).close(nfs4::CURRENT_STATEID);
+    srv.reset_counters();
+    const nfs4::CompoundResult r = client.compound(b);
+    EXPECT_EQ(srv.rpc_calls(), 1u);
+    r.check();
+    EXPECT_EQ(r.get<Nfs4ReadResult>(2).data, data);
+    EXPECT_TRUE(r.get<Nfs4ReadResult>(2).eof);
+}
+
+TEST(FakeServer, Nfs4WholeFile) {
+    FakeServer srv;
+    ClientOptions co = srv.client_options();
+    co.max_io_size   = 4096;
+    Nfs4Client client(srv.host(), co);
+    const Nfs4Fh root = client.root_fh();
+
+    // OPEN + WRITE, OPEN_CONFIRM (first open of the owner), CLOSE.
+    srv.reset_counters();
+    client.write_whole_file(root, "f", pattern(3000));
+    EXPECT_EQ(srv.rpc_calls(), 3u);
+
+    srv.reset_counters();
+    EXPECT_EQ(client.read_whole_file(root, "f"), pattern(3000));
+    EXPECT_EQ(srv.rpc_calls(), 2u);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN_CONFIRM), 0u);
+
+    // Larger than one chunk; a shorter rewrite truncates.
+    client.write_whole_file(root, "f", pattern(10000));
+    EXPECT_EQ(client.read_whole_file(root, "f"), pattern(10000));
+    client.write_whole_file(root, "f", pattern(10));
+    EXPECT_EQ(client.read_whole_file(root, "f"), pattern(10));
+    EXPECT_THROW(client.read_whole_file(root, "nope"), Nfs4Error);
+}
+
+TEST(FakeServer, Nfs41WholeFileInOneCompound) {
+    FakeServerOptions o;
+    o.max_io_size = 4096;
+    FakeServer srv(o);
+    Nfs41Client client(srv.host(), srv.client_options());
+    const Nfs4Fh root = client.root_fh();
+
+    srv.reset_counters();
+    client.write_whole_file(root, "f", pattern(3000));
+    EXPECT_EQ(client.read_whole_file(root, "f"), pattern(3000));
+    EXPECT_EQ(srv.rpc_calls(), 2u);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_CLOSE), 2u);
+
+    client.write_whole_file(root, "f", pattern(10000));
+    EXPECT_EQ(client.read_whole_file(root, "f"), pattern(10000));
+    client.write_whole_file(root, "f", std::vector<uint8_t>{});
+    EXPECT_TRUE(client.read_whole_file(root, "f").empty());
+    EXPECT_THROW(client.read_whole_file(root, "nope"), Nfs4Error);
+}
+
+TEST(FakeServer, CompoundRetriesOpenDuringGrace) {
+    FakeServer srv;
+    const auto data = pattern(100);
+    srv.fs().write(srv.fs().create(fake::FakeFs::ROOT, "f", {}), 0, data.data(), 100);
+    ClientOptions co = srv.client_options();
+    co.grace_delay   = std::chrono::milliseconds(1);
+    const auto grace = static_cast<uint32_t>(Nfsstat4::NFS4ERR_GRACE);
+
+    Nfs4Client v40(srv.host(), co);
+    srv.fail_nfs4_op(nfs4::OP_OPEN, grace, 2);
+    srv.reset_counters();
+    EXPECT_EQ(v40.read_whole_file(v40.root_fh(), "f"), data);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN), 3u);
+
+    Nfs41Client v41(srv.host(), co);
+    srv.fail_nfs4_op(nfs4::OP_OPEN, grace);
+    srv.reset_counters();
+    EXPECT_EQ(v41.read_whole_file(v41.root_fh(), "f"), data);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN), 2u);
+}
+
+TEST(FakeServer, CompoundCountsOnlySeqidsTheServerReached) {
+    FakeServer srv;
+    const auto data = pattern(100);
+    srv.fs().write(srv.fs().create(fake::FakeFs::ROOT, "f", {}), 0, data.data(), 100);
+    Nfs4Client client(srv.host(), srv.client_options());
+    const Nfs4Fh root = client.root_fh();
+    client.close(client.open_read(root, "f"));      // the owner's seqids start
+
+    // The OPEN behind a failed LOOKUP never runs, so its seqid is not used.
+    auto b = client.compound_builder();
+    b.putfh(root).lookup("nope").open("f", nfs4::OPEN4_SHARE_ACCESS_READ, false);
+    EXPECT_FALSE(client.compound(b).ok());
+
+    // An OPEN that fails still uses its seqid.
+    EXPECT_THROW(client.open_read(root, "nope"), Nfs4Error);
+
+    const Nfs4File f = client.open_read(root, "f");
+    EXPECT_EQ(client.read(f, 0, 100), data);
+    EXPECT_NO_THROW(client.close(f));
+}
+
+TEST(FakeServer, WholeFileClosesWhenGetfhFails) {
+    FakeServer srv;
+    const auto data = pattern(100);
+    srv.fs().write(srv.fs().create(fake::FakeFs::ROOT, "f", {}), 0, data.data(), 100);
+    const auto serverfault = static_cast<uint32_t>(Nfsstat4::NFS4ERR_SERVERFAULT);
+
+    Nfs4Client v40(srv.host(), srv.client_options());
+    srv.fail_nfs4_op(nfs4::OP_GETFH, serverfault);
+    srv.reset_counters();
+    EXPECT_THROW(v40.read_whole_file(v40.root_fh(), "f"), Nfs4Error);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_CLOSE), 1u);
+    srv.fail_nfs4_op(nfs4::OP_GETFH, serverfault);
+    EXPECT_THROW(v40.write_whole_file(v40.root_fh(), "f", data), Nfs4Error);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_CLOSE), 2u);
+
+    Nfs41Client v41(srv.host(), srv.client_options());
+    srv.fail_nfs4_op(nfs4::OP_GETFH, serverfault);
+    srv.reset_counters();
+    EXPECT_THROW(v41.read_whole_file(v41.root_fh(), "f"), Nfs4Error);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_CLOSE), 1u);
+    EXPECT_NO_THROW(v41.read_whole_file(v41.root_fh(), "f"));
+}
+
+TEST(FakeServer, WholeFileWithServerIoBelowClients) {
+    // The client asks for 1 MiB; the server takes 64 KiB and returns READs
+    // shorter still, none of them at EOF until the end.
+    FakeServerOptions o;
+    o.max_io_size = 64 * 1024;
+    o.short_read  = 5000;
+    FakeServer srv(o);
+    const auto data = pattern(200000);
+
+    Nfs4Client v40(srv.host(), srv.client_options());
+    v40.write_whole_file(v40.root_fh(), "f", data);
+    EXPECT_EQ(v40.read_whole_file(v40.root_fh(), "f"), data);
+
+    // v4.1 keeps the file open across the rest of the chunks, CLOSE last.
+    Nfs41Client v41(srv.host(), srv.client_options());
+    srv.reset_counters();
+    v41.write_whole_file(v41.root_fh(), "g", data);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN), 1u);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_WRITE), 4u);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_CLOSE), 1u);
+    EXPECT_EQ(v41.read_whole_file(v41.root_fh(), "g"), data);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN), 3u);      // again after the first READ
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_CLOSE), 3u);
+}
+
+TEST(FakeServer, Nfs41ReadGoesOnPastShortReads) {
+    FakeServerOptions o;
+    o.short_read = 1000;
+    FakeServer srv(o);
+    const auto data = pattern(5000);
+    srv.fs().write(srv.fs().create(fake::FakeFs::ROOT, "f", {}), 0, data.data(), 5000);
+    Nfs41Client client(srv.host(), srv.client_options());
+
+    const Nfs4File f = client.open_read(client.root_fh(), "f");
+    EXPECT_EQ(client.read(f, 0, 3000), std::vector<uint8_t>(data.begin(), data.begin() + 3000));
+    EXPECT_EQ(client.read(f, 0, 8000), data);            // stops at EOF
+
+    std::vector<uint8_t> buf(8000);
+    EXPECT_EQ(client.read_into(f, 0, buf.data(), 8000), 5000u);
+    buf.resize(5000);
+    EXPECT_EQ(buf, data);
+    client.close(f);
+}
+
+TEST(FakeServer, Nfs41SessionOverSeveralConnections) {
+    FakeServerOptions o;
+    o.max_session_slots = 4;
+    o.max_io_size       = 64 * 1024;
+    FakeServer srv(o);
+
+    ClientOptions co = srv.client_options();
+    co.nconnect      = 2;
+    co.session_slots = 16;
+    Nfs41Client client(srv.host(), co);
+    EXPECT_EQ(client.fore_channel().maxrequests, 4u);
+    EXPECT_EQ(client.max_write_size(), 64u * 1024);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_BIND_CONN_TO_SESSION), 1u);
+
+    // Larger than one COMPOUND may carry: split by the client.
+    const auto data = pattern(200000);
+    Nfs4File f = client.open_write(client.root_fh(), "f");
+    EXPECT_EQ(client.write(f, 0, Stable4::UNSTABLE, data.data(),
+                           static_cast<uint32_t>(data.size())), data.size());
+    client.commit(f);
+    client.close(f);
+    f = client.open_read(client.root_fh(), "f");
+    EXPECT_EQ(client.read(f, 0, 300000), data);
+    client.close(f);
+    EXPECT_EQ(srv.nfs4_ops(nfs4::OP_OPEN_CONFIRM), 0u);
+}
+
+TEST(FakeServer, Nfs41RejectsMisorderedSequence) {
+    FakeServer srv;
+    Nfs41Client client(srv.host(), srv.client_options());
+    TcpRpcClient rpc(srv.host(), srv.port());
+
+    XdrEncoder ops;
+    nfs4::encode_sequence41(ops, client.session_id(), 1000, 0);
+    const auto reply = nfs4::call_compound(rpc, "", ops, 1, 1);
+    XdrDecoder dec(reply);
+    EXPECT_EQ(dec.get_uint32(), static_cast<uint32_t>(Nfsstat4::NFS4ERR_SEQ_MISORDERED));
+}
+
+TEST(FakeServer, Nfs41SlotSurvivesDroppedReply) {
+    // The server runs a READ but its connection fails before the reply.  The
+    // slot's next COMPOUND, on the other connection, must be taken neither
+    // for a retry of that READ nor as misordered.
+    FakeServer srv;
+    const auto data = pattern(100);
+    srv.fs().write(srv.fs().create(fake::FakeFs::ROOT, "f", {}), 0, data.data(), 100);
+    ClientOptions co = srv.client_options();
+    co.nconnect      = 2;
+    co.session_slots = 1;
+
+    for (const bool async : {false, true}) {
+        Nfs41Client client(srv.host(), co);
+        const Nfs4File f = client.open_read(client.root_fh(), "f");
+        auto read = [&] {
+            EXPECT_EQ(async ? client.read_async(f, 0, 100).get() : client.read(f, 0, 100), data);
+        };
+        srv.drop_replies();
+        EXPECT_ANY_THROW(read());
+
+        unsigned ok = 0;
+        for (int i = 0; i < 4; ++i) {
+            try {
+                read();
+                ++ok;
+            } catch (const Nfs4Error& e) {
+                ADD_FAILURE() << e.what();
+            } catch (const std::exception&) {
+                // the connection that was dropped
+            }
+        }
+        EXPECT_EQ(ok, 2u);
+    }
+}
+
+TEST(FakeServer, Nfs4PipelinedReadWrite) {
+    FakeServerOptions o;
+    o.latency = std::chrono::milliseconds(10);
+    FakeServer srv(o);
+    Nfs4Client client(srv.host(), srv.client_options());
+    const Nfs4Fh root = client.root_fh();
+
+    const auto data = pattern(16 * 4096);
+    Nfs4File f = client.open_write(root, "f");
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::future<uint32_t>> writes;
+    for (uint32_t i = 0; i < 16; ++i)
+        writes.push_back(client.write_async(f, i * 4096, Stable4::FILE_SYNC,
+                                            data.data() + i * 4096, 4096));
+    for (auto& w : writes) EXPECT_EQ(w.get(), 4096u);
+    EXPECT_LT(elapsed_ms(t0), 16 * 10.0 / 2);
+    client.close(f);
+
+    f = client.open_read(root, "f");
+    std::vector<std::future<std::vector<uint8_t>>> reads;
+    for (uint32_t i = 0; i < 16; ++i) reads.push_back(client.read_async(f, i * 4096, 4096));
+    std::vector<uint8_t> back;
+    for (auto& r : reads) {
+        const auto chunk = r.get();
+        back.insert(back.end(), chunk.begin(), chunk.end());
+    }
+    EXPECT_EQ(back, data);
+    EXPECT_THROW(client.read_async(Nfs4File{}, 0, 4096).get(), Nfs4Error);
+    client.close(f);
+}
+
+TEST(FakeServer, Nfs41PipelinedDeeperThanSlotTable) {
+    FakeServerOptions o;
+    o.max_session_slots = 4;
+    FakeServer srv(o);
+    Nfs41Client client(srv.host(), srv.client_options());
+
+    // 32 in flight over 4 slots: each slot is freed when its reply arrives,
+    // before anything is collected, so issuing never waits on the caller.
+    const auto data = pattern(32 * 1024);
+    Nfs4File f = client.open_write(client.root_fh(), "f");
+    std::vector<std::future<uint32_t>> writes;
+    for (uint32_t i = 0; i < 32; ++i)
+        writes.push_back(client.write_async(f, i * 1024, Stable4::FILE_SYNC,
+                                            data.data() + i * 1024, 1024));
+    for (auto& w : writes) EXPECT_EQ(w.get(), 1024u);
+
+    std::vector<std::future<std::vector<uint8_t>>> reads;
+    for (uint32_t i = 0; i < 32; ++i) reads.push_back(client.read_async(f, i * 1024, 1024));
+    std::vector<uint8_t> back;
+    for (auto& r : reads) {
+        const auto chunk = r.get();
+        back.insert(back.end(), chunk.begin(), chunk.end());
+    }
+    EXPECT_EQ(back, data);
+    EXPECT_THROW(client.read_async(f, 0, client.max_read_size() + 1), std::invalid_argument);
+
+    // A failed op still gives its slot back.
+    for (int i = 0; i < 8; ++i)
+        EXPECT_THROW(client.read_async(Nfs4File{}, 0, 1024).get(), Nfs4Error);
+    EXPECT_EQ(client.read(f, 0, 1024).size(), 1024u);
+    client.close(f);
+}
+
+// ── Link model ───────────────────────────────────────────────────────────────
+
+TEST(FakeServer, LatencyDelaysEveryReply) {
+    FakeServerOptions o;
+    o.latency = std::chrono::milliseconds(20);
+    FakeServer srv(o);
+    NFSClient client(srv.host(), srv.client_options());
+    const Fh3 root = client.mount(srv.export_path());
+
+    auto t0 = std::chrono::steady_clock::now();
+    client.getattr(root);
+    EXPECT_GE(elapsed_ms(t0), 20.0);
+
+    // Pipelined calls overlap their delays instead of adding them up.
+    const Fh3 file = client.create(root, "f");
+    t0 = std::chrono::steady_clock::now();
+    std::vector<std::future<std::vector<uint8_t>>> reads;
+    for (int i = 0; i < 16; ++i) reads.push_back(client.read_async(file, 0, 4096));
+    for (auto& r : reads) r.get();
+    EXPECT_LT(elapsed_ms(t0), 16 * 20.0 / 2);
+}
+
+TEST(FakeServer, BandwidthLimitsThroughput) {
+    FakeServerOptions o;
+    o.bandwidth = 1 << 20;                           // 1 MiB/s
+    FakeServer srv(o);
+    NFSClient client(srv.host(), srv.client_options());
+    const Fh3 root = client.mount(srv.export_path());
+    const Fh3 file = client.create(root, "f");
+
+    const auto data = pattern(128 * 1024);
+    const auto t0 = std::chrono::steady_clock::now();
+    client.write(file, 0, Stable3::UNSTABLE, data);
+    EXPECT_GE(elapsed_ms(t0), 100.0);                // 128 KiB at 1 MiB/s = 125 ms
+
+    srv.reset_counters();
+    EXPECT_EQ(srv.rpc_calls(), 0u);
+}
@@ -1,4 +1,5 @@
 #include "nfs4/compound.hpp"
+#include "nfs4/compound_builder.hpp"
 #include "nfs4/fh_ops.hpp"
 #include "xdr/xdr.hpp"
 
@@ -188,3 +189,55 @@ TEST(Nfs4Compound, CheckCompoundStatusError) {
     XdrDecoder dec(reply);
     EXPECT_THROW(nfs4::check_compound_status(dec), Nfs4Error);
 }
+
+// ── CompoundBuilder ──────────────────────────────────────────────────────────
+
+TEST(Nfs4CompoundBuilder, CountsOpsAndPatchesSeqids) {
+    nfs4::CompoundBuilder b({0x1122334455667788ull, "owner"});
+    b.putfh(Nfs4Fh{}).open("f", nfs4::OPEN4_SHARE_ACCESS_READ, false).getfh()
+     .close(nfs4::CURRENT_STATEID);
+    EXPECT_EQ(b.num_ops(), 4u);
+    ASSERT_EQ(b.num_seqids(), 2u);
+    b.set_seqid(0, 7);
+    b.set_seqid(1, 8);
+
+    const std::vector<uint8_t> bytes = b.ops().bytes();
+    XdrDecoder dec(bytes);
+    EXPECT_EQ(dec.get_uint32(), nfs4::OP_PUTROOTFH);     // empty handle = root
+    EXPECT_EQ(dec.get_uint32(), nfs4::OP_OPEN);
+    EXPECT_EQ(dec.get_uint32(), 7u);                     // seqid
+    EXPECT_EQ(dec.get_uint32(), nfs4::OPEN4_SHARE_ACCESS_READ);
+    EXPECT_EQ(dec.get_uint32(), nfs4::OPEN4_SHARE_DENY_NONE);
+    EXPECT_EQ(dec.get_uint64(), 0x1122334455667788ull);  // clientid
+    EXPECT_EQ(dec.get_string(), "owner");
+}
+
+TEST(Nfs4CompoundBuilder, DecodesResultsUpToTheFailingOp) {
+    nfs4::CompoundBuilder b;
+    b.putrootfh().getfh().lookup("missing").getfh();
+
+    std::vector<uint8_t> reply;
+    append_u32(reply, 2);   // COMPOUND status: NFS4ERR_NOENT
+    append_u32(reply, 0);   // tag
+    append_u32(reply, 3);   // numres
+    append_u32(reply, nfs4::OP_PUTROOTFH);
+    append_u32(reply, 0);
+    append_u32(reply, nfs4::OP_GETFH);
+    append_u32(reply, 0);
+    append_u32(reply, 4);
+    reply.insert(reply.end(), {1, 2, 3, 4});
+    append_u32(reply, nfs4::OP_LOOKUP);
+    append_u32(reply, 2);
+
+    XdrDecoder dec(reply);
+    const nfs4::CompoundResult r = b.decode(dec);
+    EXPECT_FALSE(r.ok());
+    EXPECT_EQ(r.status, 2u);
+    ASSERT_EQ(r.ops.size(), 3u);
+    EXPECT_EQ(r.get<Nfs4Fh>(1).data, (std::vector<uint8_t>{1, 2, 3, 4}));
+    EXPECT_EQ(r.ops[2].op, nfs4::OP_LOOKUP);
+    EXPECT_EQ(r.ops[2].status, 2u);
+    EXPECT_THROW(r.get<Nfs4Fh>(3), Nfs4Error);           // never ran
+    EXPECT_THROW(r.get<Nfs4Fh>(0), std::bad_variant_access);
+    EXPECT_THROW(r.check(), Nfs4Error);
+}
@@ -13,12 +13,15 @@
 #include "nfs4/create.hpp"
 #include "nfs4/readdir.hpp"
 #include "nfs4/readlink.hpp"
+#include "nfs4/session41.hpp"
+#include "nfs4/slot_table41.hpp"
 #include "nfs4/nfs4_types.hpp"
 #include "nfs4/nfs4_attr.hpp"
 #include "xdr/xdr.hpp"
 
 #include <gtest/gtest.h>
 #include <array>
+#include <future>
 #include <cstdint>
 #include <vector>
 
@@ -562,3 +565,228 @@ TEST(Nfs4Ops, RestorefhDecodeOk) {
     XdrDecoder dec(reply);
     EXPECT_NO_THROW(decode_restorefh_result(dec));
 }
+
+TEST(Nfs4Ops, BindConnToSessionEncode) {
+    SessionId41 sid{};
+    for (size_t i = 0; i < sid.size(); ++i) sid[i] = static_cast<uint8_t>(i);
+    XdrEncoder enc;
+    encode_bind_conn_to_session(enc, sid);
+    const auto b = enc.bytes();
+    ASSERT_EQ(b.size(), 4u + 16u + 4u + 4u);
+    XdrDecoder dec(b);
+    EXPECT_EQ(dec.get_uint32(), OP_BIND_CONN_TO_SESSION);
+    EXPECT_EQ(dec.get_fixed_opaque(16), std::vector<uint8_t>(sid.begin(), sid.end()));
+    EXPECT_EQ(dec.get_uint32(), CDFC4_FORE);
+    EXPECT_EQ(dec.get_uint32(), 0u);  // not RDMA
+}
+
+TEST(Nfs4Ops, BindConnToSessionWantsForeChannel) {
+    auto reply_for = [](uint32_t dir) {
+        std::vector<uint8_t> reply;
+        append_u32(reply, OP_BIND_CONN_TO_SESSION);
+        append_u32(reply, 0);
+        reply.insert(reply.end(), 16, 0);           // bctsr_sessid
+        append_u32(reply, dir);
+        append_u32(reply, 0);                       // not RDMA
+        return reply;
+    };
+    const auto fore = reply_for(CDFS4_FORE);
+    XdrDecoder ok(fore);
+    EXPECT_NO_THROW(decode_bind_conn_to_session_result(ok));
+    const auto both = reply_for(CDFS4_BOTH);
+    XdrDecoder bad(both);
+    EXPECT_THROW(decode_bind_conn_to_session_result(bad), std::runtime_error);
+}
+
+TEST(Nfs4Ops, BindConnToSessionDecodeError) {
+    std::vector<uint8_t> reply;
+    append_u32(reply, OP_BIND_CONN_TO_SESSION);
+    append_u32(reply, 10052);  // NFS4ERR_BADSESSION
+    XdrDecoder dec(reply);
+    EXPECT_THROW(decode_bind_conn_to_session_result(dec), Nfs4Error);
+}
+
+// ── CREATE_SESSION / SEQUENCE ─────────────────────────────────────────────────
+
+TEST(Nfs4Ops, CreateSessionRequestsSlots) {
+    ChannelAttrs41 fore;
+    fore.maxrequests = 32;
+    XdrEncoder enc;
+    encode_create_session(enc, 0x1122334455667788ULL, 7, fore);
+    XdrDecoder dec(enc.bytes());
+    EXPECT_EQ(dec.get_uint32(), OP_CREATE_SESSION);
+    EXPECT_EQ(dec.get_uint64(), 0x1122334455667788ULL);
+    EXPECT_EQ(dec.get_uint32(), 7u);   // csa_sequence
+    EXPECT_EQ(dec.get_uint32(), 0u);   // csa_flags
+    for (int i = 0; i < 5; ++i) dec.get_uint32();
+    EXPECT_EQ(dec.get_uint32(), 32u);  // fore ca_maxrequests
+}
+
+TEST(Nfs4Ops, CreateSessionDecodeGrantedAttrs) {
+    std::vector<uint8_t> reply;
+    append_u32(reply, OP_CREATE_SESSION);
+    append_u32(reply, 0);
+    for (int i = 0; i < 4; ++i) append_u32(reply, 0xA0A0A0A0u + i);  // sessionid
+    append_u32(reply, 1);      // csr_sequence
+    append_u32(reply, 0);      // csr_flags
+    const uint32_t fore[] = {0, 1048576, 1048576, 4096, 8, 20};
+    for (uint32_t v : fore) append_u32(reply, v);
+    append_u32(reply, 0);      // rdma_ird count
+    for (int i = 0; i < 6; ++i) append_u32(reply, 1);
+    append_u32(reply, 1);      // back rdma_ird count = 1
+    append_u32(reply, 9);
+
+    XdrDecoder dec(reply);
+    auto r = decode_create_session_result(dec);
+    EXPECT_EQ(r.sessionid[3], 0xA0u);
+    EXPECT_EQ(r.fore.maxrequestsize, 1048576u);
+    EXPECT_EQ(r.fore.maxrequests, 20u);
+    EXPECT_EQ(r.back.maxrequests, 1u);
+    EXPECT_EQ(dec.remaining(), 0u);
+}
+
+TEST(Nfs4Ops, SequenceDecodeSlotFields) {
+    std::vector<uint8_t> reply;
+    append_u32(reply, OP_SEQUENCE);
+    append_u32(reply, 0);
+    for (int i = 0; i < 4; ++i) append_u32(reply, 0);
+    append_u32(reply, 5);    // sequenceid
+    append_u32(reply, 2);    // slotid
+    append_u32(reply, 15);   // highest_slotid
+    append_u32(reply, 7);    // target_highest_slotid
+    append_u32(reply, 0);    // status flags
+    XdrDecoder dec(reply);
+    auto r = decode_sequence41_result(dec);
+    EXPECT_EQ(r.sequenceid, 5u);
+    EXPECT_EQ(r.slotid, 2u);
+    EXPECT_EQ(r.highest_slotid, 15u);
+    EXPECT_EQ(r.target_highest_slotid, 7u);
+}
+
+TEST(Nfs4Ops, MaxIoPayloadLeavesHeadroom) {
+    EXPECT_EQ(max_io_payload((1u << 20) + CHANNEL_IO_HEADROOM), 1u << 20);
+    EXPECT_EQ(max_io_payload(1u << 20), (1u << 20) - 4096);   // rounded to 4 KiB
+    EXPECT_EQ(max_io_payload(65536), 61440u);
+    EXPECT_EQ(max_io_payload(CHANNEL_IO_HEADROOM + 100), 100u);
+    EXPECT_EQ(max_io_payload(512), 1u);
+}
+
+// ── SlotTable41 ───────────────────────────────────────────────────────────────
+
+static SequenceResult41 seq_reply(uint32_t highest, uint32_t target) {
+    SequenceResult41 r;
+    r.highest_slotid        = highest;
+    r.target_highest_slotid = target;
+    return r;
+}
+
+TEST(SlotTable41, LowestFreeSlotAndPerSlotSeqids) {
+    SlotTable41 t(4);
+    auto a = t.acquire();
+    auto b = t.acquire();
+    EXPECT_EQ(a.slotid, 0u);
+    EXPECT_EQ(b.slotid, 1u);
+    EXPECT_EQ(b.highest_slotid, 1u);
+    EXPECT_EQ(a.seqid, 1u);
+
+    t.complete(a, seq_reply(3, 3));
+    auto c = t.acquire();
+    EXPECT_EQ(c.slotid, 0u);
+    EXPECT_EQ(c.seqid, 2u);   // slot 0 advanced
+    t.release(b);             // no SEQUENCE result: seqid unchanged
+    auto d = t.acquire();
+    EXPECT_EQ(d.slotid, 1u);
+    EXPECT_EQ(d.seqid, 1u);
+}
+
+TEST(SlotTable41, ServerTargetShrinksAndGrowsTable) {
+    SlotTable41 t(8);
+    auto s = t.acquire();
+    t.complete(s, seq_reply(7, 1));      // target: slots 0..1
+    EXPECT_EQ(t.usable(), 2u);
+
+    auto a = t.acquire();
+    auto b = t.acquire();
+    EXPECT_LT(a.slotid, 2u);
+    EXPECT_LT(b.slotid, 2u);
+
+    t.complete(a, seq_reply(15, 15));    // server raises the ceiling
+    EXPECT_EQ(t.usable(), 16u);
+    EXPECT_EQ(t.capacity(), 16u);
+    auto c = t.acquire();
+    EXPECT_EQ(c.slotid, 0u);
+    auto d = t.acquire();
+    EXPECT_EQ(d.slotid, 2u);
+    EXPECT_EQ(d.seqid, 1u);              // dropped slot restarts at 1
+    t.release(b);
+    t.release(c);
+    t.release(d);
+}
+
+TEST(SlotTable41, SlotsAboveTargetKeepSeqidsUntilDropped) {
+    SlotTable41 t(4);
+    auto a = t.acquire();
+    auto b = t.acquire();
+    auto c = t.acquire();
+    t.complete(c, seq_reply(3, 3));
+    t.complete(a, seq_reply(3, 0));      // target: slot 0; server keeps 0..3
+    EXPECT_EQ(t.usable(), 1u);
+    t.complete(b, seq_reply(3, 0));      // slot 1 parked above the target
+
+    auto d = t.acquire();
+    EXPECT_EQ(d.slotid, 0u);
+    t.complete(d, seq_reply(3, 3));      // target raised again
+    EXPECT_EQ(t.usable(), 4u);
+    auto e = t.acquire();
+    auto f = t.acquire();
+    auto g = t.acquire();
+    EXPECT_EQ(f.slotid, 1u);
+    EXPECT_EQ(f.seqid, 2u);              // not restarted: the server still has it
+    EXPECT_EQ(g.slotid, 2u);
+    EXPECT_EQ(g.seqid, 2u);
+
+    t.complete(e, seq_reply(1, 1));      // server drops slots 2..3
+    t.release(f);
+    t.release(g);
+    auto h = t.acquire();
+    t.complete(h, seq_reply(3, 3));
+    auto i = t.acquire();
+    auto j = t.acquire();
+    auto k = t.acquire();
+    EXPECT_EQ(j.slotid, 1u);
+    EXPECT_EQ(j.seqid, 2u);
+    EXPECT_EQ(k.slotid, 2u);
+    EXPECT_EQ(k.seqid, 1u);              // dropped slot restarts at 1
+    t.release(i);
+    t.release(j);
+    t.release(k);
+}
+
+TEST(SlotTable41, LostSlotWaitsForResync) {
+    SlotTable41 t(1);
+    auto a = t.acquire();
+    EXPECT_FALSE(a.resync);
+    t.lost(a);                           // no reply: seqid 1 may have run
+
+    auto b = t.acquire();
+    EXPECT_EQ(b.seqid, 1u);
+    EXPECT_TRUE(b.resync);
+    b = t.resync(b, 3);                  // it had, and so had a probe at 2
+    EXPECT_EQ(b.seqid, 3u);
+    EXPECT_FALSE(b.resync);
+    t.complete(b, seq_reply(0, 0));
+
+    auto c = t.acquire();
+    EXPECT_EQ(c.seqid, 4u);
+    EXPECT_FALSE(c.resync);
+}
+
+TEST(SlotTable41, WaiterGetsReleasedSlot) {
+    SlotTable41 t(1);
+    auto held = t.acquire();
+    auto waiter = std::async(std::launch::async, [&] { return t.acquire(); });
+    t.complete(held, seq_reply(0, 0));
+    auto got = waiter.get();
+    EXPECT_EQ(got.slotid, 0u);
+    EXPECT_EQ(got.seqid, 2u);
+}
@@ -1,3 +1,5 @@
+#include "dentry_cache.hpp"
+#include "nfs/attr_cache.hpp"
 #include "nfs/lookup.hpp"
 #include "nfs/read.hpp"
 #include "nfs/write.hpp"
@@ -5,6 +7,13 @@
 
 #include <gtest/gtest.h>
 
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 // ── Helpers ──────────────────────────────────────────────────────────────────
 
 static Fh3 make_fh(std::initializer_list<uint8_t> bytes) {
@@ -89,6 +98,32 @@ TEST(ReadDecode, NonZeroStatusThrows) {
     EXPECT_THROW(nfs3::decode_read_reply(enc.release()), std::runtime_error);
 }
 
+TEST(ReadDecode, StreamingPlacesDataInCallerBuffer) {
+    const std::vector<uint8_t> file_data = {0x41, 0x42, 0x43};
+    XdrEncoder enc;
+    enc.put_uint32(0u);          // NFS3_OK
+    enc.put_uint32(1u);          // attributes_follow = TRUE
+    for (int i = 0; i < 21; ++i) enc.put_uint32(0u);  // fattr3 (84 bytes)
+    enc.put_uint32(3u);          // count
+    enc.put_uint32(1u);          // eof = true
+    enc.put_opaque(file_data);   // data
+    const auto record = TcpRpcClient::addRecordMark(enc.release());
+
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    send(sv[1], record.data(), record.size(), 0);
+
+    RecordReader rr(sv[0]);
+    uint8_t buf[16] = {};
+    const ReadResult r = nfs3::decode_read_reply_into(rr, buf, sizeof(buf));
+    ASSERT_EQ(r.count, 3u);
+    EXPECT_TRUE(r.eof);
+    EXPECT_TRUE(std::equal(file_data.begin(), file_data.end(), buf));
+
+    close(sv[0]);
+    close(sv[1]);
+}
+
 // ── WRITE ────────────────────────────────────────────────────────────────────
 
 TEST(WriteEncode, ArgsLayout) {
@@ -136,3 +171,181 @@ TEST(WriteDecode, NonZeroStatusThrows) {
 
     EXPECT_THROW(nfs3::decode_write_reply(enc.release()), std::runtime_error);
 }
+
+TEST(WriteDecode, WccDataUpdatesAttrCache) {
+    const Fh3 fh = make_fh({0x01, 0x02, 0x03, 0x04});
+    Fattr3 after{};
+    after.type = Ftype3::NF3REG;
+    after.size = 100;
+
+    XdrEncoder enc;
+    enc.put_uint32(0u);   // NFS3_OK
+    enc.put_uint32(0u);   // pre_op_attr FALSE
+    enc.put_uint32(1u);   // post_op_attr TRUE
+    xdr_encode(enc, after);
+    enc.put_uint32(100u);
+    enc.put_uint32(static_cast<uint32_t>(Stable3::FILE_SYNC));
+    enc.put_fixed_opaque(std::array<uint8_t, 8>{}.data(), 8);
+
+    nfs3::AttrCache cache;
+    nfs3::decode_write_reply(enc.release(), &cache, fh);
+    const auto cached = cache.get(fh);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->size, 100u);
+}
+
+// ── Attribute cache ──────────────────────────────────────────────────────────
+
+static Fattr3 reg_attrs(uint64_t size, uint32_t mtime) {
+    Fattr3 a{};
+    a.type  = Ftype3::NF3REG;
+    a.size  = size;
+    a.mtime = a.ctime = Nfstime3{mtime, 0};
+    return a;
+}
+
+static WccData3 wcc(const Fattr3& before, const Fattr3& after) {
+    WccData3 w;
+    w.before = PreOpAttr3{true, WccAttr3{before.size, before.mtime, before.ctime}};
+    w.after  = PostOpAttr3{true, after};
+    return w;
+}
+
+TEST(AttrCache, WccMatchingPreOpIsOurOwnChange) {
+    nfs3::AttrCache cache;
+    const Fh3 fh = make_fh({1});
+    cache.update(fh, reg_attrs(10, 1));
+
+    EXPECT_TRUE(cache.update(fh, wcc(reg_attrs(10, 1), reg_attrs(20, 2))));
+    EXPECT_EQ(cache.get(fh)->size, 20u);
+    EXPECT_EQ(cache.stats().foreign_changes, 0u);
+
+    // Someone else grew the file to 30 before our write took it to 40.
+    EXPECT_FALSE(cache.update(fh, wcc(reg_attrs(30, 3), reg_attrs(40, 4))));
+    EXPECT_EQ(cache.get(fh)->size, 40u);
+    EXPECT_EQ(cache.stats().foreign_changes, 1u);
+}
+
+TEST(AttrCache, MissingPostOpDropsEntry) {
+    nfs3::AttrCache cache;
+    const Fh3 fh = make_fh({1});
+    cache.update(fh, reg_attrs(10, 1));
+    WccData3 w = wcc(reg_attrs(10, 1), reg_attrs(0, 0));
+    w.after.present = false;
+    cache.update(fh, w);
+    EXPECT_FALSE(cache.get(fh).has_value());
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(AttrCache, TimeoutDoublesWhileUnchangedAndResetsOnChange) {
+    nfs3::AttrCacheTimeouts t;
+    t.acregmin = std::chrono::milliseconds(100);
+    t.acregmax = std::chrono::milliseconds(1000);
+    nfs3::AttrCache cache(t);
+    const Fh3 fh = make_fh({1});
+
+    cache.update(fh, reg_attrs(10, 1));
+    cache.update(fh, reg_attrs(10, 1));          // confirmed: 200 ms
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_TRUE(cache.get(fh).has_value());
+
+    cache.update(fh, reg_attrs(11, 2));          // changed: back to 100 ms
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_FALSE(cache.get(fh).has_value());
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST(AttrCache, IgnoresAttributesOlderThanCached) {
+    nfs3::AttrCache cache;
+    const Fh3 fh = make_fh({1});
+    cache.update(fh, reg_attrs(20, 2));
+
+    // Replies to earlier calls, handled after the one above.
+    cache.update(fh, reg_attrs(10, 1));
+    EXPECT_TRUE(cache.update(fh, wcc(reg_attrs(0, 0), reg_attrs(10, 1))));
+    EXPECT_EQ(cache.get(fh)->size, 20u);
+    EXPECT_EQ(cache.stats().out_of_order, 2u);
+    EXPECT_EQ(cache.stats().foreign_changes, 0u);
+
+    cache.update(fh, reg_attrs(30, 3));
+    EXPECT_EQ(cache.get(fh)->size, 30u);
+}
+
+TEST(AttrCache, EvictsLeastRecentlyUsedWhenFull) {
+    nfs3::AttrCache cache({}, 2);
+    cache.update(make_fh({1}), reg_attrs(1, 1));
+    cache.update(make_fh({2}), reg_attrs(2, 1));
+    EXPECT_TRUE(cache.get(make_fh({1})).has_value());   // 2 is now the oldest
+    cache.update(make_fh({3}), reg_attrs(3, 1));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.get(make_fh({1})).has_value());
+    EXPECT_FALSE(cache.get(make_fh({2})).has_value());
+    EXPECT_TRUE(cache.get(make_fh({3})).has_value());
+
+    cache.invalidate(make_fh({1}));
+    cache.update(make_fh({4}), reg_attrs(4, 1));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.get(make_fh({3})).has_value());
+}
+
+// ── Lookup cache ─────────────────────────────────────────────────────────────
+
+using Dentries = DentryCache<Fh3>;
+
+TEST(DentryCache, PositiveAndNegativeEntries) {
+    Dentries cache(std::chrono::seconds(30));
+    const Fh3 dir = make_fh({9});
+    EXPECT_EQ(cache.get(dir, "a").state, Dentries::State::MISS);
+
+    cache.put(dir, "a", make_fh({1}));           // directory not observed yet
+    EXPECT_EQ(cache.size(), 0u);
+
+    cache.observe_dir(dir, 100);
+    cache.put(dir, "a", make_fh({1}));
+    cache.put_negative(dir, "b");
+    const auto a = cache.get(dir, "a");
+    EXPECT_EQ(a.state, Dentries::State::FOUND);
+    EXPECT_EQ(a.fh, make_fh({1}));
+    EXPECT_EQ(cache.get(dir, "b").state, Dentries::State::NOT_FOUND);
+    EXPECT_EQ(cache.get(make_fh({8}), "a").state, Dentries::State::MISS);
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().negative_hits, 1u);
+}
+
+TEST(DentryCache, DirectoryChangeDropsEntries) {
+    Dentries cache(std::chrono::seconds(30));
+    const Fh3 dir = make_fh({9});
+    cache.observe_dir(dir, 100);
+    cache.put_negative(dir, "b");
+    cache.observe_dir(dir, 100);
+    EXPECT_EQ(cache.get(dir, "b").state, Dentries::State::NOT_FOUND);
+
+    cache.observe_dir(dir, 101);
+    EXPECT_EQ(cache.get(dir, "b").state, Dentries::State::MISS);
+    EXPECT_EQ(cache.stats().invalidations, 1u);
+}
+
+TEST(DentryCache, ExpiredDirectoryNeedsRevalidation) {
+    Dentries cache(std::chrono::milliseconds(50));
+    const Fh3 dir = make_fh({9});
+    cache.observe_dir(dir, 100);
+    cache.put(dir, "a", make_fh({1}));
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_EQ(cache.get(dir, "a").state, Dentries::State::REVALIDATE);
+    cache.observe_dir(dir, 100);
+    EXPECT_EQ(cache.get(dir, "a").state, Dentries::State::FOUND);
+}
+
+TEST(DentryCache, EvictsLeastRecentlyUsed) {
+    Dentries cache(std::chrono::seconds(30), 2);
+    const Fh3 dir = make_fh({9});
+    cache.observe_dir(dir, 100);
+    cache.put(dir, "a", make_fh({1}));
+    cache.put(dir, "b", make_fh({2}));
+    cache.get(dir, "a");
+    cache.put(dir, "c", make_fh({3}));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.get(dir, "a").state, Dentries::State::FOUND);
+    EXPECT_EQ(cache.get(dir, "b").state, Dentries::State::MISS);
+}
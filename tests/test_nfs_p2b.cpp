@@ -239,7 +239,7 @@ TEST(PathconfDecode, OkParsesFlags) {
 // addRecordMark / parseReply are pure static helpers we can test without a socket.
 // To test multi-fragment reassembly we synthesise two record-mark prefixed
 // fragments and feed them to the reassembly logic indirectly via the RPC reply
-// parser — but since recvRecord() is non-static we instead test the contract
+// parser — but since RecordReader needs a socket we instead test the contract
 // through a lower-level byte inspection of addRecordMark.
 
 TEST(RecordMark, LastFragmentBitSet) {
@@ -262,7 +262,7 @@ TEST(RecordMark, TwoFragmentsConcatenated) {
     // Simulate the bytes that would arrive on the wire for a two-fragment record.
     // Fragment 1: not-last, data = {0x01, 0x02}
     // Fragment 2: last,     data = {0x03, 0x04}
-    // recvRecord() should reassemble them into {0x01, 0x02, 0x03, 0x04}.
+    // RecordReader should reassemble them into {0x01, 0x02, 0x03, 0x04}.
     // We verify this by inspecting the addRecordMark output format.
 
     // Fragment 1 mark: bit31=0 (not last), length=2
@@ -1,8 +1,18 @@
 #include "rpc/rpc_client.hpp"
+#include "rpc/rpc_pool.hpp"
 #include "xdr/xdr.hpp"
 
 #include <gtest/gtest.h>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
 // ── buildCallMessage ──────────────────────────────────────────────────────────
 
 TEST(TcpRpcClient, BuildCallMessageLayout) {
@@ -76,11 +86,11 @@ static std::vector<uint8_t> makeAcceptedReply(uint32_t xid, uint32_t result) {
     return enc.release();
 }
 
-TEST(TcpRpcClient, ParseReplyReturnsResultBody) {
+TEST(TcpRpcClient, ParseReplyReturnsResultBodyOffset) {
     const auto record = makeAcceptedReply(0xABCDu, 0xCAFEBABEu);
-    const auto result = TcpRpcClient::parseReply(record);
-    ASSERT_EQ(result.size(), 4u);
-    XdrDecoder dec(result);
+    const size_t body = TcpRpcClient::parseReply(record);
+    ASSERT_EQ(record.size() - body, 4u);
+    XdrDecoder dec(record.data() + body, record.size() - body);
     EXPECT_EQ(dec.get_uint32(), 0xCAFEBABEu);
 }
 
@@ -112,3 +122,375 @@ TEST(TcpRpcClient, ParseReplyThrowsOnNonSuccess) {
     const auto record = enc.release();
     EXPECT_THROW(TcpRpcClient::parseReply(record), std::runtime_error);
 }
+
+// ── Pipelined calls (loopback) ────────────────────────────────────────────────
+
+// Minimal loopback RPC peer: accepts one connection, reads `n` CALL records,
+// then answers them in reverse order with a uint32 result equal to the XID.
+class ReversingPeer {
+public:
+    explicit ReversingPeer(int n) {
+        lsock_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(lsock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(lsock_, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(lsock_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this, n] { serve(n); });
+    }
+    ~ReversingPeer() {
+        thread_.join();
+        close(lsock_);
+    }
+    uint16_t port() const { return port_; }
+
+private:
+    static void read_exact(int s, uint8_t* p, size_t n) {
+        while (n > 0) {
+            const ssize_t r = recv(s, p, n, 0);
+            if (r <= 0) return;
+            p += r; n -= static_cast<size_t>(r);
+        }
+    }
+
+    void serve(int n) {
+        const int s = accept(lsock_, nullptr, nullptr);
+        std::vector<uint32_t> xids;
+        for (int i = 0; i < n; ++i) {
+            uint8_t mark[4];
+            read_exact(s, mark, 4);
+            const uint32_t len = ((mark[0] & 0x7Fu) << 24) | (mark[1] << 16) |
+                                 (mark[2] << 8) | mark[3];
+            std::vector<uint8_t> body(len);
+            read_exact(s, body.data(), len);
+            XdrDecoder dec(body);
+            xids.push_back(dec.get_uint32());
+        }
+        std::reverse(xids.begin(), xids.end());
+        for (uint32_t xid : xids) {
+            XdrEncoder enc;
+            enc.put_uint32(xid);
+            enc.put_uint32(1u);  // REPLY
+            enc.put_uint32(0u);  // MSG_ACCEPTED
+            enc.put_uint32(0u);  // verf flavor
+            enc.put_uint32(0u);  // verf body len
+            enc.put_uint32(0u);  // SUCCESS
+            enc.put_uint32(xid);
+            const auto framed = TcpRpcClient::addRecordMark(enc.bytes());
+            send(s, framed.data(), framed.size(), 0);
+        }
+        close(s);
+    }
+
+    int         lsock_ = -1;
+    uint16_t    port_  = 0;
+    std::thread thread_;
+};
+
+TEST(TcpRpcClient, PipelinedRepliesMatchedByXid) {
+    constexpr int kCalls = 8;
+    ReversingPeer peer(kCalls);
+    TcpRpcClient client("127.0.0.1", peer.port());
+
+    std::vector<std::future<std::vector<uint8_t>>> futures;
+    for (int i = 0; i < kCalls; ++i)
+        futures.push_back(client.call_async(100003u, 3u, 0u, std::vector<uint8_t>{}));
+
+    // XIDs are allocated sequentially from 1; each reply echoes its own XID
+    // even though the peer answers in reverse order.
+    for (int i = 0; i < kCalls; ++i) {
+        const auto body = futures[static_cast<size_t>(i)].get();
+        XdrDecoder dec(body);
+        EXPECT_EQ(dec.get_uint32(), static_cast<uint32_t>(i + 1));
+    }
+    EXPECT_EQ(client.outstanding(), 0u);
+}
+
+TEST(TcpRpcClient, PipelinedCallsFailWhenPeerCloses) {
+    ReversingPeer peer(1);
+    TcpRpcClient client("127.0.0.1", peer.port());
+
+    auto answered = client.call_async(100003u, 3u, 0u, std::vector<uint8_t>{});
+    EXPECT_NO_THROW(answered.get());
+    // The peer has hung up; anything after that must fail, not hang.
+    EXPECT_THROW(client.call(100003u, 3u, 0u, std::vector<uint8_t>{}), std::runtime_error);
+}
+
+// Answers each CALL as soon as it arrives, echoing its XID in the result body.
+class EchoPeer {
+public:
+    explicit EchoPeer(int n) {
+        lsock_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(lsock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(lsock_, 1);
+        socklen_t len = sizeof(addr);
+        getsockname(lsock_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this, n] { serve(n); });
+    }
+    ~EchoPeer() {
+        if (thread_.joinable()) thread_.join();
+        close(lsock_);
+    }
+    uint16_t port() const { return port_; }
+
+    // Every CALL record received, in arrival order (waits for all n).
+    const std::vector<std::vector<uint8_t>>& received() {
+        if (thread_.joinable()) thread_.join();
+        return records_;
+    }
+
+private:
+    void serve(int n) {
+        const int s = accept(lsock_, nullptr, nullptr);
+        for (int i = 0; i < n; ++i) {
+            RecordReader rr(s);
+            std::vector<uint8_t> record;
+            rr.read_rest(record);
+            records_.push_back(record);
+            const uint32_t xid = XdrDecoder(record).get_uint32();
+            XdrEncoder enc;
+            enc.put_uint32(xid);
+            enc.put_uint32(1u);  // REPLY
+            enc.put_uint32(0u);  // MSG_ACCEPTED
+            enc.put_uint32(0u);  // verf flavor
+            enc.put_uint32(0u);  // verf body len
+            enc.put_uint32(0u);  // SUCCESS
+            enc.put_uint32(xid);
+            const auto framed = TcpRpcClient::addRecordMark(enc.bytes());
+            send(s, framed.data(), framed.size(), 0);
+        }
+        close(s);
+    }
+
+    int         lsock_ = -1;
+    uint16_t    port_  = 0;
+    std::thread thread_;
+    std::vector<std::vector<uint8_t>> records_;
+};
+
+TEST(TcpRpcClient, CachedHeaderMatchesBuildCallMessage) {
+    EchoPeer peer(4);
+    TcpRpcClient client("127.0.0.1", peer.port());
+    const std::vector<uint8_t> args = {0xDE, 0xAD, 0xBE, 0xEF};
+
+    AuthSys auth;
+    auth.machinename = "host";
+    auth.uid  = 1000;
+    auth.gid  = 100;
+    auth.gids = {4, 24};
+
+    client.call(100003u, 3u, 1u, args);   // AUTH_NONE, builds the template
+    client.call(100003u, 3u, 4u, args);   // reuses it: new XID and proc
+    client.set_auth_sys(auth);
+    client.call(100003u, 3u, 6u, args);   // credentials changed: rebuilt
+    client.clear_auth();
+    client.call(100005u, 3u, 1u, args);   // another program
+
+    const auto& got = peer.received();
+    ASSERT_EQ(got.size(), 4u);
+    EXPECT_EQ(got[0], TcpRpcClient::buildCallMessage(1u, 100003u, 3u, 1u, args));
+    EXPECT_EQ(got[1], TcpRpcClient::buildCallMessage(2u, 100003u, 3u, 4u, args));
+    EXPECT_EQ(got[2], TcpRpcClient::buildCallMessage(3u, 100003u, 3u, 6u, args, &auth));
+    EXPECT_EQ(got[3], TcpRpcClient::buildCallMessage(4u, 100005u, 3u, 1u, args));
+}
+
+TEST(TcpRpcClient, ConcurrentSyncCallersEachGetTheirReply) {
+    constexpr int kThreads = 4;
+    constexpr int kCallsPerThread = 16;
+    EchoPeer peer(kThreads * kCallsPerThread);
+    TcpRpcClient client("127.0.0.1", peer.port());
+
+    std::vector<std::vector<uint32_t>> seen(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kCallsPerThread; ++i) {
+                const auto body = client.call(100003u, 3u, 0u, std::vector<uint8_t>{});
+                XdrDecoder dec(body);
+                seen[static_cast<size_t>(t)].push_back(dec.get_uint32());
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    // Every XID 1..N answered exactly once, across all threads.
+    std::vector<uint32_t> all;
+    for (const auto& v : seen) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), static_cast<size_t>(kThreads * kCallsPerThread));
+    for (size_t i = 0; i < all.size(); ++i) EXPECT_EQ(all[i], i + 1);
+}
+
+// ── RecordReader ──────────────────────────────────────────────────────────────
+
+static void send_fragment(int s, const std::vector<uint8_t>& data, bool last) {
+    const uint32_t mark = (last ? 0x80000000u : 0u) | static_cast<uint32_t>(data.size());
+    const uint8_t m[4] = {static_cast<uint8_t>(mark >> 24), static_cast<uint8_t>(mark >> 16),
+                          static_cast<uint8_t>(mark >> 8),  static_cast<uint8_t>(mark)};
+    send(s, m, 4, 0);
+    send(s, data.data(), data.size(), 0);
+}
+
+TEST(RecordReader, OpaqueSpanningFragmentsLandsInCallerBuffer) {
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+
+    XdrEncoder enc;
+    enc.put_uint32(42u);
+    const std::vector<uint8_t> payload = {1, 2, 3, 4, 5, 6};
+    enc.put_opaque(payload);
+    enc.put_uint32(7u);  // trailer the consumer never reads
+    const auto body = enc.release();
+
+    // Split mid-payload into three fragments, then a second record.
+    send_fragment(sv[1], {body.begin(), body.begin() + 10}, false);
+    send_fragment(sv[1], {body.begin() + 10, body.begin() + 13}, false);
+    send_fragment(sv[1], {body.begin() + 13, body.end()}, true);
+    send_fragment(sv[1], {0, 0, 0, 9}, true);
+
+    {
+        RecordReader rr(sv[0]);
+        EXPECT_EQ(rr.get_uint32(), 42u);
+        uint8_t buf[8] = {};
+        ASSERT_EQ(rr.get_opaque_into(buf, sizeof(buf)), payload.size());
+        EXPECT_TRUE(std::equal(payload.begin(), payload.end(), buf));
+        rr.drain();
+    }
+    RecordReader next(sv[0]);
+    EXPECT_EQ(next.get_uint32(), 9u);
+
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(RecordReader, OpaqueLargerThanBufferThrows) {
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    XdrEncoder enc;
+    enc.put_opaque(std::vector<uint8_t>(16, 0xAB));
+    send_fragment(sv[1], enc.bytes(), true);
+
+    RecordReader rr(sv[0]);
+    uint8_t buf[8];
+    EXPECT_THROW(rr.get_opaque_into(buf, sizeof(buf)), std::runtime_error);
+    EXPECT_FALSE(rr.failed());
+
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(RecordReader, LengthPastEndOfRecordThrows) {
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    // 0xFFFFFFFF would wrap to no padding at all in 32-bit arithmetic.
+    send_fragment(sv[1], {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 1}, true);
+    send_fragment(sv[1], {0x7F, 0xFF, 0xFF, 0xFF, 0, 0, 0, 2}, true);
+    send_fragment(sv[1], {0, 0, 0, 9, 1, 2, 3, 4}, true);
+
+    {
+        RecordReader rr(sv[0]);
+        EXPECT_THROW(rr.skip_opaque(), std::runtime_error);
+        EXPECT_FALSE(rr.failed());
+        rr.drain();
+    }
+    {
+        RecordReader rr(sv[0]);
+        EXPECT_THROW(rr.get_string(), std::runtime_error);   // no 2 GiB allocation
+        rr.drain();
+    }
+    {
+        RecordReader rr(sv[0]);
+        uint8_t buf[16];
+        EXPECT_THROW(rr.get_opaque_into(buf, sizeof(buf)), std::runtime_error);
+        rr.drain();
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(TcpRpcClient, CallIntoStreamsResultBody) {
+    ReversingPeer peer(1);
+    TcpRpcClient client("127.0.0.1", peer.port());
+
+    uint32_t echoed = 0;
+    client.call_into(100003u, 3u, 0u, XdrEncoder{}, [&](RecordReader& rr) {
+        echoed = rr.get_uint32();
+    });
+    EXPECT_EQ(echoed, 1u);
+}
+
+TEST(TcpRpcClient, CallIntoWhilePipelined) {
+    ReversingPeer peer(2);
+    TcpRpcClient client("127.0.0.1", peer.port());
+
+    auto first = client.call_async(100003u, 3u, 0u, std::vector<uint8_t>{});
+    uint32_t echoed = 0;
+    client.call_into(100003u, 3u, 0u, XdrEncoder{}, [&](RecordReader& rr) {
+        echoed = rr.get_uint32();
+    });
+    EXPECT_EQ(echoed, 2u);
+    const auto body = first.get();
+    XdrDecoder dec(body);
+    EXPECT_EQ(dec.get_uint32(), 1u);
+}
+
+// ── RpcConnectionPool ─────────────────────────────────────────────────────────
+
+// Listening socket that lets connections complete (via the backlog) but never
+// answers; enough to exercise connection selection.
+class SilentListener {
+public:
+    SilentListener() {
+        lsock_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(lsock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(lsock_, 8);
+        socklen_t len = sizeof(addr);
+        getsockname(lsock_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+    }
+    ~SilentListener() { close(lsock_); }
+    uint16_t port() const { return port_; }
+
+private:
+    int      lsock_ = -1;
+    uint16_t port_  = 0;
+};
+
+TEST(RpcConnectionPool, RoundRobinRotates) {
+    SilentListener srv;
+    RpcConnectionPool pool("127.0.0.1", srv.port(), 3);
+    ASSERT_EQ(pool.size(), 3u);
+
+    TcpRpcClient* a = &pool.pick();
+    TcpRpcClient* b = &pool.pick();
+    TcpRpcClient* c = &pool.pick();
+    EXPECT_NE(a, b);
+    EXPECT_NE(b, c);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(&pool.pick(), a);
+}
+
+TEST(RpcConnectionPool, LeastOutstandingAvoidsBusyConnection) {
+    SilentListener srv;
+    RpcConnectionPool pool("127.0.0.1", srv.port(), 2, ConnPolicy::LEAST_OUTSTANDING);
+
+    // Park an unanswered call on connection 0; every pick must avoid it.
+    auto parked = pool.at(0).call_async(100003u, 3u, 0u, std::vector<uint8_t>{});
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(&pool.pick(), &pool.at(1));
+}
+
+TEST(RpcConnectionPool, ZeroConnectionsRejected) {
+    EXPECT_THROW(RpcConnectionPool("127.0.0.1", 1, 0), std::invalid_argument);
+}
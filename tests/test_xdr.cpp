@@ -1,4 +1,6 @@
 #include "xdr/xdr.hpp"
+#include "xdr/xdr_struct.hpp"
+#include "xdr/xdr_bswap.hpp"
 
 #include <gtest/gtest.h>
 
@@ -74,6 +76,135 @@ TEST(XdrEncoder, PutFixedOpaque) {
     EXPECT_EQ(b[3], 0x00);  // padding
 }
 
+TEST(XdrEncoder, PutOpaqueRefReferencesPayload) {
+    const uint8_t payload[5] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    XdrEncoder enc;
+    enc.put_uint32(7u);
+    enc.put_opaque_ref(payload, 5);
+    enc.put_uint32(9u);
+    EXPECT_EQ(enc.size(), 4u + 4u + 5u + 3u + 4u);
+
+    // Gather list: [7, len] [payload] [pad, 9] — the payload is not copied.
+    XdrSegment segs[4];
+    ASSERT_EQ(enc.segments(segs, 4), 3u);
+    EXPECT_EQ(segs[0].size, 8u);
+    EXPECT_EQ(segs[1].data, payload);
+    EXPECT_EQ(segs[1].size, 5u);
+    EXPECT_EQ(segs[2].size, 7u);
+
+    // bytes() flattens to the same wire image as put_opaque().
+    XdrEncoder copy;
+    copy.put_uint32(7u);
+    copy.put_opaque(payload, 5);
+    copy.put_uint32(9u);
+    EXPECT_EQ(enc.bytes(), copy.bytes());
+}
+
+TEST(XdrEncoder, AppendRefChainsEncoders) {
+    const uint8_t payload[4] = {0xAA, 0xBB, 0xCC, 0xDD};
+    XdrEncoder inner;
+    inner.put_uint32(1u);
+    inner.put_opaque_ref(payload, 4);
+
+    XdrEncoder outer;
+    outer.put_uint32(0u);
+    outer.append_ref(inner);
+    EXPECT_EQ(outer.size(), 16u);
+
+    const auto flat = outer.release();
+    XdrDecoder dec(flat);
+    EXPECT_EQ(dec.get_uint32(), 0u);
+    EXPECT_EQ(dec.get_uint32(), 1u);
+    EXPECT_EQ(dec.get_opaque(), std::vector<uint8_t>(payload, payload + 4));
+}
+
+TEST(XdrEncoder, CallerBufferHoldsSmallMessages) {
+    uint8_t buf[16];
+    XdrEncoder enc(buf, sizeof(buf));
+    enc.put_uint32(0x01020304u);
+    enc.put_uint64(0x05060708090A0B0Cull);
+
+    // Written straight into the caller's storage.
+    XdrSegment seg;
+    ASSERT_EQ(enc.segments(&seg, 1), 1u);
+    EXPECT_EQ(seg.data, buf);
+    EXPECT_EQ(buf[0], 0x01);
+    EXPECT_EQ(buf[11], 0x0C);
+}
+
+TEST(XdrEncoder, OutgrowingBufferMovesToHeap) {
+    uint8_t buf[8];
+    XdrEncoder enc(buf, sizeof(buf));
+    enc.put_uint32(1u);
+    enc.put_string("longer than eight bytes");
+    enc.put_uint32(2u);
+
+    const auto data = enc.release();
+    XdrDecoder dec(data);
+    EXPECT_EQ(dec.get_uint32(), 1u);
+    EXPECT_EQ(dec.get_string(), "longer than eight bytes");
+    EXPECT_EQ(dec.get_uint32(), 2u);
+    EXPECT_EQ(enc.size(), 0u);  // release() leaves the encoder empty
+}
+
+TEST(XdrEncoder, ReserveKeepsContent) {
+    XdrEncoder enc;
+    enc.put_uint32(7u);
+    enc.reserve(4 * XdrEncoder::INLINE_CAPACITY);
+    const std::vector<uint8_t> big(3 * XdrEncoder::INLINE_CAPACITY, 0x5A);
+    enc.put_opaque(big);
+
+    XdrDecoder dec(enc.bytes());
+    EXPECT_EQ(dec.get_uint32(), 7u);
+    EXPECT_EQ(dec.get_opaque(), big);
+}
+
+TEST(XdrEncoder, PatchBackfillsLength) {
+    XdrEncoder enc;
+    const size_t at = enc.mark();
+    enc.put_uint32(0);
+    enc.put_uint32(1u);
+    enc.put_string("ab");
+    enc.patch_uint32(at, static_cast<uint32_t>(enc.mark() - at - 4));
+
+    XdrEncoder expect;
+    XdrEncoder body;
+    body.put_uint32(1u);
+    body.put_string("ab");
+    expect.put_opaque(body.bytes());
+    EXPECT_EQ(enc.bytes(), expect.bytes());
+
+    EXPECT_THROW(enc.patch_uint32(enc.mark(), 0), std::out_of_range);
+}
+
+TEST(XdrEncoder, CopyIsIndependent) {
+    uint8_t buf[8];
+    XdrEncoder a(buf, sizeof(buf));
+    a.put_uint32(1u);
+    XdrEncoder b = a;
+    b.put_uint32(2u);
+    a.put_uint32(3u);
+    EXPECT_EQ(a.bytes(), (std::vector<uint8_t>{0, 0, 0, 1, 0, 0, 0, 3}));
+    EXPECT_EQ(b.bytes(), (std::vector<uint8_t>{0, 0, 0, 1, 0, 0, 0, 2}));
+}
+
+TEST(XdrEncoder, ManyReferencesKeepWireOrder) {
+    const uint8_t payload[4] = {0xAA, 0xBB, 0xCC, 0xDD};
+    XdrEncoder enc;
+    for (uint32_t i = 0; i < 10; ++i) {
+        enc.put_uint32(i);
+        enc.put_bytes_ref(payload, 4);
+    }
+    XdrSegment segs[32];
+    EXPECT_EQ(enc.segments(segs, 32), 20u);
+
+    XdrDecoder dec(enc.bytes());
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(dec.get_uint32(), i);
+        EXPECT_EQ(dec.get_uint32(), 0xAABBCCDDu);
+    }
+}
+
 // ── XdrDecoder ───────────────────────────────────────────────────────────────
 
 TEST(XdrDecoder, RoundTripUint32) {
@@ -152,3 +283,168 @@ TEST(XdrDecoder, GetRemaining) {
     XdrDecoder dec2(rest);
     EXPECT_EQ(dec2.get_uint32(), 99u);
 }
+
+TEST(XdrDecoder, ViewsPointIntoBuffer) {
+    XdrEncoder enc;
+    enc.put_string("hello");
+    const uint8_t fixed[3] = {7, 8, 9};
+    enc.put_fixed_opaque(fixed, 3);
+    enc.put_uint32(42u);
+    const auto data = enc.release();
+
+    XdrDecoder dec(data);
+    EXPECT_EQ(dec.get_string_view(), "hello");
+    const XdrSegment f = dec.get_fixed_opaque_view(3);
+    EXPECT_EQ(f.data, data.data() + 12);  // 4 + "hello" + 3 pad
+    EXPECT_EQ(f.size, 3u);
+    EXPECT_EQ(dec.offset(), 16u);
+    const XdrSegment rest = dec.get_remaining_view();
+    EXPECT_EQ(rest.data, data.data() + 16);
+    EXPECT_EQ(rest.size, 4u);
+    EXPECT_EQ(dec.remaining(), 0u);
+}
+
+TEST(XdrDecoder, SkipOpaqueAndSkip) {
+    XdrEncoder enc;
+    enc.put_string("skipped");
+    enc.put_uint32(1u);
+    enc.put_uint32(2u);
+    const auto data = enc.release();
+
+    XdrDecoder dec(data);
+    dec.skip_opaque();
+    dec.skip(4);
+    EXPECT_EQ(dec.get_uint32(), 2u);
+    EXPECT_THROW(dec.skip(1), std::runtime_error);
+}
+
+TEST(XdrDecoder, OpaqueViewUnderflowThrows) {
+    const std::vector<uint8_t> data = {0, 0, 0, 5, 'a', 'b'};  // claims 5 bytes
+    XdrDecoder dec(data);
+    EXPECT_THROW(dec.get_opaque_view(), std::runtime_error);
+}
+
+// ── XdrSchema ────────────────────────────────────────────────────────────────
+
+namespace {
+enum class Color : uint32_t { RED = 1, BLUE = 2 };
+struct Inner { uint32_t a; uint64_t b; };
+struct Outer {
+    Color                  color;
+    Inner                  inner;
+    std::array<uint8_t, 5> tag;
+    bool                   flag;
+    int64_t                when;
+};
+}  // namespace
+
+template <> struct XdrSchema<Inner> { using fields = XdrFields<&Inner::a, &Inner::b>; };
+template <> struct XdrSchema<Outer> {
+    using fields = XdrFields<&Outer::color, &Outer::inner, &Outer::tag,
+                             &Outer::flag, &Outer::when>;
+};
+
+TEST(XdrSchema, WireSizeIsConstant) {
+    static_assert(xdr_wire_size<Inner> == 12);
+    static_assert(xdr_wire_size<Outer> == 4 + 12 + 8 + 4 + 8);
+}
+
+TEST(XdrSchema, MatchesFieldByFieldEncoding) {
+    const Outer o{Color::BLUE, {7u, 0x0102030405060708ull}, {1, 2, 3, 4, 5}, true, -2};
+    XdrEncoder fast;
+    xdr_encode(fast, o);
+
+    XdrEncoder slow;
+    slow.put_uint32(2u);
+    slow.put_uint32(7u);
+    slow.put_uint64(0x0102030405060708ull);
+    slow.put_fixed_opaque(o.tag.data(), 5);
+    slow.put_uint32(1u);
+    slow.put_uint64(static_cast<uint64_t>(-2));
+    EXPECT_EQ(fast.bytes(), slow.bytes());
+
+    XdrDecoder dec(fast.bytes());
+    const Outer back = xdr_decode<Outer>(dec);
+    EXPECT_EQ(back.color, Color::BLUE);
+    EXPECT_EQ(back.inner.a, 7u);
+    EXPECT_EQ(back.inner.b, 0x0102030405060708ull);
+    EXPECT_EQ(back.tag, o.tag);
+    EXPECT_TRUE(back.flag);
+    EXPECT_EQ(back.when, -2);
+    EXPECT_EQ(dec.remaining(), 0u);
+}
+
+TEST(XdrSchema, TruncatedStructThrowsBeforeDecoding) {
+    XdrEncoder enc;
+    enc.put_uint32(1u);
+    enc.put_uint32(7u);  // Inner::b missing
+    XdrDecoder dec(enc.bytes());
+    EXPECT_THROW(xdr_decode<Inner>(dec), std::runtime_error);
+    EXPECT_EQ(dec.remaining(), 8u);  // nothing consumed
+}
+
+// ── Bulk byte-swap kernels ───────────────────────────────────────────────────
+
+// Lengths straddle the 4- and 8-word vector widths so every tail is covered.
+TEST(XdrBswap, Load32MatchesScalarForAllLengths) {
+    for (size_t n = 0; n <= 40; ++n) {
+        std::vector<uint8_t> wire(4 * n);
+        for (size_t i = 0; i < wire.size(); ++i) wire[i] = static_cast<uint8_t>(i * 7 + 1);
+        std::vector<uint32_t> got(n + 1, 0xFFFFFFFFu);
+        xdr_load_be32_array(got.data(), wire.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(got[i], xdr_load_be32(&wire[4 * i])) << "n=" << n << " i=" << i;
+        EXPECT_EQ(got[n], 0xFFFFFFFFu) << "wrote past the end, n=" << n;
+    }
+}
+
+TEST(XdrBswap, Load64MatchesScalarForAllLengths) {
+    for (size_t n = 0; n <= 20; ++n) {
+        std::vector<uint8_t> wire(8 * n);
+        for (size_t i = 0; i < wire.size(); ++i) wire[i] = static_cast<uint8_t>(i * 13 + 5);
+        std::vector<uint64_t> got(n);
+        xdr_load_be64_array(got.data(), wire.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(got[i], xdr_load_be64(&wire[8 * i])) << "n=" << n << " i=" << i;
+    }
+}
+
+TEST(XdrBswap, StoreRoundTrips) {
+    std::vector<uint32_t> w32(37);
+    std::vector<uint64_t> w64(19);
+    for (size_t i = 0; i < w32.size(); ++i) w32[i] = 0x01020304u * static_cast<uint32_t>(i + 1);
+    for (size_t i = 0; i < w64.size(); ++i) w64[i] = 0x0102030405060708ull * (i + 1);
+
+    std::vector<uint8_t> wire32(4 * w32.size()), wire64(8 * w64.size());
+    xdr_store_be32_array(wire32.data(), w32.data(), w32.size());
+    xdr_store_be64_array(wire64.data(), w64.data(), w64.size());
+    EXPECT_EQ(xdr_load_be32(&wire32[4 * 5]), w32[5]);
+    EXPECT_EQ(xdr_load_be64(&wire64[8 * 9]), w64[9]);
+
+    std::vector<uint32_t> back32(w32.size());
+    std::vector<uint64_t> back64(w64.size());
+    xdr_load_be32_array(back32.data(), wire32.data(), back32.size());
+    xdr_load_be64_array(back64.data(), wire64.data(), back64.size());
+    EXPECT_EQ(back32, w32);
+    EXPECT_EQ(back64, w64);
+    EXPECT_NE(std::string(xdr_bswap_kernel()), "");
+}
+
+TEST(XdrEncoder, Uint32ArrayMatchesPerWordEncoding) {
+    const std::vector<uint32_t> gids = {4, 24, 27, 30, 46, 100, 118, 1000, 1001};
+    XdrEncoder bulk;
+    bulk.put_uint32_array(gids.data(), gids.size());
+    XdrEncoder each;
+    each.put_uint32(static_cast<uint32_t>(gids.size()));
+    for (uint32_t g : gids) each.put_uint32(g);
+    EXPECT_EQ(bulk.bytes(), each.bytes());
+
+    XdrDecoder dec(bulk.bytes());
+    EXPECT_EQ(dec.get_uint32_array(), gids);
+}
+
+TEST(XdrDecoder, Uint32ArrayRejectsOversizedCount) {
+    const std::vector<uint8_t> data = {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 1};
+    XdrDecoder dec(data);
+    EXPECT_THROW(dec.get_uint32_array(), std::runtime_error);
+}
@@ -0,0 +1,206 @@
+#include "bench_client.hpp"
+
+#include "nfs_client.hpp"
+#include "nfs4_client.hpp"
+#include "nfs41_client.hpp"
+
+#include <stdexcept>
+
+const char* proto_name(Proto p) {
+    switch (p) {
+        case Proto::V3:  return "v3";
+        case Proto::V40: return "v4.0";
+        case Proto::V41: return "v4.1";
+    }
+    return "?";
+}
+
+bool parse_proto(const std::string& s, Proto& out) {
+    if      (s == "v3" || s == "3")                      out = Proto::V3;
+    else if (s == "v4.0" || s == "v4" || s == "4.0")     out = Proto::V40;
+    else if (s == "v4.1" || s == "4.1")                  out = Proto::V41;
+    else return false;
+    return true;
+}
+
+// ── NFSv3 ────────────────────────────────────────────────────────────────────
+
+namespace {
+
+class Nfs3BenchClient final : public BenchClient {
+public:
+    Nfs3BenchClient(const std::string& host, const ClientOptions& opts, const AuthSys& auth)
+        : client_(host, opts) {
+        client_.set_auth_sys(auth);
+    }
+
+    Proto proto() const override { return Proto::V3; }
+
+    BenchFh root(const std::string& export_path, const std::string& /*v4_path*/) override {
+        return client_.mount(export_path);
+    }
+
+    BenchFh mkdir(const BenchFh& dir, const std::string& name) override {
+        return client_.mkdir(std::get<Fh3>(dir), name);
+    }
+
+    BenchFile create(const BenchFh& dir, const std::string& name) override {
+        return client_.create(std::get<Fh3>(dir), name, nfs3::CreateMode3::UNCHECKED);
+    }
+
+    BenchFile open(const BenchFh& dir, const std::string& name, bool /*for_write*/) override {
+        return client_.lookup(std::get<Fh3>(dir), name);
+    }
+
+    void close(const BenchFile&) override {}
+
+    uint32_t read(const BenchFile& f, uint64_t offset, uint8_t* buf, uint32_t count) override {
+        return client_.read_into(std::get<Fh3>(f), offset, buf, count).count;
+    }
+
+    uint32_t write(const BenchFile& f, uint64_t offset, Stable3 stable,
+                   const uint8_t* data, uint32_t len) override {
+        return client_.write(std::get<Fh3>(f), offset, stable, data, len).count;
+    }
+
+    std::future<uint32_t> read_async(const BenchFile& f, uint64_t offset,
+                                     uint32_t count) override {
+        auto data = client_.read_async(std::get<Fh3>(f), offset, count);
+        return std::async(std::launch::deferred, [data = std::move(data)]() mutable {
+            return static_cast<uint32_t>(data.get().size());
+        });
+    }
+
+    std::future<uint32_t> write_async(const BenchFile& f, uint64_t offset, Stable3 stable,
+                                      const uint8_t* data, uint32_t len) override {
+        auto wrote = client_.write_async(std::get<Fh3>(f), offset, stable, data, len);
+        return std::async(std::launch::deferred, [wrote = std::move(wrote)]() mutable {
+            return wrote.get().count;
+        });
+    }
+
+    void truncate(const BenchFile& f, uint64_t size) override {
+        Sattr3 sa;
+        sa.set_size = true;
+        sa.size     = size;
+        client_.setattr(std::get<Fh3>(f), sa);
+    }
+
+    void remove(const BenchFh& dir, const std::string& name) override {
+        client_.remove(std::get<Fh3>(dir), name);
+    }
+
+    void remove_tree(const BenchFh& dir, const std::string& name) override {
+        const Fh3& parent = std::get<Fh3>(dir);
+        const Fh3  fh     = client_.lookup(parent, name);
+        if (client_.getattr(fh).type != Ftype3::NF3DIR) {
+            client_.remove(parent, name);
+            return;
+        }
+        for (const auto& e : client_.readdirplus(fh)) {
+            if (e.name == "." || e.name == "..") continue;
+            if (e.has_attrs && e.attrs.type == Ftype3::NF3DIR) remove_tree(fh, e.name);
+            else                                                client_.remove(fh, e.name);
+        }
+        client_.rmdir(parent, name);
+    }
+
+private:
+    NFSClient client_;
+};
+
+// ── NFSv4.0 / 4.1 ────────────────────────────────────────────────────────────
+
+// Nfs4Client and Nfs41Client share their public API.
+template <typename Client, Proto P>
+class Nfs4BenchClient final : public BenchClient {
+public:
+    Nfs4BenchClient(const std::string& host, const ClientOptions& opts, const AuthSys& auth)
+        : client_(host, auth, opts) {}
+
+    Proto proto() const override { return P; }
+
+    BenchFh root(const std::string& /*export_path*/, const std::string& v4_path) override {
+        return client_.resolve_path(v4_path).fh;
+    }
+
+    BenchFh mkdir(const BenchFh& dir, const std::string& name) override {
+        return client_.mkdir(std::get<Nfs4Fh>(dir), name);
+    }
+
+    BenchFile create(const BenchFh& dir, const std::string& name) override {
+        return client_.open_write(std::get<Nfs4Fh>(dir), name, true);
+    }
+
+    BenchFile open(const BenchFh& dir, const std::string& name, bool for_write) override {
+        const Nfs4Fh& d = std::get<Nfs4Fh>(dir);
+        return for_write ? client_.open_write(d, name, false) : client_.open_read(d, name);
+    }
+
+    void close(const BenchFile& f) override { client_.close(std::get<Nfs4File>(f)); }
+
+    uint32_t read(const BenchFile& f, uint64_t offset, uint8_t* buf, uint32_t count) override {
+        return client_.read_into(std::get<Nfs4File>(f), offset, buf, count);
+    }
+
+    uint32_t write(const BenchFile& f, uint64_t offset, Stable3 stable,
+                   const uint8_t* data, uint32_t len) override {
+        return client_.write(std::get<Nfs4File>(f), offset, static_cast<Stable4>(stable),
+                             data, len);
+    }
+
+    std::future<uint32_t> read_async(const BenchFile& f, uint64_t offset,
+                                     uint32_t count) override {
+        auto data = client_.read_async(std::get<Nfs4File>(f), offset, count);
+        return std::async(std::launch::deferred, [data = std::move(data)]() mutable {
+            return static_cast<uint32_t>(data.get().size());
+        });
+    }
+
+    std::future<uint32_t> write_async(const BenchFile& f, uint64_t offset, Stable3 stable,
+                                      const uint8_t* data, uint32_t len) override {
+        return client_.write_async(std::get<Nfs4File>(f), offset,
+                                   static_cast<Stable4>(stable), data, len);
+    }
+
+    void truncate(const BenchFile& f, uint64_t size) override {
+        nfs4::Sattr4 sa;
+        sa.size = size;
+        client_.setattr(std::get<Nfs4File>(f).fh, sa);
+    }
+
+    void remove(const BenchFh& dir, const std::string& name) override {
+        client_.remove(std::get<Nfs4Fh>(dir), name);
+    }
+
+    void remove_tree(const BenchFh& dir, const std::string& name) override {
+        const Nfs4Fh& parent = std::get<Nfs4Fh>(dir);
+        const Nfs4Fh  fh     = client_.lookup(parent, name);
+        if (client_.getattr(fh).type == Ftype4::NF4DIR) {
+            for (const auto& e : client_.readdir(fh)) {
+                if (e.attrs.type == Ftype4::NF4DIR) remove_tree(fh, e.name);
+                else                                client_.remove(fh, e.name);
+            }
+        }
+        client_.remove(parent, name);
+    }
+
+private:
+    Client client_;
+};
+
+}  // namespace
+
+std::unique_ptr<BenchClient> make_bench_client(Proto proto, const std::string& host,
+                                               const ClientOptions& opts,
+                                               const AuthSys& auth) {
+    switch (proto) {
+        case Proto::V3:
+            return std::make_unique<Nfs3BenchClient>(host, opts, auth);
+        case Proto::V40:
+            return std::make_unique<Nfs4BenchClient<Nfs4Client, Proto::V40>>(host, opts, auth);
+        case Proto::V41:
+            return std::make_unique<Nfs4BenchClient<Nfs41Client, Proto::V41>>(host, opts, auth);
+    }
+    throw std::invalid_argument("unknown protocol");
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "client_options.hpp"
+#include "nfs/nfs3_types.hpp"
+#include "nfs4/nfs4_types.hpp"
+#include "rpc/rpc_types.hpp"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <variant>
+
+// NFS protocol version a run is made with (--proto).
+enum class Proto {
+    V3,
+    V40,
+    V41,
+};
+
+const char* proto_name(Proto p);                      // "v3", "v4.0", "v4.1"
+bool        parse_proto(const std::string& s, Proto& out);
+
+// A directory or file handle of whichever protocol the client speaks.
+using BenchFh = std::variant<Fh3, Nfs4Fh>;
+
+// A file ready for READ and WRITE.  Over NFSv4 it carries the open stateid
+// and must be closed; NFSv3 has no open state and close() does nothing.
+using BenchFile = std::variant<Fh3, Nfs4File>;
+
+// The operations the workloads need, over NFSv3, v4.0 or v4.1, so the same
+// workload code measures all three.  Implementations wrap NFSClient,
+// Nfs4Client and Nfs41Client and are as thread-safe as those.
+class BenchClient {
+public:
+    virtual ~BenchClient() = default;
+
+    virtual Proto proto() const = 0;
+
+    // The directory runs work in: the MOUNTed export for NFSv3, `v4_path`
+    // looked up from the pseudo-root for NFSv4.
+    virtual BenchFh root(const std::string& export_path, const std::string& v4_path) = 0;
+
+    virtual BenchFh mkdir(const BenchFh& dir, const std::string& name) = 0;
+
+    // Create `name` if needed (UNCHECKED) and open it for writing.
+    virtual BenchFile create(const BenchFh& dir, const std::string& name) = 0;
+
+    // Open an existing file.
+    virtual BenchFile open(const BenchFh& dir, const std::string& name, bool for_write) = 0;
+    virtual void      close(const BenchFile& f) = 0;
+
+    // Read into `buf` (at least `count` bytes); returns the bytes read.
+    virtual uint32_t read(const BenchFile& f, uint64_t offset, uint8_t* buf, uint32_t count) = 0;
+    virtual uint32_t write(const BenchFile& f, uint64_t offset, Stable3 stable,
+                           const uint8_t* data, uint32_t len) = 0;
+    virtual void     truncate(const BenchFile& f, uint64_t size) = 0;
+
+    // Pipelined read / write for --iodepth: the request is sent before these
+    // return; the future yields the bytes moved.
+    virtual std::future<uint32_t> read_async(const BenchFile& f, uint64_t offset,
+                                             uint32_t count) = 0;
+    virtual std::future<uint32_t> write_async(const BenchFile& f, uint64_t offset,
+                                              Stable3 stable, const uint8_t* data,
+                                              uint32_t len) = 0;
+
+    virtual void remove(const BenchFh& dir, const std::string& name) = 0;
+
+    // Remove `name` in `dir` and, if it is a directory, everything below it.
+    virtual void remove_tree(const BenchFh& dir, const std::string& name) = 0;
+};
+
+// Connect to `host` over `proto` with AUTH_SYS `auth`.
+std::unique_ptr<BenchClient> make_bench_client(Proto proto, const std::string& host,
+                                               const ClientOptions& opts,
+                                               const AuthSys& auth);
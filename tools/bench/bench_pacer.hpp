@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Inter-arrival distribution for open-loop (--rate) runs.
+enum class Arrival {
+    POISSON,    // exponential gaps: independent arrivals, like real clients
+    CONSTANT,   // fixed gaps
+};
+
+// Schedules the start times of an open-loop op stream at `rate` ops/s.
+// Times are computed from `start` rather than from when ops actually ran, so
+// a stalled op does not push later arrivals back: the schedule is what the
+// offered load would have been.  Not thread-safe; use one Pacer per thread.
+class Pacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Pacer(double rate, Arrival arrival, uint64_t seed, Clock::time_point start)
+        : arrival_(arrival), mean_ns_(1e9 / rate), gap_(rate / 1e9),
+          rng_(seed), start_(start) {}
+
+    // Scheduled start of the next op.
+    Clock::time_point next() {
+        const double at = offset_ns_;
+        offset_ns_ += arrival_ == Arrival::POISSON ? gap_(rng_) : mean_ns_;
+        return start_ + std::chrono::nanoseconds(static_cast<int64_t>(at));
+    }
+
+    // Mean gap between arrivals.
+    Clock::duration interval() const {
+        return std::chrono::nanoseconds(static_cast<int64_t>(mean_ns_));
+    }
+
+private:
+    Arrival                               arrival_;
+    double                                mean_ns_;
+    std::exponential_distribution<double> gap_;         // in ns, mean mean_ns_
+    std::mt19937_64                       rng_;
+    Clock::time_point                     start_;
+    double                                offset_ns_ = 0;   // next arrival after start_
+};
@@ -0,0 +1,193 @@
+#include "bench_report.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+std::string human_bytes(uint64_t n) {
+    char buf[32];
+    if      (n >= (1ULL << 30)) snprintf(buf, sizeof(buf), "%.1f GiB", n / double(1ULL << 30));
+    else if (n >= (1ULL << 20)) snprintf(buf, sizeof(buf), "%.1f MiB", n / double(1ULL << 20));
+    else if (n >= (1ULL << 10)) snprintf(buf, sizeof(buf), "%.1f KiB", n / double(1ULL << 10));
+    else                        snprintf(buf, sizeof(buf), "%llu B", (unsigned long long)n);
+    return buf;
+}
+
+std::string human_ns(uint64_t ns) {
+    char buf[32];
+    if      (ns >= 1'000'000'000ULL) snprintf(buf, sizeof(buf), "%.2f s",  ns / 1e9);
+    else if (ns >= 1'000'000ULL)     snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
+    else if (ns >= 1'000ULL)         snprintf(buf, sizeof(buf), "%.2f us", ns / 1e3);
+    else                             snprintf(buf, sizeof(buf), "%llu ns", (unsigned long long)ns);
+    return buf;
+}
+
+// ── JSON ─────────────────────────────────────────────────────────────────────
+
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+JsonObject& JsonObject::raw(const char* key, const std::string& json) {
+    if (!body_.empty()) body_ += ',';
+    body_ += json_string(key);
+    body_ += ':';
+    body_ += json;
+    return *this;
+}
+
+JsonObject& JsonObject::add(const char* key, const std::string& v) {
+    return raw(key, json_string(v));
+}
+
+JsonObject& JsonObject::add(const char* key, double v) {
+    if (!std::isfinite(v)) return raw(key, "null");
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6g", v);
+    return raw(key, buf);
+}
+
+JsonObject json_host() {
+    JsonObject o;
+    char name[256] = {};
+    gethostname(name, sizeof(name) - 1);
+    o.add("hostname", name);
+
+    struct utsname u{};
+    if (uname(&u) == 0) {
+        o.add("os", u.sysname).add("kernel", u.release).add("arch", u.machine);
+    }
+    o.add("cpus", std::thread::hardware_concurrency());
+    o.add("pid", static_cast<int64_t>(getpid()));
+
+    const std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    gmtime_r(&now, &tm);
+    char ts[32];
+    strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    o.add("start_time", ts);
+    return o;
+}
+
+static const char* stable_name(Stable3 s) {
+    switch (s) {
+        case Stable3::UNSTABLE:  return "unstable";
+        case Stable3::DATA_SYNC: return "datasync";
+        case Stable3::FILE_SYNC: return "filesync";
+    }
+    return "?";
+}
+
+JsonObject json_config(const BenchConfig& cfg) {
+    JsonObject o;
+    o.add("server", cfg.server)
+     .add("export", cfg.export_path)
+     .add("workload", cfg.workload)
+     .add("proto", proto_name(cfg.proto))
+     .add("bs", cfg.bs)
+     .add("size", cfg.size)
+     .add("threads", cfg.threads)
+     .add("nconnect", cfg.nconnect)
+     .add("iodepth", cfg.iodepth)
+     .add("duration_s", cfg.duration)
+     .add("warmup_s", cfg.warmup)
+     .add("stable", stable_name(cfg.stable))
+     .add("rw_ratio", cfg.rw_ratio)
+     .add("rate", cfg.rate)
+     .add("arrival", cfg.arrival == Arrival::POISSON ? "poisson" : "constant")
+     .add("hist_digits", cfg.hist_digits)
+     .add("interval_s", cfg.interval);
+    return o;
+}
+
+JsonObject json_latency(const Histogram::Stats& s) {
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    JsonObject o;
+    o.add("min", us(s.min_ns))
+     .add("mean", s.mean_ns / 1000.0)
+     .add("p50", us(s.p50_ns))
+     .add("p95", us(s.p95_ns))
+     .add("p99", us(s.p99_ns))
+     .add("p99.9", us(s.p999_ns))
+     .add("p99.99", us(s.p9999_ns))
+     .add("max", us(s.max_ns));
+    return o;
+}
+
+JsonObject json_interval(const BenchConfig& cfg, const IntervalSample& s) {
+    JsonObject o;
+    o.add("type", "interval")
+     .add("workload", cfg.workload)
+     .add("proto", proto_name(cfg.proto))
+     .add("threads", cfg.threads)
+     .add("iodepth", cfg.iodepth)
+     .add("t_s", s.t_s)
+     .add("dur_s", s.dur_s)
+     .add("ops", s.ops)
+     .add("bytes", s.bytes)
+     .add("iops", s.ops / s.dur_s)
+     .add("mb_s", s.bytes / 1e6 / s.dur_s)
+     .add("missed", s.missed)
+     .add("lat_us", json_latency(s.lat));
+    return o;
+}
+
+JsonObject json_summary(const BenchConfig& cfg, const RunResult& r) {
+    JsonObject o;
+    o.add("type", "summary")
+     .add("workload", cfg.workload)
+     .add("proto", proto_name(cfg.proto))
+     .add("threads", cfg.threads)
+     .add("iodepth", cfg.iodepth)
+     .add("elapsed_s", r.elapsed_s)
+     .add("ops", r.total_ops)
+     .add("bytes", r.total_bytes)
+     .add("iops", r.total_ops / r.elapsed_s)
+     .add("mb_s", r.total_bytes / 1e6 / r.elapsed_s)
+     .add("missed", r.missed)
+     .add("lat_us", json_latency(r.lat));
+    return o;
+}
+
+JsonLines::JsonLines(const std::string& path) {
+    if (path.empty()) return;
+    out_.open(path, std::ios::app);
+    if (!out_) fprintf(stderr, "warning: cannot open JSON file '%s'\n", path.c_str());
+}
+
+void JsonLines::write(const JsonObject& obj) {
+    if (!out_.is_open()) return;
+    out_ << obj.str() << '\n';
+    out_.flush();          // a crashed or killed run keeps what it reported
+}
+
+// ── Live output ──────────────────────────────────────────────────────────────
+
+void print_interval(const IntervalSample& s) {
+    fprintf(stderr, "[%7.1fs] %10.0f IOPS %10.1f MB/s  p50 %-10s p99 %-10s max %-10s",
+            s.t_s, s.ops / s.dur_s, s.bytes / 1e6 / s.dur_s,
+            human_ns(s.lat.p50_ns).c_str(), human_ns(s.lat.p99_ns).c_str(),
+            human_ns(s.lat.max_ns).c_str());
+    if (s.missed) fprintf(stderr, " missed %llu", (unsigned long long)s.missed);
+    fprintf(stderr, "\n");
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "bench_stats.hpp"
+#include "bench_types.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+// Aggregate result of one run.
+struct RunResult {
+    uint64_t        total_ops;
+    uint64_t        total_bytes;
+    uint64_t        missed;      // open loop: ops that started behind schedule
+    double          elapsed_s;
+    Histogram::Stats lat;
+    std::string     hist;        // merged histogram, serialized
+};
+
+// Counters and latency over one reporting interval of a run.
+struct IntervalSample {
+    double           t_s;        // end of the interval, seconds since the run started
+    double           dur_s;
+    uint64_t         ops;
+    uint64_t         bytes;
+    uint64_t         missed;
+    Histogram::Stats lat;
+};
+
+std::string human_bytes(uint64_t n);
+std::string human_ns(uint64_t ns);
+
+// One JSON object, keys in insertion order.
+class JsonObject {
+public:
+    JsonObject& add(const char* key, const std::string& v);
+    JsonObject& add(const char* key, const char* v) { return add(key, std::string(v)); }
+    JsonObject& add(const char* key, bool v)        { return raw(key, v ? "true" : "false"); }
+    JsonObject& add(const char* key, double v);
+    JsonObject& add(const char* key, const JsonObject& v) { return raw(key, v.str()); }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    JsonObject& add(const char* key, T v) { return raw(key, std::to_string(v)); }
+
+    std::string str() const { return "{" + body_ + "}"; }
+
+private:
+    JsonObject& raw(const char* key, const std::string& json);
+
+    std::string body_;
+};
+
+// Where the run happened: host name, OS, kernel, CPU count, start time.
+JsonObject json_host();
+JsonObject json_config(const BenchConfig& cfg);
+JsonObject json_latency(const Histogram::Stats& s);     // in microseconds
+JsonObject json_interval(const BenchConfig& cfg, const IntervalSample& s);
+JsonObject json_summary(const BenchConfig& cfg, const RunResult& r);
+
+// Appends one JSON object per line to --json; does nothing without a path.
+class JsonLines {
+public:
+    explicit JsonLines(const std::string& path);
+    void write(const JsonObject& obj);
+
+private:
+    std::ofstream out_;
+};
+
+// The live line printed to stderr after each interval.
+void print_interval(const IntervalSample& s);
@@ -1,40 +1,238 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
-#include <vector>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
-// Accumulates per-operation latency samples (nanoseconds) and computes
-// percentile statistics. Not thread-safe; use one Reservoir per thread.
-class Reservoir {
+// Add to a counter that only one thread writes, while others may read it:
+// a relaxed load and store instead of a locked read-modify-write.
+inline void relaxed_add(std::atomic<uint64_t>& a, uint64_t n) {
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Log-linear latency histogram (HdrHistogram layout) with fixed memory.
+//
+// Values below 2^sub_bits land in exact unit-width buckets; above that each
+// power of two is split into 2^(sub_bits-1) equal buckets, so every recorded
+// value is kept to within the relative precision chosen by
+// `significant_digits` (3 -> 0.1%).  Values above `max_value` are clamped to
+// it; min and max are exact.
+//
+// record() is wait-free and meant for a single writing thread; other threads
+// may read (percentiles, merge into another histogram) concurrently and see
+// a slightly stale but consistent-enough picture.  merge() costs O(buckets).
+class Histogram {
 public:
-    void push(uint64_t ns) { samples_.push_back(ns); }
-    size_t count() const { return samples_.size(); }
-    bool   empty() const { return samples_.empty(); }
+    static constexpr uint64_t DEFAULT_MAX = 3600ULL * 1'000'000'000ULL;   // 1 h in ns
+
+    explicit Histogram(int significant_digits = 3, uint64_t max_value = DEFAULT_MAX)
+        : digits_(significant_digits), max_value_(std::max<uint64_t>(max_value, 2)) {
+        if (digits_ < 1 || digits_ > 5)
+            throw std::invalid_argument("histogram precision must be 1-5 digits");
+        // Smallest power of two holding 2 * 10^digits distinct values.
+        const double need = 2.0 * std::pow(10.0, digits_);
+        sub_bits_ = static_cast<int>(std::ceil(std::log2(need)));
+        half_     = 1ULL << (sub_bits_ - 1);
+        nbuckets_ = index_of(max_value_) + 1;
+        counts_   = std::make_unique<std::atomic<uint64_t>[]>(nbuckets_);
+        reset();
+    }
+
+    Histogram(const Histogram& o) : Histogram(o.digits_, o.max_value_) { merge(o); }
+    Histogram& operator=(const Histogram&) = delete;
+
+    int      significant_digits() const { return digits_; }
+    uint64_t max_value() const          { return max_value_; }
+    size_t   bucket_count() const       { return nbuckets_; }
+
+    void record(uint64_t v) {
+        v = std::min(v, max_value_);
+        relaxed_add(counts_[index_of(v)], 1);
+        relaxed_add(total_, 1);
+        if (v < min_.load(std::memory_order_relaxed)) min_.store(v, std::memory_order_relaxed);
+        if (v > max_.load(std::memory_order_relaxed)) max_.store(v, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total_.load(std::memory_order_relaxed); }
+    bool     empty() const { return count() == 0; }
+    uint64_t min() const   { return empty() ? 0 : min_.load(std::memory_order_relaxed); }
+    uint64_t max() const   { return max_.load(std::memory_order_relaxed); }
 
-    void merge(const Reservoir& other) {
-        samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    void reset() {
+        for (size_t i = 0; i < nbuckets_; ++i) counts_[i].store(0, std::memory_order_relaxed);
+        total_.store(0, std::memory_order_relaxed);
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    // Add `other`'s samples; both must have the same precision and range.
+    // Not safe against a concurrent record() on *this*.
+    void merge(const Histogram& other) {
+        if (other.digits_ != digits_ || other.max_value_ != max_value_)
+            throw std::invalid_argument("merging histograms of different layout");
+        uint64_t n = 0;
+        for (size_t i = 0; i < nbuckets_; ++i) {
+            const uint64_t c = other.counts_[i].load(std::memory_order_relaxed);
+            if (c) relaxed_add(counts_[i], c);
+            n += c;
+        }
+        if (n == 0) return;
+        relaxed_add(total_, n);
+        min_.store(std::min(min_.load(std::memory_order_relaxed), other.min()),
+                   std::memory_order_relaxed);
+        max_.store(std::max(max(), other.max()), std::memory_order_relaxed);
+    }
+
+    // The samples recorded since `earlier`, a copy of this histogram taken
+    // before.  Min and max are those of the buckets, not exact.
+    Histogram since(const Histogram& earlier) const {
+        if (earlier.digits_ != digits_ || earlier.max_value_ != max_value_)
+            throw std::invalid_argument("diffing histograms of different layout");
+        Histogram d(digits_, max_value_);
+        uint64_t n = 0;
+        size_t lo = nbuckets_, hi = 0;
+        for (size_t i = 0; i < nbuckets_; ++i) {
+            const uint64_t now  = counts_[i].load(std::memory_order_relaxed);
+            const uint64_t then = earlier.counts_[i].load(std::memory_order_relaxed);
+            if (now <= then) continue;
+            d.counts_[i].store(now - then, std::memory_order_relaxed);
+            n += now - then;
+            lo = std::min(lo, i);
+            hi = i;
+        }
+        if (n == 0) return d;
+        d.total_.store(n, std::memory_order_relaxed);
+        d.min_.store(std::max(lowest_in(lo), min()), std::memory_order_relaxed);
+        d.max_.store(std::min(highest_in(hi), max()), std::memory_order_relaxed);
+        return d;
+    }
+
+    // Value at percentile `p` (0-100): the highest value equivalent to the
+    // bucket holding that rank, clamped to the recorded [min, max].
+    uint64_t percentile(double p) const {
+        const uint64_t n = count();
+        if (n == 0) return 0;
+        const double   rank   = std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(n);
+        const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(rank)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < nbuckets_; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= target) return std::clamp(highest_in(i), min(), max());
+        }
+        return max();
+    }
+
+    double mean() const {
+        const uint64_t n = count();
+        if (n == 0) return 0;
+        double sum = 0;
+        for (size_t i = 0; i < nbuckets_; ++i) {
+            const uint64_t c = counts_[i].load(std::memory_order_relaxed);
+            if (c) sum += static_cast<double>(c) * midpoint_of(i);
+        }
+        return sum / static_cast<double>(n);
     }
 
     struct Stats {
-        uint64_t min_ns = 0;
-        uint64_t p50_ns = 0;
-        uint64_t p95_ns = 0;
-        uint64_t p99_ns = 0;
-        uint64_t max_ns = 0;
+        uint64_t count    = 0;
+        uint64_t min_ns   = 0;
+        uint64_t p50_ns   = 0;
+        uint64_t p95_ns   = 0;
+        uint64_t p99_ns   = 0;
+        uint64_t p999_ns  = 0;
+        uint64_t p9999_ns = 0;
+        uint64_t max_ns   = 0;
+        double   mean_ns  = 0;
     };
 
-    Stats compute() {
-        if (samples_.empty()) return {};
-        std::sort(samples_.begin(), samples_.end());
-        auto pct = [&](double p) -> uint64_t {
-            size_t idx = static_cast<size_t>(p * static_cast<double>(samples_.size() - 1) + 0.5);
-            if (idx >= samples_.size()) idx = samples_.size() - 1;
-            return samples_[idx];
-        };
-        return {samples_.front(), pct(0.50), pct(0.95), pct(0.99), samples_.back()};
+    Stats compute() const {
+        if (empty()) return {};
+        return {count(), min(), percentile(50), percentile(95), percentile(99),
+                percentile(99.9), percentile(99.99), max(), mean()};
+    }
+
+    // One-line text form, sparse in the non-empty buckets:
+    //   "HIST1 <digits> <max_value> <min> <max> <index>:<count> ..."
+    // Histograms from separate runs (or hosts) can be parsed back and merged.
+    std::string serialize() const {
+        std::ostringstream os;
+        os << "HIST1 " << digits_ << ' ' << max_value_ << ' ' << min() << ' ' << max();
+        for (size_t i = 0; i < nbuckets_; ++i) {
+            const uint64_t c = counts_[i].load(std::memory_order_relaxed);
+            if (c) os << ' ' << i << ':' << c;
+        }
+        return os.str();
+    }
+
+    static Histogram deserialize(const std::string& s) {
+        std::istringstream is(s);
+        std::string magic;
+        int      digits = 0;
+        uint64_t maxv = 0, lo = 0, hi = 0;
+        if (!(is >> magic >> digits >> maxv >> lo >> hi) || magic != "HIST1")
+            throw std::runtime_error("not a serialized histogram");
+        Histogram h(digits, maxv);
+        std::string tok;
+        uint64_t n = 0;
+        while (is >> tok) {
+            const size_t colon = tok.find(':');
+            if (colon == std::string::npos) throw std::runtime_error("bad histogram bucket: " + tok);
+            const size_t   i = std::stoull(tok.substr(0, colon));
+            const uint64_t c = std::stoull(tok.substr(colon + 1));
+            if (i >= h.nbuckets_) throw std::runtime_error("histogram bucket out of range");
+            h.counts_[i].store(c, std::memory_order_relaxed);
+            n += c;
+        }
+        h.total_.store(n, std::memory_order_relaxed);
+        if (n) {
+            h.min_.store(lo, std::memory_order_relaxed);
+            h.max_.store(hi, std::memory_order_relaxed);
+        }
+        return h;
     }
 
 private:
-    std::vector<uint64_t> samples_;
+    size_t index_of(uint64_t v) const {
+        const uint64_t sub_count = half_ << 1;
+        if (v < sub_count) return static_cast<size_t>(v);
+        const int msb   = 63 - __builtin_clzll(v);
+        const int shift = msb - sub_bits_ + 1;                     // >= 1
+        const uint64_t top = v >> shift;                           // [half, sub_count)
+        return static_cast<size_t>(sub_count + (static_cast<uint64_t>(shift) - 1) * half_ +
+                                   (top - half_));
+    }
+
+    uint64_t lowest_in(size_t i) const {
+        const uint64_t sub_count = half_ << 1;
+        if (i < sub_count) return i;
+        const uint64_t k     = i - sub_count;
+        const uint64_t shift = k / half_ + 1;
+        return (k % half_ + half_) << shift;
+    }
+
+    uint64_t width_of(size_t i) const {
+        const uint64_t sub_count = half_ << 1;
+        return i < sub_count ? 1 : 1ULL << ((i - sub_count) / half_ + 1);
+    }
+
+    uint64_t highest_in(size_t i) const { return lowest_in(i) + width_of(i) - 1; }
+    double   midpoint_of(size_t i) const {
+        return static_cast<double>(lowest_in(i)) + static_cast<double>(width_of(i) - 1) / 2;
+    }
+
+    int      digits_;
+    uint64_t max_value_;
+    int      sub_bits_ = 0;
+    uint64_t half_     = 0;      // buckets per power of two above the linear range
+    size_t   nbuckets_ = 0;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
 };
@@ -1,39 +1,164 @@
 #pragma once
 
+#include "bench_client.hpp"
+#include "bench_pacer.hpp"
 #include "bench_stats.hpp"
 #include "nfs/nfs3_types.hpp"
-#include "nfs_client.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <future>
+#include <memory>
 #include <string>
+#include <thread>
 
 struct BenchConfig {
     std::string server;
     std::string export_path;
     std::string workload;
+    Proto       proto    = Proto::V3;
+    std::string v4_path;                   // NFSv4 working directory from the root; empty = export
     uint32_t    bs       = 65536;          // block size in bytes
     uint64_t    size     = 1ULL << 30;     // data file size in bytes (1 GiB)
     uint32_t    threads  = 1;
+    uint32_t    nconnect = 0;              // >0: threads share one client with N connections
+    uint32_t    iodepth  = 1;              // ops each thread keeps in flight
     uint32_t    duration = 30;             // wall-clock seconds
+    double      warmup   = 0;              // seconds run before measuring starts
     Stable3     stable   = Stable3::UNSTABLE; // write stability mode
     double      rw_ratio = 0.7;            // read fraction for 'mixed' workload
     std::string csv_path;                  // empty = no CSV output
+    uint16_t    portmap_port = 111;        // --fake points this at the in-process server
+    double      rate     = 0;              // open loop: target ops/s over all threads; 0 = closed loop
+    Arrival     arrival  = Arrival::POISSON;  // open-loop inter-arrival distribution
+    int         hist_digits = 3;           // latency histogram precision (significant digits)
+    std::string hist_path;                 // append serialized histograms here; empty = off
+    double      interval = 1.0;            // seconds between live snapshots; 0 = off
+    std::string json_path;                 // append JSON-lines report here; empty = off
+};
+
+// Per-thread loop driver and counters.  A workload brackets each op with
+// next() and done():
+//
+//   while (ctx.next()) { ...one op...; ctx.done(bytes); }
+//
+// Closed loop (no pacer), next() returns at once and latency is the op's own
+// service time.  Open loop, next() sleeps until the op's scheduled start and
+// latency is counted from that schedule, not from when the op was actually
+// sent, so time an op spends waiting behind a slow predecessor is charged to
+// it (no coordinated omission).  An op that starts more than one mean
+// inter-arrival gap behind schedule counts as missed.
+//
+// The counters and histogram are written by the worker only; the interval
+// sampler reads them while the run is going.
+struct WorkerCtx {
+    using Clock = std::chrono::steady_clock;
+
+    WorkerCtx(int tid_, std::atomic<bool>& stop_, Histogram& hist_)
+        : tid(tid_), stop(stop_), hist(hist_) {}
+
+    int                    tid;       // thread index [0, threads)
+    std::atomic<bool>&     stop;      // set to true after duration expires
+    Histogram&             hist;      // latency distribution, written by this thread only
+    std::unique_ptr<Pacer> pacer;     // null = closed loop
+    std::atomic<uint64_t>  ops{0};
+    std::atomic<uint64_t>  bytes{0};
+    std::atomic<uint64_t>  missed{0};    // open loop: ops started late
+
+    // Wait for the next op's start; false once the run is over.
+    bool next() {
+        if (stop.load(std::memory_order_relaxed)) return false;
+        if (!pacer) {
+            start_ = Clock::now();
+            return true;
+        }
+        start_ = pacer->next();
+        // Sleep in slices so a low rate does not hold the thread past stop.
+        for (auto now = Clock::now(); now < start_; now = Clock::now()) {
+            if (stop.load(std::memory_order_relaxed)) return false;
+            std::this_thread::sleep_until(std::min(start_, now + std::chrono::milliseconds(50)));
+        }
+        if (Clock::now() - start_ > pacer->interval()) relaxed_add(missed, 1);
+        return true;
+    }
+
+    // Record the op begun by the last next(), which moved `nbytes` of data.
+    void done(uint64_t nbytes = 0) { done(start_, nbytes); }
+
+    // Record an op that started at `start` (an earlier op_start()).
+    void done(Clock::time_point start, uint64_t nbytes) {
+        hist.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+        relaxed_add(bytes, nbytes);
+        relaxed_add(ops, 1);
+    }
+
+    // Start time of the op begun by the last next().
+    Clock::time_point op_start() const { return start_; }
+
+private:
+    Clock::time_point start_;
+};
+
+// Keeps up to --iodepth pipelined ops in flight for one worker:
+//
+//   IoQueue q(ctx, cfg.iodepth);
+//   while (q.next()) q.push(client.read_async(f, offset, cfg.bs));
+//   q.drain();
+//
+// next() collects the oldest op once the queue is full, then waits as
+// WorkerCtx::next() does.  Ops are collected in issue order, so an op that
+// completes behind a slower one is timed until it is collected.
+class IoQueue {
+public:
+    IoQueue(WorkerCtx& ctx, uint32_t depth) : ctx_(ctx), depth_(std::max(depth, 1u)) {}
+
+    bool next() {
+        while (inflight_.size() >= depth_) reap();
+        return ctx_.next();
+    }
+
+    // Queue the op begun by the last next(); the future yields its bytes.
+    void push(std::future<uint32_t> op) {
+        inflight_.push_back({std::move(op), ctx_.op_start()});
+    }
+
+    // Collect everything still in flight.
+    void drain() {
+        while (!inflight_.empty()) reap();
+    }
+
+private:
+    struct Op {
+        std::future<uint32_t>    result;
+        WorkerCtx::Clock::time_point start;
+    };
+
+    void reap() {
+        Op op = std::move(inflight_.front());
+        inflight_.pop_front();
+        ctx_.done(op.start, op.result.get());
+    }
+
+    WorkerCtx&     ctx_;
+    uint32_t       depth_;
+    std::deque<Op> inflight_;
 };
 
 // Signature for a workload function executed on each worker thread.
-// Each thread receives its own NFSClient (dedicated TCP connection).
-// workdir_fh is the per-run scratch directory shared across threads.
+// Each thread receives its own BenchClient (dedicated TCP connection), or with
+// --nconnect one BenchClient shared by all threads over its connection pool.
+// workdir_fh is the per-run scratch directory shared across threads.  Files a
+// thread opens it also closes, so NFSv4 open state stays per thread.
 using WorkloadRunFn = std::function<void(
-    NFSClient&         client,      // dedicated per-thread client
-    const Fh3&         workdir_fh,  // per-run scratch directory
+    BenchClient&       client,      // per-thread (or shared nconnect) client
+    const BenchFh&     workdir_fh,  // per-run scratch directory
     const BenchConfig& cfg,
-    int                tid,         // thread index [0, threads)
-    std::atomic<bool>& stop,        // set to true after duration expires
-    Reservoir&         res,         // per-thread latency reservoir
-    uint64_t&          ops,         // incremented per operation
-    uint64_t&          bytes        // incremented per bytes transferred
+    WorkerCtx&         ctx          // loop driver, latency and counters
 )>;
 
 struct Workload {
@@ -41,13 +166,13 @@ struct Workload {
 
     // Called once on the main thread before worker threads start.
     // Use it to pre-create test files. May be nullptr.
-    std::function<void(NFSClient&, const Fh3& workdir, const BenchConfig&)> setup
+    std::function<void(BenchClient&, const BenchFh& workdir, const BenchConfig&)> setup
         = nullptr;
 
     WorkloadRunFn run;
 
     // Called once on the main thread after all worker threads finish.
     // Use it to remove files that setup() created. May be nullptr.
-    std::function<void(NFSClient&, const Fh3& workdir, const BenchConfig&)> teardown
+    std::function<void(BenchClient&, const BenchFh& workdir, const BenchConfig&)> teardown
         = nullptr;
 };
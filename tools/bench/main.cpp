@@ -1,9 +1,12 @@
+#include "bench_client.hpp"
+#include "bench_report.hpp"
 #include "bench_stats.hpp"
 #include "bench_types.hpp"
 #include "workloads.hpp"
 
+#include "fake_server.hpp"
+
 #include "nfs/nfs3_types.hpp"
-#include "nfs_client.hpp"
 
 #include <atomic>
 #include <chrono>
@@ -16,6 +19,9 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -38,88 +44,175 @@ static uint64_t parse_size(const char* s) {
     return v;
 }
 
-static std::string human_bytes(uint64_t n) {
-    char buf[32];
-    if      (n >= (1ULL << 30)) snprintf(buf, sizeof(buf), "%.1f GiB", n / double(1ULL << 30));
-    else if (n >= (1ULL << 20)) snprintf(buf, sizeof(buf), "%.1f MiB", n / double(1ULL << 20));
-    else if (n >= (1ULL << 10)) snprintf(buf, sizeof(buf), "%.1f KiB", n / double(1ULL << 10));
-    else                        snprintf(buf, sizeof(buf), "%llu B", (unsigned long long)n);
-    return buf;
+// Microseconds, or a number with an ns/us/ms/s suffix; returns nanoseconds.
+static uint64_t parse_time_ns(const char* s) {
+    char* end = nullptr;
+    const double v = strtod(s, &end);
+    if (!end || end == s || v < 0) throw std::runtime_error(std::string("bad time: ") + s);
+    const std::string unit = end;
+    double scale;
+    if      (unit == "ns")                 scale = 1;
+    else if (unit == "us" || unit.empty()) scale = 1e3;
+    else if (unit == "ms")                 scale = 1e6;
+    else if (unit == "s")                  scale = 1e9;
+    else throw std::runtime_error("bad time suffix: " + unit);
+    return static_cast<uint64_t>(v * scale);
 }
 
-static std::string human_ns(uint64_t ns) {
-    char buf[32];
-    if      (ns >= 1'000'000'000ULL) snprintf(buf, sizeof(buf), "%.2f s",  ns / 1e9);
-    else if (ns >= 1'000'000ULL)     snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
-    else if (ns >= 1'000ULL)         snprintf(buf, sizeof(buf), "%.2f us", ns / 1e3);
-    else                             snprintf(buf, sizeof(buf), "%llu ns", (unsigned long long)ns);
-    return buf;
+// Comma-separated positive integers, e.g. "1,2,4,8".
+static std::vector<uint32_t> parse_list(const std::string& s) {
+    std::vector<uint32_t> out;
+    std::istringstream in(s);
+    for (std::string item; std::getline(in, item, ',');) {
+        char* end = nullptr;
+        const unsigned long v = strtoul(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || v == 0)
+            throw std::runtime_error("bad list entry: '" + item + "'");
+        out.push_back(static_cast<uint32_t>(v));
+    }
+    return out;
 }
 
 static void print_usage(const char* prog) {
     fprintf(stderr,
-        "Usage: %s --server HOST --export PATH --workload NAME [options]\n"
+        "Usage: %s (--server HOST --export PATH | --fake) --workload NAME [options]\n"
+        "       %s --merge-hist FILE...\n"
         "\n"
         "Workloads: seqread, seqwrite, randread, randwrite, meta, mixed\n"
         "\n"
         "Options:\n"
+        "  --proto <ver>      NFS version: v3, v4.0 or v4.1 (default v3)\n"
+        "  --compare          Run the workload over v3, v4.0 and v4.1 and compare\n"
+        "  --v4-path <path>   NFSv4 directory to work in, from the server root (default --export)\n"
         "  --bs <bytes>       Block size (default 65536, supports K/M/G suffixes)\n"
         "  --size <bytes>     Data file size (default 1G)\n"
         "  --threads <n>      Concurrent connections/threads (default 1)\n"
+        "  --nconnect <n>     Share one client across threads over n TCP connections\n"
+        "  --iodepth <n>      Pipelined ops each thread keeps in flight (default 1;\n"
+        "                     data workloads only)\n"
         "  --duration <s>     Run time in seconds (default 30)\n"
+        "  --warmup <s>       Run this long before measuring (default 0; 2 when sweeping)\n"
+        "  --sweep threads=<n,n,...> | iodepth=<n,n,...>\n"
+        "                     Run every listed point after one setup and flag the\n"
+        "                     saturation knee; may be given once per dimension\n"
+        "  --slo-p99 <time>   Find the highest open-loop rate whose p99 stays within\n"
+        "                     <time> (us, or with ns/us/ms/s suffix)\n"
         "  --stable <mode>    Write stability: unstable, datasync, filesync (default unstable)\n"
         "  --rw-ratio <0-1>   Read fraction for 'mixed' workload (default 0.7)\n"
-        "  --csv <path>       Append results to a CSV file\n",
-        prog);
+        "  --csv <path>       Append results to a CSV file\n"
+        "  --interval <s>     Print a live snapshot every s seconds (default 1, 0 = off)\n"
+        "  --json <path>      Append config, host, interval snapshots and summary as JSON lines\n"
+        "  --rate <ops/s>     Open loop: start ops on a schedule at this total rate;\n"
+        "                     latency is measured from the scheduled start\n"
+        "  --arrival <dist>   Open-loop arrivals: poisson or constant (default poisson)\n"
+        "  --hist-digits <n>  Latency histogram precision, 1-5 significant digits (default 3)\n"
+        "  --hist-out <path>  Append the run's serialized latency histogram to a file\n"
+        "  --merge-hist FILE...  Combine histograms saved by --hist-out and print percentiles\n"
+        "  --fake             Run against an in-process fake server on loopback\n"
+        "  --fake-latency <us>     Fake server: delay added to every reply\n"
+        "  --fake-bandwidth <bytes> Fake server: link bandwidth per second (K/M/G)\n",
+        prog, prog);
 }
 
-// ── Recursive workdir cleanup ─────────────────────────────────────────────────
-
-static void rmdir_recursive(NFSClient& client, const Fh3& parent, const std::string& name);
+// ── Run a workload across N threads ──────────────────────────────────────────
 
-static void clear_dir(NFSClient& client, const Fh3& dir) {
-    for (const auto& entry : client.readdirplus(dir)) {
-        if (entry.name == "." || entry.name == "..") continue;
-        if (entry.has_attrs && entry.attrs.type == Ftype3::NF3DIR) {
-            rmdir_recursive(client, dir, entry.name);
-        } else {
-            client.remove(dir, entry.name);
+// The workers' cumulative counters and histograms summed at one instant.
+struct Totals {
+    explicit Totals(int hist_digits) : hist(hist_digits) {}
+
+    void take(const std::vector<std::unique_ptr<WorkerCtx>>& ctxs) {
+        hist.reset();
+        ops = bytes = missed = 0;
+        for (const auto& c : ctxs) {
+            hist.merge(c->hist);
+            ops    += c->ops.load(std::memory_order_relaxed);
+            bytes  += c->bytes.load(std::memory_order_relaxed);
+            missed += c->missed.load(std::memory_order_relaxed);
         }
     }
-}
 
-static void rmdir_recursive(NFSClient& client, const Fh3& parent, const std::string& name) {
-    Fh3 dir_fh = client.lookup(parent, name);
-    clear_dir(client, dir_fh);
-    client.rmdir(parent, name);
-}
+    Histogram hist;
+    uint64_t  ops = 0, bytes = 0, missed = 0;
+};
 
-// ── Run a workload across N threads ──────────────────────────────────────────
+// Snapshots the workers' totals; each interval is the difference between two
+// snapshots, so workers never reset anything.  The first interval starts
+// from `base`, taken at `start`.
+class IntervalSampler {
+public:
+    IntervalSampler(const BenchConfig& cfg,
+                    const std::vector<std::unique_ptr<WorkerCtx>>& ctxs,
+                    std::chrono::steady_clock::time_point start, const Totals& base,
+                    JsonLines& json)
+        : cfg_(cfg), ctxs_(ctxs), start_(start), json_(json),
+          prev_(base), cur_(cfg.hist_digits), prev_t_(start) {}
+
+    void sample(std::chrono::steady_clock::time_point now) {
+        cur_.take(ctxs_);
+        IntervalSample s;
+        s.t_s    = std::chrono::duration<double>(now - start_).count();
+        s.dur_s  = std::chrono::duration<double>(now - prev_t_).count();
+        s.ops    = cur_.ops - prev_.ops;
+        s.bytes  = cur_.bytes - prev_.bytes;
+        s.missed = cur_.missed - prev_.missed;
+        s.lat    = cur_.hist.since(prev_.hist).compute();
+        if (s.dur_s <= 0) return;
+
+        if (cfg_.interval > 0) print_interval(s);
+        json_.write(json_interval(cfg_, s));
+
+        prev_.hist.reset();
+        prev_.hist.merge(cur_.hist);
+        prev_.ops    = cur_.ops;
+        prev_.bytes  = cur_.bytes;
+        prev_.missed = cur_.missed;
+        prev_t_ = now;
+    }
 
-struct RunResult {
-    uint64_t        total_ops;
-    uint64_t        total_bytes;
-    double          elapsed_s;
-    Reservoir::Stats lat;
+private:
+    const BenchConfig&                            cfg_;
+    const std::vector<std::unique_ptr<WorkerCtx>>& ctxs_;
+    std::chrono::steady_clock::time_point         start_;
+    JsonLines&                                    json_;
+    Totals                                        prev_;
+    Totals                                        cur_;
+    std::chrono::steady_clock::time_point         prev_t_;
 };
 
 static RunResult run_workload(const Workload& wl, const BenchConfig& cfg,
-                              const std::string& host, const Fh3& workdir_fh) {
+                              const BenchFh& workdir_fh, JsonLines& json) {
     // Per-thread state
     const int N = static_cast<int>(cfg.threads);
-    std::vector<Reservoir>  reservoirs(N);
-    std::vector<uint64_t>   thread_ops(N, 0);
-    std::vector<uint64_t>   thread_bytes(N, 0);
+    std::vector<std::unique_ptr<Histogram>> hists;
     std::atomic<bool>       stop{false};
+    std::vector<std::unique_ptr<WorkerCtx>> ctxs;
+    for (int i = 0; i < N; ++i) {
+        hists.push_back(std::make_unique<Histogram>(cfg.hist_digits));
+        ctxs.push_back(std::make_unique<WorkerCtx>(i, stop, *hists[i]));
+    }
+
+    AuthSys auth{};
+    auth.uid = 0; auth.gid = 0;
+
+    ClientOptions opts;
+    opts.portmap_port = cfg.portmap_port;
+
+    // One client per thread, or with --nconnect one client object whose
+    // calls spread over its connection pool.  Connected (and, for NFSv4,
+    // registered) before the clock starts.
+    std::vector<std::unique_ptr<BenchClient>> clients;
+    if (cfg.nconnect > 0) {
+        opts.nconnect = cfg.nconnect;
+        clients.push_back(make_bench_client(cfg.proto, cfg.server, opts, auth));
+    } else {
+        for (int i = 0; i < N; ++i)
+            clients.push_back(make_bench_client(cfg.proto, cfg.server, opts, auth));
+    }
 
     auto worker = [&](int tid) {
         try {
-            NFSClient client(host);
-            AuthSys auth{};
-            auth.uid = 0; auth.gid = 0;
-            client.set_auth_sys(auth);
-            wl.run(client, workdir_fh, cfg, tid, stop,
-                   reservoirs[tid], thread_ops[tid], thread_bytes[tid]);
+            BenchClient& client = *clients[clients.size() == 1 ? 0 : tid];
+            wl.run(client, workdir_fh, cfg, *ctxs[tid]);
         } catch (const std::exception& e) {
             fprintf(stderr, "[thread %d] error: %s\n", tid, e.what());
         }
@@ -127,71 +220,139 @@ static RunResult run_workload(const Workload& wl, const BenchConfig& cfg,
 
     auto t_start = std::chrono::steady_clock::now();
 
+    // --rate: each thread paces its share of the target rate.  Threads are
+    // phase-shifted by one arrival gap so constant arrivals do not bunch up.
+    if (cfg.rate > 0) {
+        const auto gap = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / cfg.rate));
+        for (int i = 0; i < N; ++i)
+            ctxs[i]->pacer = std::make_unique<Pacer>(cfg.rate / N, cfg.arrival,
+                                                    std::random_device{}() + i,
+                                                    t_start + i * gap);
+    }
+
     std::vector<std::thread> threads;
     threads.reserve(N);
     for (int i = 0; i < N; ++i)
         threads.emplace_back(worker, i);
 
-    std::this_thread::sleep_for(std::chrono::seconds(cfg.duration));
+    // --warmup: let connections, caches and queues settle first; what the
+    // workers did until then is subtracted from the result.
+    Totals base(cfg.hist_digits);
+    auto   t_measure = t_start;
+    if (cfg.warmup > 0) {
+        t_measure += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(cfg.warmup));
+        std::this_thread::sleep_until(t_measure);
+        base.take(ctxs);
+    }
+
+    // Only sample on a schedule with --interval; --json alone still gets the
+    // one whole-run interval below.
+    IntervalSampler sampler(cfg, ctxs, t_measure, base, json);
+    const auto t_stop = t_measure + std::chrono::seconds(cfg.duration);
+    if (cfg.interval > 0) {
+        const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(cfg.interval));
+        for (auto tick = t_measure + step; tick < t_stop; tick += step) {
+            std::this_thread::sleep_until(tick);
+            sampler.sample(std::chrono::steady_clock::now());
+        }
+    }
+    std::this_thread::sleep_until(t_stop);
     stop.store(true, std::memory_order_relaxed);
 
     for (auto& t : threads) t.join();
 
     auto t_end = std::chrono::steady_clock::now();
-    double elapsed = std::chrono::duration<double>(t_end - t_start).count();
+    sampler.sample(t_end);                   // the tail since the last tick
+    double elapsed = std::chrono::duration<double>(t_end - t_measure).count();
 
-    // Merge per-thread reservoirs into one
-    Reservoir merged;
-    uint64_t total_ops   = 0;
-    uint64_t total_bytes = 0;
-    for (int i = 0; i < N; ++i) {
-        merged.merge(reservoirs[i]);
-        total_ops   += thread_ops[i];
-        total_bytes += thread_bytes[i];
-    }
+    // Merge per-thread histograms into one
+    Totals total(cfg.hist_digits);
+    total.take(ctxs);
+    const Histogram merged = cfg.warmup > 0 ? total.hist.since(base.hist) : Histogram(total.hist);
 
-    return {total_ops, total_bytes, elapsed, merged.compute()};
+    return {total.ops - base.ops, total.bytes - base.bytes, total.missed - base.missed,
+            elapsed, merged.compute(), merged.serialize()};
 }
 
 // ── Output formatting ─────────────────────────────────────────────────────────
 
+// Throughput: for meta workload bytes is 0, show IOPS instead
+static std::string throughput(const RunResult& r) {
+    char buf[32];
+    if (r.total_bytes > 0) snprintf(buf, sizeof(buf), "%.1f MB/s", r.total_bytes / 1e6 / r.elapsed_s);
+    else                   snprintf(buf, sizeof(buf), "%.0f IOPS", r.total_ops / r.elapsed_s);
+    return buf;
+}
+
 static void print_result(const BenchConfig& cfg, const RunResult& r) {
     printf("\n");
     printf("Workload : %s\n", cfg.workload.c_str());
+    printf("protocol : %s\n", proto_name(cfg.proto));
     printf("bs       : %s\n", human_bytes(cfg.bs).c_str());
     printf("size     : %s\n", human_bytes(cfg.size).c_str());
     printf("threads  : %u\n", cfg.threads);
+    if (cfg.nconnect > 0) printf("nconnect : %u\n", cfg.nconnect);
+    if (cfg.iodepth > 1)  printf("iodepth  : %u\n", cfg.iodepth);
+    if (cfg.rate > 0) {
+        printf("rate     : %.0f ops/s target (%s), %.0f achieved\n", cfg.rate,
+               cfg.arrival == Arrival::POISSON ? "poisson" : "constant",
+               r.total_ops / r.elapsed_s);
+        printf("missed   : %llu (%.2f%% of ops started behind schedule)\n",
+               (unsigned long long)r.missed,
+               r.total_ops ? 100.0 * r.missed / r.total_ops : 0.0);
+    }
     printf("duration : %.1f s\n", r.elapsed_s);
     printf("\n");
-    printf("%-12s %-14s %-10s %-10s %-10s %-10s %-10s\n",
-           "Ops", "Throughput", "lat_min", "lat_p50", "lat_p95", "lat_p99", "lat_max");
-    printf("%-12s %-14s %-10s %-10s %-10s %-10s %-10s\n",
+    printf("%-12s %-14s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+           "Ops", "Throughput", "lat_min", "lat_p50", "lat_p95", "lat_p99",
+           "lat_p99.9", "lat_p99.99", "lat_max");
+    printf("%-12s %-14s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
            "───────────", "─────────────", "─────────", "─────────",
-           "─────────", "─────────", "─────────");
-
-    // Throughput: for meta workload bytes is 0, show IOPS instead
-    std::string tput;
-    if (r.total_bytes > 0) {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%.1f MB/s", r.total_bytes / 1e6 / r.elapsed_s);
-        tput = buf;
-    } else {
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%.0f IOPS", r.total_ops / r.elapsed_s);
-        tput = buf;
-    }
+           "─────────", "─────────", "─────────", "─────────", "─────────");
+
+    const std::string tput = throughput(r);
 
-    printf("%-12llu %-14s %-10s %-10s %-10s %-10s %-10s\n",
+    printf("%-12llu %-14s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
            (unsigned long long)r.total_ops,
            tput.c_str(),
            human_ns(r.lat.min_ns).c_str(),
            human_ns(r.lat.p50_ns).c_str(),
            human_ns(r.lat.p95_ns).c_str(),
            human_ns(r.lat.p99_ns).c_str(),
+           human_ns(r.lat.p999_ns).c_str(),
+           human_ns(r.lat.p9999_ns).c_str(),
            human_ns(r.lat.max_ns).c_str());
     printf("\n");
 }
 
+// --compare: one row per protocol, throughput relative to the first.
+static void print_comparison(const BenchConfig& cfg,
+                             const std::vector<std::pair<Proto, RunResult>>& results) {
+    if (results.empty()) return;
+    printf("Comparison: %s, bs %s, %u thread(s), iodepth %u\n\n", cfg.workload.c_str(),
+           human_bytes(cfg.bs).c_str(), cfg.threads, cfg.iodepth);
+    printf("%-8s %-12s %-14s %-10s %-10s %-10s %-10s %-10s %-8s\n",
+           "Proto", "Ops", "Throughput", "lat_p50", "lat_p99", "lat_p99.9", "lat_max",
+           "lat_mean", "vs first");
+    printf("%-8s %-12s %-14s %-10s %-10s %-10s %-10s %-10s %-8s\n",
+           "───────", "───────────", "─────────────", "─────────", "─────────",
+           "─────────", "─────────", "─────────", "───────");
+    const double base = results.front().second.total_ops / results.front().second.elapsed_s;
+    for (const auto& [proto, r] : results) {
+        const double ops_s = r.total_ops / r.elapsed_s;
+        printf("%-8s %-12llu %-14s %-10s %-10s %-10s %-10s %-10s %.2fx\n",
+               proto_name(proto), (unsigned long long)r.total_ops,
+               throughput(r).c_str(),
+               human_ns(r.lat.p50_ns).c_str(), human_ns(r.lat.p99_ns).c_str(),
+               human_ns(r.lat.p999_ns).c_str(), human_ns(r.lat.max_ns).c_str(),
+               human_ns(static_cast<uint64_t>(r.lat.mean_ns)).c_str(),
+               base > 0 ? ops_s / base : 0.0);
+    }
+    printf("\n");
+}
+
 static void write_csv(const std::string& path, const BenchConfig& cfg, const RunResult& r) {
     bool write_header = true;
     {
@@ -205,7 +366,8 @@ static void write_csv(const std::string& path, const BenchConfig& cfg, const Run
     }
     if (write_header) {
         f << "workload,bs,size,threads,duration_s,ops,throughput_mb_s,"
-          << "lat_min_us,lat_p50_us,lat_p95_us,lat_p99_us,lat_max_us\n";
+          << "lat_min_us,lat_p50_us,lat_p95_us,lat_p99_us,lat_max_us,"
+          << "target_rate,missed,lat_p999_us,lat_p9999_us,lat_mean_us,proto,iodepth\n";
     }
     auto to_us = [](uint64_t ns) { return ns / 1000.0; };
     f << cfg.workload << ","
@@ -219,13 +381,328 @@ static void write_csv(const std::string& path, const BenchConfig& cfg, const Run
       << to_us(r.lat.p50_ns) << ","
       << to_us(r.lat.p95_ns) << ","
       << to_us(r.lat.p99_ns) << ","
-      << to_us(r.lat.max_ns) << "\n";
+      << to_us(r.lat.max_ns) << ","
+      << cfg.rate << ","
+      << r.missed << ","
+      << to_us(r.lat.p999_ns) << ","
+      << to_us(r.lat.p9999_ns) << ","
+      << r.lat.mean_ns / 1000.0 << ","
+      << proto_name(cfg.proto) << ","
+      << cfg.iodepth << "\n";
+}
+
+static void write_hist(const std::string& path, const BenchConfig& cfg, const RunResult& r) {
+    std::ofstream f(path, std::ios::app);
+    if (!f) {
+        fprintf(stderr, "warning: cannot open histogram file '%s'\n", path.c_str());
+        return;
+    }
+    f << cfg.workload << ' ' << r.hist << "\n";
+}
+
+// --merge-hist: combine the histograms in --hist-out files (one
+// "<workload> HIST1 ..." line per run) and print one summary per workload.
+static int merge_hists(const std::vector<std::string>& paths) {
+    std::map<std::string, std::unique_ptr<Histogram>> by_workload;
+    for (const auto& path : paths) {
+        std::ifstream f(path);
+        if (!f) { fprintf(stderr, "cannot open '%s'\n", path.c_str()); return 1; }
+        std::string line;
+        while (std::getline(f, line)) {
+            const size_t sp = line.find(' ');
+            if (line.empty() || sp == std::string::npos) continue;
+            Histogram h = Histogram::deserialize(line.substr(sp + 1));
+            auto& slot = by_workload[line.substr(0, sp)];
+            if (!slot) slot = std::make_unique<Histogram>(h.significant_digits(), h.max_value());
+            slot->merge(h);
+        }
+    }
+    printf("%-12s %-12s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+           "Workload", "Ops", "lat_mean", "lat_min", "lat_p50", "lat_p99",
+           "lat_p99.9", "lat_p99.99", "lat_max");
+    for (const auto& [name, h] : by_workload) {
+        const Histogram::Stats s = h->compute();
+        printf("%-12s %-12llu %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+               name.c_str(), (unsigned long long)s.count,
+               human_ns(static_cast<uint64_t>(s.mean_ns)).c_str(),
+               human_ns(s.min_ns).c_str(), human_ns(s.p50_ns).c_str(),
+               human_ns(s.p99_ns).c_str(), human_ns(s.p999_ns).c_str(),
+               human_ns(s.p9999_ns).c_str(), human_ns(s.max_ns).c_str());
+    }
+    return 0;
+}
+
+// ── One run: connect, set up, run, tear down ─────────────────────────────────
+
+// Connects over cfg.proto, runs the workload's setup in a fresh bench_<pid>
+// directory, calls `body` with it, and runs the teardown.  The directory is
+// removed afterwards whatever happens.  Returns false (after printing why) if
+// anything failed.
+static bool with_workdir(const Workload& wl, const BenchConfig& cfg,
+                         const std::function<void(const BenchFh& workdir)>& body) {
+    const std::string workdir_name = "bench_" + std::to_string(getpid());
+    std::unique_ptr<BenchClient> main_client;
+    BenchFh root_fh;
+    bool    have_workdir = false;
+    bool    ok = true;
+    try {
+        // Main client uid=0 so it can create the workdir and test files
+        AuthSys auth{};
+        auth.uid = 0; auth.gid = 0;
+        ClientOptions main_opts;
+        main_opts.portmap_port = cfg.portmap_port;
+        main_client = make_bench_client(cfg.proto, cfg.server, main_opts, auth);
+        root_fh = main_client->root(cfg.export_path,
+                                    cfg.v4_path.empty() ? cfg.export_path : cfg.v4_path);
+
+        const BenchFh workdir_fh = main_client->mkdir(root_fh, workdir_name);
+        have_workdir = true;
+
+        // Phase 1: setup (pre-create test files)
+        if (wl.setup) {
+            fprintf(stderr, "Setting up workload '%s' over %s (file size %s)...\n",
+                    cfg.workload.c_str(), proto_name(cfg.proto), human_bytes(cfg.size).c_str());
+            wl.setup(*main_client, workdir_fh, cfg);
+        }
+
+        // Phase 2: run workers
+        body(workdir_fh);
+
+        // Phase 3: teardown (remove test files created by setup)
+        if (wl.teardown) wl.teardown(*main_client, workdir_fh, cfg);
+
+    } catch (const std::exception& e) {
+        fprintf(stderr, "error (%s): %s\n", proto_name(cfg.proto), e.what());
+        ok = false;
+    }
+
+    // Always clean up the workdir
+    if (have_workdir) {
+        try {
+            main_client->remove_tree(root_fh, workdir_name);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "warning: workdir cleanup failed: %s\n", e.what());
+        }
+    }
+    return ok;
+}
+
+// Runs `wl` once in an already set up `workdir_fh` and writes the JSON, CSV
+// and histogram records.
+static RunResult run_point(const Workload& wl, const BenchConfig& cfg,
+                           const BenchFh& workdir_fh, JsonLines& json) {
+    fprintf(stderr, "Running '%s' over %s for %u s with %u thread(s), iodepth %u%s...\n",
+            cfg.workload.c_str(), proto_name(cfg.proto), cfg.duration, cfg.threads,
+            cfg.iodepth, cfg.rate > 0 ? " (open loop)" : "");
+    json.write(JsonObject().add("type", "config")
+                           .add("config", json_config(cfg))
+                           .add("host", json_host()));
+    RunResult result = run_workload(wl, cfg, workdir_fh, json);
+
+    json.write(json_summary(cfg, result));
+    if (!cfg.csv_path.empty()) write_csv(cfg.csv_path, cfg, result);
+    if (!cfg.hist_path.empty()) write_hist(cfg.hist_path, cfg, result);
+    return result;
+}
+
+// Runs `wl` over cfg.proto with its own setup and teardown.
+static bool run_proto(const Workload& wl, const BenchConfig& cfg, JsonLines& json,
+                      RunResult& result) {
+    return with_workdir(wl, cfg, [&](const BenchFh& workdir_fh) {
+        result = run_point(wl, cfg, workdir_fh, json);
+    });
+}
+
+// ── Sweep: latency vs. concurrency ───────────────────────────────────────────
+
+struct SweepPoint {
+    uint32_t  threads;
+    uint32_t  iodepth;
+    RunResult r;
+};
+
+static double ops_per_s(const RunResult& r) {
+    return r.elapsed_s > 0 ? r.total_ops / r.elapsed_s : 0.0;
+}
+
+// The saturation knee: the point with the highest power (Kleinrock), i.e.
+// throughput over mean latency.  Below it more concurrency still buys
+// throughput cheaply; past it the extra requests mostly wait in queues.
+static size_t find_knee(const std::vector<SweepPoint>& pts) {
+    size_t knee       = 0;
+    double best_power = -1;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        const double mean_s = pts[i].r.lat.mean_ns / 1e9;
+        const double power  = mean_s > 0 ? ops_per_s(pts[i].r) / mean_s : 0.0;
+        if (power > best_power) {
+            best_power = power;
+            knee       = i;
+        }
+    }
+    return knee;
+}
+
+// One row per point.  "scaling" is throughput gained relative to concurrency
+// added, both against the first point: 1.00 is linear, near 0 is saturated.
+static void print_sweep(const BenchConfig& cfg, const std::vector<SweepPoint>& pts,
+                        size_t knee) {
+    if (pts.empty()) return;
+    printf("\nSweep: %s over %s, bs %s, %g s warmup + %u s per point\n\n",
+           cfg.workload.c_str(), proto_name(cfg.proto), human_bytes(cfg.bs).c_str(),
+           cfg.warmup, cfg.duration);
+    printf("%-8s %-8s %-12s %-14s %-10s %-10s %-10s %-8s\n",
+           "Threads", "Iodepth", "Ops/s", "Throughput", "lat_p50", "lat_p99", "lat_mean",
+           "Scaling");
+    printf("%-8s %-8s %-12s %-14s %-10s %-10s %-10s %-8s\n",
+           "───────", "───────", "───────────", "─────────────", "─────────",
+           "─────────", "─────────", "───────");
+    const double base_ops  = ops_per_s(pts.front().r);
+    const double base_load = double(pts.front().threads) * pts.front().iodepth;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        const SweepPoint& p    = pts[i];
+        const double      load = double(p.threads) * p.iodepth;
+        char scaling[16] = "-";
+        if (i > 0 && load != base_load && base_ops > 0)
+            snprintf(scaling, sizeof(scaling), "%.2f",
+                     (ops_per_s(p.r) / base_ops - 1) / (load / base_load - 1));
+        printf("%-8u %-8u %-12.0f %-14s %-10s %-10s %-10s %-8s%s\n",
+               p.threads, p.iodepth, ops_per_s(p.r), throughput(p.r).c_str(),
+               human_ns(p.r.lat.p50_ns).c_str(), human_ns(p.r.lat.p99_ns).c_str(),
+               human_ns(static_cast<uint64_t>(p.r.lat.mean_ns)).c_str(), scaling,
+               i == knee ? "  <- knee" : "");
+    }
+    printf("\n");
+}
+
+struct SloResult {
+    bool             found = false;   // some probed rate met the target
+    double           rate  = 0;       // highest passing rate, ops/s
+    Histogram::Stats lat{};           // its latency
+    double           failed_rate = 0; // lowest failing rate, 0 if none failed
+};
+
+constexpr int SLO_PROBES = 6;         // bisection steps after the first probe
+
+// --slo-p99: bisects the open-loop --rate between 0 and the best throughput
+// the sweep reached, at that point's threads and iodepth, for the highest
+// rate whose p99 stays within `target_ns`.  Open loop so that time spent
+// queued behind slow ops is part of the latency (see --rate).
+static SloResult slo_search(const Workload& wl, const BenchConfig& base_cfg,
+                            const BenchFh& workdir_fh, JsonLines& json,
+                            const SweepPoint& best, uint64_t target_ns) {
+    BenchConfig cfg = base_cfg;
+    cfg.threads     = best.threads;
+    cfg.iodepth     = best.iodepth;
+
+    SloResult res;
+    double lo = 0, hi = ops_per_s(best.r);
+    auto probe = [&](double rate) {
+        cfg.rate = rate;
+        const RunResult r = run_point(wl, cfg, workdir_fh, json);
+        const bool pass = r.lat.p99_ns <= target_ns;
+        fprintf(stderr, "SLO probe %.0f ops/s: p99 %s, %s\n", rate,
+                human_ns(r.lat.p99_ns).c_str(), pass ? "pass" : "fail");
+        if (pass) {
+            res.found = true;
+            res.rate  = rate;
+            res.lat   = r.lat;
+        } else {
+            res.failed_rate = rate;
+        }
+        return pass;
+    };
+
+    if (hi <= 0 || probe(hi)) return res;      // met even at full throughput
+    for (int i = 0; i < SLO_PROBES; ++i) {
+        const double mid = (lo + hi) / 2;
+        if (probe(mid)) lo = mid;
+        else            hi = mid;
+    }
+    return res;
+}
+
+static void print_slo(const BenchConfig& cfg, uint64_t target_ns, const SweepPoint& best,
+                      const SloResult& slo) {
+    printf("SLO p99 <= %s at %u thread(s), iodepth %u:\n", human_ns(target_ns).c_str(),
+           best.threads, best.iodepth);
+    if (!slo.found) {
+        printf("  not met at any probed rate (lowest tried %.0f ops/s)\n\n", slo.failed_rate);
+        return;
+    }
+    printf("  highest passing rate %.0f ops/s", slo.rate);
+    if (best.r.total_bytes > 0)
+        printf(" (%.1f MB/s)", slo.rate * cfg.bs / 1e6);
+    printf(", p50 %s, p99 %s\n", human_ns(slo.lat.p50_ns).c_str(),
+           human_ns(slo.lat.p99_ns).c_str());
+    if (slo.failed_rate > 0) printf("  failed at %.0f ops/s\n", slo.failed_rate);
+    else                     printf("  (the point's full throughput; try more concurrency)\n");
+    printf("\n");
+}
+
+// --sweep / --slo-p99: one setup, then every threads x iodepth combination in
+// turn, each with its own warmup.
+static bool run_sweep(const Workload& wl, const BenchConfig& cfg, JsonLines& json,
+                      const std::vector<uint32_t>& threads,
+                      const std::vector<uint32_t>& iodepths, uint64_t slo_ns) {
+    return with_workdir(wl, cfg, [&](const BenchFh& workdir_fh) {
+        std::vector<SweepPoint> pts;
+        for (uint32_t t : threads) {
+            for (uint32_t d : iodepths) {
+                BenchConfig point = cfg;
+                point.threads = t;
+                point.iodepth = d;
+                pts.push_back({t, d, run_point(wl, point, workdir_fh, json)});
+            }
+        }
+        const size_t knee = find_knee(pts);
+        print_sweep(cfg, pts, knee);
+
+        JsonObject rec;
+        rec.add("type", "sweep")
+           .add("workload", cfg.workload)
+           .add("proto", proto_name(cfg.proto))
+           .add("points", pts.size())
+           .add("knee_threads", pts[knee].threads)
+           .add("knee_iodepth", pts[knee].iodepth)
+           .add("knee_iops", ops_per_s(pts[knee].r));
+        if (slo_ns > 0) {
+            const auto best = std::max_element(pts.begin(), pts.end(),
+                [](const SweepPoint& a, const SweepPoint& b) {
+                    return ops_per_s(a.r) < ops_per_s(b.r);
+                });
+            const SloResult slo = slo_search(wl, cfg, workdir_fh, json, *best, slo_ns);
+            print_slo(cfg, slo_ns, *best, slo);
+            rec.add("slo_p99_us", slo_ns / 1000.0)
+               .add("slo_threads", best->threads)
+               .add("slo_iodepth", best->iodepth)
+               .add("slo_met", slo.found)
+               .add("slo_rate", slo.rate);
+        }
+        json.write(rec);
+    });
 }
 
 // ── Main ──────────────────────────────────────────────────────────────────────
 
 int main(int argc, char* argv[]) {
     BenchConfig cfg;
+    bool                    use_fake = false;
+    bool                    compare  = false;
+    bool                    warmup_set = false;
+    std::vector<uint32_t>   sweep_threads, sweep_iodepth;
+    uint64_t                slo_ns   = 0;
+    fake::FakeServerOptions fake_opts;
+    fake_opts.store_data = false;   // benchmark files would not fit in memory
+
+    if (argc > 1 && strcmp(argv[1], "--merge-hist") == 0) {
+        if (argc < 3) { print_usage(argv[0]); return 1; }
+        try {
+            return merge_hists(std::vector<std::string>(argv + 2, argv + argc));
+        } catch (const std::exception& e) {
+            fprintf(stderr, "error: %s\n", e.what());
+            return 1;
+        }
+    }
 
     for (int i = 1; i < argc; ++i) {
         auto arg = [&](const char* flag) -> bool {
@@ -235,12 +712,50 @@ int main(int argc, char* argv[]) {
         if      (arg("--server"))   cfg.server      = argv[i];
         else if (arg("--export"))   cfg.export_path = argv[i];
         else if (arg("--workload")) cfg.workload    = argv[i];
+        else if (arg("--proto")) {
+            if (!parse_proto(argv[i], cfg.proto)) {
+                fprintf(stderr, "unknown protocol: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg("--v4-path"))  cfg.v4_path     = argv[i];
+        else if (strcmp(argv[i], "--compare") == 0) compare = true;
         else if (arg("--bs"))       cfg.bs          = static_cast<uint32_t>(parse_size(argv[i]));
         else if (arg("--size"))     cfg.size        = parse_size(argv[i]);
         else if (arg("--threads"))  cfg.threads     = static_cast<uint32_t>(atoi(argv[i]));
+        else if (arg("--nconnect")) cfg.nconnect    = static_cast<uint32_t>(atoi(argv[i]));
+        else if (arg("--iodepth"))  cfg.iodepth     = static_cast<uint32_t>(atoi(argv[i]));
         else if (arg("--duration")) cfg.duration    = static_cast<uint32_t>(atoi(argv[i]));
+        else if (arg("--warmup")) { cfg.warmup = atof(argv[i]); warmup_set = true; }
+        else if (arg("--slo-p99"))  slo_ns          = parse_time_ns(argv[i]);
+        else if (arg("--sweep")) {
+            const std::string spec = argv[i];
+            const size_t eq = spec.find('=');
+            const std::string dim = spec.substr(0, eq);
+            if (eq == std::string::npos || (dim != "threads" && dim != "iodepth")) {
+                fprintf(stderr, "bad --sweep '%s': expected threads=... or iodepth=...\n",
+                        spec.c_str());
+                return 1;
+            }
+            (dim == "threads" ? sweep_threads : sweep_iodepth) = parse_list(spec.substr(eq + 1));
+        }
         else if (arg("--rw-ratio")) cfg.rw_ratio    = atof(argv[i]);
         else if (arg("--csv"))      cfg.csv_path    = argv[i];
+        else if (arg("--interval")) cfg.interval    = atof(argv[i]);
+        else if (arg("--json"))     cfg.json_path   = argv[i];
+        else if (arg("--rate"))     cfg.rate        = atof(argv[i]);
+        else if (arg("--hist-digits")) cfg.hist_digits = atoi(argv[i]);
+        else if (arg("--hist-out")) cfg.hist_path   = argv[i];
+        else if (arg("--arrival")) {
+            std::string s = argv[i];
+            if      (s == "poisson")  cfg.arrival = Arrival::POISSON;
+            else if (s == "constant") cfg.arrival = Arrival::CONSTANT;
+            else { fprintf(stderr, "unknown arrival distribution: %s\n", s.c_str()); return 1; }
+        }
+        else if (arg("--fake-latency"))
+            fake_opts.latency = std::chrono::microseconds(strtoull(argv[i], nullptr, 10));
+        else if (arg("--fake-bandwidth")) fake_opts.bandwidth = parse_size(argv[i]);
+        else if (strcmp(argv[i], "--fake") == 0) use_fake = true;
         else if (arg("--stable")) {
             std::string s = argv[i];
             if      (s == "unstable")  cfg.stable = Stable3::UNSTABLE;
@@ -254,12 +769,41 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // --fake: serve the run from this process; it replaces --server/--export.
+    std::unique_ptr<fake::FakeServer> fake_server;
+    if (use_fake) {
+        fake_server      = std::make_unique<fake::FakeServer>(fake_opts);
+        cfg.server       = fake_server->host();
+        cfg.export_path  = fake_server->export_path();
+        cfg.portmap_port = fake_server->port();
+        cfg.v4_path      = "/";                 // PUTROOTFH lands on the export
+        fprintf(stderr, "Using in-process fake server on %s:%u\n",
+                cfg.server.c_str(), cfg.portmap_port);
+    }
+
     if (cfg.server.empty() || cfg.export_path.empty() || cfg.workload.empty()) {
         print_usage(argv[0]);
         return 1;
     }
-    if (cfg.bs == 0 || cfg.size == 0 || cfg.threads == 0 || cfg.duration == 0) {
-        fprintf(stderr, "bs, size, threads, and duration must be > 0\n");
+    if (cfg.bs == 0 || cfg.size == 0 || cfg.threads == 0 || cfg.duration == 0 ||
+        cfg.iodepth == 0) {
+        fprintf(stderr, "bs, size, threads, iodepth, and duration must be > 0\n");
+        return 1;
+    }
+    if (cfg.rate < 0) {
+        fprintf(stderr, "rate must be >= 0\n");
+        return 1;
+    }
+    if (cfg.warmup < 0) {
+        fprintf(stderr, "warmup must be >= 0\n");
+        return 1;
+    }
+    if (cfg.interval < 0) {
+        fprintf(stderr, "interval must be >= 0\n");
+        return 1;
+    }
+    if (cfg.hist_digits < 1 || cfg.hist_digits > 5) {
+        fprintf(stderr, "hist-digits must be 1-5\n");
         return 1;
     }
 
@@ -280,51 +824,43 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     Workload wl = it->second();
-
-    // Connect main client (uid=0 so it can create the workdir and test files)
-    NFSClient main_client(cfg.server);
-    {
-        AuthSys auth{};
-        auth.uid = 0; auth.gid = 0;
-        main_client.set_auth_sys(auth);
+    if (cfg.workload == "meta" && (cfg.iodepth > 1 || !sweep_iodepth.empty())) {
+        fprintf(stderr, "warning: 'meta' runs one op at a time; ignoring --iodepth\n");
+        cfg.iodepth = 1;
+        sweep_iodepth.clear();
     }
-    Fh3 root_fh = main_client.mount(cfg.export_path);
 
-    // Create per-run workdir: bench_<pid>
-    const std::string workdir_name = "bench_" + std::to_string(getpid());
-    Fh3 workdir_fh = main_client.mkdir(root_fh, workdir_name);
-
-    int rc = 0;
-    try {
-        // Phase 1: setup (pre-create test files)
-        if (wl.setup) {
-            fprintf(stderr, "Setting up workload '%s' (file size %s)...\n",
-                    cfg.workload.c_str(), human_bytes(cfg.size).c_str());
-            wl.setup(main_client, workdir_fh, cfg);
+    JsonLines json(cfg.json_path);
+    if (!sweep_threads.empty() || !sweep_iodepth.empty() || slo_ns > 0) {
+        if (compare) {
+            fprintf(stderr, "--sweep and --slo-p99 cannot be combined with --compare\n");
+            return 1;
         }
-
-        // Phase 2: run workers
-        fprintf(stderr, "Running '%s' for %u s with %u thread(s)...\n",
-                cfg.workload.c_str(), cfg.duration, cfg.threads);
-        RunResult result = run_workload(wl, cfg, cfg.server, workdir_fh);
-
-        // Phase 3: teardown (remove test files created by setup)
-        if (wl.teardown) wl.teardown(main_client, workdir_fh, cfg);
-
+        if (sweep_threads.empty()) sweep_threads = {cfg.threads};
+        if (sweep_iodepth.empty()) sweep_iodepth = {cfg.iodepth};
+        if (!warmup_set) cfg.warmup = 2;
+        return run_sweep(wl, cfg, json, sweep_threads, sweep_iodepth, slo_ns) ? 0 : 1;
+    }
+    if (!compare) {
+        RunResult result;
+        if (!run_proto(wl, cfg, json, result)) return 1;
         print_result(cfg, result);
-        if (!cfg.csv_path.empty()) write_csv(cfg.csv_path, cfg, result);
-
-    } catch (const std::exception& e) {
-        fprintf(stderr, "error: %s\n", e.what());
-        rc = 1;
+        return 0;
     }
 
-    // Always clean up the workdir
-    try {
-        rmdir_recursive(main_client, root_fh, workdir_name);
-    } catch (const std::exception& e) {
-        fprintf(stderr, "warning: workdir cleanup failed: %s\n", e.what());
+    // --compare: the same workload over each protocol in turn.
+    std::vector<std::pair<Proto, RunResult>> results;
+    int rc = 0;
+    for (Proto p : {Proto::V3, Proto::V40, Proto::V41}) {
+        cfg.proto = p;
+        RunResult result;
+        if (run_proto(wl, cfg, json, result)) {
+            print_result(cfg, result);
+            results.emplace_back(p, std::move(result));
+        } else {
+            rc = 1;
+        }
     }
-
+    print_comparison(cfg, results);
     return rc;
 }
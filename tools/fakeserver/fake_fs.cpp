@@ -0,0 +1,393 @@
+#include "fake_fs.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace fake {
+
+static constexpr uint64_t FSID     = 1;
+static constexpr size_t   NAME_MAX = 255;
+
+[[noreturn]] static void fail(Nfsstat3 s) {
+    throw NfsError(static_cast<uint32_t>(s));
+}
+
+static Nfstime3 now() {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return Nfstime3{static_cast<uint32_t>(ns / 1'000'000'000),
+                    static_cast<uint32_t>(ns % 1'000'000'000)};
+}
+
+static void check_name(const std::string& name) {
+    if (name.empty() || name.find('/') != std::string::npos)
+        fail(Nfsstat3::NFS3ERR_INVAL);
+    if (name.size() > NAME_MAX)
+        fail(Nfsstat3::NFS3ERR_NAMETOOLONG);
+    if (name == "." || name == "..")
+        fail(Nfsstat3::NFS3ERR_EXIST);
+}
+
+struct FakeFs::Node {
+    Fattr3               attr{};
+    uint64_t             change = 0;
+    uint64_t             parent = ROOT;   // directories only
+    uint64_t             verf   = 0;      // EXCLUSIVE create verifier
+    std::vector<uint8_t> data;            // NF3REG; may be shorter than attr.size
+    std::string          target;          // NF3LNK
+
+    // NF3DIR: entries in cookie order, and each name's cookie.
+    std::map<uint64_t, DirEntry>              entries;
+    std::unordered_map<std::string, uint64_t> names;
+    uint64_t                                  next_cookie = 3;  // 1, 2: "." and ".."
+
+    bool is_dir() const { return attr.type == Ftype3::NF3DIR; }
+};
+
+FakeFs::FakeFs(bool store_data) : store_data_(store_data) {
+    auto root = std::make_unique<Node>();
+    const Nfstime3 t = now();
+    root->attr.type   = Ftype3::NF3DIR;
+    root->attr.mode   = 0777;
+    root->attr.nlink  = 2;
+    root->attr.size   = 4096;
+    root->attr.used   = 4096;
+    root->attr.fsid   = FSID;
+    root->attr.fileid = ROOT;
+    root->attr.atime  = root->attr.mtime = root->attr.ctime = t;
+    root->change      = next_change_++;
+    nodes_.emplace(next_id_++, std::move(root));
+}
+
+FakeFs::~FakeFs() = default;
+
+// ── Internal helpers (mutex_ held) ───────────────────────────────────────────
+
+FakeFs::Node& FakeFs::node(uint64_t id) const {
+    const auto it = nodes_.find(id);
+    if (it == nodes_.end()) fail(Nfsstat3::NFS3ERR_STALE);
+    return *it->second;
+}
+
+FakeFs::Node& FakeFs::dir_node(uint64_t id) const {
+    Node& n = node(id);
+    if (!n.is_dir()) fail(Nfsstat3::NFS3ERR_NOTDIR);
+    return n;
+}
+
+void FakeFs::touch(Node& n, bool data) {
+    const Nfstime3 t = now();
+    n.attr.ctime = t;
+    if (data) n.attr.mtime = t;
+    n.change = next_change_++;
+}
+
+Wcc FakeFs::pre(const Node& n) {
+    Wcc w;
+    w.before        = WccAttr3{n.attr.size, n.attr.mtime, n.attr.ctime};
+    w.change_before = n.change;
+    return w;
+}
+
+void FakeFs::post(Wcc* w, const Node& n) {
+    if (w) w->after = Stat{n.attr, n.change};
+}
+
+// ── Queries ──────────────────────────────────────────────────────────────────
+
+Stat FakeFs::stat(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Node& n = node(id);
+    return Stat{n.attr, n.change};
+}
+
+bool FakeFs::exists(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nodes_.count(id) != 0;
+}
+
+uint64_t FakeFs::lookup(uint64_t dir, const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Node& d = dir_node(dir);
+    if (name == ".")  return dir;
+    if (name == "..") return d.parent;
+    const auto it = d.names.find(name);
+    if (it == d.names.end()) fail(Nfsstat3::NFS3ERR_NOENT);
+    return d.entries.at(it->second).fileid;
+}
+
+uint64_t FakeFs::parent(uint64_t dir) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dir_node(dir).parent;
+}
+
+std::string FakeFs::readlink(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Node& n = node(id);
+    if (n.attr.type != Ftype3::NF3LNK) fail(Nfsstat3::NFS3ERR_INVAL);
+    return n.target;
+}
+
+std::vector<DirEntry> FakeFs::readdir(uint64_t dir, uint64_t cookie, size_t max_entries,
+                                      bool& eof) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Node& d = dir_node(dir);
+    std::vector<DirEntry> out;
+    auto it = d.entries.upper_bound(cookie);
+    for (; it != d.entries.end() && out.size() < max_entries; ++it)
+        out.push_back(it->second);
+    eof = (it == d.entries.end());
+    return out;
+}
+
+uint32_t FakeFs::read(uint64_t id, uint64_t offset, uint32_t count,
+                      std::vector<uint8_t>& out, bool& eof) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Node& n = node(id);
+    if (n.is_dir()) fail(Nfsstat3::NFS3ERR_ISDIR);
+    if (n.attr.type != Ftype3::NF3REG) fail(Nfsstat3::NFS3ERR_INVAL);
+
+    const uint64_t size = n.attr.size;
+    const uint32_t got  = offset >= size
+        ? 0 : static_cast<uint32_t>(std::min<uint64_t>(count, size - offset));
+    eof = offset + got >= size;
+
+    // Bytes past the stored data (sparse tail, or store_data off) read as zeros.
+    const size_t at = out.size();
+    out.resize(at + got, 0);
+    if (offset < n.data.size()) {
+        const size_t avail = std::min<uint64_t>(got, n.data.size() - offset);
+        std::memcpy(out.data() + at, n.data.data() + offset, avail);
+    }
+    return got;
+}
+
+// ── Modifications ────────────────────────────────────────────────────────────
+
+uint64_t FakeFs::create(uint64_t dir, const std::string& name, const NewNode& spec,
+                        Wcc* dir_wcc) {
+    check_name(name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& d = dir_node(dir);
+
+    const auto existing = d.names.find(name);
+    if (existing != d.names.end()) {
+        const uint64_t id = d.entries.at(existing->second).fileid;
+        Node& n = node(id);
+        const bool reuse =
+            (spec.how == nfs3::CreateMode3::UNCHECKED && spec.type == Ftype3::NF3REG &&
+             n.attr.type == Ftype3::NF3REG) ||
+            (spec.how == nfs3::CreateMode3::EXCLUSIVE && n.verf == spec.verf);
+        if (!reuse) fail(Nfsstat3::NFS3ERR_EXIST);
+        if (spec.how == nfs3::CreateMode3::UNCHECKED && spec.attrs.size) {
+            n.attr.size = n.attr.used = *spec.attrs.size;
+            if (n.data.size() > n.attr.size) n.data.resize(n.attr.size);
+            touch(n, true);
+        }
+        if (dir_wcc) { *dir_wcc = pre(d); post(dir_wcc, d); }
+        return id;
+    }
+
+    if (dir_wcc) *dir_wcc = pre(d);
+
+    auto n = std::make_unique<Node>();
+    const uint64_t id = next_id_++;
+    const Nfstime3 t  = now();
+    n->attr.type   = spec.type;
+    n->attr.mode   = spec.attrs.mode.value_or(spec.type == Ftype3::NF3DIR ? 0755 : 0644);
+    n->attr.nlink  = spec.type == Ftype3::NF3DIR ? 2 : 1;
+    n->attr.uid    = spec.attrs.uid.value_or(spec.uid);
+    n->attr.gid    = spec.attrs.gid.value_or(spec.gid);
+    n->attr.rdev   = spec.rdev;
+    n->attr.fsid   = FSID;
+    n->attr.fileid = id;
+    n->attr.atime  = n->attr.mtime = n->attr.ctime = t;
+    n->change      = next_change_++;
+    n->verf        = spec.how == nfs3::CreateMode3::EXCLUSIVE ? spec.verf : 0;
+    if (spec.type == Ftype3::NF3DIR) {
+        n->parent    = dir;
+        n->attr.size = n->attr.used = 4096;
+        ++d.attr.nlink;
+    } else if (spec.type == Ftype3::NF3LNK) {
+        n->target    = spec.target;
+        n->attr.size = n->attr.used = spec.target.size();
+    } else if (spec.type == Ftype3::NF3REG && spec.attrs.size) {
+        n->attr.size = n->attr.used = *spec.attrs.size;
+    }
+    nodes_.emplace(id, std::move(n));
+
+    const uint64_t cookie = d.next_cookie++;
+    d.entries.emplace(cookie, DirEntry{cookie, name, id});
+    d.names.emplace(name, cookie);
+    touch(d, true);
+    post(dir_wcc, d);
+    return id;
+}
+
+void FakeFs::remove(uint64_t dir, const std::string& name, RemoveKind kind,
+                    Wcc* dir_wcc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& d = dir_node(dir);
+    if (name == "." || name == "..") fail(Nfsstat3::NFS3ERR_INVAL);
+    const auto it = d.names.find(name);
+    if (it == d.names.end()) fail(Nfsstat3::NFS3ERR_NOENT);
+
+    const uint64_t id = d.entries.at(it->second).fileid;
+    Node& n = node(id);
+    if (n.is_dir()) {
+        if (kind == RemoveKind::FILE) fail(Nfsstat3::NFS3ERR_ISDIR);
+        if (!n.entries.empty())      fail(Nfsstat3::NFS3ERR_NOTEMPTY);
+    } else if (kind == RemoveKind::DIR) {
+        fail(Nfsstat3::NFS3ERR_NOTDIR);
+    }
+
+    if (dir_wcc) *dir_wcc = pre(d);
+    d.entries.erase(it->second);
+    d.names.erase(it);
+    if (n.is_dir()) {
+        --d.attr.nlink;
+        nodes_.erase(id);
+    } else if (--n.attr.nlink == 0) {
+        nodes_.erase(id);
+    } else {
+        touch(n, false);
+    }
+    touch(d, true);
+    post(dir_wcc, d);
+}
+
+void FakeFs::rename(uint64_t from_dir, const std::string& from_name,
+                    uint64_t to_dir, const std::string& to_name,
+                    Wcc* from_wcc, Wcc* to_wcc) {
+    check_name(to_name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& fd = dir_node(from_dir);
+    Node& td = dir_node(to_dir);
+    const auto src = fd.names.find(from_name);
+    if (src == fd.names.end()) fail(Nfsstat3::NFS3ERR_NOENT);
+    const uint64_t id = fd.entries.at(src->second).fileid;
+    Node& n = node(id);
+
+    // A directory may not move below itself.
+    if (n.is_dir()) {
+        for (uint64_t a = to_dir; ; a = node(a).parent) {
+            if (a == id) fail(Nfsstat3::NFS3ERR_INVAL);
+            if (a == ROOT) break;
+        }
+    }
+
+    if (from_wcc) *from_wcc = pre(fd);
+    if (to_wcc)   *to_wcc   = pre(td);
+
+    const auto dst = td.names.find(to_name);
+    if (dst != td.names.end()) {
+        const uint64_t victim = td.entries.at(dst->second).fileid;
+        if (victim == id) {   // same object: nothing to do
+            post(from_wcc, fd);
+            post(to_wcc, td);
+            return;
+        }
+        Node& v = node(victim);
+        if (v.is_dir() != n.is_dir())
+            fail(v.is_dir() ? Nfsstat3::NFS3ERR_ISDIR : Nfsstat3::NFS3ERR_NOTDIR);
+        if (v.is_dir() && !v.entries.empty()) fail(Nfsstat3::NFS3ERR_NOTEMPTY);
+        td.entries.erase(dst->second);
+        td.names.erase(dst);
+        if (v.is_dir()) --td.attr.nlink;
+        if (v.is_dir() || --v.attr.nlink == 0) nodes_.erase(victim);
+    }
+
+    const DirEntry moved = fd.entries.at(src->second);
+    fd.entries.erase(src->second);
+    fd.names.erase(src);
+
+    const uint64_t cookie = td.next_cookie++;
+    td.entries.emplace(cookie, DirEntry{cookie, to_name, moved.fileid});
+    td.names.emplace(to_name, cookie);
+    if (n.is_dir() && from_dir != to_dir) {
+        n.parent = to_dir;
+        --fd.attr.nlink;
+        ++td.attr.nlink;
+    }
+
+    touch(n, false);
+    touch(fd, true);
+    if (&td != &fd) touch(td, true);
+    post(from_wcc, fd);
+    post(to_wcc, td);
+}
+
+void FakeFs::link(uint64_t file, uint64_t dir, const std::string& name, Wcc* dir_wcc) {
+    check_name(name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& n = node(file);
+    Node& d = dir_node(dir);
+    if (n.is_dir()) fail(Nfsstat3::NFS3ERR_ISDIR);
+    if (d.names.count(name)) fail(Nfsstat3::NFS3ERR_EXIST);
+
+    if (dir_wcc) *dir_wcc = pre(d);
+    const uint64_t cookie = d.next_cookie++;
+    d.entries.emplace(cookie, DirEntry{cookie, name, file});
+    d.names.emplace(name, cookie);
+    ++n.attr.nlink;
+    touch(n, false);
+    touch(d, true);
+    post(dir_wcc, d);
+}
+
+Wcc FakeFs::setattr(uint64_t id, const SetAttrs& a) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& n = node(id);
+    if (a.size && n.is_dir()) fail(Nfsstat3::NFS3ERR_ISDIR);
+
+    Wcc w = pre(n);
+    if (a.mode) n.attr.mode = *a.mode & 07777;
+    if (a.uid)  n.attr.uid  = *a.uid;
+    if (a.gid)  n.attr.gid  = *a.gid;
+    if (a.size) {
+        n.attr.size = n.attr.used = *a.size;
+        if (n.data.size() > n.attr.size) n.data.resize(n.attr.size);
+    }
+    touch(n, a.size.has_value());
+    if (a.set_atime == SetTimeHow::SET_TO_CLIENT_TIME)      n.attr.atime = a.atime;
+    else if (a.set_atime == SetTimeHow::SET_TO_SERVER_TIME) n.attr.atime = n.attr.ctime;
+    if (a.set_mtime == SetTimeHow::SET_TO_CLIENT_TIME)      n.attr.mtime = a.mtime;
+    else if (a.set_mtime == SetTimeHow::SET_TO_SERVER_TIME) n.attr.mtime = n.attr.ctime;
+    post(&w, n);
+    return w;
+}
+
+uint32_t FakeFs::write(uint64_t id, uint64_t offset, const uint8_t* data, uint32_t len,
+                       Wcc* wcc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& n = node(id);
+    if (n.is_dir()) fail(Nfsstat3::NFS3ERR_ISDIR);
+    if (n.attr.type != Ftype3::NF3REG) fail(Nfsstat3::NFS3ERR_INVAL);
+
+    if (wcc) *wcc = pre(n);
+    const uint64_t end = offset + len;
+    if (store_data_ && len > 0) {
+        if (n.data.size() < end) n.data.resize(end, 0);
+        std::memcpy(n.data.data() + offset, data, len);
+    }
+    if (end > n.attr.size) n.attr.size = n.attr.used = end;
+    touch(n, true);
+    post(wcc, n);
+    return len;
+}
+
+// ── File handles ─────────────────────────────────────────────────────────────
+
+std::vector<uint8_t> make_handle(uint64_t fileid) {
+    std::vector<uint8_t> fh(8);
+    xdr_store_be64(fh.data(), fileid);
+    return fh;
+}
+
+uint64_t handle_fileid(const uint8_t* data, size_t size) {
+    if (size != 8) fail(Nfsstat3::NFS3ERR_BADHANDLE);
+    return xdr_load_be64(data);
+}
+
+}  // namespace fake
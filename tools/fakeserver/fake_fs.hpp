@@ -0,0 +1,153 @@
+#pragma once
+
+#include "nfs/create.hpp"
+#include "nfs/nfs3_types.hpp"
+#include "nfs/nfs_error.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fake {
+
+// Attributes of one object plus its NFSv4 change attribute, which moves
+// forward on every modification of the object.
+struct Stat {
+    Fattr3   attr{};
+    uint64_t change{};
+};
+
+// Attributes around a modification: the wcc_attr subset and change attribute
+// from before, and the full attributes after.  Carries both NFSv3 wcc_data
+// and NFSv4 change_info4.
+struct Wcc {
+    WccAttr3 before{};
+    uint64_t change_before{};
+    Stat     after;
+};
+
+// Attributes to apply in CREATE / SETATTR; unset fields are left alone.
+struct SetAttrs {
+    std::optional<uint32_t> mode;
+    std::optional<uint32_t> uid;
+    std::optional<uint32_t> gid;
+    std::optional<uint64_t> size;
+    SetTimeHow set_atime = SetTimeHow::DONT_CHANGE;
+    SetTimeHow set_mtime = SetTimeHow::DONT_CHANGE;
+    Nfstime3   atime{};   // used with SET_TO_CLIENT_TIME
+    Nfstime3   mtime{};
+};
+
+// A new object for FakeFs::create().
+struct NewNode {
+    Ftype3            type = Ftype3::NF3REG;
+    SetAttrs          attrs;
+    uint32_t          uid  = 0;        // owner, from the caller's credentials
+    uint32_t          gid  = 0;
+    nfs3::CreateMode3 how  = nfs3::CreateMode3::GUARDED;
+    uint64_t          verf = 0;        // EXCLUSIVE create verifier
+    std::string       target;          // NF3LNK
+    Specdata3         rdev{};          // NF3CHR / NF3BLK
+};
+
+// One directory entry; cookies are stable for the lifetime of the entry.
+struct DirEntry {
+    uint64_t    cookie;
+    std::string name;
+    uint64_t    fileid;
+};
+
+// What FakeFs::remove() accepts.
+enum class RemoveKind { FILE, DIR, ANY };
+
+// In-memory filesystem behind FakeServer, shared by its NFSv3 and NFSv4
+// front ends.  Objects are named by fileid; the file handle is the fileid in
+// 8 big-endian bytes on both protocols.
+//
+// Failures throw NfsError carrying an nfsstat3 code.  The codes FakeFs uses
+// have the same value in nfsstat4, so the NFSv4 front end passes them through.
+//
+// Thread safety: every member may be called concurrently; one mutex
+// serialises them.
+class FakeFs {
+public:
+    // store_data = false keeps only file sizes: WRITE data is dropped and READ
+    // returns zeros, so multi-gigabyte benchmark files cost no memory.
+    explicit FakeFs(bool store_data = true);
+    ~FakeFs();
+
+    FakeFs(const FakeFs&) = delete;
+    FakeFs& operator=(const FakeFs&) = delete;
+
+    static constexpr uint64_t ROOT = 1;
+
+    // Attributes of `id`; throws NFS3ERR_STALE if it does not exist.
+    Stat stat(uint64_t id) const;
+    bool exists(uint64_t id) const;
+
+    // Resolve `name` in `dir` ("." and ".." included).
+    uint64_t lookup(uint64_t dir, const std::string& name) const;
+
+    // Parent directory of `dir`; the root is its own parent.
+    uint64_t parent(uint64_t dir) const;
+
+    // Create `name` in `dir`.  Under UNCHECKED an existing regular file is
+    // returned (with attrs.size applied); under EXCLUSIVE one whose create
+    // verifier matches is.  Otherwise an existing name fails with
+    // NFS3ERR_EXIST.  `dir_wcc` (if given) receives the directory's change.
+    uint64_t create(uint64_t dir, const std::string& name, const NewNode& node,
+                    Wcc* dir_wcc = nullptr);
+
+    void remove(uint64_t dir, const std::string& name, RemoveKind kind,
+                Wcc* dir_wcc = nullptr);
+
+    void rename(uint64_t from_dir, const std::string& from_name,
+                uint64_t to_dir, const std::string& to_name,
+                Wcc* from_wcc = nullptr, Wcc* to_wcc = nullptr);
+
+    void link(uint64_t file, uint64_t dir, const std::string& name,
+              Wcc* dir_wcc = nullptr);
+
+    Wcc setattr(uint64_t id, const SetAttrs& attrs);
+
+    // Append up to `count` bytes at `offset` to `out`; returns the number
+    // appended and sets `eof` when the read reaches the end of the file.
+    uint32_t read(uint64_t id, uint64_t offset, uint32_t count,
+                  std::vector<uint8_t>& out, bool& eof) const;
+
+    uint32_t write(uint64_t id, uint64_t offset, const uint8_t* data, uint32_t len,
+                   Wcc* wcc = nullptr);
+
+    std::string readlink(uint64_t id) const;
+
+    // Entries of `dir` after `cookie` (0 = from the start), at most
+    // `max_entries`; "." and ".." are not included.
+    std::vector<DirEntry> readdir(uint64_t dir, uint64_t cookie, size_t max_entries,
+                                  bool& eof) const;
+
+private:
+    struct Node;
+
+    Node& node(uint64_t id) const;           // throws NFS3ERR_STALE
+    Node& dir_node(uint64_t id) const;       // also NFS3ERR_NOTDIR
+    void  touch(Node& n, bool data);         // bump ctime/change (and mtime)
+    static Wcc pre(const Node& n);
+    static void post(Wcc* w, const Node& n);
+
+    const bool                                         store_data_;
+    mutable std::mutex                                 mutex_;
+    std::unordered_map<uint64_t, std::unique_ptr<Node>> nodes_;
+    uint64_t                                           next_id_     = ROOT;
+    uint64_t                                           next_change_ = 1;
+};
+
+// File handle bytes for `fileid`, and back (NFS3ERR_BADHANDLE if malformed).
+std::vector<uint8_t> make_handle(uint64_t fileid);
+uint64_t             handle_fileid(const uint8_t* data, size_t size);
+
+}  // namespace fake
@@ -0,0 +1,499 @@
+#include "fake_state.hpp"
+
+#include "nfs/fsinfo.hpp"
+
+#include <algorithm>
+
+// NFSv3 program (RFC 1813) over FakeFs.
+
+namespace fake {
+
+static constexpr uint32_t NFS3_OK = 0;
+
+enum Nfs3Proc : uint32_t {
+    NULLPROC = 0, GETATTR, SETATTR, LOOKUP, ACCESS, READLINK, READ, WRITE, CREATE,
+    MKDIR, SYMLINK, MKNOD, REMOVE, RMDIR, RENAME, LINK, READDIR, READDIRPLUS,
+    FSSTAT, FSINFO, PATHCONF, COMMIT,
+};
+
+// Fixed sizes used to fit READDIR / READDIRPLUS replies into the client's count.
+static constexpr size_t READDIR_HEAD  = 4 + 4 + xdr_wire_size<Fattr3> + 8;  // status, dir attrs, verf
+static constexpr size_t READDIR_TAIL  = 4 + 4;                             // list end, eof
+static constexpr size_t ENTRY_PLUS    = 4 + xdr_wire_size<Fattr3> + 4 + 4 + 8;  // attrs + fh
+
+// ── XDR helpers ──────────────────────────────────────────────────────────────
+
+static uint64_t fileid_of(const XdrSegment& fh) {
+    return handle_fileid(fh.data, fh.size);
+}
+
+static void put_fh(XdrEncoder& res, uint64_t id) {
+    res.put_opaque(make_handle(id));
+}
+
+static void put_post_op_attr(XdrEncoder& res, const Stat& st) {
+    res.put_uint32(1);
+    xdr_encode(res, st.attr);
+}
+
+// post_op_attr of `id`, or "no attributes" if it has gone.
+static void put_post_op_attr(XdrEncoder& res, const FakeFs& fs, uint64_t id) {
+    if (!fs.exists(id)) {
+        res.put_uint32(0);
+        return;
+    }
+    try {
+        put_post_op_attr(res, fs.stat(id));
+    } catch (const NfsError&) {
+        res.put_uint32(0);
+    }
+}
+
+static void put_wcc(XdrEncoder& res, const Wcc& w) {
+    res.put_uint32(1);
+    xdr_encode(res, w.before);
+    put_post_op_attr(res, w.after);
+}
+
+// wcc_data for a failed call: no pre-op attributes, current post-op ones.
+static void put_wcc_after(XdrEncoder& res, const FakeFs& fs, uint64_t id) {
+    res.put_uint32(0);
+    put_post_op_attr(res, fs, id);
+}
+
+static SetAttrs decode_sattr3(XdrDecoder& args) {
+    SetAttrs a;
+    if (args.get_uint32()) a.mode = args.get_uint32();
+    if (args.get_uint32()) a.uid  = args.get_uint32();
+    if (args.get_uint32()) a.gid  = args.get_uint32();
+    if (args.get_uint32()) a.size = args.get_uint64();
+    a.set_atime = static_cast<SetTimeHow>(args.get_uint32());
+    if (a.set_atime == SetTimeHow::SET_TO_CLIENT_TIME) a.atime = xdr_decode<Nfstime3>(args);
+    a.set_mtime = static_cast<SetTimeHow>(args.get_uint32());
+    if (a.set_mtime == SetTimeHow::SET_TO_CLIENT_TIME) a.mtime = xdr_decode<Nfstime3>(args);
+    return a;
+}
+
+// CREATE / MKDIR / SYMLINK / MKNOD: create, then encode the shared result.
+static void create_common(ServerState& s, const XdrSegment& dir_fh,
+                          const std::string& name, const NewNode& node, XdrEncoder& res) {
+    uint64_t dir = 0;
+    try {
+        dir = fileid_of(dir_fh);
+        Wcc wcc;
+        const uint64_t id = s.fs.create(dir, name, node, &wcc);
+        res.put_uint32(NFS3_OK);
+        res.put_uint32(1);          // post_op_fh3
+        put_fh(res, id);
+        put_post_op_attr(res, s.fs, id);
+        put_wcc(res, wcc);
+    } catch (const NfsError& e) {
+        res.put_uint32(e.status);
+        put_wcc_after(res, s.fs, dir);
+    }
+}
+
+// ── Procedures ───────────────────────────────────────────────────────────────
+
+static void proc_readdir(ServerState& s, XdrDecoder& args, XdrEncoder& res, bool plus) {
+    const XdrSegment fh   = args.get_opaque_view();
+    const uint64_t cookie = args.get_uint64();
+    args.skip(8);                                    // cookieverf
+    const uint32_t dircount = args.get_uint32();
+    const uint32_t maxcount = plus ? args.get_uint32() : dircount;
+
+    uint64_t dir = 0;
+    try {
+        dir = fileid_of(fh);
+        const Stat dst = s.fs.stat(dir);
+        if (dst.attr.type != Ftype3::NF3DIR) throw NfsError(
+            static_cast<uint32_t>(Nfsstat3::NFS3ERR_NOTDIR));
+
+        // "." and ".." come first (cookies 1 and 2), then the real entries.
+        std::vector<DirEntry> list;
+        if (cookie < 1) list.push_back(DirEntry{1, ".", dir});
+        if (cookie < 2) list.push_back(DirEntry{2, "..", s.fs.parent(dir)});
+        bool fs_eof = false;
+        const auto rest = s.fs.readdir(dir, std::max<uint64_t>(cookie, 2),
+                                       maxcount / 24 + 1, fs_eof);
+        list.insert(list.end(), rest.begin(), rest.end());
+
+        size_t total = READDIR_HEAD + READDIR_TAIL, names = 0, n = 0;
+        for (; n < list.size(); ++n) {
+            const size_t name = 8 + xdr_opaque_size(list[n].name.size()) + 8;
+            const size_t entry = 4 + name + (plus ? ENTRY_PLUS : 0);
+            if (total + entry > maxcount || names + name > dircount) break;
+            total += entry;
+            names += name;
+        }
+        if (n == 0 && !list.empty())
+            throw NfsError(static_cast<uint32_t>(Nfsstat3::NFS3ERR_TOOSMALL));
+
+        res.put_uint32(NFS3_OK);
+        put_post_op_attr(res, dst);
+        res.put_uint64(0);                           // cookieverf
+        for (size_t i = 0; i < n; ++i) {
+            const DirEntry& e = list[i];
+            res.put_uint32(1);
+            res.put_uint64(e.fileid);
+            res.put_string(e.name);
+            res.put_uint64(e.cookie);
+            if (plus) {
+                put_post_op_attr(res, s.fs, e.fileid);
+                res.put_uint32(1);
+                put_fh(res, e.fileid);
+            }
+        }
+        res.put_uint32(0);
+        res.put_uint32(n == list.size() && fs_eof ? 1 : 0);
+    } catch (const NfsError& e) {
+        res.put_uint32(e.status);
+        put_post_op_attr(res, s.fs, dir);
+    }
+}
+
+bool nfs3_call(ServerState& s, uint32_t proc, const Caller& who,
+               XdrDecoder& args, XdrEncoder& res) {
+    if (proc > COMMIT) return false;
+    ++s.nfs3_calls[proc];
+    FakeFs& fs = s.fs;
+
+    switch (proc) {
+    case NULLPROC:
+        return true;
+
+    case GETATTR: {
+        const XdrSegment fh = args.get_opaque_view();
+        try {
+            const Stat st = fs.stat(fileid_of(fh));
+            res.put_uint32(NFS3_OK);
+            xdr_encode(res, st.attr);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+        }
+        return true;
+    }
+
+    case SETATTR: {
+        const XdrSegment fh = args.get_opaque_view();
+        const SetAttrs   a  = decode_sattr3(args);
+        const bool guard = args.get_uint32() != 0;
+        const Nfstime3 ctime = guard ? xdr_decode<Nfstime3>(args) : Nfstime3{};
+        uint64_t id = 0;
+        try {
+            id = fileid_of(fh);
+            if (guard) {
+                const Nfstime3 now = fs.stat(id).attr.ctime;
+                if (now.seconds != ctime.seconds || now.nseconds != ctime.nseconds)
+                    throw NfsError(static_cast<uint32_t>(Nfsstat3::NFS3ERR_NOT_SYNC));
+            }
+            const Wcc wcc = fs.setattr(id, a);
+            res.put_uint32(NFS3_OK);
+            put_wcc(res, wcc);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_wcc_after(res, fs, id);
+        }
+        return true;
+    }
+
+    case LOOKUP: {
+        const XdrSegment  fh   = args.get_opaque_view();
+        const std::string name = args.get_string();
+        uint64_t dir = 0;
+        try {
+            dir = fileid_of(fh);
+            const uint64_t id = fs.lookup(dir, name);
+            res.put_uint32(NFS3_OK);
+            put_fh(res, id);
+            put_post_op_attr(res, fs, id);
+            put_post_op_attr(res, fs, dir);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_post_op_attr(res, fs, dir);
+        }
+        return true;
+    }
+
+    case ACCESS: {
+        const XdrSegment fh   = args.get_opaque_view();
+        const uint32_t   mask = args.get_uint32();
+        try {
+            const Stat st = fs.stat(fileid_of(fh));
+            res.put_uint32(NFS3_OK);
+            put_post_op_attr(res, st);
+            res.put_uint32(mask & 0x3f);    // everything is granted
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            res.put_uint32(0);
+        }
+        return true;
+    }
+
+    case READLINK: {
+        const XdrSegment fh = args.get_opaque_view();
+        uint64_t id = 0;
+        try {
+            id = fileid_of(fh);
+            const std::string target = fs.readlink(id);
+            res.put_uint32(NFS3_OK);
+            put_post_op_attr(res, fs, id);
+            res.put_string(target);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_post_op_attr(res, fs, id);
+        }
+        return true;
+    }
+
+    case READ: {
+        const XdrSegment fh     = args.get_opaque_view();
+        const uint64_t   offset = args.get_uint64();
+        const uint32_t   count  = std::min(args.get_uint32(), read_limit(s.opts));
+        uint64_t id = 0;
+        try {
+            id = fileid_of(fh);
+            std::vector<uint8_t> data;
+            bool eof = false;
+            const uint32_t got = fs.read(id, offset, count, data, eof);
+            res.put_uint32(NFS3_OK);
+            put_post_op_attr(res, fs, id);
+            res.put_uint32(got);
+            res.put_uint32(eof ? 1 : 0);
+            res.put_opaque(data);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_post_op_attr(res, fs, id);
+        }
+        return true;
+    }
+
+    case WRITE: {
+        const XdrSegment fh     = args.get_opaque_view();
+        const uint64_t   offset = args.get_uint64();
+        args.get_uint32();                           // count (the opaque says it too)
+        const uint32_t   stable = args.get_uint32();
+        const XdrSegment data   = args.get_opaque_view();
+        uint64_t id = 0;
+        try {
+            id = fileid_of(fh);
+            if (data.size > s.opts.max_io_size)
+                throw NfsError(static_cast<uint32_t>(Nfsstat3::NFS3ERR_INVAL));
+            Wcc wcc;
+            const uint32_t n = fs.write(id, offset, data.data,
+                                        static_cast<uint32_t>(data.size), &wcc);
+            res.put_uint32(NFS3_OK);
+            put_wcc(res, wcc);
+            res.put_uint32(n);
+            res.put_uint32(stable == 0 ? 0 : 2);     // UNSTABLE, else FILE_SYNC
+            res.put_fixed_opaque(s.write_verf.data(), 8);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_wcc_after(res, fs, id);
+        }
+        return true;
+    }
+
+    case CREATE: {
+        const XdrSegment  fh   = args.get_opaque_view();
+        const std::string name = args.get_string();
+        NewNode node;
+        node.uid = who.uid;
+        node.gid = who.gid;
+        node.how = static_cast<nfs3::CreateMode3>(args.get_uint32());
+        if (node.how == nfs3::CreateMode3::EXCLUSIVE) {
+            node.verf = xdr_load_be64(args.get_fixed_opaque_view(8).data);
+        } else {
+            node.attrs = decode_sattr3(args);
+        }
+        create_common(s, fh, name, node, res);
+        return true;
+    }
+
+    case MKDIR: {
+        const XdrSegment  fh   = args.get_opaque_view();
+        const std::string name = args.get_string();
+        NewNode node;
+        node.type  = Ftype3::NF3DIR;
+        node.uid   = who.uid;
+        node.gid   = who.gid;
+        node.attrs = decode_sattr3(args);
+        create_common(s, fh, name, node, res);
+        return true;
+    }
+
+    case SYMLINK: {
+        const XdrSegment  fh   = args.get_opaque_view();
+        const std::string name = args.get_string();
+        NewNode node;
+        node.type   = Ftype3::NF3LNK;
+        node.uid    = who.uid;
+        node.gid    = who.gid;
+        node.attrs  = decode_sattr3(args);
+        node.target = args.get_string();
+        create_common(s, fh, name, node, res);
+        return true;
+    }
+
+    case MKNOD: {
+        const XdrSegment  fh   = args.get_opaque_view();
+        const std::string name = args.get_string();
+        NewNode node;
+        node.type = static_cast<Ftype3>(args.get_uint32());
+        node.uid  = who.uid;
+        node.gid  = who.gid;
+        switch (node.type) {
+        case Ftype3::NF3CHR:
+        case Ftype3::NF3BLK:
+            node.attrs = decode_sattr3(args);
+            node.rdev  = xdr_decode<Specdata3>(args);
+            break;
+        case Ftype3::NF3SOCK:
+        case Ftype3::NF3FIFO:
+            node.attrs = decode_sattr3(args);
+            break;
+        default:
+            res.put_uint32(static_cast<uint32_t>(Nfsstat3::NFS3ERR_BADTYPE));
+            res.put_uint32(0);
+            res.put_uint32(0);
+            return true;
+        }
+        create_common(s, fh, name, node, res);
+        return true;
+    }
+
+    case REMOVE:
+    case RMDIR: {
+        const XdrSegment  fh   = args.get_opaque_view();
+        const std::string name = args.get_string();
+        uint64_t dir = 0;
+        try {
+            dir = fileid_of(fh);
+            Wcc wcc;
+            fs.remove(dir, name, proc == RMDIR ? RemoveKind::DIR : RemoveKind::FILE, &wcc);
+            res.put_uint32(NFS3_OK);
+            put_wcc(res, wcc);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_wcc_after(res, fs, dir);
+        }
+        return true;
+    }
+
+    case RENAME: {
+        const XdrSegment  from_fh   = args.get_opaque_view();
+        const std::string from_name = args.get_string();
+        const XdrSegment  to_fh     = args.get_opaque_view();
+        const std::string to_name   = args.get_string();
+        uint64_t from = 0, to = 0;
+        try {
+            from = fileid_of(from_fh);
+            to   = fileid_of(to_fh);
+            Wcc from_wcc, to_wcc;
+            fs.rename(from, from_name, to, to_name, &from_wcc, &to_wcc);
+            res.put_uint32(NFS3_OK);
+            put_wcc(res, from_wcc);
+            put_wcc(res, to_wcc);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_wcc_after(res, fs, from);
+            put_wcc_after(res, fs, to);
+        }
+        return true;
+    }
+
+    case LINK: {
+        const XdrSegment  file_fh = args.get_opaque_view();
+        const XdrSegment  dir_fh  = args.get_opaque_view();
+        const std::string name    = args.get_string();
+        uint64_t file = 0, dir = 0;
+        try {
+            file = fileid_of(file_fh);
+            dir  = fileid_of(dir_fh);
+            Wcc wcc;
+            fs.link(file, dir, name, &wcc);
+            res.put_uint32(NFS3_OK);
+            put_post_op_attr(res, fs, file);
+            put_wcc(res, wcc);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_post_op_attr(res, fs, file);
+            put_wcc_after(res, fs, dir);
+        }
+        return true;
+    }
+
+    case READDIR:
+    case READDIRPLUS:
+        proc_readdir(s, args, res, proc == READDIRPLUS);
+        return true;
+
+    case FSSTAT:
+    case FSINFO:
+    case PATHCONF: {
+        const XdrSegment fh = args.get_opaque_view();
+        try {
+            const Stat st = fs.stat(fileid_of(fh));
+            res.put_uint32(NFS3_OK);
+            put_post_op_attr(res, st);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            res.put_uint32(0);
+            return true;
+        }
+        if (proc == FSSTAT) {
+            const uint64_t tbytes = 1ull << 40, tfiles = 1ull << 24;
+            res.put_uint64(tbytes);
+            res.put_uint64(tbytes);
+            res.put_uint64(tbytes);
+            res.put_uint64(tfiles);
+            res.put_uint64(tfiles);
+            res.put_uint64(tfiles);
+            res.put_uint32(0);                       // invarsec
+        } else if (proc == FSINFO) {
+            res.put_uint32(s.opts.max_io_size);      // rtmax, rtpref, rtmult
+            res.put_uint32(s.opts.max_io_size);
+            res.put_uint32(4096);
+            res.put_uint32(s.opts.max_io_size);      // wtmax, wtpref, wtmult
+            res.put_uint32(s.opts.max_io_size);
+            res.put_uint32(4096);
+            res.put_uint32(32768);                   // dtpref
+            res.put_uint64(~0ull >> 1);              // maxfilesize
+            res.put_uint32(0);                       // time_delta: 1 ns
+            res.put_uint32(1);
+            res.put_uint32(nfs3::FSF_LINK | nfs3::FSF_SYMLINK |
+                           nfs3::FSF_HOMOGENEOUS | nfs3::FSF_CANSETTIME);
+        } else {
+            res.put_uint32(32000);                   // linkmax
+            res.put_uint32(255);                     // name_max
+            res.put_uint32(1);                       // no_trunc
+            res.put_uint32(1);                       // chown_restricted
+            res.put_uint32(0);                       // case_insensitive
+            res.put_uint32(1);                       // case_preserving
+        }
+        return true;
+    }
+
+    case COMMIT: {
+        const XdrSegment fh = args.get_opaque_view();
+        args.get_uint64();                           // offset
+        args.get_uint32();                           // count
+        uint64_t id = 0;
+        try {
+            id = fileid_of(fh);
+            const Stat st = fs.stat(id);
+            res.put_uint32(NFS3_OK);
+            put_wcc(res, Wcc{WccAttr3{st.attr.size, st.attr.mtime, st.attr.ctime},
+                             st.change, st});
+            res.put_fixed_opaque(s.write_verf.data(), 8);
+        } catch (const NfsError& e) {
+            res.put_uint32(e.status);
+            put_wcc_after(res, fs, id);
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+}  // namespace fake
@@ -0,0 +1,837 @@
+#include "fake_state.hpp"
+
+#include "nfs4/compound.hpp"
+#include "nfs4/nfs4_attr.hpp"
+#include "nfs4/nfs4_error.hpp"
+#include "nfs4/open.hpp"
+#include "nfs4/session41.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// NFSv4.0 (RFC 7530) and NFSv4.1 (RFC 8881) COMPOUND over FakeFs.
+
+namespace fake {
+
+using namespace nfs4;
+
+static constexpr uint32_t NFS4_OK = 0;
+static constexpr uint32_t OP_RELEASE_LOCKOWNER = 39;
+static constexpr uint32_t OP_ILLEGAL           = 10044;
+
+// NFSv4.1 status codes the client has no use for.
+static constexpr uint32_t NFS4ERR_SEQUENCE_POS       = 10064;
+static constexpr uint32_t NFS4ERR_RETRY_UNCACHED_REP = 10068;
+static constexpr uint32_t NFS4ERR_OP_NOT_IN_SESSION  = 10071;
+
+static constexpr uint32_t EXCHGID4_FLAG_USE_NON_PNFS = 0x00010000;
+static constexpr uint32_t EXCLUSIVE4_1 = 3;
+static constexpr uint32_t CLAIM_FH     = 4;
+
+static const char SERVER_OWNER[] = "fakeserver";
+
+[[noreturn]] static void fail(Nfsstat4 s) {
+    throw Nfs4Error(static_cast<uint32_t>(s));
+}
+
+// Per-COMPOUND evaluation state.  File handles are fileids; 0 = none.
+struct Compound {
+    ServerState&  s;
+    const Caller& who;
+    uint32_t      minor;
+    uint64_t      cfh = 0;
+    uint64_t      sfh = 0;
+
+    uint64_t current() const {
+        if (cfh == 0) fail(Nfsstat4::NFS4ERR_NOFILEHANDLE);
+        return cfh;
+    }
+};
+
+// ── fattr4 ───────────────────────────────────────────────────────────────────
+
+// Attributes GETATTR and READDIR can return, in ascending ID order.
+static constexpr uint32_t SUPPORTED_ATTRS = 0;
+static constexpr uint32_t READABLE[] = {
+    SUPPORTED_ATTRS, attr::TYPE, attr::CHANGE, attr::SIZE, attr::FSID, attr::FILEID,
+    attr::MAXREAD, attr::MAXWRITE, attr::MODE, attr::NUMLINKS, attr::OWNER, attr::OWNER_GROUP, attr::SPACE_USED,
+    attr::TIME_ACCESS, attr::TIME_METADATA, attr::TIME_MODIFY, attr::MOUNTED_ON_FILEID,
+};
+
+static void put_nfstime(XdrEncoder& res, const Nfstime3& t) {
+    xdr_encode(res, Nfstime4{t.seconds, t.nseconds});
+}
+
+static void encode_fattr(XdrEncoder& res, const std::vector<uint32_t>& want, const Stat& st,
+                         uint32_t max_io) {
+    std::vector<uint32_t> have;
+    for (uint32_t id : READABLE)
+        if (bitmap4_test(want, id)) bitmap4_set(have, id);
+    encode_bitmap4(res, have);
+
+    const Fattr3& a = st.attr;
+    const size_t len_at = res.mark();
+    res.put_uint32(0);
+    for (uint32_t id : READABLE) {
+        if (!bitmap4_test(have, id)) continue;
+        switch (id) {
+        case SUPPORTED_ATTRS: {
+            std::vector<uint32_t> all;
+            for (uint32_t r : READABLE) bitmap4_set(all, r);
+            bitmap4_set(all, attr::TIME_ACCESS_SET);
+            bitmap4_set(all, attr::TIME_MODIFY_SET);
+            encode_bitmap4(res, all);
+            break;
+        }
+        case attr::TYPE:        res.put_uint32(static_cast<uint32_t>(a.type)); break;
+        case attr::CHANGE:      res.put_uint64(st.change); break;
+        case attr::SIZE:        res.put_uint64(a.size); break;
+        case attr::FSID:        res.put_uint64(a.fsid); res.put_uint64(0); break;
+        case attr::FILEID:      res.put_uint64(a.fileid); break;
+        case attr::MAXREAD:
+        case attr::MAXWRITE:    res.put_uint64(max_io); break;
+        case attr::MODE:        res.put_uint32(a.mode & 07777); break;
+        case attr::NUMLINKS:    res.put_uint32(a.nlink); break;
+        case attr::OWNER:       res.put_string(std::to_string(a.uid)); break;
+        case attr::OWNER_GROUP: res.put_string(std::to_string(a.gid)); break;
+        case attr::SPACE_USED:  res.put_uint64(a.used); break;
+        case attr::TIME_ACCESS:   put_nfstime(res, a.atime); break;
+        case attr::TIME_METADATA: put_nfstime(res, a.ctime); break;
+        case attr::TIME_MODIFY:   put_nfstime(res, a.mtime); break;
+        case attr::MOUNTED_ON_FILEID: res.put_uint64(a.fileid); break;
+        }
+    }
+    res.patch_uint32(len_at, static_cast<uint32_t>(res.mark() - len_at - 4));
+}
+
+// Owners are numeric ids on the wire ("1000"); anything else is refused.
+static uint32_t parse_id(const std::string& s) {
+    char* end = nullptr;
+    const unsigned long v = std::strtoul(s.c_str(), &end, 10);
+    if (s.empty() || *end != '\0' || v > UINT32_MAX) fail(Nfsstat4::NFS4ERR_BADOWNER);
+    return static_cast<uint32_t>(v);
+}
+
+static void decode_settime(XdrDecoder& ad, SetTimeHow& how, Nfstime3& t) {
+    if (ad.get_uint32() == 1) {                     // SET_TO_CLIENT_TIME4
+        const Nfstime4 v = xdr_decode<Nfstime4>(ad);
+        how = SetTimeHow::SET_TO_CLIENT_TIME;
+        t   = Nfstime3{static_cast<uint32_t>(v.seconds), v.nseconds};
+    } else {
+        how = SetTimeHow::SET_TO_SERVER_TIME;
+    }
+}
+
+// Settable fattr4 (SETATTR, CREATE, OPEN); `set` receives its bitmap.
+static SetAttrs decode_sattr(XdrDecoder& args, std::vector<uint32_t>& set) {
+    set = decode_bitmap4(args);
+    const XdrSegment list = args.get_opaque_view();
+    XdrDecoder ad(list.data, list.size);
+
+    static constexpr uint32_t SETTABLE[] = {
+        attr::SIZE, attr::MODE, attr::OWNER, attr::OWNER_GROUP,
+        attr::TIME_ACCESS_SET, attr::TIME_MODIFY_SET,
+    };
+    std::vector<uint32_t> known;
+    for (uint32_t id : SETTABLE) bitmap4_set(known, id);
+    for (size_t w = 0; w < set.size(); ++w)
+        if (set[w] & ~(w < known.size() ? known[w] : 0)) fail(Nfsstat4::NFS4ERR_ATTRNOTSUPP);
+
+    SetAttrs a;
+    if (bitmap4_test(set, attr::SIZE))        a.size = ad.get_uint64();
+    if (bitmap4_test(set, attr::MODE))        a.mode = ad.get_uint32() & 07777;
+    if (bitmap4_test(set, attr::OWNER))       a.uid  = parse_id(ad.get_string());
+    if (bitmap4_test(set, attr::OWNER_GROUP)) a.gid  = parse_id(ad.get_string());
+    if (bitmap4_test(set, attr::TIME_ACCESS_SET)) decode_settime(ad, a.set_atime, a.atime);
+    if (bitmap4_test(set, attr::TIME_MODIFY_SET)) decode_settime(ad, a.set_mtime, a.mtime);
+    return a;
+}
+
+static void put_change_info(XdrEncoder& res, uint64_t before, uint64_t after) {
+    res.put_uint32(1);                              // atomic: one lock covers it
+    res.put_uint64(before);
+    res.put_uint64(after);
+}
+
+static void put_change_info(XdrEncoder& res, const Wcc& w) {
+    put_change_info(res, w.change_before, w.after.change);
+}
+
+static uint64_t fileid_of(const XdrSegment& fh) {
+    return handle_fileid(fh.data, fh.size);
+}
+
+static Stateid4 new_stateid(ServerState& s) {
+    Stateid4 sid;
+    sid.seqid = 1;
+    uint32_t n;
+    {
+        std::lock_guard<std::mutex> lk(s.v4.mutex);
+        n = s.v4.next_stateid++;
+    }
+    xdr_store_be32(sid.other.data(), n);
+    return sid;
+}
+
+// ── Operations ───────────────────────────────────────────────────────────────
+//
+// Each decodes its arguments and does all of its work before encoding the
+// result body, so a failure (thrown as Nfs4Error or NfsError) leaves nothing
+// behind but the status.
+
+static void op_open(Compound& c, XdrDecoder& args, XdrEncoder& res) {
+    ServerState& s = c.s;
+    args.get_uint32();                              // seqid: not checked
+    args.get_uint32();                              // share_access
+    args.get_uint32();                              // share_deny
+    Nfs4Registry::OpenOwner owner;
+    owner.first = args.get_uint64();
+    owner.second = args.get_opaque();
+
+    const bool create = args.get_uint32() != 0;
+    NewNode node;
+    node.uid = c.who.uid;
+    node.gid = c.who.gid;
+    std::vector<uint32_t> attrsset;
+    if (create) {
+        const uint32_t mode = args.get_uint32();
+        if (mode == EXCLUSIVE4 || mode == EXCLUSIVE4_1) {
+            node.how  = nfs3::CreateMode3::EXCLUSIVE;
+            node.verf = xdr_load_be64(args.get_fixed_opaque_view(8).data);
+            if (mode == EXCLUSIVE4_1) node.attrs = decode_sattr(args, attrsset);
+        } else {
+            node.how   = mode == GUARDED4 ? nfs3::CreateMode3::GUARDED
+                                          : nfs3::CreateMode3::UNCHECKED;
+            node.attrs = decode_sattr(args, attrsset);
+        }
+    }
+    const uint32_t claim = args.get_uint32();
+    std::string name;
+    if (claim == CLAIM_NULL) name = args.get_string();
+    else if (claim != CLAIM_FH) fail(Nfsstat4::NFS4ERR_NOTSUPP);
+    if (claim == CLAIM_FH && (c.minor == 0 || create)) fail(Nfsstat4::NFS4ERR_INVAL);
+
+    uint64_t file = 0;
+    uint64_t before = 0, after = 0;
+    if (claim == CLAIM_FH) {
+        file = c.current();
+    } else if (create) {
+        Wcc wcc;
+        file   = s.fs.create(c.current(), name, node, &wcc);
+        before = wcc.change_before;
+        after  = wcc.after.change;
+    } else {
+        const uint64_t dir = c.current();
+        file   = s.fs.lookup(dir, name);
+        before = after = s.fs.stat(dir).change;
+    }
+    const Ftype3 type = s.fs.stat(file).attr.type;
+    if (type == Ftype3::NF3DIR) fail(Nfsstat4::NFS4ERR_ISDIR);
+    if (type == Ftype3::NF3LNK) fail(Nfsstat4::NFS4ERR_SYMLINK);
+    if (type != Ftype3::NF3REG) fail(Nfsstat4::NFS4ERR_INVAL);
+
+    const Stateid4 sid = new_stateid(s);
+    uint32_t rflags = OPEN4_RESULT_LOCKTYPE_POSIX;
+    if (c.minor == 0) {
+        std::lock_guard<std::mutex> lk(s.v4.mutex);
+        s.v4.open_owners[sid.other] = owner;
+        if (!s.v4.confirmed_owners.count(owner)) {
+            rflags |= OPEN4_RESULT_CONFIRM;
+            s.v4.unconfirmed[sid.other] = owner;
+        }
+    }
+
+    c.cfh = file;
+    encode_stateid4(res, sid);
+    put_change_info(res, before, after);
+    res.put_uint32(rflags);
+    encode_bitmap4(res, attrsset);
+    res.put_uint32(0);                              // OPEN_DELEGATE_NONE
+}
+
+static void op_readdir(Compound& c, XdrDecoder& args, XdrEncoder& res) {
+    const uint64_t cookie   = args.get_uint64();
+    args.skip(8);                                   // cookieverf
+    const uint32_t dircount = args.get_uint32();
+    const uint32_t maxcount = args.get_uint32();
+    const std::vector<uint32_t> want = decode_bitmap4(args);
+
+    const uint64_t dir = c.current();
+    if (cookie == 1 || cookie == 2) fail(Nfsstat4::NFS4ERR_BAD_COOKIE);
+    bool fs_eof = false;
+    const auto list = c.s.fs.readdir(dir, cookie, maxcount / 24 + 1, fs_eof);
+
+    // Encode entries on the side until the next one would not fit.
+    static constexpr size_t FIXED = 8 + 4 + 4;      // verf, list end, eof
+    XdrEncoder body;
+    size_t total = FIXED, names = 0, n = 0;
+    for (; n < list.size(); ++n) {
+        const DirEntry& e = list[n];
+        Stat st;
+        try {
+            st = c.s.fs.stat(e.fileid);
+        } catch (const NfsError&) {
+            continue;                               // removed since readdir()
+        }
+        const size_t start = body.size();
+        body.put_uint32(1);
+        body.put_uint64(e.cookie);
+        body.put_string(e.name);
+        encode_fattr(body, want, st, c.s.opts.max_io_size);
+        const size_t entry = body.size() - start;
+        const size_t name  = 8 + xdr_opaque_size(e.name.size());
+        if (total + entry > maxcount || (dircount && names + name > dircount)) break;
+        total += entry;
+        names += name;
+    }
+    if (n == 0 && !list.empty()) fail(Nfsstat4::NFS4ERR_TOOSMALL);
+
+    std::vector<uint8_t> bytes = body.release();
+    bytes.resize(total - FIXED);                    // drop the entry that did not fit
+    res.put_uint64(0);                              // cookieverf
+    std::memcpy(res.put_raw(bytes.size()), bytes.data(), bytes.size());
+    res.put_uint32(0);
+    res.put_uint32(n == list.size() && fs_eof ? 1 : 0);
+}
+
+static void op_exchange_id(Compound& c, XdrDecoder& args, XdrEncoder& res) {
+    args.skip(8);                                   // verifier
+    args.skip_opaque();                             // ownerid
+    args.get_uint32();                              // flags
+    if (args.get_uint32() != 0) fail(Nfsstat4::NFS4ERR_NOTSUPP);   // SP4_NONE only
+    const uint32_t impls = args.get_uint32();
+    if (impls > 1) fail(Nfsstat4::NFS4ERR_BADXDR);
+    for (uint32_t i = 0; i < impls; ++i) {
+        args.skip_opaque();
+        args.skip_opaque();
+        args.skip(12);
+    }
+
+    uint64_t clientid;
+    {
+        std::lock_guard<std::mutex> lk(c.s.v4.mutex);
+        clientid = c.s.v4.next_clientid++;
+    }
+    res.put_uint64(clientid);
+    res.put_uint32(1);                              // sequenceid
+    res.put_uint32(EXCHGID4_FLAG_USE_NON_PNFS);
+    res.put_uint32(0);                              // SP4_NONE
+    res.put_uint64(0);                              // server_owner.minor_id
+    res.put_opaque(reinterpret_cast<const uint8_t*>(SERVER_OWNER), sizeof(SERVER_OWNER) - 1);
+    res.put_opaque(reinterpret_cast<const uint8_t*>(SERVER_OWNER), sizeof(SERVER_OWNER) - 1);
+    res.put_uint32(0);                              // no impl_id
+}
+
+static ChannelAttrs41 decode_channel(XdrDecoder& args) {
+    uint32_t w[7];
+    args.get_uint32_words(w, 7);
+    args.skip(4 * static_cast<size_t>(std::min<uint32_t>(w[6], 1)));
+    ChannelAttrs41 ca;
+    ca.headerpadsize          = w[0];
+    ca.maxrequestsize         = w[1];
+    ca.maxresponsesize        = w[2];
+    ca.maxresponsesize_cached = w[3];
+    ca.maxoperations          = w[4];
+    ca.maxrequests            = w[5];
+    return ca;
+}
+
+static void put_channel(XdrEncoder& res, const ChannelAttrs41& ca) {
+    const uint32_t w[7] = {ca.headerpadsize, ca.maxrequestsize, ca.maxresponsesize,
+                           ca.maxresponsesize_cached, ca.maxoperations,
+                           ca.maxrequests, 0};
+    res.put_uint32_words(w, 7);
+}
+
+static void op_create_session(Compound& c, XdrDecoder& args, XdrEncoder& res) {
+    const uint64_t clientid = args.get_uint64();
+    const uint32_t sequence = args.get_uint32();
+    args.get_uint32();                              // flags: no persistence, no back channel
+    ChannelAttrs41       fore = decode_channel(args);
+    const ChannelAttrs41 back = decode_channel(args);
+    args.get_uint32();                              // cb_program
+    const uint32_t nsec = args.get_uint32();
+    for (uint32_t i = 0; i < nsec; ++i) {
+        switch (args.get_uint32()) {
+        case 0:                                     // AUTH_NONE
+            break;
+        case 1:                                     // AUTH_SYS
+            args.get_uint32();
+            args.skip_opaque();
+            args.skip(8);
+            args.get_uint32_array();
+            break;
+        case 6:                                     // RPCSEC_GSS
+            args.get_uint32();
+            args.skip_opaque();
+            args.skip_opaque();
+            break;
+        default:
+            fail(Nfsstat4::NFS4ERR_BADXDR);
+        }
+    }
+
+    const uint32_t io_max = c.s.opts.max_io_size + CHANNEL_IO_HEADROOM;
+    fore.headerpadsize   = 0;
+    fore.maxrequestsize  = std::min(fore.maxrequestsize, io_max);
+    fore.maxresponsesize = std::min(fore.maxresponsesize, io_max);
+    fore.maxrequests     = std::max(1u, std::min(fore.maxrequests,
+                                                 c.s.opts.max_session_slots));
+    if (c.s.opts.max_compound_ops != 0)
+        fore.maxoperations = std::min(fore.maxoperations, c.s.opts.max_compound_ops);
+
+    SessionId41 sid{};
+    {
+        std::lock_guard<std::mutex> lk(c.s.v4.mutex);
+        if (clientid == 0 || clientid >= c.s.v4.next_clientid)
+            fail(Nfsstat4::NFS4ERR_STALE_CLIENTID);
+        xdr_store_be64(sid.data(), clientid);
+        xdr_store_be32(sid.data() + 8, c.s.v4.next_session++);
+        c.s.v4.sessions[sid].assign(fore.maxrequests, 0);
+    }
+    res.put_fixed_opaque(sid.data(), sid.size());
+    res.put_uint32(sequence);
+    res.put_uint32(0);                              // flags
+    put_channel(res, fore);
+    put_channel(res, back);
+}
+
+static SessionId41 get_sessionid(XdrDecoder& args) {
+    SessionId41 sid;
+    std::memcpy(sid.data(), args.get_fixed_opaque_view(16).data, 16);
+    return sid;
+}
+
+static void op_sequence(Compound& c, XdrDecoder& args, XdrEncoder& res) {
+    SequenceResult41 r;
+    r.sessionid  = get_sessionid(args);
+    r.sequenceid = args.get_uint32();
+    r.slotid     = args.get_uint32();
+    args.get_uint32();                              // highest_slotid
+    args.get_uint32();                              // cachethis: nothing is cached
+    {
+        std::lock_guard<std::mutex> lk(c.s.v4.mutex);
+        auto it = c.s.v4.sessions.find(r.sessionid);
+        if (it == c.s.v4.sessions.end()) fail(Nfsstat4::NFS4ERR_BADSESSION);
+        std::vector<uint32_t>& slots = it->second;
+        if (r.slotid >= slots.size()) fail(Nfsstat4::NFS4ERR_BADSLOT);
+        uint32_t& last = slots[r.slotid];
+        if (r.sequenceid == last) throw Nfs4Error(NFS4ERR_RETRY_UNCACHED_REP);
+        if (r.sequenceid != last + 1) fail(Nfsstat4::NFS4ERR_SEQ_MISORDERED);
+        last = r.sequenceid;
+        r.highest_slotid = r.target_highest_slotid =
+            static_cast<uint32_t>(slots.size() - 1);
+    }
+    xdr_encode(res, r);
+}
+
+// One operation: its arguments are next in `args`; returns its status.
+static uint32_t run_op(Compound& c, uint32_t op, XdrDecoder& args, XdrEncoder& res) {
+    ServerState& s  = c.s;
+    FakeFs&      fs = s.fs;
+
+    // Operations NFSv4.1 removed.
+    if (c.minor != 0 && (op == OP_OPEN_CONFIRM || op == OP_RENEW ||
+                 op == OP_SETCLIENTID || op == OP_SETCLIENTID_CONFIRM))
+        fail(Nfsstat4::NFS4ERR_NOTSUPP);
+
+    switch (op) {
+    case OP_ACCESS: {
+        const uint32_t mask = args.get_uint32();
+        fs.stat(c.current());
+        res.put_uint32(mask & 0x3f);                // supported
+        res.put_uint32(mask & 0x3f);                // granted: everything
+        break;
+    }
+    case OP_CLOSE: {
+        args.get_uint32();                          // seqid
+        Stateid4 sid = decode_stateid4(args);
+        fs.stat(c.current());
+        ++sid.seqid;
+        encode_stateid4(res, sid);
+        break;
+    }
+    case OP_COMMIT:
+        args.get_uint64();
+        args.get_uint32();
+        fs.stat(c.current());
+        res.put_fixed_opaque(s.write_verf.data(), 8);
+        break;
+
+    case OP_CREATE: {
+        NewNode node;
+        node.type = static_cast<Ftype3>(args.get_uint32());
+        node.uid  = c.who.uid;
+        node.gid  = c.who.gid;
+        if (node.type == Ftype3::NF3LNK) node.target = args.get_string();
+        if (node.type == Ftype3::NF3BLK || node.type == Ftype3::NF3CHR)
+            node.rdev = xdr_decode<Specdata3>(args);
+        const std::string name = args.get_string();
+        std::vector<uint32_t> attrsset;
+        node.attrs = decode_sattr(args, attrsset);
+        if (node.type == Ftype3::NF3REG || static_cast<uint32_t>(node.type) < 1 ||
+            static_cast<uint32_t>(node.type) > 7)
+            fail(Nfsstat4::NFS4ERR_BADTYPE);
+        Wcc wcc;
+        c.cfh = fs.create(c.current(), name, node, &wcc);
+        put_change_info(res, wcc);
+        encode_bitmap4(res, attrsset);
+        break;
+    }
+    case OP_GETATTR: {
+        const std::vector<uint32_t> want = decode_bitmap4(args);
+        encode_fattr(res, want, fs.stat(c.current()), s.opts.max_io_size);
+        break;
+    }
+    case OP_GETFH:
+        fs.stat(c.current());
+        res.put_opaque(make_handle(c.cfh));
+        break;
+
+    case OP_LOOKUP: {
+        const std::string name = args.get_string();
+        if (name.empty() || name == "." || name == "..") fail(Nfsstat4::NFS4ERR_BADNAME);
+        c.cfh = fs.lookup(c.current(), name);
+        break;
+    }
+    case OP_LOOKUPP: {
+        const uint64_t dir = c.current();
+        if (fs.stat(dir).attr.type != Ftype3::NF3DIR) fail(Nfsstat4::NFS4ERR_NOTDIR);
+        if (dir == FakeFs::ROOT) fail(Nfsstat4::NFS4ERR_NOENT);
+        c.cfh = fs.parent(dir);
+        break;
+    }
+    case OP_OPEN:
+        op_open(c, args, res);
+        break;
+
+    case OP_OPEN_CONFIRM: {
+        Stateid4 sid = decode_stateid4(args);
+        args.get_uint32();                          // seqid
+        fs.stat(c.current());
+        {
+            std::lock_guard<std::mutex> lk(s.v4.mutex);
+            auto it = s.v4.unconfirmed.find(sid.other);
+            if (it == s.v4.unconfirmed.end()) fail(Nfsstat4::NFS4ERR_BAD_STATEID);
+            s.v4.confirmed_owners.insert(it->second);
+            s.v4.unconfirmed.erase(it);
+        }
+        ++sid.seqid;
+        encode_stateid4(res, sid);
+        break;
+    }
+    case OP_PUTFH: {
+        const uint64_t id = fileid_of(args.get_opaque_view());
+        if (!fs.exists(id)) fail(Nfsstat4::NFS4ERR_STALE);
+        c.cfh = id;
+        break;
+    }
+    case OP_PUTROOTFH:
+        c.cfh = FakeFs::ROOT;
+        break;
+
+    case OP_READ: {
+        decode_stateid4(args);
+        const uint64_t offset = args.get_uint64();
+        const uint32_t count  = std::min(args.get_uint32(), read_limit(s.opts));
+        std::vector<uint8_t> data;
+        bool eof = false;
+        fs.read(c.current(), offset, count, data, eof);
+        res.put_uint32(eof ? 1 : 0);
+        res.put_opaque(data);
+        break;
+    }
+    case OP_READDIR:
+        op_readdir(c, args, res);
+        break;
+
+    case OP_READLINK:
+        res.put_string(fs.readlink(c.current()));
+        break;
+
+    case OP_REMOVE: {
+        const std::string name = args.get_string();
+        Wcc wcc;
+        fs.remove(c.current(), name, RemoveKind::ANY, &wcc);
+        put_change_info(res, wcc);
+        break;
+    }
+    case OP_RENAME: {
+        const std::string from = args.get_string();
+        const std::string to   = args.get_string();
+        if (c.sfh == 0) fail(Nfsstat4::NFS4ERR_NOFILEHANDLE);
+        Wcc from_wcc, to_wcc;
+        fs.rename(c.sfh, from, c.current(), to, &from_wcc, &to_wcc);
+        put_change_info(res, from_wcc);
+        put_change_info(res, to_wcc);
+        break;
+    }
+    case OP_RENEW: {
+        const uint64_t clientid = args.get_uint64();
+        std::lock_guard<std::mutex> lk(s.v4.mutex);
+        if (clientid == 0 || clientid >= s.v4.next_clientid)
+            fail(Nfsstat4::NFS4ERR_STALE_CLIENTID);
+        break;
+    }
+    case OP_RESTOREFH:
+        if (c.sfh == 0) fail(Nfsstat4::NFS4ERR_RESTOREFH);
+        c.cfh = c.sfh;
+        break;
+
+    case OP_SAVEFH:
+        c.sfh = c.current();
+        break;
+
+    case OP_SETATTR: {
+        // SETATTR4res carries attrsset even on failure: empty then.
+        decode_stateid4(args);
+        std::vector<uint32_t> attrsset;
+        try {
+            const SetAttrs a = decode_sattr(args, attrsset);
+            fs.setattr(c.current(), a);
+        } catch (const std::exception&) {
+            encode_bitmap4(res, {});
+            throw;
+        }
+        encode_bitmap4(res, attrsset);
+        break;
+    }
+    case OP_SETCLIENTID: {
+        args.skip(8);                               // verifier
+        args.skip_opaque();                         // id
+        args.get_uint32();                          // cb_program
+        args.skip_opaque();                         // r_netid
+        args.skip_opaque();                         // r_addr
+        args.get_uint32();                          // callback_ident
+        uint64_t clientid;
+        {
+            std::lock_guard<std::mutex> lk(s.v4.mutex);
+            clientid = s.v4.next_clientid++;
+        }
+        res.put_uint64(clientid);
+        res.put_uint64(clientid);                   // setclientid_confirm verifier
+        break;
+    }
+    case OP_SETCLIENTID_CONFIRM: {
+        const uint64_t clientid = args.get_uint64();
+        const uint64_t verf     = xdr_load_be64(args.get_fixed_opaque_view(8).data);
+        if (verf != clientid) fail(Nfsstat4::NFS4ERR_STALE_CLIENTID);
+        break;
+    }
+    case OP_WRITE: {
+        decode_stateid4(args);
+        const uint64_t   offset = args.get_uint64();
+        const uint32_t   stable = args.get_uint32();
+        const XdrSegment data   = args.get_opaque_view();
+        if (data.size > s.opts.max_io_size) fail(Nfsstat4::NFS4ERR_INVAL);
+        const uint32_t n = fs.write(c.current(), offset, data.data,
+                                    static_cast<uint32_t>(data.size));
+        res.put_uint32(n);
+        res.put_uint32(stable == 0 ? 0 : 2);        // UNSTABLE4, else FILE_SYNC4
+        res.put_fixed_opaque(s.write_verf.data(), 8);
+        break;
+    }
+
+    case OP_BIND_CONN_TO_SESSION: {
+        const SessionId41 sid = get_sessionid(args);
+        const uint32_t dir = args.get_uint32();     // channel_dir_from_client4
+        args.get_uint32();                          // use_conn_in_rdma_mode
+        {
+            std::lock_guard<std::mutex> lk(s.v4.mutex);
+            if (!s.v4.sessions.count(sid)) fail(Nfsstat4::NFS4ERR_BADSESSION);
+        }
+        res.put_fixed_opaque(sid.data(), sid.size());
+        res.put_uint32(dir == CDFC4_BACK ? CDFS4_BACK : CDFS4_FORE);
+        res.put_uint32(0);
+        break;
+    }
+    case OP_EXCHANGE_ID:
+        op_exchange_id(c, args, res);
+        break;
+
+    case OP_CREATE_SESSION:
+        op_create_session(c, args, res);
+        break;
+
+    case OP_DESTROY_SESSION: {
+        const SessionId41 sid = get_sessionid(args);
+        std::lock_guard<std::mutex> lk(s.v4.mutex);
+        if (!s.v4.sessions.erase(sid)) fail(Nfsstat4::NFS4ERR_BADSESSION);
+        break;
+    }
+    case OP_FREE_STATEID:
+        decode_stateid4(args);
+        break;
+
+    case OP_SEQUENCE:
+        op_sequence(c, args, res);
+        break;
+
+    case OP_TEST_STATEID: {
+        const uint32_t n = args.get_uint32();
+        args.skip(static_cast<size_t>(n) * xdr_wire_size<Stateid4>);
+        res.put_uint32(n);
+        for (uint32_t i = 0; i < n; ++i) res.put_uint32(NFS4_OK);
+        break;
+    }
+    case OP_DESTROY_CLIENTID:
+        args.get_uint64();
+        break;
+
+    case OP_RECLAIM_COMPLETE:
+        args.get_uint32();
+        break;
+
+    default:
+        fail(Nfsstat4::NFS4ERR_NOTSUPP);
+    }
+    return NFS4_OK;
+}
+
+// Ops an NFSv4.1 COMPOUND may start with instead of SEQUENCE.
+static bool sessionless(uint32_t op) {
+    return op == OP_EXCHANGE_ID || op == OP_CREATE_SESSION || op == OP_DESTROY_SESSION ||
+           op == OP_BIND_CONN_TO_SESSION || op == OP_DESTROY_CLIENTID;
+}
+
+// Opcodes the minor version defines (RFC 7530 §16, RFC 8881 §18); the rest
+// are OP_ILLEGAL.
+static bool known_op(uint32_t op, uint32_t minor) {
+    return op >= OP_ACCESS && op <= (minor == 0 ? OP_RELEASE_LOCKOWNER : OP_RECLAIM_COMPLETE);
+}
+
+// The open-owner seqid a v4.0 OPEN, OPEN_CONFIRM or CLOSE carries.
+struct SeqidUse {
+    Nfs4Registry::OpenOwner owner;
+    uint32_t                seqid = 0;
+};
+
+// Read the open-owner and seqid of `op` from a copy of its arguments, so
+// that they are checked and counted also when the op itself does not run.
+// False for other ops, for stateids of no known open, and for arguments
+// too short, which the op itself then reports.
+static bool peek_seqid(ServerState& s, uint32_t op, XdrDecoder args, SeqidUse& use) {
+    if (op != OP_OPEN && op != OP_OPEN_CONFIRM && op != OP_CLOSE) return false;
+    Stateid4 sid;
+    try {
+        if (op != OP_OPEN_CONFIRM) use.seqid = args.get_uint32();
+        if (op == OP_OPEN) {
+            args.skip(8);                           // share_access, share_deny
+            use.owner.first  = args.get_uint64();
+            use.owner.second = args.get_opaque();
+            return true;
+        }
+        sid = decode_stateid4(args);
+        if (op == OP_OPEN_CONFIRM) use.seqid = args.get_uint32();
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(s.v4.mutex);
+    const auto it = s.v4.open_owners.find(sid.other);
+    if (it == s.v4.open_owners.end()) return false;
+    use.owner = it->second;
+    return true;
+}
+
+// RFC 7530 §9.1.7: an owner's first seqid may be anything, each later one
+// the last one it used plus one.  Returns NFS4_OK or NFS4ERR_BAD_SEQID.
+static uint32_t check_seqid(ServerState& s, const SeqidUse& use) {
+    std::lock_guard<std::mutex> lk(s.v4.mutex);
+    const auto it = s.v4.owner_seqids.find(use.owner);
+    if (it == s.v4.owner_seqids.end() || use.seqid == it->second + 1) return NFS4_OK;
+    return static_cast<uint32_t>(Nfsstat4::NFS4ERR_BAD_SEQID);
+}
+
+// The op with `use` finished with `status`: count its seqid as used unless
+// the error says it was never applied.
+static void seqid_done(ServerState& s, const SeqidUse& use, uint32_t status) {
+    if (!nfs4_seqid_advances(status)) return;
+    std::lock_guard<std::mutex> lk(s.v4.mutex);
+    s.v4.owner_seqids[use.owner] = use.seqid;
+}
+
+// The status queued by FakeServer::fail_nfs4_op() for `op`, or NFS4_OK.
+static uint32_t injected_failure(ServerState& s, uint32_t op) {
+    std::lock_guard<std::mutex> lk(s.inject_mutex);
+    const auto it = s.injected.find(op);
+    if (it == s.injected.end()) return NFS4_OK;
+    const uint32_t status = it->second.first;
+    if (--it->second.second == 0) s.injected.erase(it);
+    return status;
+}
+
+bool nfs4_call(ServerState& s, uint32_t proc, const Caller& who,
+               XdrDecoder& args, XdrEncoder& res) {
+    if (proc == 0) return true;                     // NULL
+    if (proc != 1) return false;
+
+    const std::string tag   = args.get_string();
+    const uint32_t    minor = args.get_uint32();
+    const uint32_t    nops  = args.get_uint32();
+
+    const size_t status_at = res.mark();
+    res.put_uint32(NFS4_OK);
+    res.put_string(tag);
+    const size_t count_at = res.mark();
+    res.put_uint32(0);
+
+    if (minor > 1) {
+        res.patch_uint32(status_at, static_cast<uint32_t>(Nfsstat4::NFS4ERR_MINOR_VERS_MISMATCH));
+        return true;
+    }
+
+    const uint32_t max_ops = s.opts.max_compound_ops;
+    if (max_ops != 0 && nops > max_ops) {
+        res.patch_uint32(status_at, minor == 0
+            ? static_cast<uint32_t>(Nfsstat4::NFS4ERR_RESOURCE)
+            : static_cast<uint32_t>(Nfsstat4::NFS4ERR_TOO_MANY_OPS));
+        return true;
+    }
+
+    Compound c{s, who, minor};
+    uint32_t status = NFS4_OK, done = 0;
+    while (done < nops && status == NFS4_OK) {
+        const uint32_t op = args.get_uint32();
+        ++done;
+        if (op < s.nfs4_ops.size()) ++s.nfs4_ops[op];
+
+        if (!known_op(op, minor)) {
+            res.put_uint32(OP_ILLEGAL);
+            status = static_cast<uint32_t>(Nfsstat4::NFS4ERR_OP_ILLEGAL);
+            res.put_uint32(status);
+            break;
+        }
+        res.put_uint32(op);
+        const size_t op_status_at = res.mark();
+        res.put_uint32(NFS4_OK);
+        SeqidUse   use;
+        const bool seqid_op = minor == 0 && peek_seqid(s, op, args, use);
+        if (seqid_op && (status = check_seqid(s, use)) != NFS4_OK) {
+            // out of order: the arguments are left unread
+        } else if (minor == 1 && done == 1 && op != OP_SEQUENCE && !sessionless(op)) {
+            status = NFS4ERR_OP_NOT_IN_SESSION;
+        } else if (minor == 1 && done > 1 && op == OP_SEQUENCE) {
+            status = NFS4ERR_SEQUENCE_POS;
+        } else if ((status = injected_failure(s, op)) != NFS4_OK) {
+            // queued by the test; the arguments are left unread
+        } else {
+            try {
+                status = run_op(c, op, args, res);
+            } catch (const Nfs4Error& e) {
+                status = e.status;
+            } catch (const NfsError& e) {
+                status = e.status;                  // FakeFs codes are valid nfsstat4
+            } catch (const std::runtime_error&) {
+                status = static_cast<uint32_t>(Nfsstat4::NFS4ERR_BADXDR);
+            }
+        }
+        if (seqid_op) seqid_done(s, use, status);
+        res.patch_uint32(op_status_at, status);
+    }
+    res.patch_uint32(status_at, status);
+    res.patch_uint32(count_at, done);
+    return true;
+}
+
+}  // namespace fake
@@ -0,0 +1,391 @@
+#include "fake_server.hpp"
+#include "fake_state.hpp"
+
+#include "rpc/record_reader.hpp"
+#include "rpc/rpc_types.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <condition_variable>
+#include <deque>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fake {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint32_t PMAP_PROG  = 100000;
+static constexpr uint32_t PMAP_VERS  = 2;
+static constexpr uint32_t MOUNT_PROG = 100005;
+static constexpr uint32_t MOUNT_VERS = 3;
+static constexpr uint32_t NFS_PROG   = 100003;
+
+static constexpr uint32_t PMAPPROC_GETPORT  = 3;
+static constexpr uint32_t MOUNTPROC3_MNT    = 1;
+static constexpr uint32_t MOUNTPROC3_UMNT   = 3;
+static constexpr uint32_t MOUNTPROC3_EXPORT = 5;
+static constexpr uint32_t IPPROTO_TCP_XDR   = 6;
+static constexpr uint32_t MNT3ERR_NOENT     = 2;
+
+// ── Connections ──────────────────────────────────────────────────────────────
+
+// A reply waiting for its modelled departure time.
+struct Delayed {
+    Clock::time_point    due;
+    std::vector<uint8_t> record;
+};
+
+struct Conn {
+    explicit Conn(int s) : sock(s) {}
+
+    const int         sock;
+    std::thread       reader;
+    std::thread       sender;    // only with latency / bandwidth
+    std::atomic<bool> done{false};
+
+    std::mutex              mutex;      // guards queue and closing
+    std::condition_variable wake;
+    std::deque<Delayed>     queue;
+    bool                    closing = false;
+};
+
+struct Transport {
+    int                                listen_sock = -1;
+    uint16_t                           port        = 0;
+    std::atomic<bool>                  stopping{false};
+    std::thread                        acceptor;
+    std::mutex                         conns_mutex;
+    std::vector<std::unique_ptr<Conn>> conns;
+
+    std::mutex        link_mutex;   // guards link_free
+    Clock::time_point link_free{};  // when the modelled link next goes idle
+};
+
+static bool send_all(int sock, const uint8_t* p, size_t n) {
+    while (n > 0) {
+        const ssize_t w = ::send(sock, p, n, MSG_NOSIGNAL);
+        if (w <= 0) return false;
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+static void finish(Conn& c) {
+    if (c.sender.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            c.closing = true;
+        }
+        c.wake.notify_one();
+        c.sender.join();
+    }
+    if (c.reader.joinable()) c.reader.join();
+    ::close(c.sock);
+}
+
+// ── RPC layer ────────────────────────────────────────────────────────────────
+
+// Reply header up to and including accept_stat.
+static void put_accepted(XdrEncoder& enc, uint32_t xid, AcceptStat stat) {
+    enc.put_uint32(xid);
+    enc.put_uint32(static_cast<uint32_t>(MsgType::REPLY));
+    enc.put_uint32(static_cast<uint32_t>(ReplyStat::MSG_ACCEPTED));
+    enc.put_uint32(AUTH_NONE);   // verifier
+    enc.put_uint32(0);
+    enc.put_uint32(static_cast<uint32_t>(stat));
+}
+
+static Caller decode_credential(XdrDecoder& dec) {
+    Caller who;
+    const uint32_t flavor = dec.get_uint32();
+    const XdrSegment body = dec.get_opaque_view();
+    if (flavor == AUTH_SYS_FLAV) {
+        XdrDecoder cred(body.data, body.size);
+        cred.get_uint32();      // stamp
+        cred.skip_opaque();     // machinename
+        who.uid = cred.get_uint32();
+        who.gid = cred.get_uint32();
+    }
+    dec.get_uint32();           // verifier flavor
+    dec.skip_opaque();          // verifier body
+    return who;
+}
+
+static bool portmap_call(ServerState&, uint16_t port, uint32_t proc,
+                         XdrDecoder& args, XdrEncoder& res) {
+    if (proc == 0) return true;
+    if (proc != PMAPPROC_GETPORT) return false;
+
+    const uint32_t prog = args.get_uint32();
+    const uint32_t vers = args.get_uint32();
+    const uint32_t prot = args.get_uint32();
+    const bool known = prot == IPPROTO_TCP_XDR &&
+        ((prog == NFS_PROG && (vers == 3 || vers == 4)) ||
+         (prog == MOUNT_PROG && vers == MOUNT_VERS));
+    res.put_uint32(known ? port : 0);
+    return true;
+}
+
+static bool mount_call(ServerState& s, uint32_t proc, XdrDecoder& args, XdrEncoder& res) {
+    switch (proc) {
+    case 0:
+        return true;
+    case MOUNTPROC3_MNT: {
+        const std::string path = args.get_string();
+        if (path != s.opts.export_path) {
+            res.put_uint32(MNT3ERR_NOENT);
+            return true;
+        }
+        res.put_uint32(0);
+        res.put_opaque(make_handle(FakeFs::ROOT));
+        res.put_uint32(2);           // auth_flavors
+        res.put_uint32(AUTH_NONE);
+        res.put_uint32(AUTH_SYS_FLAV);
+        return true;
+    }
+    case MOUNTPROC3_UMNT:
+        args.skip_opaque();
+        return true;
+    case MOUNTPROC3_EXPORT:
+        res.put_uint32(1);           // one exportnode
+        res.put_string(s.opts.export_path);
+        res.put_uint32(0);           // no groups: world-accessible
+        res.put_uint32(0);           // end of list
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Decode one CALL record and encode its REPLY into `reply`.  The result body
+// is encoded into `res` and referenced from `reply`, so it is only
+// acknowledged as SUCCESS once the handler has run cleanly.
+static void handle_call(ServerState& s, uint16_t port, const std::vector<uint8_t>& record,
+                        XdrEncoder& reply, XdrEncoder& res) {
+    XdrDecoder dec(record);
+    const uint32_t xid = dec.get_uint32();
+    if (dec.get_uint32() != static_cast<uint32_t>(MsgType::CALL) ||
+        dec.get_uint32() != RPC_VERSION)
+        throw std::runtime_error("fake server: not an RPCv2 CALL");
+    const uint32_t prog = dec.get_uint32();
+    const uint32_t vers = dec.get_uint32();
+    const uint32_t proc = dec.get_uint32();
+    const Caller   who  = decode_credential(dec);
+
+    ++s.rpc_calls;
+
+    uint32_t low = 0, high = 0;
+    switch (prog) {
+    case PMAP_PROG:  low = high = PMAP_VERS;  break;
+    case MOUNT_PROG: low = high = MOUNT_VERS; break;
+    case NFS_PROG:   low = 3; high = 4;       break;
+    default:
+        put_accepted(reply, xid, AcceptStat::PROG_UNAVAIL);
+        return;
+    }
+    if (vers < low || vers > high) {
+        put_accepted(reply, xid, AcceptStat::PROG_MISMATCH);
+        reply.put_uint32(low);
+        reply.put_uint32(high);
+        return;
+    }
+
+    AcceptStat stat = AcceptStat::SUCCESS;
+    try {
+        bool known = false;
+        if (prog == PMAP_PROG)  known = portmap_call(s, port, proc, dec, res);
+        if (prog == MOUNT_PROG) known = mount_call(s, proc, dec, res);
+        if (prog == NFS_PROG)   known = vers == 3 ? nfs3_call(s, proc, who, dec, res)
+                                                  : nfs4_call(s, proc, who, dec, res);
+        if (!known) stat = AcceptStat::PROC_UNAVAIL;
+    } catch (const std::exception&) {
+        stat = AcceptStat::GARBAGE_ARGS;
+    }
+
+    put_accepted(reply, xid, stat);
+    if (stat == AcceptStat::SUCCESS) reply.append_ref(res);
+}
+
+// ── FakeServer ───────────────────────────────────────────────────────────────
+
+static void send_loop(Conn& c) {
+    std::unique_lock<std::mutex> lock(c.mutex);
+    for (;;) {
+        if (c.queue.empty()) {
+            if (c.closing) return;
+            c.wake.wait_until(lock, Clock::now() + std::chrono::milliseconds(100));
+            continue;
+        }
+        if (Clock::now() < c.queue.front().due) {
+            c.wake.wait_until(lock, c.queue.front().due);
+            continue;
+        }
+        Delayed d = std::move(c.queue.front());
+        c.queue.pop_front();
+        lock.unlock();
+        const bool ok = send_all(c.sock, d.record.data(), d.record.size());
+        lock.lock();
+        if (!ok) return;
+    }
+}
+
+static void serve(ServerState& s, Transport& net, Conn& c) {
+    const bool delayed = s.opts.latency.count() > 0 || s.opts.bandwidth > 0;
+    for (;;) {
+        std::vector<uint8_t> record;
+        try {
+            RecordReader rr(c.sock);
+            rr.read_rest(record);
+        } catch (const std::exception&) {
+            break;   // peer closed (or server shutting down)
+        }
+        const auto arrived = Clock::now();
+
+        XdrEncoder reply;
+        XdrEncoder res;
+        reply.put_uint32(0);   // record mark, patched below
+        try {
+            handle_call(s, net.port, record, reply, res);
+        } catch (const std::exception&) {
+            break;   // not RPC: drop the connection
+        }
+        unsigned drops = s.drop_replies.load();
+        while (drops > 0 && !s.drop_replies.compare_exchange_weak(drops, drops - 1)) {}
+        if (drops > 0) {
+            ::shutdown(c.sock, SHUT_RDWR);
+            break;
+        }
+        reply.patch_uint32(0, 0x80000000u | static_cast<uint32_t>(reply.size() - 4));
+        std::vector<uint8_t> bytes = reply.release();
+
+        if (!delayed) {
+            if (!send_all(c.sock, bytes.data(), bytes.size())) break;
+            continue;
+        }
+
+        auto due = arrived + s.opts.latency;
+        if (s.opts.bandwidth > 0) {
+            // Serialise CALL + REPLY bytes on the shared link once the reply
+            // is ready to go.
+            const uint64_t wire = record.size() + bytes.size() + 4;
+            const auto     tx   = std::chrono::nanoseconds(
+                wire * 1'000'000'000ull / s.opts.bandwidth);
+            std::lock_guard<std::mutex> lock(net.link_mutex);
+            due = std::max(due, net.link_free) + tx;
+            net.link_free = due;
+        }
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            c.queue.push_back(Delayed{due, std::move(bytes)});
+        }
+        c.wake.notify_one();
+    }
+    c.done = true;
+}
+
+static void accept_loop(ServerState& s, Transport& net) {
+    const bool delayed = s.opts.latency.count() > 0 || s.opts.bandwidth > 0;
+    while (!net.stopping) {
+        const int sock = ::accept(net.listen_sock, nullptr, nullptr);
+        if (sock < 0) {
+            if (net.stopping) break;
+            continue;
+        }
+        const int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::lock_guard<std::mutex> lock(net.conns_mutex);
+        // Reap connections whose peer has gone.
+        for (auto it = net.conns.begin(); it != net.conns.end();) {
+            if ((*it)->done) {
+                finish(**it);
+                it = net.conns.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        net.conns.push_back(std::make_unique<Conn>(sock));
+        Conn& c = *net.conns.back();
+        if (delayed) c.sender = std::thread(send_loop, std::ref(c));
+        c.reader = std::thread(serve, std::ref(s), std::ref(net), std::ref(c));
+    }
+}
+
+FakeServer::FakeServer(const FakeServerOptions& opts)
+    : state_(std::make_unique<ServerState>(opts)), net_(std::make_unique<Transport>()) {
+    const auto boot = Clock::now().time_since_epoch().count();
+    xdr_store_be64(state_->write_verf.data(), static_cast<uint64_t>(boot));
+
+    net_->listen_sock = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (net_->listen_sock < 0) throw std::runtime_error("fake server: socket() failed");
+    const int one = 1;
+    setsockopt(net_->listen_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = htons(opts.port);
+    socklen_t len = sizeof(addr);
+    if (::bind(net_->listen_sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(net_->listen_sock, 64) != 0 ||
+        ::getsockname(net_->listen_sock, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        ::close(net_->listen_sock);
+        throw std::runtime_error("fake server: cannot listen on port " +
+                                 std::to_string(opts.port));
+    }
+    net_->port     = ntohs(addr.sin_port);
+    net_->acceptor = std::thread(accept_loop, std::ref(*state_), std::ref(*net_));
+}
+
+FakeServer::~FakeServer() {
+    net_->stopping = true;
+    ::shutdown(net_->listen_sock, SHUT_RDWR);   // wakes accept()
+    net_->acceptor.join();
+    ::close(net_->listen_sock);
+
+    std::lock_guard<std::mutex> lock(net_->conns_mutex);
+    for (auto& c : net_->conns) ::shutdown(c->sock, SHUT_RDWR);
+    for (auto& c : net_->conns) finish(*c);
+}
+
+const std::string& FakeServer::host() const        { return state_->host; }
+uint16_t           FakeServer::port() const        { return net_->port; }
+const std::string& FakeServer::export_path() const { return state_->opts.export_path; }
+FakeFs&            FakeServer::fs()                { return state_->fs; }
+
+ClientOptions FakeServer::client_options(ClientOptions base) const {
+    base.portmap_port = net_->port;
+    return base;
+}
+
+uint64_t FakeServer::rpc_calls() const { return state_->rpc_calls; }
+
+uint64_t FakeServer::nfs3_calls(uint32_t proc) const {
+    return proc < state_->nfs3_calls.size() ? state_->nfs3_calls[proc].load() : 0;
+}
+
+uint64_t FakeServer::nfs4_ops(uint32_t op) const {
+    return op < state_->nfs4_ops.size() ? state_->nfs4_ops[op].load() : 0;
+}
+
+void FakeServer::reset_counters() {
+    state_->rpc_calls = 0;
+    for (auto& n : state_->nfs3_calls) n = 0;
+    for (auto& n : state_->nfs4_ops)   n = 0;
+}
+
+void FakeServer::fail_nfs4_op(uint32_t op, uint32_t status, unsigned times) {
+    std::lock_guard<std::mutex> lk(state_->inject_mutex);
+    if (times == 0) state_->injected.erase(op);
+    else            state_->injected[op] = {status, times};
+}
+
+void FakeServer::drop_replies(unsigned times) { state_->drop_replies = times; }
+
+}  // namespace fake
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "fake_fs.hpp"
+
+#include "client_options.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace fake {
+
+struct ServerState;
+struct Transport;
+
+struct FakeServerOptions {
+    // Path MOUNT MNT accepts; NFSv4 PUTROOTFH lands on the same directory.
+    std::string export_path = "/export";
+
+    // Loopback port to listen on; 0 picks a free one (see FakeServer::port()).
+    uint16_t port = 0;
+
+    // Added to every reply, counted from the moment its CALL was read.
+    std::chrono::microseconds latency{0};
+
+    // Link bandwidth in bytes per second, shared by all connections and
+    // charged for each CALL and REPLY record; 0 = unlimited.
+    uint64_t bandwidth = 0;
+
+    // See FakeFs: false drops WRITE data and READs zeros.
+    bool store_data = true;
+
+    // Largest READ/WRITE payload: FSINFO rtmax/wtmax, and the NFSv4.1
+    // fore-channel sizes granted by CREATE_SESSION (plus headroom).
+    uint32_t max_io_size = 1u << 20;
+
+    // Largest READ reply actually sent, if below max_io_size; 0 = no lower.
+    // Longer READs come back short without being at EOF, as servers may do.
+    uint32_t short_read = 0;
+
+    // NFSv4.1 fore-channel slots granted at most.
+    uint32_t max_session_slots = 64;
+
+    // Most operations a COMPOUND may carry (the NFSv4.1 ca_maxoperations
+    // granted at most); 0 = unlimited.  Longer COMPOUNDs are refused whole
+    // with NFS4ERR_RESOURCE (v4.0) or NFS4ERR_TOO_MANY_OPS (v4.1).
+    uint32_t max_compound_ops = 0;
+};
+
+// Hermetic NFS server stand-in on 127.0.0.1 for tests and benchmarks.
+//
+// One TCP port answers every program the clients use: portmap GETPORT (which
+// points MOUNT, NFSv3 and NFSv4 back at the same port), MOUNT v3, NFSv3, and
+// NFSv4.0 / 4.1 COMPOUND, all backed by one in-memory FakeFs.  Connect with
+// host() and client_options(), which sets ClientOptions::portmap_port.
+//
+// Each connection is served by its own thread, so calls on one connection are
+// handled in order while connections proceed in parallel.  With `latency` or
+// `bandwidth` set, replies are held back until their modelled departure time
+// by a per-connection sender thread; the request itself is applied at once.
+//
+// NFSv4 state is tracked loosely: client IDs, sessions and SEQUENCE slot
+// ordering are checked, as are v4.0 open-owner seqids, OPEN_CONFIRM is
+// required once per v4.0 open-owner, but stateids are never validated and
+// there are no locks or delegations.
+class FakeServer {
+public:
+    explicit FakeServer(const FakeServerOptions& opts = {});
+    ~FakeServer();
+
+    FakeServer(const FakeServer&) = delete;
+    FakeServer& operator=(const FakeServer&) = delete;
+
+    const std::string& host() const;
+    uint16_t           port() const;
+    const std::string& export_path() const;
+
+    // `base` with portmap_port pointing at this server.
+    ClientOptions client_options(ClientOptions base = {}) const;
+
+    // The backing filesystem, e.g. to pre-populate it or inspect results.
+    FakeFs& fs();
+
+    // Calls served since construction or reset_counters(): all RPC calls,
+    // NFSv3 calls by procedure number, NFSv4 operations by opcode.
+    uint64_t rpc_calls() const;
+    uint64_t nfs3_calls(uint32_t proc) const;
+    uint64_t nfs4_ops(uint32_t op) const;
+    void     reset_counters();
+
+    // Fail the next `times` NFSv4 operations `op` with `status` instead of
+    // running them, e.g. NFS4ERR_GRACE, to exercise client error paths.
+    void fail_nfs4_op(uint32_t op, uint32_t status, unsigned times = 1);
+
+    // Run the next `times` calls, but close their connection instead of
+    // replying, as when a link fails after the request got through.
+    void drop_replies(unsigned times = 1);
+
+private:
+    std::unique_ptr<ServerState> state_;   // filesystem, NFSv4 state, counters
+    std::unique_ptr<Transport>   net_;     // listener and connections
+};
+
+}  // namespace fake
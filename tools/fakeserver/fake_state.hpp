@@ -0,0 +1,84 @@
+#pragma once
+
+// Internal to the fake server: state shared by its program handlers.
+
+#include "fake_server.hpp"
+
+#include "nfs4/nfs4_types.hpp"
+#include "xdr/xdr.hpp"
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fake {
+
+// Identity from a CALL's credential; AUTH_NONE maps to nobody.
+struct Caller {
+    uint32_t uid = 65534;
+    uint32_t gid = 65534;
+};
+
+// NFSv4 client IDs, open-owners and sessions.
+struct Nfs4Registry {
+    std::mutex mutex;
+    uint64_t   next_clientid = 1;
+    uint32_t   next_session  = 1;
+    uint32_t   next_stateid  = 1;
+
+    // v4.0 open-owners (clientid, owner) that have done OPEN_CONFIRM, and
+    // those waiting for it by the `other` field of the stateid OPEN returned.
+    using OpenOwner = std::pair<uint64_t, std::vector<uint8_t>>;
+    std::set<OpenOwner>                             confirmed_owners;
+    std::map<std::array<uint8_t, 12>, OpenOwner>    unconfirmed;
+
+    // The last seqid each v4.0 open-owner used, and the owner of every open
+    // stateid, by its `other` field, for OPEN_CONFIRM and CLOSE.
+    std::map<OpenOwner, uint32_t>                   owner_seqids;
+    std::map<std::array<uint8_t, 12>, OpenOwner>    open_owners;
+
+    // Last sequenceid seen on each slot, per session.
+    std::map<SessionId41, std::vector<uint32_t>> sessions;
+};
+
+struct ServerState {
+    explicit ServerState(const FakeServerOptions& o)
+        : opts(o), fs(o.store_data) {}
+
+    const FakeServerOptions opts;
+    const std::string       host = "127.0.0.1";
+    FakeFs                  fs;
+    std::array<uint8_t, 8>  write_verf{};   // changes with every server instance
+    Nfs4Registry            v4;
+
+    std::atomic<uint64_t>                 rpc_calls{0};
+    std::array<std::atomic<uint64_t>, 22> nfs3_calls{};
+    std::array<std::atomic<uint64_t>, 64> nfs4_ops{};
+
+    // Failures queued by FakeServer::fail_nfs4_op(): opcode -> (status, times).
+    std::mutex                                        inject_mutex;
+    std::map<uint32_t, std::pair<uint32_t, unsigned>> injected;
+
+    // Replies still to drop, see FakeServer::drop_replies().
+    std::atomic<unsigned>                             drop_replies{0};
+};
+
+// Most bytes one READ returns.
+inline uint32_t read_limit(const FakeServerOptions& o) {
+    return o.short_read && o.short_read < o.max_io_size ? o.short_read : o.max_io_size;
+}
+
+// Program handlers: decode `args`, apply the call to the server state and
+// encode the result body into `res`.  Return false for an unknown procedure
+// (PROC_UNAVAIL); malformed arguments throw (GARBAGE_ARGS).
+bool nfs3_call(ServerState& s, uint32_t proc, const Caller& who,
+               XdrDecoder& args, XdrEncoder& res);
+bool nfs4_call(ServerState& s, uint32_t proc, const Caller& who,
+               XdrDecoder& args, XdrEncoder& res);
+
+}  // namespace fake
@@ -0,0 +1,37 @@
+#include "alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Replacing the global allocation functions is the one portable way to see
+// every allocation, including those inside std::vector and std::string.
+// The count is thread-local so benchmark bookkeeping on other threads does
+// not leak into the numbers.
+
+static thread_local uint64_t t_allocs = 0;
+
+uint64_t thread_alloc_count() { return t_allocs; }
+
+static void* counted_alloc(std::size_t n) {
+    ++t_allocs;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n)   { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    ++t_allocs;
+    return std::malloc(n ? n : 1);
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+    ++t_allocs;
+    return std::malloc(n ? n : 1);
+}
+
+void operator delete(void* p) noexcept                        { std::free(p); }
+void operator delete[](void* p) noexcept                      { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept           { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept         { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept   { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocations made by the calling thread since it started, counted by
+// the replacement operator new in alloc_counter.cpp.
+uint64_t thread_alloc_count();
+
+// Per-iteration counters shared by every benchmark:
+//   bytes/op  — XDR bytes encoded or decoded by one iteration
+//   allocs/op — heap allocations made by one iteration
+// Construct before the timing loop, call finish() after it.
+class OpCounters {
+public:
+    explicit OpCounters(size_t wire_bytes)
+        : wire_bytes_(wire_bytes), start_(thread_alloc_count()) {}
+
+    void finish(benchmark::State& state) const {
+        const uint64_t allocs = thread_alloc_count() - start_;
+        state.counters["bytes/op"] =
+            benchmark::Counter(static_cast<double>(wire_bytes_));
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(allocs), benchmark::Counter::kAvgIterations);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                                static_cast<int64_t>(wire_bytes_));
+    }
+
+private:
+    size_t   wire_bytes_;
+    uint64_t start_;
+};
@@ -0,0 +1,58 @@
+// Attribute and directory-listing decoders on canned replies.
+
+#include "alloc_counter.hpp"
+#include "canned_replies.hpp"
+
+#include "nfs/nfs3_types.hpp"
+#include "nfs/readdirplus.hpp"
+#include "nfs4/nfs4_attr.hpp"
+#include "nfs4/readdir.hpp"
+#include "xdr/xdr.hpp"
+
+#include <benchmark/benchmark.h>
+
+static void BM_DecodeFattr3(benchmark::State& state) {
+    const auto data = canned_fattr3();
+    OpCounters counters(data.size());
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        benchmark::DoNotOptimize(decode_fattr3(dec));
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_DecodeFattr3);
+
+static void BM_DecodeReaddirplusReply(benchmark::State& state) {
+    const auto data = canned_readdirplus_reply(static_cast<size_t>(state.range(0)));
+    OpCounters counters(data.size());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(nfs3::decode_readdirplus_reply(data));
+    counters.finish(state);
+    state.counters["entries/s"] = benchmark::Counter(
+        static_cast<double>(state.range(0)), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_DecodeReaddirplusReply)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_DecodeFattr4(benchmark::State& state) {
+    const auto data = canned_fattr4();
+    OpCounters counters(data.size());
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        benchmark::DoNotOptimize(nfs4::decode_fattr4(dec));
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_DecodeFattr4);
+
+static void BM_DecodeReaddir4Result(benchmark::State& state) {
+    const auto data = canned_readdir4_result(static_cast<size_t>(state.range(0)));
+    OpCounters counters(data.size());
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        benchmark::DoNotOptimize(nfs4::decode_readdir_result(dec));
+    }
+    counters.finish(state);
+    state.counters["entries/s"] = benchmark::Counter(
+        static_cast<double>(state.range(0)), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_DecodeReaddir4Result)->Arg(1)->Arg(100)->Arg(1000);
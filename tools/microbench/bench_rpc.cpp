@@ -0,0 +1,44 @@
+// RPC framing helpers on TcpRpcClient.
+
+#include "alloc_counter.hpp"
+#include "canned_replies.hpp"
+
+#include "rpc/rpc_client.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+static void BM_BuildCallMessage(benchmark::State& state) {
+    const std::vector<uint8_t> args(static_cast<size_t>(state.range(0)), 0x11);
+    AuthSys auth;
+    auth.uid  = 1000;
+    auth.gid  = 1000;
+    auth.gids = {4, 24, 27, 30, 46};
+    const auto sample = TcpRpcClient::buildCallMessage(1, 100003, 3, 1, args, &auth);
+    OpCounters counters(sample.size());
+    uint32_t xid = 0;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(
+            TcpRpcClient::buildCallMessage(++xid, 100003, 3, 1, args, &auth));
+    counters.finish(state);
+}
+BENCHMARK(BM_BuildCallMessage)->Arg(36)->Arg(4096);
+
+static void BM_AddRecordMark(benchmark::State& state) {
+    const std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 0x22);
+    OpCounters counters(payload.size() + 4);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(TcpRpcClient::addRecordMark(payload));
+    counters.finish(state);
+}
+BENCHMARK(BM_AddRecordMark)->Arg(128)->Arg(65536);
+
+static void BM_ParseReply(benchmark::State& state) {
+    const auto record = canned_rpc_reply(static_cast<size_t>(state.range(0)));
+    OpCounters counters(record.size());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(TcpRpcClient::parseReply(record));
+    counters.finish(state);
+}
+BENCHMARK(BM_ParseReply)->Arg(100)->Arg(65536);
@@ -0,0 +1,105 @@
+// XdrEncoder / XdrDecoder primitives.
+
+#include "alloc_counter.hpp"
+
+#include "nfs/nfs3_types.hpp"
+#include "nfs/lookup.hpp"
+#include "xdr/xdr.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+static void BM_EncodeUint32x64(benchmark::State& state) {
+    OpCounters counters(64 * 4);
+    for (auto _ : state) {
+        XdrEncoder enc;
+        for (uint32_t i = 0; i < 64; ++i) enc.put_uint32(i);
+        benchmark::DoNotOptimize(enc.size());
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_EncodeUint32x64);
+
+static void BM_EncodeOpaque(benchmark::State& state) {
+    const std::vector<uint8_t> data(static_cast<size_t>(state.range(0)), 0x42);
+    OpCounters counters(xdr_opaque_size(data.size()));
+    for (auto _ : state) {
+        XdrEncoder enc;
+        enc.put_opaque(data);
+        benchmark::DoNotOptimize(enc.size());
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_EncodeOpaque)->Arg(13)->Arg(64)->Arg(4096);
+
+// A whole metadata request: LOOKUP3args into a stack encoder.
+static void BM_EncodeLookupArgs(benchmark::State& state) {
+    const Fh3 dir{std::vector<uint8_t>(32, 0xAB)};
+    const std::string name = "some_file_name.txt";
+    OpCounters counters(xdr_opaque_size(32) + xdr_opaque_size(name.size()));
+    for (auto _ : state) {
+        XdrEncoder enc;
+        nfs3::encode_lookup_args(enc, dir, name);
+        benchmark::DoNotOptimize(enc.size());
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_EncodeLookupArgs);
+
+static void BM_DecodeUint32x64(benchmark::State& state) {
+    XdrEncoder enc;
+    for (uint32_t i = 0; i < 64; ++i) enc.put_uint32(i);
+    const auto data = enc.release();
+    OpCounters counters(data.size());
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        uint32_t sum = 0;
+        for (int i = 0; i < 64; ++i) sum += dec.get_uint32();
+        benchmark::DoNotOptimize(sum);
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_DecodeUint32x64);
+
+static void BM_DecodeUint32Words(benchmark::State& state) {
+    XdrEncoder enc;
+    for (uint32_t i = 0; i < 64; ++i) enc.put_uint32(i);
+    const auto data = enc.release();
+    OpCounters counters(data.size());
+    uint32_t out[64];
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        dec.get_uint32_words(out, 64);
+        benchmark::DoNotOptimize(out);
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_DecodeUint32Words);
+
+static void BM_DecodeString(benchmark::State& state) {
+    XdrEncoder enc;
+    enc.put_string("a_reasonably_long_directory_entry_name.txt");
+    const auto data = enc.release();
+    OpCounters counters(data.size());
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        benchmark::DoNotOptimize(dec.get_string());
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_DecodeString);
+
+static void BM_DecodeStringView(benchmark::State& state) {
+    XdrEncoder enc;
+    enc.put_string("a_reasonably_long_directory_entry_name.txt");
+    const auto data = enc.release();
+    OpCounters counters(data.size());
+    for (auto _ : state) {
+        XdrDecoder dec(data);
+        benchmark::DoNotOptimize(dec.get_string_view());
+    }
+    counters.finish(state);
+}
+BENCHMARK(BM_DecodeStringView);
@@ -0,0 +1,114 @@
+#include "canned_replies.hpp"
+
+#include "nfs4/compound.hpp"
+#include "nfs4/nfs4_attr.hpp"
+#include "nfs4/nfs4_types.hpp"
+#include "xdr/xdr.hpp"
+#include "xdr/xdr_struct.hpp"
+
+#include <string>
+
+Fattr3 sample_fattr3() {
+    Fattr3 a{};
+    a.type   = Ftype3::NF3REG;
+    a.mode   = 0644;
+    a.nlink  = 1;
+    a.uid    = 1000;
+    a.gid    = 1000;
+    a.size   = 1u << 20;
+    a.used   = 1u << 20;
+    a.fsid   = 0x1234;
+    a.fileid = 987654321;
+    a.atime  = {1700000000, 1};
+    a.mtime  = {1700000001, 2};
+    a.ctime  = {1700000002, 3};
+    return a;
+}
+
+std::vector<uint8_t> canned_fattr3() {
+    XdrEncoder enc;
+    xdr_encode(enc, sample_fattr3());
+    return enc.release();
+}
+
+std::vector<uint8_t> canned_readdirplus_reply(size_t entries) {
+    const Fattr3 attrs = sample_fattr3();
+    const std::vector<uint8_t> fh(32, 0xAB);
+    const uint8_t verf[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    XdrEncoder enc;
+    enc.put_uint32(0);                  // NFS3_OK
+    enc.put_uint32(1);                  // dir_attributes follow
+    xdr_encode(enc, attrs);
+    enc.put_fixed_opaque(verf, 8);      // cookieverf
+    for (size_t i = 0; i < entries; ++i) {
+        enc.put_uint32(1);              // value_follows
+        enc.put_uint64(1000 + i);       // fileid
+        enc.put_string("file_" + std::to_string(i) + ".dat");
+        enc.put_uint64(i + 1);          // cookie
+        enc.put_uint32(1);              // name_attributes follow
+        xdr_encode(enc, attrs);
+        enc.put_uint32(1);              // name_handle follows
+        enc.put_opaque(fh);
+    }
+    enc.put_uint32(0);                  // no more entries
+    enc.put_uint32(1);                  // eof
+    return enc.release();
+}
+
+static void encode_sample_fattr4(XdrEncoder& enc) {
+    using namespace nfs4::attr;
+    nfs4::encode_bitmap4(enc, nfs4::make_bitmap4({TYPE, CHANGE, SIZE, FILEID, MODE,
+                                                  NUMLINKS, OWNER, OWNER_GROUP,
+                                                  TIME_MODIFY}));
+    const size_t len_at = enc.mark();
+    enc.put_uint32(0);
+    enc.put_uint32(1);                  // NF4REG
+    enc.put_uint64(42);                 // change
+    enc.put_uint64(1u << 20);           // size
+    enc.put_uint64(987654321);          // fileid
+    enc.put_uint32(0644);               // mode
+    enc.put_uint32(1);                  // numlinks
+    enc.put_string("1000");             // owner
+    enc.put_string("1000");             // owner_group
+    enc.put_uint64(1700000001);         // time_modify.seconds
+    enc.put_uint32(2);                  // time_modify.nseconds
+    enc.patch_uint32(len_at, static_cast<uint32_t>(enc.mark() - len_at - 4));
+}
+
+std::vector<uint8_t> canned_fattr4() {
+    XdrEncoder enc;
+    encode_sample_fattr4(enc);
+    return enc.release();
+}
+
+std::vector<uint8_t> canned_readdir4_result(size_t entries) {
+    const uint8_t verf[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    XdrEncoder enc;
+    enc.put_uint32(nfs4::OP_READDIR);
+    enc.put_uint32(0);                  // NFS4_OK
+    enc.put_fixed_opaque(verf, 8);
+    for (size_t i = 0; i < entries; ++i) {
+        enc.put_uint32(1);              // value_follows
+        enc.put_uint64(i + 3);          // cookie
+        enc.put_string("file_" + std::to_string(i) + ".dat");
+        encode_sample_fattr4(enc);
+    }
+    enc.put_uint32(0);
+    enc.put_uint32(1);                  // eof
+    return enc.release();
+}
+
+std::vector<uint8_t> canned_rpc_reply(size_t body_bytes) {
+    XdrEncoder enc;
+    enc.put_uint32(0x1234);             // xid
+    enc.put_uint32(1);                  // REPLY
+    enc.put_uint32(0);                  // MSG_ACCEPTED
+    enc.put_uint32(0);                  // verifier AUTH_NONE
+    enc.put_uint32(0);
+    enc.put_uint32(0);                  // SUCCESS
+    auto record = enc.release();
+    record.resize(record.size() + body_bytes, 0x5A);
+    return record;
+}
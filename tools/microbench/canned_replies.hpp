@@ -0,0 +1,27 @@
+#pragma once
+
+#include "nfs/nfs3_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Wire images of typical server replies, built once and decoded repeatedly.
+
+// A populated fattr3 value and its 84-byte encoding.
+Fattr3               sample_fattr3();
+std::vector<uint8_t> canned_fattr3();
+
+// READDIRPLUS3res body (status onward) with `entries` entries, each carrying
+// attributes and a 32-byte file handle.
+std::vector<uint8_t> canned_readdirplus_reply(size_t entries);
+
+// fattr4 (bitmap + attrlist) with the attributes a listing typically asks for.
+std::vector<uint8_t> canned_fattr4();
+
+// READDIR4res op result (resop onward) with `entries` entries.
+std::vector<uint8_t> canned_readdir4_result(size_t entries);
+
+// A complete accepted RPC REPLY record (XID onward) carrying `body_bytes`
+// of result body.
+std::vector<uint8_t> canned_rpc_reply(size_t body_bytes);